@@ -0,0 +1,113 @@
+import XCTest
+@testable import IKEMEN_Lab
+
+/// Tests for the streaming .air action index and on-demand action parsing
+final class AIRParserTests: XCTestCase {
+
+    var workingDir: URL!
+
+    override func setUp() {
+        super.setUp()
+        workingDir = FileManager.default.temporaryDirectory
+            .appendingPathComponent("AIRParserTests-\(UUID().uuidString)")
+        try? FileManager.default.createDirectory(at: workingDir, withIntermediateDirectories: true)
+    }
+
+    override func tearDown() {
+        try? FileManager.default.removeItem(at: workingDir)
+        workingDir = nil
+        super.tearDown()
+    }
+
+    // MARK: - Indexing
+
+    func testIndexRecordsBlockOffsets() throws {
+        // Given
+        let airText = """
+        ; Kung Fu Man animations
+        [Begin Action 0]
+        0,0, 0,0, 10
+        [Begin Action 5]
+        5,0, 0,0, 4
+        """
+        let url = try writeAIR(airText)
+
+        // When
+        let index = try XCTUnwrap(AIRParser.buildIndex(url: url))
+
+        // Then - Each block runs from its header to the next header (or EOF)
+        XCTAssertEqual(index.actionNumbers, [0, 5])
+        let stand = try XCTUnwrap(index.blocks[0])
+        let bytes = Data(airText.utf8)
+        XCTAssertEqual(String(decoding: bytes[Int(stand.offset)..<(Int(stand.offset) + stand.length)], as: UTF8.self),
+                       "[Begin Action 0]\n0,0, 0,0, 10\n")
+        XCTAssertEqual(Int(index.blocks[5]!.offset) + index.blocks[5]!.length, bytes.count)
+    }
+
+    func testIndexSpansChunkBoundaries() throws {
+        // Given - Several thousand actions, well past one read chunk
+        var airText = ""
+        for action in 0..<4000 {
+            airText += "[Begin Action \(action)]\n\(action),0, 0,0, 5\n\(action),1, 0,0, 5\n\n"
+        }
+        XCTAssertGreaterThan(airText.utf8.count, AIRParser.chunkSize * 2)
+        let url = try writeAIR(airText)
+
+        // When
+        let index = try XCTUnwrap(AIRParser.buildIndex(url: url))
+
+        // Then
+        XCTAssertEqual(index.blocks.count, 4000)
+        let last = try XCTUnwrap(index.action(3999))
+        XCTAssertEqual(last.frames.map { $0.group }, [3999, 3999])
+        XCTAssertEqual(index.action(1234)?.frames.first?.image, 0)
+        XCTAssertNil(index.action(4000))
+    }
+
+    func testHeaderRecognition() {
+        func number(_ line: String) -> Int? {
+            return AIRParser.actionNumber(inHeader: Array(line.utf8))
+        }
+
+        XCTAssertEqual(number("[Begin Action 200]"), 200)
+        XCTAssertEqual(number("  [begin  action 7] ; comment"), 7)
+        XCTAssertEqual(number("\t[BEGIN ACTION 0]"), 0)
+        XCTAssertNil(number("; [Begin Action 1]"))
+        XCTAssertNil(number("[Begin Action]"))
+        XCTAssertNil(number("[Statedef 0]"))
+    }
+
+    func testFirstDefinitionOfRepeatedActionWins() throws {
+        let url = try writeAIR("[Begin Action 0]\n1,1, 0,0, 1\n[Begin Action 0]\n2,2, 0,0, 1\n")
+
+        let index = try XCTUnwrap(AIRParser.buildIndex(url: url))
+
+        XCTAssertEqual(index.action(0)?.frames.first?.group, 1)
+    }
+
+    // MARK: - Action Parsing
+
+    func testParseActionSkipsCollisionBoxesAndHonorsLoopStart() {
+        // Given - CRLF line endings, collision boxes, flip and a loop marker
+        let block = "[Begin Action 0]\r\nClsn2Default: 1\r\n  Clsn2[0] = -10,0, 10,-80\r\n" +
+                    "0,0, 0,0, 6\r\nLoopStart\r\n0,1, 2,-1, 6, H ; blink\r\n0,2, 0,0, -1,,A\r\n"
+
+        // When
+        let action = AIRParser.parseAction(Data(block.utf8), number: 0)
+
+        // Then
+        XCTAssertEqual(action.frames.count, 3)
+        XCTAssertEqual(action.loopStart, 1)
+        XCTAssertEqual(action.frames[1], AIRFrame(group: 0, image: 1, x: 2, y: -1, duration: 6, flip: "H"))
+        XCTAssertEqual(action.frames[2].duration, -1)
+        XCTAssertNil(action.frames[2].flip)
+    }
+
+    // MARK: - Helpers
+
+    private func writeAIR(_ text: String) throws -> URL {
+        let url = workingDir.appendingPathComponent("test-\(UUID().uuidString).air")
+        try text.write(to: url, atomically: true, encoding: .utf8)
+        return url
+    }
+}
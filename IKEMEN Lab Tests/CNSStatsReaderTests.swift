@@ -0,0 +1,115 @@
+import XCTest
+@testable import IKEMEN_Lab
+
+/// Tests for the chunked, early-terminating CNS stats reader
+final class CNSStatsReaderTests: XCTestCase {
+
+    var workingDir: URL!
+
+    override func setUp() {
+        super.setUp()
+        workingDir = FileManager.default.temporaryDirectory
+            .appendingPathComponent("CNSStatsReaderTests-\(UUID().uuidString)")
+        try? FileManager.default.createDirectory(at: workingDir, withIntermediateDirectories: true)
+    }
+
+    override func tearDown() {
+        try? FileManager.default.removeItem(at: workingDir)
+        workingDir = nil
+        super.tearDown()
+    }
+
+    // MARK: - Streaming
+
+    func testDataSectionSpanningChunkBoundary() throws {
+        // Given - Comments push [Data] so a line straddles the first chunk boundary
+        let padding = String(repeating: "; padding line to push the data section along\n",
+                             count: CNSParser.chunkSize / 47 + 1)
+        let url = try write("big.cns", padding + "[Data]\r\nlife = 1450\r\nattack = 120\r\n" + states(count: 10))
+
+        // When
+        let result = try XCTUnwrap(CNSParser.readStats(from: url))
+
+        // Then
+        XCTAssertTrue(result.foundData)
+        XCTAssertEqual(result.stats.life, 1450)
+        XCTAssertEqual(result.stats.attack, 120)
+    }
+
+    func testStopsAfterDataSection() throws {
+        // Given - A later [Data] block; reading stops before it, so it can't override the first
+        let url = try write("stop.cns", "[Data]\nlife = 900\n" + states(count: 3000) + "[Data]\nlife = 1\n")
+
+        // When
+        let stats = try XCTUnwrap(CNSParser.parseStats(from: url))
+
+        // Then
+        XCTAssertEqual(stats.life, 900)
+    }
+
+    func testFileWithoutTrailingNewline() throws {
+        let url = try write("short.cns", "[Data]\npower = 4000")
+
+        XCTAssertEqual(CNSParser.parseStats(from: url)?.power, 4000)
+    }
+
+    func testInMemoryReadReportsMissingDataSection() {
+        let withData = CNSParser.readStats(data: Data("[Data]\nlife = 1200\n[Statedef 0]\n".utf8))
+        let withoutData = CNSParser.readStats(data: Data("[Statedef 0]\ntype = S\n".utf8))
+
+        XCTAssertTrue(withData.foundData)
+        XCTAssertEqual(withData.stats.life, 1200)
+        XCTAssertFalse(withoutData.foundData)
+    }
+
+    // MARK: - State File Lookup
+
+    func testCNSEntryIsSearchedBeforeStateFiles() throws {
+        // Given - Both the cns and an st file carry [Data]
+        _ = try write("kfm.cns", "[Data]\nlife = 1000\ndefence = 130\n")
+        _ = try write("kfm.st", "[Data]\nlife = 5\n")
+        let def = try write("kfm.def", "[Files]\nst = kfm.st\ncns = kfm.cns\n")
+
+        // When
+        let stats = CNSParser.getStats(for: workingDir, defFile: def)
+
+        // Then
+        XCTAssertEqual(stats.life, 1000)
+        XCTAssertEqual(stats.defence, 130)
+    }
+
+    func testFallsBackToStateFileWithData() throws {
+        // Given - The cns has only states; [Data] lives in st2
+        _ = try write("split.cns", states(count: 5))
+        _ = try write("split2.st", "[Data]\nlife = 1300\n")
+        let def = try write("split.def", "[Files]\ncns = split.cns\nst = split.cns\nst2 = split2.st\n")
+
+        // Then
+        XCTAssertEqual(CNSParser.getStats(for: workingDir, defFile: def).life, 1300)
+    }
+
+    func testMissingFilesGiveDefaults() throws {
+        let def = try write("none.def", "[Files]\ncns = missing.cns\n")
+
+        let stats = CNSParser.getStats(for: workingDir, defFile: def)
+
+        XCTAssertEqual(stats.life, CNSParser.CharacterStats.defaults.life)
+        XCTAssertEqual(stats.power, CNSParser.CharacterStats.defaults.power)
+    }
+
+    // MARK: - Helpers
+
+    private func states(count: Int) -> String {
+        var text = ""
+        for state in 0..<count {
+            text += "[Statedef \(state)]\ntype = S\n[State \(state), 1]\ntype = ChangeAnim\ntrigger1 = Time = 0\nvalue = \(state)\n"
+        }
+        return text
+    }
+
+    private func write(_ name: String, _ content: String) throws -> URL {
+        let url = workingDir.appendingPathComponent(name)
+        try Data(content.utf8).write(to: url)
+        return url
+    }
+}
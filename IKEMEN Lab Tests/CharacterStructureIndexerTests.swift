@@ -0,0 +1,136 @@
+import XCTest
+@testable import IKEMEN_Lab
+
+/// Tests for CNS/CMD/AIR structure indexing
+final class CharacterStructureIndexerTests: XCTestCase {
+
+    var workingDir: URL!
+
+    override func setUp() {
+        super.setUp()
+        workingDir = FileManager.default.temporaryDirectory
+            .appendingPathComponent("CharacterStructureIndexerTests-\(UUID().uuidString)")
+        try? FileManager.default.createDirectory(at: workingDir, withIntermediateDirectories: true)
+    }
+
+    override func tearDown() {
+        try? FileManager.default.removeItem(at: workingDir)
+        workingDir = nil
+        super.tearDown()
+    }
+
+    // MARK: - Indexing
+
+    func testIndexCollectsStatsMovesAndCounts() throws {
+        // Given
+        let character = try makeCharacter()
+
+        // When
+        let record = CharacterStructureIndexer.shared.index(character)
+
+        // Then - Stats from the cns, states from cns + st, moves from the cmd, actions from the air
+        XCTAssertEqual(record.characterId, "kfm")
+        XCTAssertEqual(record.life, 1100)
+        XCTAssertEqual(record.attack, 105)
+        XCTAssertEqual(record.stateCount, 3)
+        XCTAssertEqual(record.commandCount, 4)
+        XCTAssertEqual(record.hyperMoveCount, 1)
+        XCTAssertEqual(record.specialMoveCount, 1)
+        XCTAssertEqual(record.actionCount, 2)
+        XCTAssertEqual(record.moveList.map { $0.name }, ["SuperKFPalm", "QCF_x"])
+    }
+
+    func testFingerprintChangesWhenSourceFileChanges() throws {
+        // Given
+        let character = try makeCharacter()
+        let before = CharacterStructureIndexer.shared.index(character)
+
+        // When - The CMD gains a move
+        let cmd = character.directory.appendingPathComponent("kfm.cmd")
+        try (String(contentsOf: cmd, encoding: .utf8) + "\n[Command]\nname = \"QCB_y\"\ncommand = ~D, DB, B, y\n")
+            .write(to: cmd, atomically: true, encoding: .utf8)
+        let after = CharacterStructureIndexer.shared.index(character)
+
+        // Then
+        XCTAssertNotEqual(before.sourceFingerprint, after.sourceFingerprint)
+        XCTAssertEqual(after.specialMoveCount, 2)
+        XCTAssertEqual(after.commandCount, 5)
+    }
+
+    func testMissingFilesGiveDefaults() throws {
+        let folder = workingDir.appendingPathComponent("empty")
+        try FileManager.default.createDirectory(at: folder, withIntermediateDirectories: true)
+        let def = folder.appendingPathComponent("empty.def")
+        try Data("[Info]\nname = Empty\n[Files]\ncns = none.cns\n".utf8).write(to: def)
+
+        let record = CharacterStructureIndexer.shared.index(CharacterInfo(directory: folder, defFile: def))
+
+        XCTAssertEqual(record.life, CNSParser.CharacterStats.defaults.life)
+        XCTAssertEqual(record.stateCount, 0)
+        XCTAssertEqual(record.actionCount, 0)
+        XCTAssertTrue(record.moveList.isEmpty)
+    }
+
+    // MARK: - Parsers
+
+    func testStateCountCountsStatedefsOnly() {
+        let content = "[Data]\nlife = 1\n[Statedef 0]\n[State 0, 1]\n[StateDef -2]\n[State -2]\n"
+        XCTAssertEqual(CNSParser.stateCount(data: Data(content.utf8)), 2)
+    }
+
+    // MARK: - Helpers
+
+    private func makeCharacter() throws -> CharacterInfo {
+        let folder = workingDir.appendingPathComponent("kfm")
+        try FileManager.default.createDirectory(at: folder, withIntermediateDirectories: true)
+
+        try write(folder, "kfm.def", """
+        [Info]
+        name = "Kung Fu Man"
+        [Files]
+        cmd = kfm.cmd
+        cns = kfm.cns
+        st = kfm.st
+        anim = kfm.air
+        """)
+        try write(folder, "kfm.cns", """
+        [Data]
+        life = 1100
+        attack = 105
+        [Statedef 0]
+        type = S
+        """)
+        try write(folder, "kfm.st", """
+        [Statedef 200]
+        type = S
+        [Statedef 210]
+        type = S
+        """)
+        try write(folder, "kfm.cmd", """
+        [Command]
+        name = "QCF_x"
+        command = ~D, DF, F, x
+        [Command]
+        name = "SuperKFPalm"
+        command = ~D, DF, F, D, DF, F, x
+        [Command]
+        name = "holdfwd"
+        command = /$F
+        [Command]
+        name = "AI_1"
+        command = x, y, z, a, b, c
+        """)
+        try write(folder, "kfm.air", """
+        [Begin Action 0]
+        0,0, 0,0, 10
+        [Begin Action 20]
+        20,0, 0,0, 5
+        """)
+
+        return CharacterInfo(directory: folder, defFile: folder.appendingPathComponent("kfm.def"))
+    }
+
+    private func write(_ folder: URL, _ name: String, _ content: String) throws {
+        try Data(content.utf8).write(to: folder.appendingPathComponent(name))
+    }
+}
@@ -0,0 +1,215 @@
+import XCTest
+@testable import IKEMEN_Lab
+
+/// XCTest `measure` timings for the parsers, sprite codecs and palette kernel
+///
+/// Skipped unless IKEMEN_BENCHMARK is set; run through scripts/run-benchmarks.sh alongside the
+/// library benchmark. These report timings only — correctness lives in each component's unit tests.
+final class ComponentBenchmarkTests: XCTestCase {
+
+    var workingDir: URL!
+
+    override func setUpWithError() throws {
+        try super.setUpWithError()
+        try XCTSkipUnless(ProcessInfo.processInfo.environment["IKEMEN_BENCHMARK"] != nil,
+                          "Set IKEMEN_BENCHMARK=1 to run the component benchmarks")
+        workingDir = FileManager.default.temporaryDirectory
+            .appendingPathComponent("ComponentBenchmarkTests-\(UUID().uuidString)")
+        try FileManager.default.createDirectory(at: workingDir, withIntermediateDirectories: true)
+    }
+
+    override func tearDown() {
+        MetadataStore.shared.close()
+        if let workingDir = workingDir {
+            try? FileManager.default.removeItem(at: workingDir)
+        }
+        workingDir = nil
+        super.tearDown()
+    }
+
+    // MARK: - Text Parsing
+
+    func testParseStatsThroughput() {
+        // A typical CNS: small [Data] block followed by hundreds of state controllers
+        var content = "[Data]\nlife = 1000\nattack = 100\ndefence = 100\npower = 3000\n"
+        for state in 0..<500 {
+            content += "\n[Statedef \(state)]\ntype = S\nmovetype = I\nphysics = S\n"
+            content += "[State \(state), 1]\ntype = ChangeAnim\ntrigger1 = Time = 0 ; start\nvalue = \(state)\n"
+        }
+        let data = Data(content.utf8)
+
+        measure {
+            for _ in 0..<20 {
+                _ = CNSParser.parseStats(data: data)
+            }
+        }
+    }
+
+    func testHeavyCNSReadThroughput() throws {
+        // Several MB of state controllers after a small [Data] block
+        var content = "[Data]\nlife = 1000\n"
+        for state in 0..<40_000 {
+            content += "[Statedef \(state)]\ntype = S\n[State \(state), 1]\ntype = ChangeAnim\ntrigger1 = Time = 0\nvalue = \(state)\n"
+        }
+        let url = workingDir.appendingPathComponent("heavy.cns")
+        try Data(content.utf8).write(to: url)
+
+        measure {
+            for _ in 0..<20 {
+                _ = CNSParser.parseStats(from: url)
+            }
+        }
+    }
+
+    func testEncodingDetectionThroughput() throws {
+        // A large ASCII-heavy CNS with a Japanese name near the end, in Shift-JIS
+        var text = ""
+        for state in 0..<2000 {
+            text += "[State \(state), 1]\ntype = ChangeAnim\ntrigger1 = Time = 0\nvalue = \(state)\n"
+        }
+        text += "name = リュウ\n"
+        let data = try XCTUnwrap(text.data(using: .shiftJIS))
+
+        measure {
+            for _ in 0..<10 {
+                _ = TextEncodingDetector.detect(data)
+            }
+        }
+    }
+
+    func testCachedClassificationThroughput() throws {
+        let urls = try (0..<200).map { index -> URL in
+            let url = workingDir.appendingPathComponent("char\(index).def")
+            try Data("[Info]\nname = Char \(index)\n[Files]\ncmd = c.cmd\ncns = c.cns\nsprite = c.sff\n".utf8)
+                .write(to: url)
+            return url
+        }
+
+        measure {
+            for url in urls {
+                _ = DEFParser.isValidCharacterDefFile(url)
+                _ = DEFParser.parse(url: url)
+            }
+        }
+    }
+
+    // MARK: - Sprite Codecs
+
+    func testRLE8DecodeThroughput() {
+        measureDecode(SFFDecoderCorpus.standard(.rle8), decode: SFFSpriteDecoder.decodeRLE8)
+    }
+
+    func testRLE5DecodeThroughput() {
+        measureDecode(SFFDecoderCorpus.standard(.rle5), decode: SFFSpriteDecoder.decodeRLE5)
+    }
+
+    func testLZ5DecodeThroughput() {
+        measureDecode(SFFDecoderCorpus.standard(.lz5), decode: SFFSpriteDecoder.decodeLZ5)
+    }
+
+    func testRLE8EncodeThroughput() {
+        let corpus = SFFDecoderCorpus.standard(.rle8).map { $0.expected }
+        measure {
+            for pixels in corpus {
+                _ = SFFSpriteEncoder.encodeRLE8(pixels)
+            }
+        }
+    }
+
+    func testLZ5EncodeThroughput() {
+        let corpus = SFFDecoderCorpus.standard(.lz5).map { $0.expected }
+        measure {
+            for pixels in corpus {
+                _ = SFFSpriteEncoder.encodeLZ5(pixels)
+            }
+        }
+    }
+
+    // MARK: - Palette Kernel
+
+    func testExpand640x480() {
+        measureExpansion(width: 640, height: 480)
+    }
+
+    func testExpand1280x720() {
+        measureExpansion(width: 1280, height: 720)
+    }
+
+    func testDownsampledExpansion1280x720() {
+        let width = 1280, height = 720
+        let indices = patternIndices(count: width * height)
+        let table = SFFPaletteKernel.lookupTable(rgba: makeRGBAPalette())
+
+        measure {
+            indices.withUnsafeBufferPointer { buffer in
+                _ = SFFPaletteKernel.expandDownsampled(rows: buffer.baseAddress!, width: width, height: height, bytesPerRow: width,
+                                                       table: table, targetWidth: 640, targetHeight: 360)
+            }
+        }
+    }
+
+    func testTwelvePaletteRecolor() {
+        // One cached index buffer recolored with 12 palettes, as the palette preview does
+        let indices = patternIndices(count: 640 * 480)
+        let tables = (0..<12).map { shift in
+            SFFPaletteKernel.lookupTable(rgba: makeRGBAPalette().map { $0 &+ UInt8(shift * 16) })
+        }
+
+        measure {
+            for table in tables {
+                _ = SFFPaletteKernel.expand(indices, table: table)
+            }
+        }
+    }
+
+    // MARK: - Metadata Store
+
+    func testReindexThroughput() throws {
+        let charsDir = workingDir.appendingPathComponent("chars")
+        for index in 0..<1000 {
+            let directory = charsDir.appendingPathComponent("char\(index)")
+            try FileManager.default.createDirectory(at: directory, withIntermediateDirectories: true)
+            try Data("[Info]\nname = \"Character \(index)\"\n[Files]\ncmd = char\(index).cmd\n".utf8)
+                .write(to: directory.appendingPathComponent("char\(index).def"))
+        }
+        try MetadataStore.shared.initialize(workingDir: workingDir)
+        let manifest = LibraryManifest.build(charsDirectory: charsDir)
+
+        measure {
+            try? MetadataStore.shared.reindexCharacters(from: workingDir, manifest: manifest)
+        }
+    }
+
+    // MARK: - Helpers
+
+    private func measureDecode(_ corpus: [SFFDecoderCorpus.Sprite], decode: (Data, Int, Int) -> [UInt8]) {
+        measure {
+            for _ in 0..<5 {
+                for sprite in corpus {
+                    _ = decode(sprite.encoded, sprite.width, sprite.height)
+                }
+            }
+        }
+    }
+
+    private func measureExpansion(width: Int, height: Int) {
+        let indices = patternIndices(count: width * height)
+        let table = SFFPaletteKernel.lookupTable(rgba: makeRGBAPalette())
+
+        measure {
+            for _ in 0..<10 {
+                _ = SFFPaletteKernel.expand(indices, table: table)
+            }
+        }
+    }
+
+    private func patternIndices(count: Int) -> [UInt8] {
+        return (0..<count).map { UInt8(truncatingIfNeeded: ($0 * 7) ^ ($0 >> 5)) }
+    }
+
+    private func makeRGBAPalette() -> [UInt8] {
+        return (0..<256).flatMap { i -> [UInt8] in
+            [UInt8(i), UInt8(255 - i), UInt8(truncatingIfNeeded: i * 3), 255]
+        }
+    }
+}
@@ -0,0 +1,83 @@
+import XCTest
+@testable import IKEMEN_Lab
+
+/// Tests for single-read .def classification and its cache
+final class DEFClassifierTests: XCTestCase {
+
+    var workingDir: URL!
+
+    override func setUp() {
+        super.setUp()
+        workingDir = FileManager.default.temporaryDirectory
+            .appendingPathComponent("DEFClassifierTests-\(UUID().uuidString)")
+        try? FileManager.default.createDirectory(at: workingDir, withIntermediateDirectories: true)
+        DEFClassifier.shared.removeAll()
+    }
+
+    override func tearDown() {
+        try? FileManager.default.removeItem(at: workingDir)
+        workingDir = nil
+        super.tearDown()
+    }
+
+    // MARK: - Content Types
+
+    func testContentTypes() {
+        let cases: [(String, String, DEFContentType)] = [
+            ("kfm.def", "[Info]\nname = KFM\n[Files]\ncmd = kfm.cmd\ncns = kfm.cns\n", .character),
+            ("stage.def", "[Info]\nname = Dojo\n[BGdef]\nspr = dojo.sff\n", .stage),
+            ("bg.def", "[BG 1]\ntype = normal\n", .stage),
+            ("intro.def", "[SceneDef]\nspr = intro.sff\n[Files]\ncns = x.cns\n", .storyboard),
+            ("font.def", "[FNT v2]\nfontversion = 2\n", .font),
+            ("system.def", "[Files]\nspr = system.sff\n", .screenpack),
+            ("screen.def", "[Title Info]\nfadein.time = 10\n", .screenpack),
+            ("readme.def", "[Files]\nsprite = a.sff\n", .unknown)
+        ]
+
+        for (fileName, content, expected) in cases {
+            let result = DEFClassifier.classify(data: Data(content.utf8), fileName: fileName)
+            XCTAssertEqual(result.contentType, expected, fileName)
+        }
+    }
+
+    func testCharacterWithStageSectionsIsCharacter() {
+        let content = "[Files]\nanim = kfm.air\n[BGdef]\nspr = intro.sff\n"
+
+        let result = DEFClassifier.classify(data: Data(content.utf8), fileName: "kfm.def")
+
+        XCTAssertEqual(result.contentType, .character)
+        XCTAssertEqual(result.parsed.animFile, "kfm.air")
+    }
+
+    func testStageNameComesFromCommentWhenValueIsShort() {
+        let content = "[Info]\nname = \"O\";\"Avalon\"\n[StageInfo]\nzoffset = 200\n"
+
+        let result = DEFClassifier.classify(data: Data(content.utf8), fileName: "avalon.def")
+
+        XCTAssertEqual(result.contentType, .stage)
+        XCTAssertEqual(result.stageName, "Avalon")
+    }
+
+    // MARK: - Cache
+
+    func testCachedResultIsReusedUntilFileChanges() throws {
+        // Given
+        let url = workingDir.appendingPathComponent("thing.def")
+        try Data("[StageInfo]\nname = A\n".utf8).write(to: url)
+        XCTAssertTrue(DEFParser.isValidStageDefFile(url))
+        XCTAssertEqual(DEFParser.parse(url: url)?.name, "A")
+
+        // When - Rewritten as a character
+        try Data("[Info]\nname = Ryu\n[Files]\ncmd = ryu.cmd\n".utf8).write(to: url)
+
+        // Then
+        XCTAssertFalse(DEFParser.isValidStageDefFile(url))
+        XCTAssertTrue(DEFParser.isValidCharacterDefFile(url))
+        XCTAssertEqual(DEFParser.parse(url: url)?.name, "Ryu")
+    }
+
+    func testUnreadableFileHasNoClassification() {
+        XCTAssertNil(DEFClassifier.shared.classify(workingDir.appendingPathComponent("missing.def")))
+        XCTAssertFalse(DEFParser.isValidCharacterDefFile(workingDir.appendingPathComponent("missing.def")))
+    }
+}
@@ -0,0 +1,163 @@
+import XCTest
+@testable import IKEMEN_Lab
+
+/// Tests for the byte-level DEF/CNS tokenizer and the parsers built on it
+final class DEFTokenizerTests: XCTestCase {
+
+    // MARK: - Tokens
+
+    func testTokenKindsAndRanges() {
+        // Given
+        let content = """
+        ; header comment
+        [ Files ]
+        sprite = "kfm.sff" ; sprites
+        junk line without equals
+        [Broken
+        anim=kfm.air
+        """
+
+        // When
+        let tokens = collect(content)
+
+        // Then
+        XCTAssertEqual(tokens.map { $0.kind }, ["comment", "section", "keyValue", "keyValue"])
+        XCTAssertEqual(tokens[0].name, "header comment")
+        XCTAssertEqual(tokens[1].name, "Files")
+        XCTAssertEqual(tokens[2].name, "sprite")
+        XCTAssertEqual(tokens[2].value, "\"kfm.sff\"")
+        XCTAssertEqual(tokens[2].comment, "sprites")
+        XCTAssertEqual(tokens[3].name, "anim")
+        XCTAssertEqual(tokens[3].value, "kfm.air")
+        XCTAssertNil(tokens[3].comment)
+    }
+
+    func testSemicolonBeforeEqualsIsNotAKey() {
+        let tokens = collect("life ; = 1000\n")
+        XCTAssertTrue(tokens.isEmpty)
+    }
+
+    func testLineEndingsAndByteOrderMark() {
+        // Given - BOM, CRLF, bare CR and no trailing newline
+        var data = Data([0xEF, 0xBB, 0xBF])
+        data.append(Data("[Info]\r\nname = A\rauthor = B\r\n\r\nversion = 1".utf8))
+
+        // When
+        let tokens = collect(data)
+
+        // Then
+        XCTAssertEqual(tokens.map { $0.name }, ["Info", "name", "author", "version"])
+        XCTAssertEqual(tokens.map { $0.value }, ["", "A", "B", "1"])
+    }
+
+    func testStopsWhenBodyReturnsFalse() {
+        let data = Data("a = 1\nb = 2\nc = 3\n".utf8)
+        var seen = 0
+
+        DEFTokenizer.scan(data) { tokens in
+            tokens.forEachToken { _ in
+                seen += 1
+                return seen < 2
+            }
+        }
+
+        XCTAssertEqual(seen, 2)
+    }
+
+    // MARK: - Matching
+
+    func testCaseFoldedMatching() {
+        DEFTokenizer.scan(Data("FALL.Defence_UP".utf8)) { tokens in
+            let all = 0..<tokens.bytes.count
+            XCTAssertTrue(tokens.matches(all, "fall.defence_up"))
+            XCTAssertFalse(tokens.matches(all, "fall.defence"))
+            XCTAssertTrue(tokens.hasPrefix(all, "fall"))
+            XCTAssertTrue(tokens.contains(all, "defence"))
+            XCTAssertFalse(tokens.contains(all, "attack"))
+            XCTAssertEqual(tokens.lowercasedString(all), "fall.defence_up")
+        }
+    }
+
+    func testIntegerParsing() {
+        DEFTokenizer.scan(Data("1000|-25|+7|12a||-".utf8)) { tokens in
+            let fields = [0..<4, 5..<8, 9..<11, 12..<15, 16..<16, 17..<18]
+            XCTAssertEqual(fields.map { tokens.int($0) }, [1000, -25, 7, nil, nil, nil])
+        }
+    }
+
+    func testLegacyEncodedValueIsDecoded() {
+        // "Café" in Windows-1252 is not valid UTF-8
+        let data = Data("name = Caf".utf8) + Data([0xE9])
+
+        XCTAssertEqual(DEFParser.parse(data: data).name, "Café")
+    }
+
+    func testValuesUseEncodingDetectedForWholeFile() throws {
+        // Half-width katakana alone is too short to read as Shift-JIS; the rest of the file decides
+        let text = "[Info]\nname = ｶﾞｲ\ndisplayname = ガイ\nauthor = 作者\n"
+        let data = try XCTUnwrap(text.data(using: .shiftJIS))
+
+        let info = DEFParser.parse(data: data)
+
+        XCTAssertEqual(info.name, "ｶﾞｲ")
+        XCTAssertEqual(info.displayName, "ガイ")
+        XCTAssertEqual(info.author, "作者")
+    }
+
+    // MARK: - CNS Stats
+
+    func testParseStatsReadsOnlyDataSection() {
+        // Given
+        let content = """
+        [Data]
+        life = 1200 ; tougher than usual
+        Attack = 110
+        power =
+        fall.defence_up = 75
+
+        [Size]
+        life = 1
+
+        [Statedef 0]
+        type = S
+        """
+
+        // When
+        let stats = CNSParser.parseStats(content: content)
+
+        // Then - Keys outside [Data] and empty values are ignored
+        XCTAssertEqual(stats.life, 1200)
+        XCTAssertEqual(stats.attack, 110)
+        XCTAssertEqual(stats.defence, 100)
+        XCTAssertEqual(stats.power, 3000)
+        XCTAssertEqual(stats.airJuggle, 15)
+        XCTAssertEqual(stats.fallDefenceUp, 75)
+    }
+
+    // MARK: - Helpers
+
+    private struct DecodedToken {
+        let kind: String
+        let name: String
+        let value: String
+        let comment: String?
+    }
+
+    private func collect(_ content: String) -> [DecodedToken] {
+        return collect(Data(content.utf8))
+    }
+
+    private func collect(_ data: Data) -> [DecodedToken] {
+        return DEFTokenizer.scan(data) { tokens in
+            var result: [DecodedToken] = []
+            tokens.forEachToken { token in
+                result.append(DecodedToken(kind: "\(token.kind)",
+                                           name: tokens.string(token.name),
+                                           value: tokens.string(token.value),
+                                           comment: token.comment.map { tokens.string($0) }))
+                return true
+            }
+            return result
+        }
+    }
+}
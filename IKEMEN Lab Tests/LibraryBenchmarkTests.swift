@@ -0,0 +1,156 @@
+import XCTest
+@testable import IKEMEN_Lab
+
+/// Headless scan / index / thumbnail benchmark over a synthetic library
+///
+/// Skipped unless IKEMEN_BENCHMARK is set; run it through scripts/run-benchmarks.sh. The library
+/// shape comes from the environment (IKEMEN_BENCHMARK_CHARACTERS, _STAGES, _SPRITES, _SFF_VERSIONS,
+/// _SELECT_FRACTION, _SEED) and the JSON report goes to IKEMEN_BENCHMARK_OUTPUT, or stdout.
+final class LibraryBenchmarkTests: XCTestCase {
+
+    /// Everything the benchmark reports; times are in seconds
+    struct Report: Codable {
+        struct Library: Codable {
+            let characters: Int
+            let stages: Int
+            let spritesPerCharacter: Int
+            let sffVersions: [Int]
+            let selectDefFraction: Double
+            let seed: UInt64
+        }
+
+        let library: Library
+        let generateSeconds: Double
+        let coldScanSeconds: Double
+        let warmScanSeconds: Double
+        let reindexSeconds: Double
+        let thumbnailsPerSecond: Double
+        let peakMemoryBytes: Int64
+        let charactersFound: Int
+        let stagesFound: Int
+        let processorCount: Int
+        let osVersion: String
+    }
+
+    var workingDir: URL!
+    var environment: [String: String] { ProcessInfo.processInfo.environment }
+
+    override func setUpWithError() throws {
+        try super.setUpWithError()
+        try XCTSkipUnless(environment["IKEMEN_BENCHMARK"] != nil, "Set IKEMEN_BENCHMARK=1 to run the library benchmark")
+        workingDir = FileManager.default.temporaryDirectory
+            .appendingPathComponent("LibraryBenchmarkTests-\(UUID().uuidString)")
+    }
+
+    override func tearDown() {
+        MetadataStore.shared.close()
+        LibraryManifest.invalidate()
+        if let workingDir = workingDir {
+            try? FileManager.default.removeItem(at: workingDir)
+        }
+        workingDir = nil
+        super.tearDown()
+    }
+
+    // MARK: - Benchmark
+
+    func testLibraryBenchmark() async throws {
+        // Given
+        let configuration = benchmarkConfiguration()
+        var start = Date()
+        let library = try SyntheticLibrary.generate(at: workingDir, configuration: configuration)
+        let generateSeconds = Date().timeIntervalSince(start)
+        try MetadataStore.shared.initialize(workingDir: workingDir)
+
+        // When - Cold: empty database, empty in-memory caches (the OS page cache can't be dropped from here)
+        resetCaches()
+        start = Date()
+        let characters = await LibraryScanner.scanCharacters(in: library.charsDirectory, snapshot: LibrarySnapshot(kind: .character))
+        let stages = await LibraryScanner.scanStages(in: library.stagesDirectory, snapshot: LibrarySnapshot(kind: .stage))
+        let coldScanSeconds = Date().timeIntervalSince(start)
+
+        // Warm: nothing changed on disk, so the stored snapshot answers
+        LibraryManifest.invalidate()
+        start = Date()
+        _ = await LibraryScanner.scanCharacters(in: library.charsDirectory, snapshot: LibrarySnapshot(kind: .character))
+        _ = await LibraryScanner.scanStages(in: library.stagesDirectory, snapshot: LibrarySnapshot(kind: .stage))
+        let warmScanSeconds = Date().timeIntervalSince(start)
+
+        start = Date()
+        try MetadataStore.shared.reindexAll(from: workingDir)
+        let reindexSeconds = Date().timeIntervalSince(start)
+
+        resetCaches()
+        start = Date()
+        let thumbnails = characters.compactMap { ImageCache.shared.getPortraitThumbnail(for: $0) }.count
+        let thumbnailSeconds = Date().timeIntervalSince(start)
+
+        // Then
+        XCTAssertEqual(characters.count, configuration.characterCount)
+        XCTAssertEqual(stages.count, configuration.stageCount)
+        XCTAssertEqual(thumbnails, characters.count)
+
+        let report = Report(
+            library: Report.Library(characters: configuration.characterCount,
+                                    stages: configuration.stageCount,
+                                    spritesPerCharacter: configuration.spritesPerCharacter,
+                                    sffVersions: configuration.sffVersions,
+                                    selectDefFraction: configuration.selectDefFraction,
+                                    seed: configuration.seed),
+            generateSeconds: generateSeconds,
+            coldScanSeconds: coldScanSeconds,
+            warmScanSeconds: warmScanSeconds,
+            reindexSeconds: reindexSeconds,
+            thumbnailsPerSecond: thumbnailSeconds > 0 ? Double(thumbnails) / thumbnailSeconds : 0,
+            peakMemoryBytes: peakMemoryBytes(),
+            charactersFound: characters.count,
+            stagesFound: stages.count,
+            processorCount: ProcessInfo.processInfo.activeProcessorCount,
+            osVersion: ProcessInfo.processInfo.operatingSystemVersionString
+        )
+        try write(report)
+    }
+
+    // MARK: - Helpers
+
+    private func benchmarkConfiguration() -> SyntheticLibrary.Configuration {
+        var configuration = SyntheticLibrary.Configuration()
+        configuration.characterCount = environment["IKEMEN_BENCHMARK_CHARACTERS"].flatMap(Int.init) ?? 500
+        configuration.stageCount = environment["IKEMEN_BENCHMARK_STAGES"].flatMap(Int.init) ?? 50
+        configuration.spritesPerCharacter = environment["IKEMEN_BENCHMARK_SPRITES"].flatMap(Int.init) ?? configuration.spritesPerCharacter
+        configuration.selectDefFraction = environment["IKEMEN_BENCHMARK_SELECT_FRACTION"].flatMap(Double.init) ?? configuration.selectDefFraction
+        configuration.seed = environment["IKEMEN_BENCHMARK_SEED"].flatMap(UInt64.init) ?? configuration.seed
+        if let versions = environment["IKEMEN_BENCHMARK_SFF_VERSIONS"]?.split(separator: ",").compactMap({ Int($0) }),
+           !versions.isEmpty {
+            configuration.sffVersions = versions
+        }
+        return configuration
+    }
+
+    private func resetCaches() {
+        LibraryManifest.invalidate()
+        DEFClassifier.shared.removeAll()
+        TextFileCache.shared.removeAll()
+        SFFDirectoryIndex.shared.clearMemoryCache()
+        ImageCache.shared.clear()
+    }
+
+    /// Peak resident set size of the test process
+    private func peakMemoryBytes() -> Int64 {
+        var usage = rusage()
+        guard getrusage(RUSAGE_SELF, &usage) == 0 else { return 0 }
+        return Int64(usage.ru_maxrss)  // Bytes on macOS
+    }
+
+    private func write(_ report: Report) throws {
+        let encoder = JSONEncoder()
+        encoder.outputFormatting = [.prettyPrinted, .sortedKeys]
+        let data = try encoder.encode(report)
+
+        if let path = environment["IKEMEN_BENCHMARK_OUTPUT"], !path.isEmpty {
+            try data.write(to: URL(fileURLWithPath: path))
+        } else {
+            print(String(decoding: data, as: UTF8.self))
+        }
+    }
+}
@@ -0,0 +1,109 @@
+import XCTest
+@testable import IKEMEN_Lab
+
+/// Tests for the shared chars/ manifest and the consumers reading it
+final class LibraryManifestTests: XCTestCase {
+
+    var workingDir: URL!
+    var charsDir: URL!
+
+    override func setUp() {
+        super.setUp()
+        workingDir = FileManager.default.temporaryDirectory
+            .appendingPathComponent("LibraryManifestTests-\(UUID().uuidString)")
+        charsDir = workingDir.appendingPathComponent("chars")
+        try? FileManager.default.createDirectory(at: charsDir, withIntermediateDirectories: true)
+        LibraryManifest.invalidate()
+    }
+
+    override func tearDown() {
+        LibraryManifest.invalidate()
+        try? FileManager.default.removeItem(at: workingDir)
+        workingDir = nil
+        charsDir = nil
+        super.tearDown()
+    }
+
+    // MARK: - Building
+
+    func testBuildListsFoldersWithAttributes() throws {
+        // Given
+        try write("kfm/kfm.def", "[Info]\nname = KFM\n[Files]\ncmd = kfm.cmd\n")
+        try write("kfm/kfm.sff", "SFF")
+        try write(".trash/old.def", "[Info]\nname = Old\n[Files]\ncmd = old.cmd\n")
+        try write("loose.def", "[Info]\nname = Loose\n")
+
+        // When
+        let manifest = LibraryManifest.build(charsDirectory: charsDir)
+
+        // Then - Hidden folders and loose files aren't character folders
+        XCTAssertEqual(manifest.folders.map { $0.name }, ["kfm"])
+        let sprite = manifest.folders.first?.files.first { $0.name == "kfm.sff" }
+        XCTAssertEqual(sprite?.size, 3)
+        XCTAssertEqual(sprite?.isDirectory, false)
+        XCTAssertNotNil(sprite?.modifiedAt)
+    }
+
+    func testCharacterDefPrefersFolderNameThenFirstValid() throws {
+        // Given
+        try write("Ryu/intro.def", "[SceneDef]\nspr = intro.sff\n")
+        try write("Ryu/ryu.def", "[Info]\nname = Ryu\n[Files]\ncmd = ryu.cmd\n")
+        try write("Ken/ending.def", "[SceneDef]\nspr = ending.sff\n")
+        try write("Ken/ken_sf2.def", "[Info]\nname = Ken\n[Files]\ncmd = ken.cmd\n")
+        try write("Notes/readme.def", "[Files]\nsprite = a.sff\n")
+
+        // When
+        let manifest = LibraryManifest.build(charsDirectory: charsDir)
+
+        // Then
+        XCTAssertEqual(manifest.folder(named: "ryu")?.characterDefFile?.lastPathComponent, "ryu.def")
+        XCTAssertEqual(manifest.folder(named: "Ken")?.characterDefFile?.lastPathComponent, "ken_sf2.def")
+        XCTAssertNil(manifest.folder(named: "Notes")?.characterDefFile)
+    }
+
+    // MARK: - Shared Manifest
+
+    func testCurrentReusesRefreshUntilInvalidated() throws {
+        // Given
+        try write("kfm/kfm.def", "[Info]\nname = KFM\n[Files]\ncmd = kfm.cmd\n")
+        let refreshed = LibraryManifest.refresh(charsDirectory: charsDir)
+
+        // When - A folder appears without a refresh
+        try write("ryu/ryu.def", "[Info]\nname = Ryu\n[Files]\ncmd = ryu.cmd\n")
+        let reused = LibraryManifest.current(charsDirectory: charsDir)
+        LibraryManifest.invalidate()
+        let rebuilt = LibraryManifest.current(charsDirectory: charsDir)
+
+        // Then
+        XCTAssertEqual(reused.createdAt, refreshed.createdAt)
+        XCTAssertEqual(reused.folders.count, 1)
+        XCTAssertEqual(Set(rebuilt.folders.map { $0.name }), ["kfm", "ryu"])
+    }
+
+    func testConsumersAgreeOnCharacterDef() async throws {
+        // Given - The storyboard sorts first, so "first .def" rules would pick it
+        try write("Intro_2/aaa_intro.def", "[SceneDef]\nspr = intro.sff\n")
+        try write("Intro_2/kfm.def", "[Info]\nname = \"Kung Fu Man\"\n[Files]\ncmd = kfm.cmd\n")
+        let manifest = LibraryManifest.build(charsDirectory: charsDir)
+
+        // When
+        let characters = await LibraryScanner.scanCharacters(in: charsDir, manifest: manifest)
+        let misnamed = FolderSanitizer.shared.findMisnamedCharacterFolders(in: workingDir, manifest: manifest)
+        let validation = ContentValidator.shared.validateAllCharacters(in: workingDir, manifest: manifest)
+
+        // Then
+        XCTAssertEqual(characters.map { $0.defFile.lastPathComponent }, ["kfm.def"])
+        XCTAssertEqual(misnamed.map { $0.0.lastPathComponent }, ["Intro_2"])
+        XCTAssertTrue(validation.allSatisfy { result in result.issues.allSatisfy { $0.file != "aaa_intro.def" } })
+    }
+
+    // MARK: - Helpers
+
+    @discardableResult
+    private func write(_ relativePath: String, _ content: String) throws -> URL {
+        let url = charsDir.appendingPathComponent(relativePath)
+        try FileManager.default.createDirectory(at: url.deletingLastPathComponent(), withIntermediateDirectories: true)
+        try Data(content.utf8).write(to: url)
+        return url
+    }
+}
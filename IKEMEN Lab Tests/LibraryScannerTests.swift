@@ -0,0 +1,147 @@
+import XCTest
+@testable import IKEMEN_Lab
+
+/// Tests for the bounded, order-preserving library scan
+final class LibraryScannerTests: XCTestCase {
+
+    var workingDir: URL!
+
+    override func setUp() {
+        super.setUp()
+        workingDir = FileManager.default.temporaryDirectory
+            .appendingPathComponent("LibraryScannerTests-\(UUID().uuidString)")
+        try? FileManager.default.createDirectory(at: workingDir, withIntermediateDirectories: true)
+    }
+
+    override func tearDown() {
+        try? FileManager.default.removeItem(at: workingDir)
+        workingDir = nil
+        super.tearDown()
+    }
+
+    // MARK: - Bounded Map
+
+    func testMapKeepsInputOrderAndRespectsLimit() async {
+        // Given - Later items finish first
+        let inFlight = Counter()
+
+        // When
+        let results = await LibraryScanner.map(Array(0..<40), limit: 3) { value -> Int? in
+            inFlight.enter()
+            usleep(useconds_t((40 - value) * 100))
+            inFlight.leave()
+            return value % 5 == 0 ? nil : value * 2
+        }
+
+        // Then
+        XCTAssertEqual(results, (0..<40).filter { $0 % 5 != 0 }.map { $0 * 2 })
+        XCTAssertLessThanOrEqual(inFlight.peak, 3)
+    }
+
+    // MARK: - Characters
+
+    func testScanCharactersPicksDefAndSkipsNonCharacters() async throws {
+        // Given
+        try makeCharacter("kfm", defName: "kfm.def")
+        try makeCharacter("Ryu", defName: "ryu_sf2.def")
+        try write("notes/readme.def", "[Files]\nsprite = a.sff\n")
+        try write("loose.def", "[Info]\nname = Loose\n[Files]\ncmd = x.cmd\n")
+
+        // When
+        let characters = await LibraryScanner.scanCharacters(in: workingDir)
+
+        // Then
+        let byFolder = Dictionary(uniqueKeysWithValues: characters.map { ($0.id, $0.defFile.lastPathComponent) })
+        XCTAssertEqual(byFolder, ["kfm": "kfm.def", "Ryu": "ryu_sf2.def"])
+        XCTAssertTrue(characters.allSatisfy { $0.status == .unregistered })
+    }
+
+    func testSortFollowsSelectDefThenAlphabetical() throws {
+        // Given
+        let characters = try ["zangief", "kfm", "Ryu", "akuma"].map { folder -> CharacterInfo in
+            let def = try makeCharacter(folder, defName: "\(folder).def")
+            return CharacterInfo(directory: def.deletingLastPathComponent(), defFile: def)
+        }
+
+        // When
+        let sorted = LibraryScanner.sortCharacters(characters, selectDefOrder: ["ryu", "kfm/kfm.def", "missing"])
+
+        // Then
+        XCTAssertEqual(sorted.map { $0.id }, ["Ryu", "kfm", "akuma", "zangief"])
+    }
+
+    // MARK: - Streaming
+
+    func testCharacterBatchesArriveInOrderWithProgress() async throws {
+        // Given
+        for index in 0..<7 {
+            try makeCharacter(String(format: "char%02d", index), defName: String(format: "char%02d.def", index))
+        }
+        try write("notes/readme.def", "[Files]\nsprite = a.sff\n")
+        let manifest = LibraryManifest.build(charsDirectory: workingDir)
+
+        // When
+        var batches: [LibraryScanner.Batch<CharacterInfo>] = []
+        for await batch in LibraryScanner.characterBatches(in: workingDir, manifest: manifest, batchSize: 3) {
+            batches.append(batch)
+        }
+
+        // Then
+        XCTAssertEqual(batches.map { $0.progress.entriesSeen }, [3, 6, 8])
+        XCTAssertEqual(batches.flatMap { $0.items }.map { $0.id }, manifest.folders.compactMap { folder in
+            folder.characterDefFile == nil ? nil : folder.name
+        })
+        let last = try XCTUnwrap(batches.last?.progress)
+        XCTAssertEqual(last.totalEntries, 8)
+        XCTAssertEqual(last.entriesParsed, 7)
+        XCTAssertEqual(last.entriesFailed, 1)
+        XCTAssertEqual(last.fractionCompleted, 1)
+    }
+
+    // MARK: - Stages
+
+    func testScanStagesFindsTopLevelAndNestedDefs() async throws {
+        try write("dojo.def", "[Info]\nname = Dojo\n[StageInfo]\nzoffset = 200\n")
+        try write("Forest/forest.def", "[Info]\nname = Forest\n[BGdef]\nspr = forest.sff\n")
+        try write("kfm/kfm.def", "[Info]\nname = KFM\n[Files]\ncmd = kfm.cmd\n")
+
+        let stages = await LibraryScanner.scanStages(in: workingDir)
+
+        XCTAssertEqual(Set(stages.map { $0.defFileName }), ["dojo.def", "forest.def"])
+    }
+
+    // MARK: - Helpers
+
+    /// Tracks the peak number of concurrent callers
+    private final class Counter: @unchecked Sendable {
+        private let lock = NSLock()
+        private var current = 0
+        private(set) var peak = 0
+
+        func enter() {
+            lock.lock()
+            current += 1
+            peak = max(peak, current)
+            lock.unlock()
+        }
+
+        func leave() {
+            lock.lock()
+            current -= 1
+            lock.unlock()
+        }
+    }
+
+    @discardableResult
+    private func makeCharacter(_ folder: String, defName: String) throws -> URL {
+        return try write("\(folder)/\(defName)", "[Info]\nname = \(folder)\n[Files]\ncmd = \(folder).cmd\ncns = \(folder).cns\n")
+    }
+
+    @discardableResult
+    private func write(_ relativePath: String, _ content: String) throws -> URL {
+        let url = workingDir.appendingPathComponent(relativePath)
+        try FileManager.default.createDirectory(at: url.deletingLastPathComponent(), withIntermediateDirectories: true)
+        try Data(content.utf8).write(to: url)
+        return url
+    }
+}
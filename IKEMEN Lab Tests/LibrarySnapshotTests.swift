@@ -0,0 +1,136 @@
+import XCTest
+@testable import IKEMEN_Lab
+
+/// Tests for snapshot-driven incremental library rescans
+final class LibrarySnapshotTests: XCTestCase {
+
+    var workingDir: URL!
+    var charsDir: URL!
+
+    override func setUp() {
+        super.setUp()
+        workingDir = FileManager.default.temporaryDirectory
+            .appendingPathComponent("LibrarySnapshotTests-\(UUID().uuidString)")
+        charsDir = workingDir.appendingPathComponent("chars")
+        try? FileManager.default.createDirectory(at: charsDir, withIntermediateDirectories: true)
+        try? MetadataStore.shared.initialize(workingDir: workingDir)
+    }
+
+    override func tearDown() {
+        MetadataStore.shared.close()
+        try? FileManager.default.removeItem(at: workingDir)
+        workingDir = nil
+        charsDir = nil
+        super.tearDown()
+    }
+
+    // MARK: - Incremental Rescan
+
+    func testUnchangedLibraryIsNotReparsed() async throws {
+        // Given
+        for name in ["kfm", "ryu", "ken"] {
+            try writeCharacter(name, displayName: name.uppercased())
+        }
+        let first = LibrarySnapshot(kind: .character)
+        let initial = await LibraryScanner.scanCharacters(in: charsDir, snapshot: first)
+
+        // When
+        let second = LibrarySnapshot(kind: .character)
+        let rescanned = await LibraryScanner.scanCharacters(in: charsDir, snapshot: second)
+
+        // Then
+        XCTAssertEqual(first.parsedCount, 3)
+        XCTAssertEqual(second.parsedCount, 0)
+        XCTAssertEqual(rescanned, initial)
+    }
+
+    func testEditedDefIsReparsedAlone() async throws {
+        // Given
+        try writeCharacter("kfm", displayName: "Kung Fu Man")
+        try writeCharacter("ryu", displayName: "Ryu")
+        _ = await LibraryScanner.scanCharacters(in: charsDir, snapshot: LibrarySnapshot(kind: .character))
+
+        // When - Same size, different content and mtime
+        let def = charsDir.appendingPathComponent("ryu/ryu.def")
+        try Data("[Info]\nname = \"Ken\"\n[Files]\ncmd = ryu.cmd\n".utf8).write(to: def)
+        try FileManager.default.setAttributes([.modificationDate: Date().addingTimeInterval(60)], ofItemAtPath: def.path)
+        let snapshot = LibrarySnapshot(kind: .character)
+        let characters = await LibraryScanner.scanCharacters(in: charsDir, snapshot: snapshot)
+
+        // Then
+        XCTAssertEqual(snapshot.parsedCount, 1)
+        XCTAssertEqual(characters.first { $0.id == "ryu" }?.name, "Ken")
+    }
+
+    func testRemovedFolderIsDroppedFromSnapshot() async throws {
+        // Given
+        try writeCharacter("kfm", displayName: "KFM")
+        try writeCharacter("ryu", displayName: "Ryu")
+        _ = await LibraryScanner.scanCharacters(in: charsDir, snapshot: LibrarySnapshot(kind: .character))
+
+        // When
+        try FileManager.default.removeItem(at: charsDir.appendingPathComponent("ryu"))
+        let characters = await LibraryScanner.scanCharacters(in: charsDir, snapshot: LibrarySnapshot(kind: .character))
+
+        // Then
+        XCTAssertEqual(characters.map { $0.id }, ["kfm"])
+        let stored = try MetadataStore.shared.librarySnapshot(kind: LibrarySnapshot.Kind.character.rawValue)
+        XCTAssertEqual(stored.map { URL(fileURLWithPath: $0.path).lastPathComponent }, ["kfm"])
+    }
+
+    func testFolderWithoutCharacterIsRememberedAsEmpty() async throws {
+        // Given - A folder holding only a storyboard
+        let folder = charsDir.appendingPathComponent("intro")
+        try FileManager.default.createDirectory(at: folder, withIntermediateDirectories: true)
+        try Data("[SceneDef]\nspr = intro.sff\n".utf8).write(to: folder.appendingPathComponent("intro.def"))
+        _ = await LibraryScanner.scanCharacters(in: charsDir, snapshot: LibrarySnapshot(kind: .character))
+
+        // When
+        let snapshot = LibrarySnapshot(kind: .character)
+        let characters = await LibraryScanner.scanCharacters(in: charsDir, snapshot: snapshot)
+
+        // Then
+        XCTAssertTrue(characters.isEmpty)
+        XCTAssertEqual(snapshot.parsedCount, 0)
+    }
+
+    // MARK: - Startup Hydration
+
+    func testStoredLibraryRestoresLastScanWithoutParsing() async throws {
+        // Given
+        try writeCharacter("kfm", displayName: "Kung Fu Man")
+        try writeCharacter("ryu", displayName: "Ryu")
+        let scanned = await LibraryScanner.scanCharacters(in: charsDir, snapshot: LibrarySnapshot(kind: .character))
+
+        // When - The DEFs are gone, so the values can only have come from the database
+        try FileManager.default.removeItem(at: charsDir)
+        let stored = LibrarySnapshot.storedLibrary()
+
+        // Then
+        XCTAssertTrue(LibraryScanner.isIdentical(stored.characters.sorted { $0.id < $1.id },
+                                                 to: scanned.sorted { $0.id < $1.id }))
+        XCTAssertEqual(stored.characters.first { $0.id == "kfm" }?.name, "Kung Fu Man")
+        XCTAssertTrue(stored.stages.isEmpty)
+    }
+
+    func testIdenticalComparesFieldsNotJustIds() throws {
+        try writeCharacter("kfm", displayName: "Kung Fu Man")
+        let def = charsDir.appendingPathComponent("kfm/kfm.def")
+        let character = CharacterInfo(directory: def.deletingLastPathComponent(), defFile: def)
+        var disabled = character
+        disabled.status = .disabled
+
+        XCTAssertTrue(LibraryScanner.isIdentical([character], to: [character]))
+        XCTAssertEqual(character, disabled)
+        XCTAssertFalse(LibraryScanner.isIdentical([character], to: [disabled]))
+    }
+
+    // MARK: - Helpers
+
+    private func writeCharacter(_ folder: String, displayName: String) throws {
+        let directory = charsDir.appendingPathComponent(folder)
+        try FileManager.default.createDirectory(at: directory, withIntermediateDirectories: true)
+        try Data("[Info]\nname = \"\(displayName)\"\n[Files]\ncmd = \(folder).cmd\n".utf8)
+            .write(to: directory.appendingPathComponent("\(folder).def"))
+    }
+}
@@ -0,0 +1,130 @@
+import XCTest
+@testable import IKEMEN_Lab
+
+/// Tests for library change detection, path mapping and event coalescing
+final class LibraryWatcherTests: XCTestCase {
+
+    var workingDir: URL!
+
+    override func setUp() {
+        super.setUp()
+        workingDir = FileManager.default.temporaryDirectory
+            .appendingPathComponent("LibraryWatcherTests-\(UUID().uuidString)")
+        for folder in ["chars", "stages", "data"] {
+            try? FileManager.default.createDirectory(at: workingDir.appendingPathComponent(folder),
+                                                     withIntermediateDirectories: true)
+        }
+    }
+
+    override func tearDown() {
+        try? FileManager.default.removeItem(at: workingDir)
+        workingDir = nil
+        super.tearDown()
+    }
+
+    // MARK: - Path Mapping
+
+    func testPathsMapToTopLevelEntries() {
+        // Given
+        let root = workingDir.path
+        let paths = [
+            "\(root)/chars/kfm/kfm.def",
+            "\(root)/chars/kfm/kfm.sff",
+            "\(root)/chars/Ryu",
+            "\(root)/stages/dojo.def",
+            "\(root)/stages/Forest/forest.sff",
+            "\(root)/data/select.def",
+            "\(root)/data/select.def.backup.20250101-120000",
+            "\(root)/save/config.ini",
+            "/elsewhere/chars/x.def"
+        ]
+
+        // When
+        let changes = LibraryWatcher.changes(for: paths, root: workingDir)
+
+        // Then
+        XCTAssertEqual(changes.characterFolders, ["kfm", "Ryu"])
+        XCTAssertEqual(changes.stageEntries, ["dojo.def", "Forest"])
+        XCTAssertTrue(changes.selectDef)
+        XCTAssertFalse(changes.screenpacks)
+        XCTAssertFalse(changes.rescanCharacters)
+    }
+
+    func testLibraryFolderItselfRequestsRescan() {
+        let changes = LibraryWatcher.changes(for: ["\(workingDir.path)/chars", "\(workingDir.path)/data/MyPack/system.def"],
+                                             root: workingDir)
+
+        XCTAssertTrue(changes.rescanCharacters)
+        XCTAssertTrue(changes.screenpacks)
+        XCTAssertTrue(changes.characterFolders.isEmpty)
+    }
+
+    // MARK: - Coalescing
+
+    func testBurstIsDeliveredOnce() {
+        // Given
+        let source = ManualChangeSource()
+        let delivered = expectation(description: "changes delivered")
+        var batches: [LibraryChangeSet] = []
+        let watcher = LibraryWatcher(root: workingDir, source: source, coalescingInterval: 0.1, maximumDelay: 0.5) { changes in
+            batches.append(changes)
+            delivered.fulfill()
+        }
+        watcher.start()
+
+        // When - An unzip-style burst of events across one pack
+        for index in 0..<50 {
+            source.emit(["\(workingDir.path)/chars/newchar/file\(index).sff"])
+        }
+        source.emit(["\(workingDir.path)/chars/newchar/newchar.def"])
+
+        // Then
+        wait(for: [delivered], timeout: 2)
+        watcher.stop()
+        XCTAssertEqual(batches.count, 1)
+        XCTAssertEqual(batches.first?.characterFolders, ["newchar"])
+    }
+
+    // MARK: - Polling Source
+
+    func testPollingSourceReportsNewFolder() {
+        // Given
+        let source = PollingChangeSource(interval: 0.1)
+        let delivered = expectation(description: "new character seen")
+        delivered.assertForOverFulfill = false
+        let watcher = LibraryWatcher(root: workingDir, source: source, coalescingInterval: 0.05) { changes in
+            if changes.characterFolders.contains("kfm") {
+                delivered.fulfill()
+            }
+        }
+        watcher.start()
+
+        // When
+        let folder = workingDir.appendingPathComponent("chars/kfm")
+        try? FileManager.default.createDirectory(at: folder, withIntermediateDirectories: true)
+        try? Data("[Info]\nname = KFM\n".utf8).write(to: folder.appendingPathComponent("kfm.def"))
+
+        // Then - Surfaces well within a second
+        wait(for: [delivered], timeout: 1)
+        watcher.stop()
+    }
+
+    // MARK: - Helpers
+
+    /// Change source driven directly by the test
+    private final class ManualChangeSource: LibraryChangeSource {
+        private var handler: (([String]) -> Void)?
+
+        func start(watching paths: [URL], handler: @escaping ([String]) -> Void) {
+            self.handler = handler
+        }
+
+        func stop() {
+            handler = nil
+        }
+
+        func emit(_ paths: [String]) {
+            handler?(paths)
+        }
+    }
+}
@@ -0,0 +1,180 @@
+import XCTest
+@testable import IKEMEN_Lab
+
+/// Tests for the single-transaction character and stage reindex
+final class MetadataStoreReindexTests: XCTestCase {
+
+    var workingDir: URL!
+    var charsDir: URL!
+
+    override func setUp() {
+        super.setUp()
+        workingDir = FileManager.default.temporaryDirectory
+            .appendingPathComponent("MetadataStoreReindexTests-\(UUID().uuidString)")
+        charsDir = workingDir.appendingPathComponent("chars")
+        try? FileManager.default.createDirectory(at: charsDir, withIntermediateDirectories: true)
+        try? FileManager.default.createDirectory(at: workingDir.appendingPathComponent("stages"), withIntermediateDirectories: true)
+        try? MetadataStore.shared.initialize(workingDir: workingDir)
+    }
+
+    override func tearDown() {
+        MetadataStore.shared.close()
+        try? FileManager.default.removeItem(at: workingDir)
+        workingDir = nil
+        charsDir = nil
+        super.tearDown()
+    }
+
+    // MARK: - Characters
+
+    func testReindexUpdatesRowsAndKeepsInstallDate() throws {
+        // Given
+        try writeCharacter("kfm", displayName: "KFM")
+        try MetadataStore.shared.reindexCharacters(from: workingDir, manifest: manifest())
+        let installedAt = try XCTUnwrap(MetadataStore.shared.character(id: "kfm")).installedAt
+
+        // When
+        try writeCharacter("kfm", displayName: "Kung Fu Man")
+        try writeCharacter("ryu", displayName: "Ryu")
+        try MetadataStore.shared.reindexCharacters(from: workingDir, manifest: manifest())
+
+        // Then
+        let kfm = try XCTUnwrap(MetadataStore.shared.character(id: "kfm"))
+        XCTAssertEqual(kfm.name, "Kung Fu Man")
+        XCTAssertEqual(kfm.installedAt, installedAt)
+        XCTAssertEqual(try MetadataStore.shared.characterCount(), 2)
+    }
+
+    func testReindexRemovesDeletedCharactersAndTheirCaches() throws {
+        // Given
+        try writeCharacter("kfm", displayName: "KFM")
+        try writeCharacter("kfm_2", displayName: "KFM 2")
+        try MetadataStore.shared.reindexCharacters(from: workingDir, manifest: manifest())
+        try storeSFFDirectory(at: charsDir.appendingPathComponent("kfm/kfm.sff"))
+        try storeSFFDirectory(at: charsDir.appendingPathComponent("kfm_2/kfm.sff"))
+        try storeThumbnail(ImageCache.portraitThumbnailKey(for: "kfm"))
+        try storeThumbnail(ImageCache.portraitThumbnailKey(for: "kfm_2"))
+        try storeSnapshot(at: charsDir.appendingPathComponent("kfm"), kind: .character)
+        try storeSnapshot(at: charsDir.appendingPathComponent("kfm_2"), kind: .character)
+
+        // When
+        try FileManager.default.removeItem(at: charsDir.appendingPathComponent("kfm"))
+        try MetadataStore.shared.reindexCharacters(from: workingDir, manifest: manifest())
+
+        // Then - "kfm_2/" shares the "kfm" prefix but keeps its cached data
+        XCTAssertEqual(try MetadataStore.shared.allCharacters().map { $0.id }, ["kfm_2"])
+        XCTAssertNil(try MetadataStore.shared.sffDirectory(path: charsDir.appendingPathComponent("kfm/kfm.sff").path, fileSize: 0, modifiedAt: 0))
+        XCTAssertNotNil(try MetadataStore.shared.sffDirectory(path: charsDir.appendingPathComponent("kfm_2/kfm.sff").path, fileSize: 0, modifiedAt: 0))
+        XCTAssertEqual(try storedThumbnailKeys(), [ImageCache.portraitThumbnailKey(for: "kfm_2")])
+        XCTAssertEqual(try MetadataStore.shared.allLibrarySnapshots().map { $0.path },
+                       [charsDir.appendingPathComponent("kfm_2").standardizedFileURL.path])
+    }
+
+    func testIndexCharacterKeepsInstallDate() throws {
+        // Given
+        try writeCharacter("kfm", displayName: "KFM")
+        try MetadataStore.shared.reindexCharacters(from: workingDir, manifest: manifest())
+        let installedAt = try XCTUnwrap(MetadataStore.shared.character(id: "kfm")).installedAt
+
+        // When - The installer re-indexes the character after an update
+        try writeCharacter("kfm", displayName: "Kung Fu Man")
+        let directory = charsDir.appendingPathComponent("kfm")
+        try MetadataStore.shared.indexCharacter(CharacterInfo(directory: directory, defFile: directory.appendingPathComponent("kfm.def")))
+
+        // Then
+        let kfm = try XCTUnwrap(MetadataStore.shared.character(id: "kfm"))
+        XCTAssertEqual(kfm.name, "Kung Fu Man")
+        XCTAssertEqual(kfm.installedAt, installedAt)
+    }
+
+    // MARK: - Stages
+
+    func testReindexStagesRemovesDeletedStages() throws {
+        // Given
+        let stagesDir = workingDir.appendingPathComponent("stages")
+        try Data("[Info]\nname = Dojo\n[StageInfo]\nzoffset = 200\n".utf8).write(to: stagesDir.appendingPathComponent("dojo.def"))
+        try Data("[Info]\nname = Forest\n[BGdef]\nspr = forest.sff\n".utf8).write(to: stagesDir.appendingPathComponent("forest.def"))
+        try MetadataStore.shared.reindexStages(from: workingDir)
+        try storeThumbnail(ImageCache.stagePreviewThumbnailKey(for: "dojo"))
+        try storeThumbnail(ImageCache.stagePreviewThumbnailKey(for: "forest"))
+        try storeSnapshot(at: stagesDir.appendingPathComponent("dojo.def"), kind: .stage)
+        try storeSnapshot(at: stagesDir.appendingPathComponent("forest.def"), kind: .stage)
+
+        // When
+        try FileManager.default.removeItem(at: stagesDir.appendingPathComponent("forest.def"))
+        try MetadataStore.shared.reindexStages(from: workingDir)
+
+        // Then
+        XCTAssertEqual(try MetadataStore.shared.allStages().map { $0.id }, ["dojo"])
+        XCTAssertEqual(try storedThumbnailKeys(), [ImageCache.stagePreviewThumbnailKey(for: "dojo")])
+        XCTAssertEqual(try MetadataStore.shared.allLibrarySnapshots().map { $0.path },
+                       [stagesDir.appendingPathComponent("dojo.def").standardizedFileURL.path])
+    }
+
+    // MARK: - Thumbnails
+
+    func testThumbnailCapDropsLeastRecentlyUsed() throws {
+        // Given - Three thumbnails stored in order; the oldest is then shown again
+        let now = Date()
+        try storeThumbnail("a", accessedAt: now.addingTimeInterval(-30), limit: 3)
+        try storeThumbnail("b", accessedAt: now.addingTimeInterval(-20), limit: 3)
+        try storeThumbnail("c", accessedAt: now.addingTimeInterval(-10), limit: 3)
+        try MetadataStore.shared.touchThumbnails(keys: ["a"])
+
+        // When
+        try storeThumbnail("d", accessedAt: now.addingTimeInterval(-5), limit: 3)
+
+        // Then
+        XCTAssertEqual(try storedThumbnailKeys(), ["a", "c", "d"])
+    }
+
+    // MARK: - Helpers
+
+    private func manifest() -> LibraryManifest {
+        return LibraryManifest.build(charsDirectory: charsDir)
+    }
+
+    private func writeCharacter(_ folder: String, displayName: String) throws {
+        let directory = charsDir.appendingPathComponent(folder)
+        try FileManager.default.createDirectory(at: directory, withIntermediateDirectories: true)
+        try Data("[Info]\nname = \"\(displayName)\"\n[Files]\ncmd = \(folder).cmd\n".utf8)
+            .write(to: directory.appendingPathComponent("\(folder).def"))
+    }
+
+    private func storeThumbnail(_ key: String, accessedAt: Date = Date(),
+                                limit: Int = MetadataStore.maxStoredThumbnails) throws {
+        try MetadataStore.shared.storeThumbnail(ThumbnailRecord(key: key, sourceFingerprint: "", imageData: Data(),
+                                                                storedAt: accessedAt, accessedAt: accessedAt), limit: limit)
+    }
+
+    private func storeSnapshot(at url: URL, kind: LibrarySnapshot.Kind) throws {
+        try MetadataStore.shared.updateLibrarySnapshot([LibrarySnapshotRecord(
+            path: url.standardizedFileURL.path,
+            kind: kind.rawValue,
+            files: "",
+            fingerprint: "",
+            payload: Data("[]".utf8),
+            scannedAt: Date()
+        )], removingPaths: [])
+    }
+
+    private func storedThumbnailKeys() throws -> [String] {
+        let keys = ["a", "b", "c", "d"]
+            + ["kfm", "kfm_2"].map { ImageCache.portraitThumbnailKey(for: $0) }
+            + ["dojo", "forest"].map { ImageCache.stagePreviewThumbnailKey(for: $0) }
+        return try MetadataStore.shared.thumbnails(keys: keys).map { $0.key }.sorted()
+    }
+
+    private func storeSFFDirectory(at url: URL) throws {
+        try MetadataStore.shared.storeSFFDirectory(SFFDirectoryRecord(
+            path: url.standardizedFileURL.path,
+            fileSize: 0,
+            modifiedAt: 0,
+            version: 2,
+            spriteCount: 0,
+            paletteCount: 0,
+            entries: Data(),
+            indexedAt: Date()
+        ))
+    }
+}
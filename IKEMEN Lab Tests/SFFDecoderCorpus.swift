@@ -0,0 +1,198 @@
+import Foundation
+
+/// Deterministic corpus of compressed SFFv2 sprites for decoder tests and benchmarks
+///
+/// Each sprite is generated token by token from a fixed seed while the expected output is
+/// built alongside it, so every token form (short/long runs, short/long back-references,
+/// recycled-bit offsets, overlapping copies) is exercised with a known-good result.
+struct SFFDecoderCorpus {
+
+    struct Sprite {
+        let name: String
+        let width: Int
+        let height: Int
+        let encoded: Data
+        let expected: [UInt8]
+    }
+
+    enum Format {
+        case rle8
+        case rle5
+        case lz5
+    }
+
+    /// Standard benchmark corpus: a character-sized sprite, a 640x480 and a 1280x720 background
+    static func standard(_ format: Format) -> [Sprite] {
+        return [
+            sprite(format, width: 160, height: 200, seed: 1),
+            sprite(format, width: 640, height: 480, seed: 2),
+            sprite(format, width: 1280, height: 720, seed: 3)
+        ]
+    }
+
+    static func sprite(_ format: Format, width: Int, height: Int, seed: UInt64) -> Sprite {
+        var rng = SplitMix64(seed: seed)
+        let count = width * height
+        let generated: (encoded: Data, expected: [UInt8])
+
+        switch format {
+        case .rle8: generated = makeRLE8(count: count, rng: &rng)
+        case .rle5: generated = makeRLE5(count: count, rng: &rng)
+        case .lz5: generated = makeLZ5(count: count, rng: &rng)
+        }
+
+        return Sprite(name: "\(format) \(width)x\(height)", width: width, height: height,
+                      encoded: generated.encoded, expected: Array(generated.expected.prefix(count)))
+    }
+
+    // MARK: - RLE8
+
+    private static func makeRLE8(count: Int, rng: inout SplitMix64) -> (Data, [UInt8]) {
+        var encoded = Data()
+        var expected: [UInt8] = []
+        expected.reserveCapacity(count + 64)
+
+        while expected.count < count {
+            let value = UInt8(truncatingIfNeeded: rng.next())
+            let runLength = rng.next(in: 0...3) == 0 ? 1 : rng.next(in: 1...63)
+
+            if runLength == 1 && (value & 0xC0) != 0x40 {
+                encoded.append(value)
+            } else {
+                encoded.append(0x40 | UInt8(runLength))
+                encoded.append(value)
+            }
+            expected += repeatElement(value, count: runLength)
+        }
+        return (encoded, expected)
+    }
+
+    // MARK: - RLE5
+
+    private static func makeRLE5(count: Int, rng: inout SplitMix64) -> (Data, [UInt8]) {
+        var encoded = Data()
+        var expected: [UInt8] = []
+        expected.reserveCapacity(count + 8192)
+
+        while expected.count < count {
+            let runLength = rng.next(in: 0...255)
+            let dataLength = rng.next(in: 0...127)
+            let hasColor = rng.next(in: 0...1) == 1
+            let color = hasColor ? UInt8(truncatingIfNeeded: rng.next()) : 0
+
+            encoded.append(UInt8(runLength))
+            encoded.append(UInt8(dataLength) | (hasColor ? 0x80 : 0))
+            if hasColor { encoded.append(color) }
+            expected += repeatElement(color, count: runLength + 1)
+
+            for _ in 0..<dataLength {
+                let packed = UInt8(truncatingIfNeeded: rng.next())
+                encoded.append(packed)
+                expected += repeatElement(packed & 0x1F, count: Int(packed >> 5) + 1)
+            }
+        }
+        return (encoded, expected)
+    }
+
+    // MARK: - LZ5
+
+    private static func makeLZ5(count: Int, rng: inout SplitMix64) -> (Data, [UInt8]) {
+        var encoded = Data([0])
+        var controlIndex = 0
+        var controlBit = 0
+        var expected: [UInt8] = []
+        expected.reserveCapacity(count + 512)
+
+        var recycled = 0
+        var recycledCount = 0
+
+        while expected.count < count {
+            // Back-references need history; the first tokens are always runs
+            let isCopy = expected.count >= 1024 && rng.next(in: 0...2) != 0
+
+            if isCopy {
+                encoded[controlIndex] |= UInt8(1 << controlBit)
+
+                if rng.next(in: 0...3) == 0 {
+                    // Long back-reference: 10-bit offset, 3...258 bytes
+                    let offset = rng.next(in: 1...1024)
+                    let length = rng.next(in: 3...258)
+                    encoded.append(UInt8(((offset - 1) >> 8) << 6))
+                    encoded.append(UInt8((offset - 1) & 0xFF))
+                    encoded.append(UInt8(length - 3))
+                    appendCopy(&expected, offset: offset, length: length)
+                } else {
+                    // Short back-reference: 2...64 bytes; every fourth uses the recycled bits
+                    let length = rng.next(in: 2...64)
+                    let topBits = rng.next(in: 0...3)
+                    encoded.append(UInt8(topBits << 6 | (length - 1)))
+                    recycled |= (topBits << 6) >> (recycledCount * 2)
+                    recycledCount += 1
+
+                    let offset: Int
+                    if recycledCount < 4 {
+                        offset = rng.next(in: 1...256)
+                        encoded.append(UInt8(offset - 1))
+                    } else {
+                        offset = recycled + 1
+                        recycled = 0
+                        recycledCount = 0
+                    }
+                    appendCopy(&expected, offset: offset, length: length)
+                }
+            } else {
+                let color = UInt8(rng.next(in: 0...31))
+                if rng.next(in: 0...1) == 0 {
+                    // Short run: 1...7 pixels
+                    let length = rng.next(in: 1...7)
+                    encoded.append(UInt8(length << 5) | color)
+                    expected += repeatElement(color, count: length)
+                } else {
+                    // Long run: 8...263 pixels
+                    let length = rng.next(in: 8...263)
+                    encoded.append(color)
+                    encoded.append(UInt8(length - 8))
+                    expected += repeatElement(color, count: length)
+                }
+            }
+
+            controlBit += 1
+            if controlBit == 8 {
+                controlIndex = encoded.count
+                encoded.append(0)
+                controlBit = 0
+            }
+        }
+        return (encoded, expected)
+    }
+
+    private static func appendCopy(_ output: inout [UInt8], offset: Int, length: Int) {
+        for _ in 0..<length {
+            output.append(output[output.count - offset])
+        }
+    }
+}
+
+// MARK: - Seeded Generator
+
+/// Small deterministic PRNG so the corpus is identical on every run
+struct SplitMix64 {
+    private var state: UInt64
+
+    init(seed: UInt64) {
+        state = seed
+    }
+
+    mutating func next() -> UInt64 {
+        state &+= 0x9E37_79B9_7F4A_7C15
+        var z = state
+        z = (z ^ (z >> 30)) &* 0xBF58_476D_1CE4_E5B9
+        z = (z ^ (z >> 27)) &* 0x94D0_49BB_1331_11EB
+        return z ^ (z >> 31)
+    }
+
+    mutating func next(in range: ClosedRange<Int>) -> Int {
+        let span = UInt64(range.upperBound - range.lowerBound + 1)
+        return range.lowerBound + Int(next() % span)
+    }
+}
@@ -0,0 +1,109 @@
+import XCTest
+@testable import IKEMEN_Lab
+
+/// Tests and microbenchmarks for the shared index -> RGBA palette expansion kernel
+final class SFFPaletteKernelTests: XCTestCase {
+
+    // MARK: - Correctness
+
+    func testExpandMatchesScalarReferenceForAllTailLengths() {
+        // Given - A palette with distinct colors and indices covering the SIMD body and tail
+        let palette = makeRGBAPalette()
+        let table = SFFPaletteKernel.lookupTable(rgba: palette)
+
+        for count in 0...33 {
+            let indices = (0..<count).map { UInt8(truncatingIfNeeded: $0 * 37) }
+
+            // When
+            let expanded = SFFPaletteKernel.expand(indices, table: table)
+
+            // Then
+            XCTAssertEqual(expanded, referenceExpand(indices, rgba: palette), "Mismatch for \(count) pixels")
+        }
+    }
+
+    func testIndexZeroIsTransparent() {
+        let rgbTable = SFFPaletteKernel.lookupTable(rgb: [UInt8](repeating: 200, count: 768))
+        let rgbaTable = SFFPaletteKernel.lookupTable(rgba: [UInt8](repeating: 200, count: 1024), usePaletteAlpha: true)
+
+        XCTAssertEqual(SFFPaletteKernel.expand([0, 1], table: rgbTable), [200, 200, 200, 0, 200, 200, 200, 255])
+        XCTAssertEqual(SFFPaletteKernel.expand([0, 1], table: rgbaTable), [200, 200, 200, 0, 200, 200, 200, 200])
+    }
+
+    func testExpandRowsHonorsStride() {
+        // Given - 3x2 bitmap with 2 bytes of row padding
+        let bitmap: [UInt8] = [1, 2, 3, 0xEE, 0xEE,
+                               4, 5, 6, 0xEE, 0xEE]
+        let palette = makeRGBAPalette()
+        let table = SFFPaletteKernel.lookupTable(rgba: palette)
+
+        // When
+        let expanded = bitmap.withUnsafeBufferPointer { buffer in
+            SFFPaletteKernel.expand(rows: buffer.baseAddress!, width: 3, height: 2, bytesPerRow: 5, table: table)
+        }
+
+        // Then
+        XCTAssertEqual(expanded, referenceExpand([1, 2, 3, 4, 5, 6], rgba: palette))
+    }
+
+    func testACTPaletteIsReversed() throws {
+        // Given - .act file whose first color is (1,2,3) and last color is (7,8,9)
+        var act = [UInt8](repeating: 0, count: 768)
+        act.replaceSubrange(0..<3, with: [1, 2, 3])
+        act.replaceSubrange(765..<768, with: [7, 8, 9])
+
+        // When
+        let table = try XCTUnwrap(SFFPaletteKernel.lookupTable(act: Data(act)))
+
+        // Then - File order is index 255 first; index 0 stays transparent
+        XCTAssertEqual(SFFPaletteKernel.expand([255, 0], table: table), [1, 2, 3, 255, 7, 8, 9, 0])
+        XCTAssertNil(SFFPaletteKernel.lookupTable(act: Data(count: 100)))
+    }
+
+    func testThumbnailSizeKeepsAspectRatio() {
+        XCTAssertNil(SFFPaletteKernel.thumbnailSize(width: 200, height: 100, maxPixelSize: 320))
+        XCTAssertEqual(SFFPaletteKernel.thumbnailSize(width: 1280, height: 720, maxPixelSize: 640)?.width, 640)
+        XCTAssertEqual(SFFPaletteKernel.thumbnailSize(width: 1280, height: 720, maxPixelSize: 640)?.height, 360)
+        XCTAssertEqual(SFFPaletteKernel.thumbnailSize(width: 10, height: 4000, maxPixelSize: 320)?.width, 1)
+    }
+
+    func testDownsampledExpansionBoxFiltersPremultiplied() {
+        // Given - 4x2 bitmap: left box is 2 transparent + 2 opaque pixels, right box is all opaque
+        let bitmap: [UInt8] = [0, 1, 2, 2,
+                               0, 1, 2, 2]
+        var palette = [UInt8](repeating: 0, count: 1024)
+        palette.replaceSubrange(4..<8, with: [200, 100, 50, 255])   // index 1
+        palette.replaceSubrange(8..<12, with: [10, 20, 30, 255])    // index 2
+        let table = SFFPaletteKernel.lookupTable(rgba: palette)
+
+        // When
+        let thumbnail = bitmap.withUnsafeBufferPointer { buffer in
+            SFFPaletteKernel.expandDownsampled(rows: buffer.baseAddress!, width: 4, height: 2, bytesPerRow: 4,
+                                               table: table, targetWidth: 2, targetHeight: 1)
+        }
+
+        // Then - Half coverage halves alpha and (premultiplied) color; no dark fringe from index 0
+        XCTAssertEqual(thumbnail, [100, 50, 25, 127, 10, 20, 30, 255])
+    }
+
+    // MARK: - Helpers
+
+    private func makeRGBAPalette() -> [UInt8] {
+        return (0..<256).flatMap { i -> [UInt8] in
+            [UInt8(i), UInt8(255 - i), UInt8(truncatingIfNeeded: i * 3), 255]
+        }
+    }
+
+    /// The per-pixel loop the kernel replaced
+    private func referenceExpand(_ indices: [UInt8], rgba palette: [UInt8]) -> [UInt8] {
+        var rgba = [UInt8](repeating: 255, count: indices.count * 4)
+        for i in 0..<indices.count {
+            let colorIndex = Int(indices[i])
+            rgba[i * 4] = palette[colorIndex * 4]
+            rgba[i * 4 + 1] = palette[colorIndex * 4 + 1]
+            rgba[i * 4 + 2] = palette[colorIndex * 4 + 2]
+            rgba[i * 4 + 3] = colorIndex == 0 ? 0 : 255
+        }
+        return rgba
+    }
+}
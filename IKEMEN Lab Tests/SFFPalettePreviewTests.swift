@@ -0,0 +1,90 @@
+import XCTest
+import AppKit
+@testable import IKEMEN_Lab
+
+/// End-to-end tests for palette previews: DEF .act files versus SFFv2 palette nodes
+final class SFFPalettePreviewTests: XCTestCase {
+
+    var workingDir: URL!
+
+    override func setUp() {
+        super.setUp()
+        workingDir = FileManager.default.temporaryDirectory
+            .appendingPathComponent("SFFPalettePreviewTests-\(UUID().uuidString)")
+        try? FileManager.default.createDirectory(at: workingDir, withIntermediateDirectories: true)
+    }
+
+    override func tearDown() {
+        SFFPalettePreview.shared.clearCache()
+        try? FileManager.default.removeItem(at: workingDir)
+        workingDir = nil
+        super.tearDown()
+    }
+
+    // MARK: - Precedence
+
+    func testActFilesOverrideSFFPaletteNodes() throws {
+        // Given - SFF palettes 1,1 blue and 1,2 green; pal1 is a red .act, pal2's .act is missing
+        let character = try writeCharacter("kfm", files: "pal1 = red.act\npal2 = missing.act\n")
+        try writeAct(red: 255, green: 0, blue: 0, to: character.directory.appendingPathComponent("red.act"))
+
+        // When
+        let previews = SFFPalettePreview.shared.previews(for: character)
+
+        // Then
+        XCTAssertEqual(previews.map { $0.number }, [1, 2])
+        XCTAssertEqual(previews.first.flatMap { dominantChannel(of: $0.image) }, "red")
+        XCTAssertEqual(previews.last.flatMap { dominantChannel(of: $0.image) }, "green")
+    }
+
+    func testSFFPaletteNodesAreUsedWithoutActFiles() throws {
+        // Given
+        let character = try writeCharacter("ryu", files: "")
+
+        // When
+        let previews = SFFPalettePreview.shared.previews(for: character)
+
+        // Then
+        XCTAssertEqual(previews.map { $0.number }, [1, 2])
+        XCTAssertEqual(previews.map { dominantChannel(of: $0.image) }, ["blue", "green"])
+    }
+
+    // MARK: - Helpers
+
+    /// Character folder whose SFF holds one 4x4 sprite (0,0) of palette index 1
+    private func writeCharacter(_ name: String, files: String) throws -> CharacterInfo {
+        let directory = workingDir.appendingPathComponent(name)
+        try FileManager.default.createDirectory(at: directory, withIntermediateDirectories: true)
+
+        let def = directory.appendingPathComponent("\(name).def")
+        try Data("[Info]\nname = \"\(name)\"\n[Files]\ncmd = \(name).cmd\nsprite = \(name).sff\n\(files)".utf8).write(to: def)
+
+        let writer = try SFFStreamWriter(url: directory.appendingPathComponent("\(name).sff"), spriteCapacity: 1, paletteNodes: [
+            SFFStreamWriter.PaletteNode(group: 1, item: 1, colorCount: 2, linkedIndex: 0, colors: [0, 0, 0, 0, 0, 0, 255, 255]),
+            SFFStreamWriter.PaletteNode(group: 1, item: 2, colorCount: 2, linkedIndex: 0, colors: [0, 0, 0, 0, 0, 255, 0, 255])
+        ])
+        try writer.append(group: 0, image: 0, x: 0, y: 0, width: 4, height: 4,
+                          format: 0, colorDepth: 8, paletteIndex: 0, payload: Data(repeating: 1, count: 16))
+        try writer.finish()
+
+        return CharacterInfo(directory: directory, defFile: def)
+    }
+
+    /// .act file (colors stored last index first) where index 1 has the given color
+    private func writeAct(red: UInt8, green: UInt8, blue: UInt8, to url: URL) throws {
+        var act = [UInt8](repeating: 0, count: 768)
+        act.replaceSubrange(762..<765, with: [red, green, blue])
+        try Data(act).write(to: url)
+    }
+
+    /// Strongest color channel at the image's center pixel
+    private func dominantChannel(of image: NSImage) -> String? {
+        guard let cgImage = image.cgImage(forProposedRect: nil, context: nil, hints: nil),
+              let color = NSBitmapImageRep(cgImage: cgImage)
+                .colorAt(x: cgImage.width / 2, y: cgImage.height / 2)?
+                .usingColorSpace(.deviceRGB) else { return nil }
+
+        let channels = [("red", color.redComponent), ("green", color.greenComponent), ("blue", color.blueComponent)]
+        return channels.max { $0.1 < $1.1 }?.0
+    }
+}
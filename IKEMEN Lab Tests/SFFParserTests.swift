@@ -1,4 +1,5 @@
 import XCTest
+import AppKit
 @testable import IKEMEN_Lab
 
 /// Tests for SFFParser signature validation and error handling
@@ -133,6 +134,435 @@ final class SFFParserTests: XCTestCase {
         }
     }
     
+    // MARK: - SFFReader Tests
+
+    func testReaderMapsFileAndReadsLittleEndianFields() throws {
+        // Given - A v2 header written to disk
+        var data = Data("ElecbyteSpr\0".utf8)
+        data.append(contentsOf: [0x00, 0x01, 0x00, 0x02])
+        data.append(contentsOf: Array(repeating: UInt8(0), count: 20))
+        data.append(contentsOf: [0x44, 0x00, 0x00, 0x00])  // sprite list offset = 68
+        data.append(contentsOf: [0x02, 0x01, 0x00, 0x00])  // sprite count = 258
+
+        let url = FileManager.default.temporaryDirectory.appendingPathComponent("reader-\(UUID().uuidString).sff")
+        try data.write(to: url)
+        defer { try? FileManager.default.removeItem(at: url) }
+
+        // When
+        let reader = try SFFReader(url: url)
+
+        // Then
+        XCTAssertTrue(reader.hasValidSignature)
+        XCTAssertEqual(reader.versionHi, 2)
+        XCTAssertEqual(reader.readUInt32(at: 36), 68)
+        XCTAssertEqual(reader.readUInt16(at: 40), 258)
+        XCTAssertEqual(reader.count, data.count)
+    }
+
+    func testReaderOutOfBoundsReadsAreSafe() {
+        let reader = SFFReader(data: Data([0x01, 0x02, 0x03]))
+
+        XCTAssertEqual(reader.readUInt32(at: 0), 0)
+        XCTAssertEqual(reader.readUInt16(at: 2), 0)
+        XCTAssertEqual(reader.byte(at: -1), 0)
+        XCTAssertNil(reader.bytes(at: 1, length: 3))
+        XCTAssertEqual(reader.bytes(at: 1, upTo: 10), Data([0x02, 0x03]))
+    }
+
+    func testReaderRebasesDataSlices() {
+        let backing = Data([0xFF, 0xFF, 0x34, 0x12])
+        let reader = SFFReader(data: backing[2...])
+
+        XCTAssertEqual(reader.readUInt16(at: 0), 0x1234)
+    }
+
+    // MARK: - Sprite Directory Tests
+
+    func testDirectoryIndexesSFFv2Nodes() throws {
+        // Given - A two-sprite file written by SFFWriter
+        let url = FileManager.default.temporaryDirectory.appendingPathComponent("dir-\(UUID().uuidString).sff")
+        defer { try? FileManager.default.removeItem(at: url) }
+        let sprites = [
+            SFFWriter.SpriteEntry(group: 9000, image: 1, pngData: Data(repeating: 0xAB, count: 10), width: 240, height: 100),
+            SFFWriter.SpriteEntry(group: 0, image: 0, pngData: Data(repeating: 0xCD, count: 20), width: 640, height: 480)
+        ]
+        guard case .success = SFFWriter.write(sprites: sprites, to: url) else {
+            return XCTFail("Failed to write test SFF")
+        }
+
+        // When
+        let reader = try SFFReader(url: url)
+        let directory = try XCTUnwrap(SFFSpriteDirectory.build(from: reader))
+
+        // Then
+        XCTAssertEqual(directory.version, 2)
+        XCTAssertEqual(directory.spriteCount, 2)
+        XCTAssertEqual(directory.paletteCount, 1)
+
+        let background = try XCTUnwrap(directory.entry(group: 0, image: 0))
+        XCTAssertEqual(background.width, 640)
+        XCTAssertEqual(background.height, 480)
+        XCTAssertEqual(background.format, 12)
+        XCTAssertEqual(background.dataLength, 24)
+        XCTAssertEqual(reader.bytes(at: Int(background.dataOffset) + 4, length: 20), Data(repeating: 0xCD, count: 20))
+        XCTAssertNil(directory.entry(group: 9000, image: 0))
+    }
+
+    func testWriterLinksDuplicatePayloads() throws {
+        // Given - Two identical sprites and one that differs only in size
+        let url = FileManager.default.temporaryDirectory.appendingPathComponent("dedup-\(UUID().uuidString).sff")
+        defer { try? FileManager.default.removeItem(at: url) }
+        let png = Data(repeating: 0xAB, count: 32)
+        let sprites = [
+            SFFWriter.SpriteEntry(group: 0, image: 0, pngData: png, width: 64, height: 64),
+            SFFWriter.SpriteEntry(group: 0, image: 1, pngData: png, width: 64, height: 64),
+            SFFWriter.SpriteEntry(group: 0, image: 2, pngData: png, width: 32, height: 32)
+        ]
+
+        // When
+        guard case .success = SFFWriter.write(sprites: sprites, to: url) else {
+            return XCTFail("Failed to write test SFF")
+        }
+
+        // Then - The duplicate is a payload-less node linked to the first copy
+        let archive = try SFFArchive(url: url)
+        let duplicate = try XCTUnwrap(archive.entry(group: 0, image: 1))
+        XCTAssertTrue(duplicate.isLinked)
+        XCTAssertEqual(duplicate.linkedIndex, 0)
+        XCTAssertEqual(archive.resolvedEntry(group: 0, image: 1)?.dataLength, 36)
+        XCTAssertFalse(try XCTUnwrap(archive.entry(group: 0, image: 2)).isLinked)
+
+        // Header + 3 nodes + palette node + palette data + two 36-byte payloads
+        let fileSize = try XCTUnwrap(SFFDirectoryIndex.fileIdentity(of: url)?.size)
+        XCTAssertEqual(fileSize, Int64(68 + 3 * 28 + 16 + 4 + 2 * 36))
+    }
+
+    func testStreamWriterRejectsSpritesBeyondCapacity() throws {
+        let url = FileManager.default.temporaryDirectory.appendingPathComponent("cap-\(UUID().uuidString).sff")
+        defer { try? FileManager.default.removeItem(at: url) }
+        let writer = try SFFStreamWriter(url: url, spriteCapacity: 1)
+        let sprite = SFFWriter.SpriteEntry(group: 0, image: 0, pngData: Data([1, 2, 3]), width: 1, height: 1)
+
+        try writer.append(sprite)
+
+        XCTAssertThrowsError(try writer.append(sprite))
+        XCTAssertNoThrow(try writer.finish())
+        XCTAssertEqual(try SFFArchive(url: url).spriteCount, 1)
+    }
+
+    func testAbandonedStreamWriterLeavesDestinationIntact() throws {
+        // Given - An existing file at the destination
+        let folder = FileManager.default.temporaryDirectory.appendingPathComponent("partial-\(UUID().uuidString)")
+        try FileManager.default.createDirectory(at: folder, withIntermediateDirectories: true)
+        defer { try? FileManager.default.removeItem(at: folder) }
+        let url = folder.appendingPathComponent("char.sff")
+        try Data("original".utf8).write(to: url)
+
+        // When - A sprite fails to append and the writer is dropped unfinished
+        do {
+            let writer = try SFFStreamWriter(url: url, spriteCapacity: 2, palettes: [[0, 0, 0, 0]])
+            try writer.append(SFFWriter.SpriteEntry(group: 0, image: 0, pngData: Data([1, 2, 3]), width: 1, height: 1))
+            XCTAssertThrowsError(try writer.append(SFFWriter.SpriteEntry(group: 0, image: 1, indexedPixels: [1],
+                                                                         palette: [9, 9, 9, 9], width: 1, height: 1)))
+        }
+
+        // Then - The original survives and no partial output is left next to it
+        XCTAssertEqual(try Data(contentsOf: url), Data("original".utf8))
+        XCTAssertEqual(try FileManager.default.contentsOfDirectory(atPath: folder.path), ["char.sff"])
+
+        // A finished writer replaces it in one move
+        let writer = try SFFStreamWriter(url: url, spriteCapacity: 1)
+        try writer.append(SFFWriter.SpriteEntry(group: 0, image: 0, pngData: Data([1, 2, 3]), width: 1, height: 1))
+        try writer.finish()
+        XCTAssertEqual(try SFFArchive(url: url).spriteCount, 1)
+        XCTAssertEqual(try FileManager.default.contentsOfDirectory(atPath: folder.path), ["char.sff"])
+    }
+
+    func testDirectoryPackRoundTrip() throws {
+        let entries = [
+            SFFSpriteDirectory.Entry(group: 9000, image: 0, nodeOffset: 68, width: 25, height: 25, format: 4,
+                                     colorDepth: 8, paletteIndex: 3, linkedIndex: 0, dataOffset: 1024, dataLength: 300),
+            SFFSpriteDirectory.Entry(group: 0, image: 0, nodeOffset: 96, width: 120, height: 140, format: 2,
+                                     colorDepth: 8, paletteIndex: 0, linkedIndex: 0, dataOffset: 1324, dataLength: 0)
+        ]
+        let directory = SFFSpriteDirectory(version: 2, entries: entries, paletteCount: 12)
+
+        let restored = try XCTUnwrap(SFFSpriteDirectory.unpack(version: 2, paletteCount: 12, packed: directory.packedEntries()))
+
+        XCTAssertEqual(restored.entries, entries)
+        XCTAssertEqual(restored.index(group: 0, image: 0), 1)
+        XCTAssertTrue(restored.entries[1].isLinked)
+        XCTAssertNil(SFFSpriteDirectory.unpack(version: 2, paletteCount: 0, packed: Data([0x01])))
+    }
+
+    // MARK: - SFF Archive Tests
+
+    func testArchiveResolvesLinkedPortrait() throws {
+        // Given - 9000,0 is a linked node pointing at the standing sprite's data
+        let data = makeSFFv2(
+            sprites: [
+                TestSprite(group: 0, image: 0, pixels: [0, 1, 2, 3], linkedIndex: 0, paletteIndex: 0),
+                TestSprite(group: 9000, image: 0, pixels: [], linkedIndex: 0, paletteIndex: 0)
+            ],
+            palettes: [.colors(4)]
+        )
+
+        // When
+        let archive = try SFFArchive(reader: SFFReader(data: data))
+
+        // Then
+        XCTAssertEqual(archive.spriteCount, 2)
+        let linked = try XCTUnwrap(archive.directory.index(group: 9000, image: 0))
+        XCTAssertEqual(archive.resolvedIndex(linked), 0)
+        XCTAssertEqual(archive.resolvedEntry(group: 9000, image: 0)?.dataLength, 4)
+
+        let image = try XCTUnwrap(archive.image(group: 9000, image: 0))
+        XCTAssertEqual(image.size.width, 2)
+        XCTAssertEqual(image.size.height, 2)
+
+        // Thumbnail decode downsamples while expanding the palette
+        let thumbnail = try XCTUnwrap(archive.image(group: 9000, image: 0, maxPixelSize: 1))
+        XCTAssertEqual(thumbnail.size.width, 1)
+        XCTAssertEqual(thumbnail.size.height, 1)
+
+        // The portrait path no longer skips linked 9000 sprites
+        guard case .success = SFFParser.extractPortraitResult(from: data) else {
+            return XCTFail("Expected linked portrait to decode")
+        }
+    }
+
+    func testArchiveRejectsLinkCycles() throws {
+        // Given - Two payload-less nodes linking to each other
+        let data = makeSFFv2(
+            sprites: [
+                TestSprite(group: 9000, image: 0, pixels: [], linkedIndex: 1, paletteIndex: 0),
+                TestSprite(group: 9000, image: 1, pixels: [], linkedIndex: 0, paletteIndex: 0)
+            ],
+            palettes: [.colors(4)]
+        )
+
+        // When
+        let archive = try SFFArchive(reader: SFFReader(data: data))
+
+        // Then
+        XCTAssertNil(archive.resolvedIndex(0))
+        XCTAssertNil(archive.image(group: 9000, image: 1))
+        XCTAssertNil(archive.image(group: 1, image: 1))
+    }
+
+    func testArchiveFollowsLinkedPalettes() throws {
+        // Given - Palette 1 has no colors of its own and links to palette 0
+        let data = makeSFFv2(
+            sprites: [TestSprite(group: 0, image: 0, pixels: [1, 1, 1, 1], linkedIndex: 0, paletteIndex: 1)],
+            palettes: [.colors(4), .linked(0)]
+        )
+
+        // When
+        let archive = try SFFArchive(reader: SFFReader(data: data))
+
+        // Then
+        let base = try XCTUnwrap(archive.palette(at: 0))
+        XCTAssertEqual(base.count, 1024)
+        XCTAssertEqual(archive.palette(at: 1), base)
+        XCTAssertNil(archive.palette(at: 5))
+        XCTAssertNotNil(archive.image(group: 0, image: 0))
+    }
+
+    func testArchiveDecodesIndexedSpriteForRecoloring() throws {
+        // Given - Sprite using palette 0; palette 1,1 links back to it
+        let data = makeSFFv2(
+            sprites: [TestSprite(group: 0, image: 0, pixels: [0, 1, 2, 3], linkedIndex: 0, paletteIndex: 0)],
+            palettes: [.colors(4), .linked(0)]
+        )
+        let archive = try SFFArchive(reader: SFFReader(data: data))
+
+        // When
+        let sprite = try XCTUnwrap(archive.indexedSprite(at: 0))
+
+        // Then - Raw indices are kept, and the default table matches palette 0
+        XCTAssertEqual(sprite.pixels, [0, 1, 2, 3])
+        XCTAssertEqual(sprite.width, 2)
+        XCTAssertFalse(sprite.usesPaletteAlpha)
+        XCTAssertEqual(archive.paletteIndex(group: 1, item: 1), 1)
+        XCTAssertNil(archive.paletteIndex(group: 1, item: 2))
+
+        let palette = try XCTUnwrap(archive.palette(at: 1))
+        XCTAssertEqual(sprite.table, SFFPaletteKernel.lookupTable(rgba: palette))
+    }
+
+    // MARK: - Portrait Tests
+
+    func testPNGPortraitIsDownsampledForThumbnails() throws {
+        // Given - A character that ships a 256x128 portrait.png
+        let folder = FileManager.default.temporaryDirectory.appendingPathComponent("portrait-\(UUID().uuidString)")
+        try FileManager.default.createDirectory(at: folder, withIntermediateDirectories: true)
+        defer { try? FileManager.default.removeItem(at: folder) }
+        let def = folder.appendingPathComponent("kfm.def")
+        try Data("[Info]\nname = \"KFM\"\n[Files]\ncmd = kfm.cmd\n".utf8).write(to: def)
+        let bitmap = try XCTUnwrap(NSBitmapImageRep(bitmapDataPlanes: nil, pixelsWide: 256, pixelsHigh: 128,
+                                                    bitsPerSample: 8, samplesPerPixel: 4, hasAlpha: true, isPlanar: false,
+                                                    colorSpaceName: .deviceRGB, bytesPerRow: 0, bitsPerPixel: 0))
+        try XCTUnwrap(bitmap.representation(using: .png, properties: [:]))
+            .write(to: folder.appendingPathComponent("portrait.png"))
+        let character = CharacterInfo(directory: folder, defFile: def)
+
+        // When
+        let thumbnail = try XCTUnwrap(character.getPortraitImage(maxPixelSize: 64))
+        let full = try XCTUnwrap(character.getPortraitImage())
+
+        // Then
+        let cgThumbnail = try XCTUnwrap(thumbnail.cgImage(forProposedRect: nil, context: nil, hints: nil))
+        XCTAssertEqual(cgThumbnail.width, 64)
+        XCTAssertEqual(cgThumbnail.height, 32)
+        XCTAssertEqual(full.size, NSSize(width: 256, height: 128))
+    }
+
+    // MARK: - Animation Stream Tests
+
+    func testAnimationStreamDecodesSharedSpritesOnce() throws {
+        // Given - 0,1 links to 0,0; the idle loop visits 0,0 / 0,1 / 0,2
+        let data = makeSFFv2(
+            sprites: [
+                TestSprite(group: 0, image: 0, pixels: [0, 1, 2, 3], linkedIndex: 0, paletteIndex: 0),
+                TestSprite(group: 0, image: 1, pixels: [], linkedIndex: 0, paletteIndex: 0),
+                TestSprite(group: 0, image: 2, pixels: [3, 2, 1, 0], linkedIndex: 0, paletteIndex: 0)
+            ],
+            palettes: [.colors(4)]
+        )
+        let frames = [(0, 0), (0, 1), (0, 2)].map { AIRFrame(group: $0.0, image: $0.1, x: 0, y: 0, duration: 5, flip: nil) }
+        let action = AIRAction(number: 0, frames: frames, loopStart: 1)
+        let stream = SFFAnimationStream(archive: try SFFArchive(reader: SFFReader(data: data)), action: action, capacity: 2)
+
+        // When
+        stream.prefetch()
+
+        // Then - The linked frame reuses the first sprite's slot
+        XCTAssertEqual(stream.cachedSpriteCount, 2)
+        XCTAssertNotNil(stream.image(at: 1))
+        XCTAssertEqual(stream.nextFrameIndex(after: 2), 1)
+
+        // Recoloring keeps the index buffers
+        stream.setPalette(SFFPaletteKernel.lookupTable(rgb: [UInt8](repeating: 90, count: 768)))
+        XCTAssertNotNil(stream.image(at: 0))
+        XCTAssertEqual(stream.cachedSpriteCount, 2)
+    }
+
+    func testAnimationStreamEvictsLeastRecentlyUsed() throws {
+        let data = makeSFFv2(
+            sprites: (0..<3).map { TestSprite(group: 0, image: UInt16($0), pixels: [1, 1, 1, 1], linkedIndex: 0, paletteIndex: 0) },
+            palettes: [.colors(4)]
+        )
+        let frames = (0..<3).map { AIRFrame(group: 0, image: $0, x: 0, y: 0, duration: 1, flip: nil) }
+        let stream = SFFAnimationStream(archive: try SFFArchive(reader: SFFReader(data: data)),
+                                        action: AIRAction(number: 0, frames: frames, loopStart: 0), capacity: 1)
+
+        for index in 0..<3 {
+            XCTAssertNotNil(stream.image(at: index))
+        }
+
+        XCTAssertEqual(stream.cachedSpriteCount, 1)
+    }
+
+    // MARK: - SFF Stats Tests
+
+    func testStatsScannerSummarizesNodeTables() throws {
+        // Given - A raw sprite, a linked portrait, and palette 1,1 linking to 1,0
+        let data = makeSFFv2(
+            sprites: [
+                TestSprite(group: 0, image: 0, pixels: [0, 1, 2, 3], linkedIndex: 0, paletteIndex: 0),
+                TestSprite(group: 9000, image: 0, pixels: [], linkedIndex: 0, paletteIndex: 0)
+            ],
+            palettes: [.colors(4), .linked(0)]
+        )
+
+        // When
+        let stats = try XCTUnwrap(SFFStatsScanner.shared.scan(SFFReader(data: data)))
+
+        // Then - Linked sprites count once and contribute no decoded pixels
+        XCTAssertEqual(stats.version, 2)
+        XCTAssertEqual(stats.spriteCount, 2)
+        XCTAssertEqual(stats.linkedSpriteCount, 1)
+        XCTAssertEqual(stats.paletteCount, 2)
+        XCTAssertEqual(stats.characterPaletteCount, 1)
+        XCTAssertEqual(stats.formatCounts, ["raw": 1])
+        XCTAssertEqual(stats.maxSpriteWidth, 2)
+        XCTAssertEqual(stats.maxSpriteHeight, 2)
+        XCTAssertEqual(stats.portraitWidth, 2)
+        XCTAssertEqual(stats.portraitHeight, 2)
+        XCTAssertEqual(stats.decodedPixelCount, 4)
+        XCTAssertEqual(stats.decodedRGBABytes, 16)
+    }
+
+    func testStatsRecordRoundTrip() {
+        let stats = SFFStats(version: 1, spriteCount: 10, linkedSpriteCount: 2, paletteCount: 3,
+                             characterPaletteCount: 0, formatCounts: ["pcx": 8], maxSpriteWidth: 320,
+                             maxSpriteHeight: 240, portraitWidth: nil, portraitHeight: nil,
+                             decodedPixelCount: 12_345)
+
+        let record = SFFStatsRecord(path: "/tmp/kfm.sff", characterId: "kfm", fileSize: 100, modifiedAt: 1, stats: stats)
+
+        XCTAssertEqual(record.stats, stats)
+    }
+
+    // MARK: - Test SFF Builder
+
+    private struct TestSprite {
+        let group: UInt16
+        let image: UInt16
+        /// Raw 8-bit indices for a 2x2 sprite; empty for a linked node
+        let pixels: [UInt8]
+        let linkedIndex: UInt16
+        let paletteIndex: UInt16
+    }
+
+    private enum TestPalette {
+        case colors(Int)
+        case linked(UInt16)
+    }
+
+    /// Build a minimal SFFv2 file with raw (format 0) 2x2 sprites
+    private func makeSFFv2(sprites: [TestSprite], palettes: [TestPalette]) -> Data {
+        let spriteListOffset = 68
+        let paletteListOffset = spriteListOffset + sprites.count * 28
+        let ldataOffset = paletteListOffset + palettes.count * 16
+
+        // ldata: palette colors first, then sprite payloads
+        var ldata = Data()
+        var paletteNodes = Data()
+        for palette in palettes {
+            switch palette {
+            case .colors(let count):
+                paletteNodes.appendLE16(1, 0, UInt16(count), 0)
+                paletteNodes.appendLE32(ldata.count, count * 4)
+                for i in 0..<count {
+                    ldata.append(contentsOf: [UInt8(i * 40), UInt8(i * 20), UInt8(i * 10), 255])
+                }
+            case .linked(let target):
+                paletteNodes.appendLE16(1, 1, 0, target)
+                paletteNodes.appendLE32(0, 0)
+            }
+        }
+
+        var spriteNodes = Data()
+        for sprite in sprites {
+            spriteNodes.appendLE16(sprite.group, sprite.image, 2, 2, 0, 0, sprite.linkedIndex)
+            spriteNodes.append(contentsOf: [0, 8])  // format 0 (raw), 8-bit
+            spriteNodes.appendLE32(sprite.pixels.isEmpty ? 0 : ldata.count, sprite.pixels.count)
+            spriteNodes.appendLE16(sprite.paletteIndex, 0)
+            ldata.append(contentsOf: sprite.pixels)
+        }
+
+        var data = Data("ElecbyteSpr\0".utf8)
+        data.append(contentsOf: [0x00, 0x01, 0x00, 0x02])
+        data.append(Data(count: 20))
+        data.appendLE32(spriteListOffset, sprites.count, paletteListOffset, palettes.count)
+        data.appendLE32(ldataOffset, ldata.count, ldataOffset + ldata.count, 0)
+        data.append(spriteNodes)
+        data.append(paletteNodes)
+        data.append(ldata)
+        return data
+    }
+
     // MARK: - Helper Methods for Error Matching
     
     private func isInvalidSignatureError(_ error: SFFError) -> Bool {
@@ -150,3 +580,22 @@ final class SFFParserTests: XCTestCase {
         return false
     }
 }
+
+// MARK: - Little Endian Test Helpers
+
+private extension Data {
+    mutating func appendLE16(_ values: UInt16...) {
+        for value in values {
+            append(UInt8(value & 0xFF))
+            append(UInt8(value >> 8))
+        }
+    }
+
+    mutating func appendLE32(_ values: Int...) {
+        for value in values {
+            for shift in stride(from: 0, to: 32, by: 8) {
+                append(UInt8((value >> shift) & 0xFF))
+            }
+        }
+    }
+}
@@ -0,0 +1,57 @@
+import XCTest
+@testable import IKEMEN_Lab
+
+/// Correctness tests and throughput benchmarks for the SFFv2 RLE8 / RLE5 / LZ5 decoders
+final class SFFSpriteDecoderTests: XCTestCase {
+
+    // MARK: - Corpus Correctness
+
+    func testRLE8DecodesCorpus() {
+        for sprite in SFFDecoderCorpus.standard(.rle8) {
+            let pixels = SFFSpriteDecoder.decodeRLE8(sprite.encoded, width: sprite.width, height: sprite.height)
+            XCTAssertEqual(pixels, sprite.expected, sprite.name)
+        }
+    }
+
+    func testRLE5DecodesCorpus() {
+        for sprite in SFFDecoderCorpus.standard(.rle5) {
+            let pixels = SFFSpriteDecoder.decodeRLE5(sprite.encoded, width: sprite.width, height: sprite.height)
+            XCTAssertEqual(pixels, sprite.expected, sprite.name)
+        }
+    }
+
+    func testLZ5DecodesCorpus() {
+        for sprite in SFFDecoderCorpus.standard(.lz5) {
+            let pixels = SFFSpriteDecoder.decodeLZ5(sprite.encoded, width: sprite.width, height: sprite.height)
+            XCTAssertEqual(pixels, sprite.expected, sprite.name)
+        }
+    }
+
+    // MARK: - Edge Cases
+
+    func testLZ5OverlappingBackReference() {
+        // Given - Short run of 3 x color 5, then a 10-byte short back-reference at distance 2
+        // ct = 0b10 (second token is a copy)
+        let data = Data([0x02, 0x65, 0x09, 0x01])
+
+        // When
+        let pixels = SFFSpriteDecoder.decodeLZ5(data, width: 13, height: 1)
+
+        // Then - Period-2 pattern continues from the last two pixels
+        XCTAssertEqual(pixels, [UInt8](repeating: 5, count: 13))
+    }
+
+    func testTruncatedInputRepeatsLastByte() {
+        // Given - RLE8 stream cut off after a literal; IKEMEN-GO keeps re-reading the last byte
+        let pixels = SFFSpriteDecoder.decodeRLE8(Data([0x43, 0x07, 0x09]), width: 6, height: 1)
+
+        XCTAssertEqual(pixels, [7, 7, 7, 9, 9, 9])
+    }
+
+    func testDegenerateInputTerminates() {
+        // A zero-length RLE8 marker and a backwards LZ5 reference at the end of input must not hang
+        XCTAssertEqual(SFFSpriteDecoder.decodeRLE8(Data([0x40]), width: 4, height: 4), [UInt8](repeating: 0, count: 16))
+        XCTAssertEqual(SFFSpriteDecoder.decodeLZ5(Data([0xFF, 0x01]), width: 4, height: 4).count, 16)
+        XCTAssertEqual(SFFSpriteDecoder.decodeRLE5(Data(), width: 4, height: 4), [])
+    }
+}
@@ -0,0 +1,166 @@
+import XCTest
+@testable import IKEMEN_Lab
+
+/// Round-trip tests and size/speed benchmarks for the SFFv2 RLE8 / LZ5 encoders
+final class SFFSpriteEncoderTests: XCTestCase {
+
+    var workingDir: URL!
+
+    override func setUp() {
+        super.setUp()
+        workingDir = FileManager.default.temporaryDirectory
+            .appendingPathComponent("SFFSpriteEncoderTests-\(UUID().uuidString)")
+        try? FileManager.default.createDirectory(at: workingDir, withIntermediateDirectories: true)
+    }
+
+    override func tearDown() {
+        try? FileManager.default.removeItem(at: workingDir)
+        workingDir = nil
+        super.tearDown()
+    }
+
+    // MARK: - Corpus Round Trips
+
+    func testRLE8RoundTripsCorpus() {
+        for sprite in SFFDecoderCorpus.standard(.rle8) {
+            let encoded = SFFSpriteEncoder.encodeRLE8(sprite.expected)
+            let decoded = SFFSpriteDecoder.decodeRLE8(encoded, width: sprite.width, height: sprite.height)
+            XCTAssertEqual(decoded, sprite.expected, sprite.name)
+        }
+    }
+
+    func testLZ5RoundTripsCorpus() throws {
+        for sprite in SFFDecoderCorpus.standard(.lz5) {
+            let encoded = try XCTUnwrap(SFFSpriteEncoder.encodeLZ5(sprite.expected), sprite.name)
+            let decoded = SFFSpriteDecoder.decodeLZ5(encoded, width: sprite.width, height: sprite.height)
+            XCTAssertEqual(decoded, sprite.expected, sprite.name)
+            XCTAssertLessThan(encoded.count, sprite.expected.count, sprite.name)
+        }
+    }
+
+    func testLZ5RoundTripsTiledSprite() throws {
+        // Given - A repeating 16x16 tile with sparse noise: mostly short back-references,
+        // so the recycled-bit offsets of every fourth short copy are exercised many times
+        let pixels = makeTiledSprite(width: 256, height: 64, seed: 7)
+
+        // When
+        let encoded = try XCTUnwrap(SFFSpriteEncoder.encodeLZ5(pixels))
+
+        // Then
+        XCTAssertEqual(SFFSpriteDecoder.decodeLZ5(encoded, width: 256, height: 64), pixels)
+    }
+
+    // MARK: - Edge Cases
+
+    func testRLE8EscapesMarkerRangeLiterals() {
+        // Single pixels in 0x40-0x7F would read as markers and need a run of one
+        let pixels: [UInt8] = [0x3F, 0x40, 0x7F, 0x80, 0x00]
+
+        let encoded = SFFSpriteEncoder.encodeRLE8(pixels)
+
+        XCTAssertEqual(encoded, Data([0x3F, 0x41, 0x40, 0x41, 0x7F, 0x80, 0x00]))
+        XCTAssertEqual(SFFSpriteDecoder.decodeRLE8(encoded, width: 5, height: 1), pixels)
+    }
+
+    func testRunsLongerThanOneToken() throws {
+        // Given - Runs past RLE8's 63-pixel and LZ5's 263-pixel token limits
+        let pixels = [UInt8](repeating: 9, count: 1000) + [UInt8](repeating: 3, count: 7) + [1]
+
+        // Then
+        let rle8 = SFFSpriteEncoder.encodeRLE8(pixels)
+        XCTAssertEqual(SFFSpriteDecoder.decodeRLE8(rle8, width: pixels.count, height: 1), pixels)
+
+        let lz5 = try XCTUnwrap(SFFSpriteEncoder.encodeLZ5(pixels))
+        XCTAssertEqual(SFFSpriteDecoder.decodeLZ5(lz5, width: pixels.count, height: 1), pixels)
+        XCTAssertLessThan(lz5.count, 16)
+    }
+
+    func testLZ5RejectsIndicesAboveThirtyOne() {
+        XCTAssertNil(SFFSpriteEncoder.encodeLZ5([0, 31, 32]))
+        XCTAssertEqual(SFFSpriteEncoder.encode([0, 31, 32], as: .lz5).format, .raw)
+    }
+
+    func testSmallestEncodingPicksFormat() {
+        // Flat sprite: LZ5's 2-byte long runs beat RLE8's 63-pixel runs
+        let flat = [UInt8](repeating: 4, count: 64 * 64)
+        XCTAssertEqual(SFFSpriteEncoder.encode(flat, as: .smallest).format, .lz5)
+
+        // Runs of high indices: LZ5 can't store them, RLE8 can
+        let banded = (0..<64).flatMap { [UInt8](repeating: UInt8(128 + $0), count: 64) }
+        XCTAssertEqual(SFFSpriteEncoder.encode(banded, as: .smallest).format, .rle8)
+
+        // Noise: nothing beats raw
+        var rng = SplitMix64(seed: 11)
+        let noise = (0..<4096).map { _ in UInt8(truncatingIfNeeded: rng.next()) }
+        XCTAssertEqual(SFFSpriteEncoder.encode(noise, as: .smallest).format, .raw)
+    }
+
+    // MARK: - Writer Round Trip
+
+    func testWriterRoundTripsIndexedSpritesThroughArchive() throws {
+        // Given - The same tiled sprite stored in each indexed format
+        let pixels = makeTiledSprite(width: 64, height: 32, seed: 3)
+        let palette = (0..<32).flatMap { [UInt8($0 * 8), UInt8(255 - $0 * 8), 0, 255] }
+        let encodings: [SFFWriter.Encoding] = [.raw, .rle8, .lz5, .smallest]
+        let sprites = encodings.enumerated().map { index, encoding in
+            SFFWriter.SpriteEntry(group: 0, image: UInt16(index), indexedPixels: pixels, palette: palette,
+                                  width: 64, height: 32, encoding: encoding)
+        }
+        let url = workingDir.appendingPathComponent("indexed.sff")
+
+        // When
+        guard case .success = SFFWriter.write(sprites: sprites, to: url) else {
+            return XCTFail("write failed")
+        }
+        let archive = try SFFArchive(url: url)
+
+        // Then - One palette node, identical pixels from every format
+        XCTAssertEqual(archive.directory.entries.map { $0.format }, [0, 2, 4, 4])
+        XCTAssertEqual(archive.directory.entries[3].linkedIndex, 2)
+        XCTAssertEqual(archive.directory.paletteCount, 1)
+        XCTAssertEqual(archive.palette(at: 0).map { Array($0.prefix(8)) }, Array(palette.prefix(8)))
+
+        for index in 0..<encodings.count {
+            let sprite = try XCTUnwrap(archive.indexedSprite(at: index))
+            XCTAssertEqual(sprite.pixels, pixels, "\(encodings[index])")
+        }
+        XCTAssertNotNil(archive.image(at: 1))
+    }
+
+    func testWriterRejectsUnregisteredPalette() throws {
+        let url = workingDir.appendingPathComponent("unregistered.sff")
+        let writer = try SFFStreamWriter(url: url, spriteCapacity: 1, palettes: [[0, 0, 0, 0]])
+        let sprite = SFFWriter.SpriteEntry(group: 0, image: 0, indexedPixels: [1], palette: [0, 0, 0, 0, 9, 9, 9, 255],
+                                           width: 1, height: 1)
+
+        XCTAssertThrowsError(try writer.append(sprite))
+    }
+
+    // MARK: - Compression
+
+    func testLZ5IsNoLargerThanRLE8OnCorpus() throws {
+        for sprite in SFFDecoderCorpus.standard(.lz5) {
+            let rle8 = SFFSpriteEncoder.encodeRLE8(sprite.expected)
+            let lz5 = try XCTUnwrap(SFFSpriteEncoder.encodeLZ5(sprite.expected))
+            XCTAssertLessThanOrEqual(lz5.count, rle8.count, sprite.name)
+        }
+    }
+
+    // MARK: - Helpers
+
+    /// 5-bit sprite made of one random 16x16 tile repeated, with about 1 in 50 pixels replaced
+    private func makeTiledSprite(width: Int, height: Int, seed: UInt64) -> [UInt8] {
+        var rng = SplitMix64(seed: seed)
+        let tile = (0..<256).map { _ in UInt8(rng.next(in: 0...31)) }
+
+        var pixels = [UInt8](repeating: 0, count: width * height)
+        for y in 0..<height {
+            for x in 0..<width {
+                pixels[y * width + x] = rng.next(in: 0...49) == 0
+                    ? UInt8(rng.next(in: 0...31))
+                    : tile[(y % 16) * 16 + x % 16]
+            }
+        }
+        return pixels
+    }
+}
@@ -0,0 +1,231 @@
+import XCTest
+@testable import IKEMEN_Lab
+
+/// Tests for in-place SFF transcoding: re-encoding, verification and the atomic swap
+final class SFFTranscoderTests: XCTestCase {
+
+    var workingDir: URL!
+
+    override func setUp() {
+        super.setUp()
+        workingDir = FileManager.default.temporaryDirectory
+            .appendingPathComponent("SFFTranscoderTests-\(UUID().uuidString)")
+        try? FileManager.default.createDirectory(at: workingDir, withIntermediateDirectories: true)
+    }
+
+    override func tearDown() {
+        try? FileManager.default.removeItem(at: workingDir)
+        workingDir = nil
+        super.tearDown()
+    }
+
+    // MARK: - Transcoding
+
+    func testRawSpritesAreRecompressedLosslessly() throws {
+        // Given - Two raw 8-bit sprites, a linked sprite and a linked palette
+        let url = try writeRawSFF(name: "raw.sff", pixels: [bands(seed: 1), bands(seed: 2)])
+        let before = try SFFArchive(reader: SFFReader(data: Data(contentsOf: url)))
+        let originalPixels = (0..<3).map { before.indexedSprite(at: $0)?.pixels }
+
+        // When
+        let result = SFFTranscoder.transcodeFile(at: url, characterId: "kfm")
+
+        // Then - Smaller file, same sprites, links and palette table
+        XCTAssertEqual(result.status, .transcoded, result.detail ?? "")
+        XCTAssertLessThan(result.transcodedBytes, result.originalBytes)
+        XCTAssertGreaterThan(result.savedBytes, 0)
+
+        let after = try SFFArchive(reader: SFFReader(data: Data(contentsOf: url)))
+        XCTAssertEqual(after.directory.entries.map { $0.format }, [4, 4, 0])
+        XCTAssertTrue(after.directory.entries[2].isLinked)
+        XCTAssertEqual(after.directory.entries[2].linkedIndex, 0)
+        XCTAssertEqual((0..<3).map { after.indexedSprite(at: $0)?.pixels }, originalPixels)
+        XCTAssertEqual(after.paletteIndex(group: 1, item: 2), 1)
+        XCTAssertEqual(after.palette(at: 1), before.palette(at: 0))
+        XCTAssertNil(SFFTranscoder.verify(original: before, transcoded: after))
+
+        // No temporary file or backup left behind
+        let leftovers = try FileManager.default.contentsOfDirectory(atPath: workingDir.path)
+        XCTAssertEqual(leftovers, ["raw.sff"])
+    }
+
+    func testCompactFileIsLeftUntouched() throws {
+        // Given - A file that was already transcoded
+        let url = try writeRawSFF(name: "twice.sff", pixels: [bands(seed: 3)])
+        XCTAssertEqual(SFFTranscoder.transcodeFile(at: url).status, .transcoded)
+        let bytes = try Data(contentsOf: url)
+
+        // When
+        let second = SFFTranscoder.transcodeFile(at: url)
+
+        // Then
+        XCTAssertEqual(second.status, .alreadyCompact)
+        XCTAssertEqual(second.savedBytes, 0)
+        XCTAssertEqual(try Data(contentsOf: url), bytes)
+    }
+
+    func testBackupIsKeptWhenRequested() throws {
+        let url = try writeRawSFF(name: "keep.sff", pixels: [bands(seed: 4)])
+        let original = try Data(contentsOf: url)
+
+        XCTAssertEqual(SFFTranscoder.transcodeFile(at: url, keepBackup: true).status, .transcoded)
+
+        let backup = workingDir.appendingPathComponent("keep.sff.bak")
+        XCTAssertEqual(try Data(contentsOf: backup), original)
+    }
+
+    func testStaleTemporaryOutputIsDiscarded() throws {
+        // Given - Garbage left by an interrupted run
+        let url = try writeRawSFF(name: "stale.sff", pixels: [bands(seed: 5)])
+        let temp = url.appendingPathExtension(SFFTranscoder.temporaryExtension)
+        try Data("partial".utf8).write(to: temp)
+
+        // When
+        let result = SFFTranscoder.transcodeFile(at: url)
+
+        // Then
+        XCTAssertEqual(result.status, .transcoded)
+        XCTAssertFalse(FileManager.default.fileExists(atPath: temp.path))
+    }
+
+    func testUnreadableFileFailsWithoutTouchingIt() throws {
+        let url = workingDir.appendingPathComponent("broken.sff")
+        try Data("not an sff file at all, just text padding".utf8).write(to: url)
+
+        let result = SFFTranscoder.transcodeFile(at: url)
+
+        XCTAssertEqual(result.status, .failed)
+        XCTAssertEqual(try String(contentsOf: url), "not an sff file at all, just text padding")
+    }
+
+    func testVersion200HeaderIsPreserved() throws {
+        // Given - A v2.00 file with a nonzero compatibility field
+        let header = SFFStreamWriter.VersionHeader(bytes: [0, 0, 0, 2] + [UInt8](repeating: 0, count: 16) + [0, 0, 0, 1])
+        let url = try writeRawSFF(name: "v200.sff", pixels: [bands(seed: 7)], versionHeader: header)
+
+        // When
+        let result = SFFTranscoder.transcodeFile(at: url)
+
+        // Then
+        XCTAssertEqual(result.status, .transcoded, result.detail ?? "")
+        let bytes = try Data(contentsOf: url)
+        XCTAssertEqual([UInt8](bytes[12..<36]), header.bytes)
+    }
+
+    // MARK: - Verification
+
+    func testVerificationCatchesPixelDifferences() throws {
+        var changed = bands(seed: 6)
+        changed[100] ^= 1
+        let a = try SFFArchive(url: writeRawSFF(name: "a.sff", pixels: [bands(seed: 6)]))
+        let b = try SFFArchive(url: writeRawSFF(name: "b.sff", pixels: [changed]))
+
+        XCTAssertNotNil(SFFTranscoder.verify(original: a, transcoded: b))
+    }
+
+    func testVerificationRejectsVersionMismatch() throws {
+        let v200 = SFFStreamWriter.VersionHeader(bytes: [0, 0, 0, 2] + [UInt8](repeating: 0, count: 20))
+        let a = try SFFArchive(url: writeRawSFF(name: "a.sff", pixels: [bands(seed: 8)], versionHeader: v200))
+        let b = try SFFArchive(url: writeRawSFF(name: "b.sff", pixels: [bands(seed: 8)]))
+
+        XCTAssertEqual(SFFTranscoder.verify(original: a, transcoded: b), "version 2.0.0.0 != 2.0.1.0")
+    }
+
+    // MARK: - Library Job
+
+    func testCancelledLibraryRunResumesWithoutRedoingFiles() throws {
+        // Given - Four characters with one compressible sprite file each
+        try MetadataStore.shared.initialize(workingDir: workingDir)
+        defer { MetadataStore.shared.close() }
+        let characters = try (0..<4).map { index -> CharacterInfo in
+            let folder = workingDir.appendingPathComponent("char\(index)")
+            try FileManager.default.createDirectory(at: folder, withIntermediateDirectories: true)
+            _ = try writeRawSFF(name: "char\(index)/char\(index).sff", pixels: [bands(seed: index)])
+            return CharacterInfo(directory: folder, defFile: folder.appendingPathComponent("char\(index).def"))
+        }
+        var options = SFFTranscoder.Options()
+        options.maxConcurrentFiles = 1
+
+        // When - Cancelled from the worker once two files are done, then run again
+        var firstRun: [String] = []
+        let first = try XCTUnwrap(runLibraryJob(characters, options: options) { result in
+            firstRun.append(result.path)
+            if firstRun.count == 2 {
+                SFFTranscoder.shared.cancel()
+            }
+        })
+        var secondRun: [String] = []
+        let second = try XCTUnwrap(runLibraryJob(characters, options: options) { secondRun.append($0.path) })
+
+        // Then - The second run only touches the files the first one never reached
+        XCTAssertTrue(first.wasCancelled)
+        XCTAssertEqual(first.results.count, 2)
+        XCTAssertFalse(second.wasCancelled)
+        XCTAssertEqual(secondRun.count, 2)
+        XCTAssertTrue(Set(secondRun).isDisjoint(with: firstRun))
+        XCTAssertEqual(second.results.count, 4)
+        XCTAssertTrue(second.results.allSatisfy { $0.status == .transcoded })
+    }
+
+    // MARK: - Report
+
+    func testReportGroupsSavingsByCharacter() {
+        let report = SFFTranscodeReport(results: [
+            SFFTranscodeResult(path: "/a/a.sff", characterId: "a", status: .transcoded,
+                               originalBytes: 1000, transcodedBytes: 400, detail: nil),
+            SFFTranscodeResult(path: "/a/a2.sff", characterId: "a", status: .alreadyCompact,
+                               originalBytes: 50, transcodedBytes: 50, detail: nil),
+            SFFTranscodeResult(path: "/b/b.sff", characterId: "b", status: .transcoded,
+                               originalBytes: 2000, transcodedBytes: 100, detail: nil),
+            SFFTranscodeResult(path: "/c/c.sff", characterId: "c", status: .failed,
+                               originalBytes: 10, transcodedBytes: 10, detail: "bad")
+        ], wasCancelled: false)
+
+        XCTAssertEqual(report.totalSavedBytes, 2500)
+        XCTAssertEqual(report.characters.map { $0.characterId }, ["b", "a", "c"])
+        XCTAssertEqual(report.characters[1].files, 2)
+        XCTAssertEqual(report.characters[1].savedBytes, 600)
+        XCTAssertEqual(report.failures.count, 1)
+    }
+
+    // MARK: - Helpers
+
+    /// Run a library job and wait for its report
+    private func runLibraryJob(_ characters: [CharacterInfo], options: SFFTranscoder.Options,
+                               fileFinished: @escaping (SFFTranscodeResult) -> Void) -> SFFTranscodeReport? {
+        let finished = expectation(description: "library job finished")
+        var report: SFFTranscodeReport?
+        SFFTranscoder.shared.transcodeLibrary(characters, options: options, fileFinished: fileFinished) {
+            report = $0
+            finished.fulfill()
+        }
+        wait(for: [finished], timeout: 10)
+        return report
+    }
+
+    /// 64x64 sprite of horizontal color bands
+    private func bands(seed: Int) -> [UInt8] {
+        return (0..<64 * 64).map { UInt8((($0 / 64) / 8 + seed) % 16) }
+    }
+
+    /// Write an SFFv2 file of raw 8-bit sprites plus a link to the first sprite
+    /// Palette 1,1 has colors; palette 1,2 is linked to it.
+    private func writeRawSFF(name: String, pixels sprites: [[UInt8]],
+                             versionHeader: SFFStreamWriter.VersionHeader = .v201) throws -> URL {
+        let url = workingDir.appendingPathComponent(name)
+        let colors = (0..<16).flatMap { [UInt8($0 * 16), 0, UInt8(255 - $0 * 16), 255] }
+        let writer = try SFFStreamWriter(url: url, spriteCapacity: sprites.count + 1, paletteNodes: [
+            SFFStreamWriter.PaletteNode(group: 1, item: 1, colorCount: 16, linkedIndex: 0, colors: colors),
+            SFFStreamWriter.PaletteNode(group: 1, item: 2, colorCount: 16, linkedIndex: 0, colors: [])
+        ], versionHeader: versionHeader)
+
+        for (index, pixels) in sprites.enumerated() {
+            try writer.append(group: 0, image: UInt16(index), x: 10, y: -5, width: 64, height: 64,
+                              format: 0, colorDepth: 8, paletteIndex: 0, payload: Data(pixels))
+        }
+        try writer.appendLink(group: 5, image: 0, x: 0, y: 0, width: 64, height: 64,
+                              format: 0, colorDepth: 8, paletteIndex: 0, linkedIndex: 0)
+        try writer.finish()
+        return url
+    }
+}
@@ -0,0 +1,453 @@
+import Foundation
+import AppKit
+@testable import IKEMEN_Lab
+
+/// Builds deterministic synthetic IKEMEN GO trees for benchmarks
+///
+/// Characters get a DEF, CNS, CMD and AIR from text templates and a sprite file with
+/// 9000,0/9000,1 portraits plus filler sprites. SFF v2 files are written with SFFWriter (raw,
+/// RLE8, LZ5 or PNG sprites); SFF v1 files get PCX sprites. Versions, sprite encodings and DEF
+/// text encodings are cycled through per character, so any mix can be reproduced from the
+/// configuration alone. Stages are top-level DEFs with a background SFF, and data/select.def
+/// lists a configurable share of the characters.
+struct SyntheticLibrary {
+
+    /// How DEF text is stored on disk
+    enum TextEncoding: String, CaseIterable {
+        case utf8
+        case utf8BOM
+        case windows1252
+        case shiftJIS
+    }
+
+    struct Configuration {
+        var characterCount = 100
+        var stageCount = 20
+        /// SFF versions (1 or 2), cycled per character
+        var sffVersions: [Int] = [2, 2, 2, 1]
+        /// Encodings for v2 character sprites, cycled per character
+        var spriteEncodings: [SFFWriter.Encoding] = [.rle8, .lz5, .raw, .png]
+        /// DEF text encodings, cycled per character
+        var textEncodings: [TextEncoding] = TextEncoding.allCases
+        /// Filler sprites per character, on top of the two portraits
+        var spritesPerCharacter = 6
+        /// Share of characters listed in select.def (0...1)
+        var selectDefFraction = 1.0
+        /// Every nth character folder also holds an intro storyboard DEF (0 = none)
+        var storyboardInterval = 5
+        var seed: UInt64 = 1
+    }
+
+    let root: URL
+    let configuration: Configuration
+
+    var charsDirectory: URL { root.appendingPathComponent("chars") }
+    var stagesDirectory: URL { root.appendingPathComponent("stages") }
+
+    // MARK: - Generation
+
+    /// Write a complete tree (chars/, stages/, data/) under `root`
+    @discardableResult
+    static func generate(at root: URL, configuration: Configuration = Configuration()) throws -> SyntheticLibrary {
+        let library = SyntheticLibrary(root: root, configuration: configuration)
+        let fileManager = FileManager.default
+        for folder in ["chars", "stages", "data"] {
+            try fileManager.createDirectory(at: root.appendingPathComponent(folder), withIntermediateDirectories: true)
+        }
+
+        // Characters are independent, so write them in parallel
+        var firstError: Error?
+        let lock = NSLock()
+        DispatchQueue.concurrentPerform(iterations: configuration.characterCount) { index in
+            do {
+                try library.writeCharacter(index)
+            } catch {
+                lock.lock()
+                firstError = firstError ?? error
+                lock.unlock()
+            }
+        }
+        if let error = firstError {
+            throw error
+        }
+
+        for index in 0..<configuration.stageCount {
+            try library.writeStage(index)
+        }
+        try library.writeSelectDef()
+        try Data("[Info]\nname = \"Synthetic\"\n".utf8).write(to: root.appendingPathComponent("data/system.def"))
+
+        return library
+    }
+
+    static func characterName(_ index: Int) -> String {
+        return String(format: "char%05d", index)
+    }
+
+    static func stageName(_ index: Int) -> String {
+        return String(format: "stage%04d", index)
+    }
+
+    // MARK: - Characters
+
+    private func writeCharacter(_ index: Int) throws {
+        let name = SyntheticLibrary.characterName(index)
+        let folder = charsDirectory.appendingPathComponent(name)
+        try FileManager.default.createDirectory(at: folder, withIntermediateDirectories: true)
+
+        let textEncoding = configuration.textEncodings[index % max(1, configuration.textEncodings.count)]
+        try write(characterDef(name: name, index: index, encoding: textEncoding),
+                  to: folder.appendingPathComponent("\(name).def"), encoding: textEncoding)
+        try write(characterCNS(index: index), to: folder.appendingPathComponent("\(name).cns"), encoding: .utf8)
+        try write(characterCMD(index: index), to: folder.appendingPathComponent("\(name).cmd"), encoding: .utf8)
+        try write(characterAIR(), to: folder.appendingPathComponent("\(name).air"), encoding: .utf8)
+
+        if configuration.storyboardInterval > 0 && index % configuration.storyboardInterval == 0 {
+            try write("[SceneDef]\nspr = \(name).sff\n\n[Scene 0]\nend.time = 60\n",
+                      to: folder.appendingPathComponent("intro.def"), encoding: .utf8)
+        }
+
+        var rng = SplitMix64(seed: configuration.seed &+ UInt64(index))
+        let sprites = characterSprites(count: configuration.spritesPerCharacter, rng: &rng)
+        let sffFile = folder.appendingPathComponent("\(name).sff")
+        let version = configuration.sffVersions[index % max(1, configuration.sffVersions.count)]
+
+        if version == 1 {
+            try SyntheticLibrary.writeSFFv1(sprites, to: sffFile)
+        } else {
+            let encoding = configuration.spriteEncodings[index % max(1, configuration.spriteEncodings.count)]
+            try SyntheticLibrary.writeSFFv2(sprites, encoding: encoding, to: sffFile)
+        }
+    }
+
+    private func characterDef(name: String, index: Int, encoding: TextEncoding) -> String {
+        // A display name only the given encoding can represent, so decoding is exercised
+        let displayName: String
+        switch encoding {
+        case .utf8, .utf8BOM: displayName = "Fighter \(index) ★"
+        case .windows1252: displayName = "Fighter \(index) Café"
+        case .shiftJIS: displayName = "ファイター\(index)"
+        }
+
+        return """
+        ; Synthetic character \(index)
+        [Info]
+        name = "\(name)"
+        displayname = "\(displayName)"
+        versiondate = 01,01,2024
+        mugenversion = 1.1
+        author = "Synthetic Author \(index % 17)"
+        pal.defaults = 1
+
+        [Files]
+        cmd = \(name).cmd
+        cns = \(name).cns
+        st = \(name).cns
+        stcommon = common1.cns
+        sprite = \(name).sff
+        anim = \(name).air
+
+        """
+    }
+
+    private func characterCNS(index: Int) -> String {
+        var text = """
+        [Data]
+        life = \(800 + index % 5 * 100)
+        attack = \(90 + index % 20)
+        defence = \(90 + index % 15)
+        power = 3000
+        airjuggle = 15
+        fall.defence_up = 50
+
+        [Size]
+        xscale = 1
+        yscale = 1
+
+        [Velocity]
+        walk.fwd = 2.4
+        walk.back = -2.2
+
+        """
+        for state in [200, 210, 1000, 1100, 3000] {
+            text += """
+
+            [Statedef \(state)]
+            type = S
+            movetype = A
+            physics = S
+            anim = \(state)
+
+            [State \(state), End]
+            type = ChangeState
+            trigger1 = AnimTime = 0
+            value = 0
+
+            """
+        }
+        return text
+    }
+
+    private func characterCMD(index: Int) -> String {
+        var text = "[Remap]\nx = x\ny = y\n\n[Defaults]\ncommand.time = 15\ncommand.buffer.time = 1\n"
+        let commands = [("QCF_x", "~D, DF, F, x"), ("QCF_y", "~D, DF, F, y"),
+                        ("DP_x", "~F, D, DF, x"), ("Super", "~D, DF, F, D, DF, F, x")]
+        for (name, command) in commands {
+            text += "\n[Command]\nname = \"\(name)\"\ncommand = \(command)\ntime = 20\n"
+        }
+        text += "\n[Statedef -1]\n\n[State -1, Super]\ntype = ChangeState\nvalue = 3000\ntriggerall = command = \"Super\"\ntrigger1 = power >= 1000\n"
+        return text
+    }
+
+    private func characterAIR() -> String {
+        var text = ""
+        for action in [0, 200, 210, 1000, 1100, 3000] {
+            text += "\n[Begin Action \(action)]\n"
+            for frame in 0..<4 {
+                text += "0,\(frame), 0,0, 5\n"
+            }
+        }
+        return text
+    }
+
+    // MARK: - Stages
+
+    private func writeStage(_ index: Int) throws {
+        let name = SyntheticLibrary.stageName(index)
+        let def = """
+        [Info]
+        name = "Synthetic Stage \(index)"
+        author = "Synthetic Author \(index % 7)"
+
+        [Camera]
+        boundleft = -\(150 + index % 4 * 50)
+        boundright = \(150 + index % 4 * 50)
+
+        [StageInfo]
+        zoffset = 200
+
+        [BGdef]
+        spr = \(name).sff
+
+        [BG Back]
+        type = normal
+        spriteno = 0,0
+        start = 0,0
+
+        """
+        try write(def, to: stagesDirectory.appendingPathComponent("\(name).def"), encoding: .utf8)
+
+        var rng = SplitMix64(seed: configuration.seed &+ 0x5747 &+ UInt64(index))
+        let background = Sprite(group: 0, image: 0, width: 320, height: 240,
+                                pixels: SyntheticLibrary.pixels(width: 320, height: 240, rng: &rng))
+        try SyntheticLibrary.writeSFFv2([background], encoding: .rle8, to: stagesDirectory.appendingPathComponent("\(name).sff"))
+    }
+
+    // MARK: - select.def
+
+    private func writeSelectDef() throws {
+        let listed = Int((Double(configuration.characterCount) * min(max(configuration.selectDefFraction, 0), 1)).rounded())
+        var text = "; Synthetic select.def\n[Characters]\n"
+        for index in 0..<listed {
+            let name = SyntheticLibrary.characterName(index)
+            text += "\(name)/\(name).def, random\n"
+        }
+        text += "\n[ExtraStages]\n"
+        for index in 0..<configuration.stageCount {
+            text += "stages/\(SyntheticLibrary.stageName(index)).def\n"
+        }
+        text += "\n[Options]\narcade.maxmatches = 6,1,1,0,0,0,0,0,0,0\nteam.maxmatches = 4,1,1,0,0,0,0,0,0,0\n"
+        try write(text, to: root.appendingPathComponent("data/select.def"), encoding: .utf8)
+    }
+
+    // MARK: - Text
+
+    private func write(_ text: String, to url: URL, encoding: TextEncoding) throws {
+        let data: Data?
+        switch encoding {
+        case .utf8: data = text.data(using: .utf8)
+        case .utf8BOM: data = text.data(using: .utf8).map { Data([0xEF, 0xBB, 0xBF]) + $0 }
+        case .windows1252: data = text.data(using: .windowsCP1252, allowLossyConversion: true)
+        case .shiftJIS: data = text.data(using: .shiftJIS, allowLossyConversion: true)
+        }
+        guard let encoded = data else {
+            throw CocoaError(.fileWriteInapplicableStringEncoding)
+        }
+        try encoded.write(to: url)
+    }
+
+    // MARK: - Sprites
+
+    /// An 8-bit sprite: palette indices plus the shared palette below
+    struct Sprite {
+        let group: UInt16
+        let image: UInt16
+        let width: Int
+        let height: Int
+        let pixels: [UInt8]
+    }
+
+    /// Shared 32-color RGBA palette; color 0 is transparent. Indices stay below 32 so LZ5 applies.
+    static let palette: [UInt8] = (0..<32).flatMap { index -> [UInt8] in
+        index == 0 ? [0, 0, 0, 0] : [UInt8(index * 8), UInt8(255 - index * 8), UInt8(index * 5 % 256), 255]
+    }
+
+    private func characterSprites(count: Int, rng: inout SplitMix64) -> [Sprite] {
+        var sprites = [
+            Sprite(group: 9000, image: 0, width: 25, height: 25, pixels: SyntheticLibrary.pixels(width: 25, height: 25, rng: &rng)),
+            Sprite(group: 9000, image: 1, width: 120, height: 140, pixels: SyntheticLibrary.pixels(width: 120, height: 140, rng: &rng))
+        ]
+        for index in 0..<count {
+            sprites.append(Sprite(group: 0, image: UInt16(index), width: 80, height: 100,
+                                  pixels: SyntheticLibrary.pixels(width: 80, height: 100, rng: &rng)))
+        }
+        return sprites
+    }
+
+    /// Blocky indexed pixels with transparent margins, compressible the way real sprites are
+    static func pixels(width: Int, height: Int, rng: inout SplitMix64) -> [UInt8] {
+        var pixels = [UInt8](repeating: 0, count: width * height)
+        for y in (height / 8)..<(height - height / 8) {
+            var x = width / 6
+            while x < width - width / 6 {
+                let run = rng.next(in: 1...12)
+                let color = UInt8(rng.next(in: 1...31))
+                for offset in 0..<run where x + offset < width - width / 6 {
+                    pixels[y * width + x + offset] = color
+                }
+                x += run
+            }
+        }
+        return pixels
+    }
+
+    // MARK: - SFF v2
+
+    /// Write sprites with SFFWriter; `.png` sprites are converted to RGBA PNGs first
+    static func writeSFFv2(_ sprites: [Sprite], encoding: SFFWriter.Encoding, to url: URL) throws {
+        let entries = try sprites.map { sprite -> SFFWriter.SpriteEntry in
+            guard encoding == .png else {
+                return SFFWriter.SpriteEntry(group: sprite.group, image: sprite.image, indexedPixels: sprite.pixels,
+                                             palette: palette, width: UInt16(sprite.width), height: UInt16(sprite.height),
+                                             encoding: encoding)
+            }
+            guard let png = pngData(for: sprite) else {
+                throw SFFWriter.SFFWriteError.pngEncodingFailed
+            }
+            return SFFWriter.SpriteEntry(group: sprite.group, image: sprite.image, pngData: png,
+                                         width: UInt16(sprite.width), height: UInt16(sprite.height))
+        }
+
+        if case .failure(let error) = SFFWriter.write(sprites: entries, to: url) {
+            throw error
+        }
+    }
+
+    private static func pngData(for sprite: Sprite) -> Data? {
+        guard let bitmap = NSBitmapImageRep(bitmapDataPlanes: nil, pixelsWide: sprite.width, pixelsHigh: sprite.height,
+                                            bitsPerSample: 8, samplesPerPixel: 4, hasAlpha: true, isPlanar: false,
+                                            colorSpaceName: .deviceRGB, bytesPerRow: sprite.width * 4, bitsPerPixel: 32),
+              let data = bitmap.bitmapData else {
+            return nil
+        }
+        for (index, value) in sprite.pixels.enumerated() {
+            for channel in 0..<4 {
+                data[index * 4 + channel] = palette[Int(value) * 4 + channel]
+            }
+        }
+        return bitmap.representation(using: .png, properties: [:])
+    }
+
+    // MARK: - SFF v1
+
+    /// Write an SFF v1 file: 512-byte header, then one 32-byte subfile header plus PCX per sprite
+    static func writeSFFv1(_ sprites: [Sprite], to url: URL) throws {
+        var data = Data("ElecbyteSpr\0".utf8)
+        data.append(contentsOf: [0, 1, 0, 1])                            // Version 1.01
+        data.appendLittleEndian(UInt32(Set(sprites.map { $0.group }).count))  // Group count
+        data.appendLittleEndian(UInt32(sprites.count))                  // Image count
+        data.appendLittleEndian(UInt32(512))                            // First subfile offset
+        data.appendLittleEndian(UInt32(32))                             // Subfile header size
+        data.append(1)                                                  // Palette type: shared
+        data.append(contentsOf: [UInt8](repeating: 0, count: 512 - data.count))
+
+        for (index, sprite) in sprites.enumerated() {
+            let pcx = pcxData(for: sprite)
+            let next = index == sprites.count - 1 ? 0 : data.count + 32 + pcx.count
+            data.appendLittleEndian(UInt32(next))                       // Next subfile offset
+            data.appendLittleEndian(UInt32(pcx.count))                  // Subfile length
+            data.appendLittleEndian(UInt16(0))                          // X axis
+            data.appendLittleEndian(UInt16(0))                          // Y axis
+            data.appendLittleEndian(sprite.group)
+            data.appendLittleEndian(sprite.image)
+            data.appendLittleEndian(UInt16(0))                          // Linked index
+            data.append(index == 0 ? 0 : 1)                             // Same palette as previous
+            data.append(contentsOf: [UInt8](repeating: 0, count: 13))   // Comment
+            data.append(pcx)
+        }
+
+        try data.write(to: url)
+    }
+
+    /// 8-bit RLE PCX with a trailing 256-color palette
+    private static func pcxData(for sprite: Sprite) -> Data {
+        let bytesPerLine = sprite.width + sprite.width % 2
+        var header = [UInt8](repeating: 0, count: 128)
+        header[0] = 10                                                  // Manufacturer
+        header[1] = 5                                                   // Version
+        header[2] = 1                                                   // RLE
+        header[3] = 8                                                   // Bits per pixel
+        header[8] = UInt8(truncatingIfNeeded: sprite.width - 1)         // xmax
+        header[9] = UInt8(truncatingIfNeeded: (sprite.width - 1) >> 8)
+        header[10] = UInt8(truncatingIfNeeded: sprite.height - 1)       // ymax
+        header[11] = UInt8(truncatingIfNeeded: (sprite.height - 1) >> 8)
+        header[65] = 1                                                  // Planes
+        header[66] = UInt8(truncatingIfNeeded: bytesPerLine)
+        header[67] = UInt8(truncatingIfNeeded: bytesPerLine >> 8)
+
+        var data = Data(header)
+        for y in 0..<sprite.height {
+            var line = Array(sprite.pixels[(y * sprite.width)..<((y + 1) * sprite.width)])
+            line += [UInt8](repeating: 0, count: bytesPerLine - sprite.width)
+
+            var x = 0
+            while x < line.count {
+                var run = 1
+                while x + run < line.count && run < 63 && line[x + run] == line[x] {
+                    run += 1
+                }
+                if run > 1 || line[x] >= 0xC0 {
+                    data.append(0xC0 | UInt8(run))
+                }
+                data.append(line[x])
+                x += run
+            }
+        }
+
+        data.append(12)
+        for index in 0..<256 {
+            let base = index * 4
+            if base + 2 < palette.count {
+                data.append(contentsOf: palette[base..<(base + 3)])
+            } else {
+                data.append(contentsOf: [0, 0, 0])
+            }
+        }
+        return data
+    }
+}
+
+// MARK: - Little-Endian Helpers
+
+private extension Data {
+    mutating func appendLittleEndian(_ value: UInt16) {
+        append(UInt8(value & 0xFF))
+        append(UInt8(value >> 8))
+    }
+
+    mutating func appendLittleEndian(_ value: UInt32) {
+        for shift in stride(from: 0, to: 32, by: 8) {
+            append(UInt8((value >> UInt32(shift)) & 0xFF))
+        }
+    }
+}
@@ -0,0 +1,104 @@
+import XCTest
+@testable import IKEMEN_Lab
+
+/// Tests for byte-level encoding detection and the decoded text cache
+final class TextEncodingDetectorTests: XCTestCase {
+
+    var workingDir: URL!
+
+    override func setUp() {
+        super.setUp()
+        workingDir = FileManager.default.temporaryDirectory
+            .appendingPathComponent("TextEncodingDetectorTests-\(UUID().uuidString)")
+        try? FileManager.default.createDirectory(at: workingDir, withIntermediateDirectories: true)
+        TextFileCache.shared.removeAll()
+    }
+
+    override func tearDown() {
+        try? FileManager.default.removeItem(at: workingDir)
+        workingDir = nil
+        super.tearDown()
+    }
+
+    // MARK: - Detection
+
+    func testASCIIAndUTF8AreDetectedAsUTF8() throws {
+        XCTAssertEqual(TextEncodingDetector.detect(Data("[Info]\nname = Kung Fu Man\n".utf8)), .utf8)
+        XCTAssertEqual(TextEncodingDetector.detect(Data("name = リュウ ; 日本語\n".utf8)), .utf8)
+        XCTAssertEqual(TextEncodingDetector.detect(Data()), .utf8)
+    }
+
+    func testShiftJISIsDetected() throws {
+        // Given - Kana, kanji and half-width katakana
+        let text = "[Info]\nname = \"リュウ\"\nauthor = 山田 ﾃｽﾄ\n"
+        let data = try XCTUnwrap(text.data(using: .shiftJIS))
+
+        // Then
+        XCTAssertEqual(TextEncodingDetector.detect(data), .shiftJIS)
+        XCTAssertEqual(TextEncodingDetector.decode(data), text)
+    }
+
+    func testWindows1252IsNotMistakenForShiftJIS() throws {
+        // "été" and "Café" contain bytes that are also Shift-JIS lead bytes
+        let text = "name = Café\nauthor = été Noël\n"
+        let data = try XCTUnwrap(text.data(using: .windowsCP1252))
+
+        XCTAssertEqual(TextEncodingDetector.detect(data), .windowsCP1252)
+        XCTAssertEqual(TextEncodingDetector.decode(data), text)
+    }
+
+    func testMalformedUTF8IsRejected() {
+        let malformed: [[UInt8]] = [
+            [0xC0, 0x80],              // overlong NUL
+            [0xE0, 0x80, 0x80],        // overlong 3-byte form
+            [0xED, 0xA0, 0x80],        // UTF-16 surrogate
+            [0xF4, 0x90, 0x80, 0x80],  // past U+10FFFF
+            [0x41, 0xE3, 0x81],        // truncated sequence
+            [0x80]                     // stray continuation byte
+        ]
+        for bytes in malformed {
+            let valid = bytes.withUnsafeBufferPointer { TextEncodingDetector.isValidUTF8($0) }
+            XCTAssertFalse(valid, "\(bytes)")
+        }
+    }
+
+    func testNonASCIIPastWordBoundaryIsValidated() {
+        // Multi-byte characters straddling the 8-byte ASCII skip
+        let text = "abcdefg\u{E9}hijklmnop\u{1F600}qrstuvw"
+        let valid = Array(text.utf8).withUnsafeBufferPointer { TextEncodingDetector.isValidUTF8($0) }
+        XCTAssertTrue(valid)
+    }
+
+    func testUndefinedWindows1252BytesStillDecode() {
+        // 0x81 and 0x8D are unassigned in Windows-1252 and don't form Shift-JIS pairs here
+        let data = Data("name = A".utf8) + Data([0x81, 0x20, 0x8D])
+
+        XCTAssertFalse(TextEncodingDetector.decode(data).isEmpty)
+    }
+
+    // MARK: - Cache
+
+    func testReadFileContentDecodesShiftJISFile() throws {
+        let url = workingDir.appendingPathComponent("jp.def")
+        try XCTUnwrap("[Info]\nname = 春麗\n".data(using: .shiftJIS)).write(to: url)
+
+        XCTAssertEqual(DEFParser.readFileContent(from: url), "[Info]\nname = 春麗\n")
+    }
+
+    func testCacheIsInvalidatedWhenFileChanges() throws {
+        // Given
+        let url = workingDir.appendingPathComponent("kfm.def")
+        try Data("name = First\n".utf8).write(to: url)
+        XCTAssertEqual(TextFileCache.shared.string(contentsOf: url), "name = First\n")
+
+        // When - Rewritten with a different size
+        try Data("name = Second one\n".utf8).write(to: url)
+
+        // Then
+        XCTAssertEqual(TextFileCache.shared.string(contentsOf: url), "name = Second one\n")
+    }
+
+    func testMissingFileReturnsNil() {
+        XCTAssertNil(TextFileCache.shared.string(contentsOf: workingDir.appendingPathComponent("none.def")))
+    }
+}
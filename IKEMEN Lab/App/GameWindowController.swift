@@ -1096,39 +1096,41 @@ class GameWindowController: NSWindowController {
         let previousStageCount = IkemenBridge.shared.stages.count
         let previousScreenpackCount = IkemenBridge.shared.screenpacks.count
         
-        // Rescan content from disk
-        IkemenBridge.shared.loadContent()
-        
-        // Get new counts
-        let newCharacterCount = IkemenBridge.shared.characters.count
-        let newStageCount = IkemenBridge.shared.stages.count
-        let newScreenpackCount = IkemenBridge.shared.screenpacks.count
-        
-        // Then refresh the current view with updated data
-        switch selectedNavItem {
-        case .characters:
-            characterBrowserView?.refresh()
-            showRefreshNotification(
-                contentType: "character",
-                previous: previousCharacterCount,
-                current: newCharacterCount
-            )
-        case .stages:
-            stageBrowserView?.refresh()
-            showRefreshNotification(
-                contentType: "stage",
-                previous: previousStageCount,
-                current: newStageCount
-            )
-        case .addons:
-            screenpackBrowserView?.refresh()
-            showRefreshNotification(
-                contentType: "screenpack",
-                previous: previousScreenpackCount,
-                current: newScreenpackCount
-            )
-        default:
-            break
+        // Rescan content from disk; counts are compared once the new content is published
+        IkemenBridge.shared.loadContent { [weak self] in
+            guard let self = self else { return }
+            
+            // Get new counts
+            let newCharacterCount = IkemenBridge.shared.characters.count
+            let newStageCount = IkemenBridge.shared.stages.count
+            let newScreenpackCount = IkemenBridge.shared.screenpacks.count
+            
+            // Then refresh the current view with updated data
+            switch self.selectedNavItem {
+            case .characters:
+                self.characterBrowserView?.refresh()
+                self.showRefreshNotification(
+                    contentType: "character",
+                    previous: previousCharacterCount,
+                    current: newCharacterCount
+                )
+            case .stages:
+                self.stageBrowserView?.refresh()
+                self.showRefreshNotification(
+                    contentType: "stage",
+                    previous: previousStageCount,
+                    current: newStageCount
+                )
+            case .addons:
+                self.screenpackBrowserView?.refresh()
+                self.showRefreshNotification(
+                    contentType: "screenpack",
+                    previous: previousScreenpackCount,
+                    current: newScreenpackCount
+                )
+            default:
+                break
+            }
         }
     }
     
@@ -1942,9 +1944,10 @@ class GameWindowController: NSWindowController {
     private func setupBridge() {
         ikemenBridge = IkemenBridge.shared
         
-        // Initialize metadata database
+        // Initialize metadata database, then show the stored library while disk is reconciled
         if let workingDir = ikemenBridge.workingDirectory {
             initializeMetadataStore(at: workingDir)
+            ikemenBridge.loadContentFromSnapshot()
         }
         
         // Observe state changes
@@ -1961,6 +1964,12 @@ class GameWindowController: NSWindowController {
                 self?.charactersCountLabel?.stringValue = "\(characters.count)"
                 self?.updateNavItemCount(.characters, count: characters.count)
                 self?.updateDashboardStats()
+                // Partial lists from a scan in progress are followed by the full one
+                guard self?.ikemenBridge.libraryScanProgress == nil else { return }
+                // Refresh header-only sprite stats for new or changed SFF files in the background
+                SFFStatsScanner.shared.scanLibrary(characters)
+                // Index CNS/CMD/AIR structure for new or changed characters in the background
+                CharacterStructureIndexer.shared.indexLibrary(characters)
             }
             .store(in: &cancellables)
         
@@ -2251,9 +2260,11 @@ class GameWindowController: NSWindowController {
         // Run validation in background
         DispatchQueue.global(qos: .userInitiated).async { [weak self] in
             let validator = ContentValidator.shared
+            // The user asked for a check, so validate what is on disk now rather than the last listing
+            let manifest = LibraryManifest.refresh(charsDirectory: workingDir.appendingPathComponent("chars"))
             
             let stageResults = validator.validateAllStages(in: workingDir)
-            let charResults = validator.validateAllCharacters(in: workingDir)
+            let charResults = validator.validateAllCharacters(in: workingDir, manifest: manifest)
             let placementResults = validator.validateContentPlacement(in: workingDir)
             
             DispatchQueue.main.async {
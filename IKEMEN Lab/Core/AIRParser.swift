@@ -0,0 +1,231 @@
+import Foundation
+
+// MARK: - AIR Types
+
+/// A single animation element from an .air action
+public struct AIRFrame: Equatable {
+    public let group: Int
+    public let image: Int
+    public let x: Int
+    public let y: Int
+    /// Display time in ticks (1/60 s); -1 holds the frame forever
+    public let duration: Int
+    /// "H", "V", "HV" or nil
+    public let flip: String?
+}
+
+/// An animation action (`[Begin Action N]` block)
+public struct AIRAction: Equatable {
+    public let number: Int
+    public let frames: [AIRFrame]
+    /// Index of the frame the animation loops back to (the `LoopStart` marker), else 0
+    public let loopStart: Int
+}
+
+// MARK: - AIR Index
+
+/// Byte-offset index of the actions in an .air file
+///
+/// Built by streaming the file once; only the header line of each block is inspected. Actions
+/// are parsed on demand by reading just their own byte range, so a 2 MB AIR file with
+/// thousands of actions never has to be loaded or parsed as a whole.
+public struct AIRIndex {
+
+    /// Byte range of one action block, from its header line to the next header (or EOF)
+    public struct Block: Equatable {
+        public let offset: UInt64
+        public let length: Int
+    }
+
+    public let url: URL
+
+    /// Action number -> block; the first definition wins when an action is repeated
+    public let blocks: [Int: Block]
+
+    /// Action numbers in file order
+    public let actionNumbers: [Int]
+
+    public func contains(action number: Int) -> Bool {
+        return blocks[number] != nil
+    }
+
+    /// Read and parse a single action
+    /// - Returns: The action, or nil if it isn't defined or the file can't be read
+    public func action(_ number: Int) -> AIRAction? {
+        guard let block = blocks[number],
+              let handle = try? FileHandle(forReadingFrom: url) else { return nil }
+        defer { try? handle.close() }
+
+        do {
+            try handle.seek(toOffset: block.offset)
+            guard let data = try handle.read(upToCount: block.length) else { return nil }
+            return AIRParser.parseAction(data, number: number)
+        } catch {
+            return nil
+        }
+    }
+}
+
+// MARK: - AIR Parser
+
+/// Parser for character .air animation files
+public struct AIRParser {
+
+    /// Bytes read per chunk while indexing
+    static let chunkSize = 64 * 1024
+
+    /// Longest line prefix needed to recognize a `[Begin Action N]` header
+    private static let headerPrefixLimit = 64
+
+    private static let indexCache: NSCache<NSString, CachedIndex> = {
+        let cache = NSCache<NSString, CachedIndex>()
+        cache.name = "com.ikemenlab.AIRParser"
+        cache.countLimit = 200
+        return cache
+    }()
+
+    private final class CachedIndex {
+        let fileSize: Int64
+        let modifiedAt: Double
+        let index: AIRIndex
+
+        init(fileSize: Int64, modifiedAt: Double, index: AIRIndex) {
+            self.fileSize = fileSize
+            self.modifiedAt = modifiedAt
+            self.index = index
+        }
+    }
+
+    // MARK: - Indexing
+
+    /// Get the action index for an AIR file, reusing the cached one if the file is unchanged
+    public static func index(for url: URL) -> AIRIndex? {
+        guard let identity = SFFDirectoryIndex.fileIdentity(of: url) else { return nil }
+        let key = url.standardizedFileURL.path as NSString
+
+        if let cached = indexCache.object(forKey: key),
+           cached.fileSize == identity.size, cached.modifiedAt == identity.modifiedAt {
+            return cached.index
+        }
+
+        guard let index = buildIndex(url: url) else { return nil }
+        indexCache.setObject(CachedIndex(fileSize: identity.size, modifiedAt: identity.modifiedAt, index: index), forKey: key)
+        return index
+    }
+
+    /// Stream an AIR file in fixed-size chunks and record where each action block starts
+    public static func buildIndex(url: URL) -> AIRIndex? {
+        guard let handle = try? FileHandle(forReadingFrom: url) else { return nil }
+        defer { try? handle.close() }
+
+        var headers: [(number: Int, offset: UInt64)] = []
+        var offset: UInt64 = 0
+        var lineStart: UInt64 = 0
+        var linePrefix: [UInt8] = []
+        linePrefix.reserveCapacity(headerPrefixLimit)
+
+        while true {
+            guard let chunk = try? handle.read(upToCount: chunkSize), !chunk.isEmpty else { break }
+
+            chunk.withUnsafeBytes { raw in
+                for byte in raw.bindMemory(to: UInt8.self) {
+                    if byte == 0x0A {
+                        if let number = actionNumber(inHeader: linePrefix) {
+                            headers.append((number, lineStart))
+                        }
+                        linePrefix.removeAll(keepingCapacity: true)
+                        lineStart = offset + 1
+                    } else if linePrefix.count < headerPrefixLimit {
+                        linePrefix.append(byte)
+                    }
+                    offset += 1
+                }
+            }
+        }
+
+        // Last line without a trailing newline
+        if let number = actionNumber(inHeader: linePrefix) {
+            headers.append((number, lineStart))
+        }
+
+        var blocks: [Int: AIRIndex.Block] = [:]
+        var actionNumbers: [Int] = []
+        for (i, header) in headers.enumerated() {
+            let end = i + 1 < headers.count ? headers[i + 1].offset : offset
+            guard blocks[header.number] == nil else { continue }
+            blocks[header.number] = AIRIndex.Block(offset: header.offset, length: Int(end - header.offset))
+            actionNumbers.append(header.number)
+        }
+
+        return AIRIndex(url: url, blocks: blocks, actionNumbers: actionNumbers)
+    }
+
+    /// Action number of a `[Begin Action N]` line, or nil for any other line
+    static func actionNumber(inHeader line: [UInt8]) -> Int? {
+        var i = 0
+        while i < line.count && (line[i] == 0x20 || line[i] == 0x09) { i += 1 }
+        guard i < line.count, line[i] == UInt8(ascii: "[") else { return nil }
+        i += 1
+
+        // Case-insensitive "begin action", tolerating extra spaces between the words
+        for word in ["begin", "action"] {
+            while i < line.count && line[i] == 0x20 { i += 1 }
+            for expected in word.utf8 {
+                guard i < line.count, (line[i] | 0x20) == expected else { return nil }
+                i += 1
+            }
+        }
+
+        while i < line.count && line[i] == 0x20 { i += 1 }
+
+        var number = 0
+        var digits = 0
+        while i < line.count, line[i] >= 0x30 && line[i] <= 0x39, digits < 9 {
+            number = number * 10 + Int(line[i] - 0x30)
+            digits += 1
+            i += 1
+        }
+        return digits > 0 ? number : nil
+    }
+
+    // MARK: - Action Parsing
+
+    /// Parse the text of one action block (header line included)
+    public static func parseAction(_ data: Data, number: Int) -> AIRAction {
+        let text = String(decoding: data, as: UTF8.self)
+        var frames: [AIRFrame] = []
+        var loopStart = 0
+
+        for rawLine in text.split(whereSeparator: { $0.isNewline }) {
+            var line = Substring(rawLine)
+            if let commentIndex = line.firstIndex(of: ";") {
+                line = line[..<commentIndex]
+            }
+            let trimmed = line.trimmingCharacters(in: .whitespaces)
+            guard !trimmed.isEmpty, !trimmed.hasPrefix("[") else { continue }
+
+            let lowered = trimmed.lowercased()
+            if lowered.hasPrefix("loopstart") {
+                loopStart = frames.count
+                continue
+            }
+            // Collision boxes and interpolation settings aren't frames
+            if lowered.hasPrefix("clsn") || lowered.hasPrefix("interpolate") {
+                continue
+            }
+
+            let fields = trimmed.split(separator: ",", omittingEmptySubsequences: false)
+                .map { $0.trimmingCharacters(in: .whitespaces) }
+            guard fields.count >= 5,
+                  let group = Int(fields[0]), let image = Int(fields[1]),
+                  let x = Int(fields[2]), let y = Int(fields[3]), let duration = Int(fields[4]) else {
+                continue
+            }
+
+            let flip = fields.count > 5 && !fields[5].isEmpty ? fields[5].uppercased() : nil
+            frames.append(AIRFrame(group: group, image: image, x: x, y: y, duration: duration, flip: flip))
+        }
+
+        return AIRAction(number: number, frames: frames, loopStart: loopStart < frames.count ? loopStart : 0)
+    }
+}
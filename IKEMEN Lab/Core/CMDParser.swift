@@ -0,0 +1,236 @@
+import Foundation
+
+// MARK: - Move Command
+
+struct MoveCommand: Codable, Equatable {
+    let name: String       // Internal name (e.g., "SpecialX")
+    let displayName: String // Human-readable name
+    let command: String    // Raw command (e.g., "~D,DF,F, x")
+    let notation: String   // Pretty notation (e.g., "↓↘→ + LP")
+    
+    /// Hyper/super moves are listed before specials
+    var isHyper: Bool {
+        let lowered = name.lowercased()
+        return lowered.contains("hyper") || lowered.contains("super")
+    }
+}
+
+// MARK: - CMD Parser
+
+struct CMDParser {
+    
+    /// Special moves and command totals from one pass over a CMD file
+    struct Summary {
+        /// Special and hyper moves, hypers first
+        let moves: [MoveCommand]
+        /// Number of [Command] blocks, including basic movement and AI commands
+        let commandCount: Int
+    }
+    
+    /// Parse special moves from a character's CMD file
+    static func parseMoves(for character: CharacterInfo) -> [MoveCommand] {
+        // Find CMD file
+        guard let cmdFile = findCMDFile(for: character),
+              let data = try? Data(contentsOf: cmdFile) else {
+            return []
+        }
+        return parse(data: data).moves
+    }
+    
+    /// Parse raw CMD bytes
+    static func parse(data: Data) -> Summary {
+        var moves: [MoveCommand] = []
+        var commandCount = 0
+        var seenCommands = Set<String>()
+        
+        var currentName: String?
+        var currentCommand: String?
+        
+        // Only name/command values become strings; state controllers are skipped by key
+        DEFTokenizer.scan(data) { tokens in
+            tokens.forEachToken { token in
+                if token.kind == .section && tokens.matches(token.name, "command") {
+                    commandCount += 1
+                }
+                guard token.kind == .keyValue else { return true }
+                
+                // Parse name = "..."
+                if tokens.matches(token.name, "name") {
+                    if let nameMatch = extractQuotedValue(from: tokens.string(token.value)) {
+                        currentName = nameMatch
+                    }
+                }
+                
+                // Parse command = ...
+                if tokens.matches(token.name, "command") {
+                    currentCommand = tokens.string(token.value)
+                }
+                
+                // If we have both name and command, create a move
+                if let name = currentName, let command = currentCommand {
+                    // Skip AI commands and basic movement
+                    let skipPrefixes = ["AI_", "holdfwd", "holdback", "holdup", "holddown", "recovery", "fwd", "back", "up", "down"]
+                    let shouldSkip = skipPrefixes.contains { name.lowercased().hasPrefix($0.lowercased()) } ||
+                                     name.lowercased() == "run" ||
+                                     name.lowercased() == "dash"
+                    
+                    // Only include special/hyper moves
+                    if !shouldSkip && isSpecialMove(command: command) {
+                        let key = "\(name)|\(command)"
+                        if !seenCommands.contains(key) {
+                            seenCommands.insert(key)
+                            
+                            let displayName = formatMoveName(name)
+                            let notation = formatNotation(command)
+                            
+                            moves.append(MoveCommand(
+                                name: name,
+                                displayName: displayName,
+                                command: command,
+                                notation: notation
+                            ))
+                        }
+                    }
+                    
+                    currentName = nil
+                    currentCommand = nil
+                }
+                return true
+            }
+        }
+        
+        // Sort: Hypers first, then specials
+        let sorted = moves.sorted { m1, m2 in
+            if m1.isHyper != m2.isHyper { return m1.isHyper }
+            return m1.displayName < m2.displayName
+        }
+        return Summary(moves: sorted, commandCount: commandCount)
+    }
+    
+    static func findCMDFile(for character: CharacterInfo) -> URL? {
+        let fileManager = FileManager.default
+        
+        // First, check the DEF file for cmd reference
+        if let cmdName = DEFParser.parse(url: character.defFile)?.cmdFile, !cmdName.isEmpty {
+            let cmdPath = character.directory.appendingPathComponent(cmdName)
+            if fileManager.fileExists(atPath: cmdPath.path) {
+                return cmdPath
+            }
+        }
+        
+        // Fallback: look for .cmd file with same name as character
+        let defName = character.defFile.deletingPathExtension().lastPathComponent
+        let cmdFile = character.directory.appendingPathComponent("\(defName).cmd")
+        if fileManager.fileExists(atPath: cmdFile.path) {
+            return cmdFile
+        }
+        
+        // Last resort: any .cmd file
+        if let contents = try? fileManager.contentsOfDirectory(at: character.directory, includingPropertiesForKeys: nil) {
+            return contents.first { $0.pathExtension.lowercased() == "cmd" }
+        }
+        
+        return nil
+    }
+    
+    private static func extractQuotedValue(from line: String) -> String? {
+        guard let firstQuote = line.firstIndex(of: "\""),
+              let lastQuote = line.lastIndex(of: "\""),
+              firstQuote != lastQuote else {
+            return nil
+        }
+        return String(line[line.index(after: firstQuote)..<lastQuote])
+    }
+    
+    private static func isSpecialMove(command: String) -> Bool {
+        let lower = command.lowercased()
+        // Special moves typically have direction sequences
+        let hasDirectionSequence = lower.contains("~d") || lower.contains("~f") || lower.contains("~b") ||
+                                   lower.contains(",d") || lower.contains(",f") || lower.contains(",b") ||
+                                   lower.contains("df") || lower.contains("db") || lower.contains("uf") || lower.contains("ub")
+        // And end with a button
+        let hasButton = lower.contains("x") || lower.contains("y") || lower.contains("z") ||
+                       lower.contains("a") || lower.contains("b") || lower.contains("c")
+        return hasDirectionSequence && hasButton
+    }
+    
+    private static func formatMoveName(_ name: String) -> String {
+        // Convert "SpecialX" to "Special X", "Hyper1" to "Hyper 1", etc.
+        let result = name
+        
+        // Insert space before capital letters and numbers
+        var formatted = ""
+        for (i, char) in result.enumerated() {
+            if i > 0 && (char.isUppercase || char.isNumber) {
+                let prevChar = result[result.index(result.startIndex, offsetBy: i - 1)]
+                if !prevChar.isUppercase && !prevChar.isNumber && prevChar != " " {
+                    formatted += " "
+                }
+            }
+            formatted += String(char)
+        }
+        
+        return formatted
+    }
+    
+    private static func formatNotation(_ command: String) -> String {
+        var result = command
+            .replacingOccurrences(of: " ", with: "")
+            .replacingOccurrences(of: "~", with: "")
+        
+        // Direction mappings
+        let directionMap: [(String, String)] = [
+            ("DF", "↘"),
+            ("DB", "↙"),
+            ("UF", "↗"),
+            ("UB", "↖"),
+            ("D", "↓"),
+            ("U", "↑"),
+            ("F", "→"),
+            ("B", "←"),
+        ]
+        
+        // Button mappings (case-sensitive for final output)
+        let buttonMap: [(String, String)] = [
+            ("x+y", "LP+MP"),
+            ("y+z", "MP+HP"),
+            ("x+z", "LP+HP"),
+            ("a+b", "LK+MK"),
+            ("b+c", "MK+HK"),
+            ("a+c", "LK+HK"),
+            ("x", "LP"),
+            ("y", "MP"),
+            ("z", "HP"),
+            ("a", "LK"),
+            ("b", "MK"),
+            ("c", "HK"),
+        ]
+        
+        // Apply direction mappings (case-insensitive)
+        for (from, to) in directionMap {
+            result = result.replacingOccurrences(of: from, with: to, options: .caseInsensitive)
+        }
+        
+        // Apply button mappings
+        for (from, to) in buttonMap {
+            result = result.replacingOccurrences(of: from, with: to, options: .caseInsensitive)
+        }
+        
+        // Clean up separators
+        result = result.replacingOccurrences(of: ",", with: " ")
+        
+        // Add + before button at the end
+        let buttons = ["LP", "MP", "HP", "LK", "MK", "HK", "LP+MP", "MP+HP", "LP+HP", "LK+MK", "MK+HK", "LK+HK"]
+        for button in buttons {
+            if result.hasSuffix(button) && !result.hasSuffix("+ \(button)") {
+                let prefix = String(result.dropLast(button.count)).trimmingCharacters(in: .whitespaces)
+                if !prefix.isEmpty {
+                    result = "\(prefix) + \(button)"
+                }
+                break
+            }
+        }
+        
+        return result
+    }
+}
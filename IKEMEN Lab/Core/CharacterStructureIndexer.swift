@@ -0,0 +1,180 @@
+import Foundation
+import os.log
+
+// MARK: - Character Structure Indexer
+
+/// Parses each character's CNS, CMD and AIR once and persists the results in `MetadataStore`
+///
+/// The details panel and smart collections read stats, the move list and state/command/action
+/// counts from the stored record instead of re-parsing the source files. A record is keyed to
+/// a fingerprint of every source file's name, size and modification date, so editing the CMD
+/// (or swapping the AIR) re-indexes just that character.
+public final class CharacterStructureIndexer {
+
+    // MARK: - Singleton
+
+    public static let shared = CharacterStructureIndexer()
+
+    // MARK: - Properties
+
+    private static let logger = Logger(subsystem: Bundle.main.bundleIdentifier ?? "com.ikemenlab", category: "CharacterStructureIndexer")
+
+    private let indexQueue = DispatchQueue(label: "com.ikemenlab.characterStructureIndexer", qos: .utility)
+
+    // MARK: - Initialization
+
+    private init() {}
+
+    // MARK: - Lookup
+
+    /// Get the structure for a character, indexing it only if the stored record is missing or stale
+    public func structure(for character: CharacterInfo) -> CharacterStructureRecord {
+        let sources = sourceFiles(for: character)
+        let fingerprint = CharacterStructureIndexer.fingerprint(of: sources.all)
+
+        if let record = try? MetadataStore.shared.characterStructure(id: character.id),
+           record.sourceFingerprint == fingerprint {
+            return record
+        }
+
+        let record = index(character, sources: sources, fingerprint: fingerprint)
+        do {
+            try MetadataStore.shared.storeCharacterStructures([record])
+        } catch {
+            Self.logger.error("Failed to store character structure: \(error.localizedDescription)")
+        }
+        return record
+    }
+
+    // MARK: - Indexing
+
+    /// Parse a character's source files without consulting the stored index
+    public func index(_ character: CharacterInfo) -> CharacterStructureRecord {
+        let sources = sourceFiles(for: character)
+        return index(character, sources: sources, fingerprint: CharacterStructureIndexer.fingerprint(of: sources.all))
+    }
+
+    /// Index every character in parallel and store the results in one transaction
+    /// Characters whose stored record is still current are skipped.
+    /// - Parameters:
+    ///   - characters: Characters to index
+    ///   - completion: Called on the main queue with the number of characters (re)indexed
+    public func indexLibrary(_ characters: [CharacterInfo], completion: ((Int) -> Void)? = nil) {
+        indexQueue.async {
+            let existing = (try? MetadataStore.shared.allCharacterStructures()) ?? []
+            let current = Dictionary(existing.map { ($0.characterId, $0.sourceFingerprint) },
+                                     uniquingKeysWith: { first, _ in first })
+
+            // Resolve source files up front; this touches only the DEF (cached) and file metadata
+            var pending: [(character: CharacterInfo, sources: SourceFiles, fingerprint: String)] = []
+            for character in characters {
+                let sources = self.sourceFiles(for: character)
+                let fingerprint = CharacterStructureIndexer.fingerprint(of: sources.all)
+                if current[character.id] == fingerprint { continue }
+                pending.append((character, sources, fingerprint))
+            }
+
+            var results = [CharacterStructureRecord?](repeating: nil, count: pending.count)
+            let lock = NSLock()
+
+            DispatchQueue.concurrentPerform(iterations: pending.count) { i in
+                let item = pending[i]
+                let record = self.index(item.character, sources: item.sources, fingerprint: item.fingerprint)
+                lock.lock()
+                results[i] = record
+                lock.unlock()
+            }
+
+            let records = results.compactMap { $0 }
+            do {
+                try MetadataStore.shared.storeCharacterStructures(records)
+            } catch {
+                Self.logger.error("Failed to store character structures: \(error.localizedDescription)")
+            }
+
+            DispatchQueue.main.async {
+                completion?(records.count)
+            }
+        }
+    }
+
+    // MARK: - Helpers
+
+    /// Files a character's structure is derived from
+    private struct SourceFiles {
+        let defFile: URL
+        let stateFiles: [URL]
+        let cmdFile: URL?
+        let airFile: URL?
+
+        var all: [URL] {
+            return [defFile] + stateFiles + [cmdFile, airFile].compactMap { $0 }
+        }
+    }
+
+    private func sourceFiles(for character: CharacterInfo) -> SourceFiles {
+        let parsed = DEFParser.parse(url: character.defFile)
+        let stateFiles = parsed.map { CNSParser.stateFiles(for: character.directory, defParsed: $0) } ?? []
+        let airFile = parsed?.animFile.flatMap { $0.isEmpty ? nil : character.directory.appendingPathComponent($0) }
+
+        return SourceFiles(defFile: character.defFile,
+                           stateFiles: stateFiles,
+                           cmdFile: CMDParser.findCMDFile(for: character),
+                           airFile: airFile)
+    }
+
+    private func index(_ character: CharacterInfo, sources: SourceFiles, fingerprint: String) -> CharacterStructureRecord {
+        // Stats come from the first state file with a [Data] section (the cns, normally)
+        var stats: CNSParser.CharacterStats?
+        var stateCount = 0
+        for file in sources.stateFiles {
+            guard let data = try? Data(contentsOf: file) else { continue }
+            if stats == nil {
+                let result = CNSParser.readStats(data: data)
+                stats = result.foundData ? result.stats : nil
+            }
+            stateCount += CNSParser.stateCount(data: data)
+        }
+        let resolvedStats = stats ?? CNSParser.CharacterStats.defaults
+
+        var moves: [MoveCommand] = []
+        var commandCount = 0
+        if let cmdFile = sources.cmdFile, let data = try? Data(contentsOf: cmdFile) {
+            let summary = CMDParser.parse(data: data)
+            moves = summary.moves
+            commandCount = summary.commandCount
+        }
+
+        let actionCount = sources.airFile.flatMap { AIRParser.index(for: $0)?.blocks.count } ?? 0
+        let encodedMoves = (try? JSONEncoder().encode(moves)).flatMap { String(data: $0, encoding: .utf8) } ?? "[]"
+        let hyperCount = moves.filter { $0.isHyper }.count
+
+        return CharacterStructureRecord(
+            characterId: character.id,
+            sourceFingerprint: fingerprint,
+            life: resolvedStats.life,
+            attack: resolvedStats.attack,
+            defence: resolvedStats.defence,
+            power: resolvedStats.power,
+            airJuggle: resolvedStats.airJuggle,
+            fallDefenceUp: resolvedStats.fallDefenceUp,
+            stateCount: stateCount,
+            commandCount: commandCount,
+            specialMoveCount: moves.count - hyperCount,
+            hyperMoveCount: hyperCount,
+            actionCount: actionCount,
+            moves: encodedMoves,
+            indexedAt: Date()
+        )
+    }
+
+    /// Name, size and modification date of each file; missing files are recorded as such
+    static func fingerprint(of files: [URL]) -> String {
+        return files.map { url -> String in
+            guard let identity = SFFDirectoryIndex.fileIdentity(of: url) else {
+                return "\(url.lastPathComponent):-"
+            }
+            return "\(url.lastPathComponent):\(identity.size):\(identity.modifiedAt)"
+        }.joined(separator: "|")
+    }
+}
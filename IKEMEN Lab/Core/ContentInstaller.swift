@@ -451,6 +451,7 @@ public final class ContentInstaller {
         
         // Copy to chars directory
         try fileManager.copyItem(at: source, to: destPath)
+        LibraryManifest.invalidate()
         
         // Find the .def file to determine the correct select.def entry
         let defEntry = findCharacterDefEntry(charName: sanitizedName, in: destPath)
@@ -651,71 +652,12 @@ public final class ContentInstaller {
     }
     
     /// Check SFF file for portrait sprite dimensions
+    /// Reads only the header and node tables (via SFFStatsScanner), for both SFF v1 and v2
     private func checkSFFPortraitDimensions(_ sffURL: URL) -> (width: Int, height: Int)? {
-        guard let data = try? Data(contentsOf: sffURL) else { return nil }
-        guard data.count > 32 else { return nil }
-        
-        let signature = String(data: data[0..<12], encoding: .ascii) ?? ""
-        
-        if signature.hasPrefix("ElecbyteSpr") {
-            return parseSFFv1PortraitDimensions(data)
-        }
-        
-        return nil
-    }
-    
-    /// Parse SFF v1 to find portrait sprite dimensions
-    private func parseSFFv1PortraitDimensions(_ data: Data) -> (width: Int, height: Int)? {
-        guard data.count > 32 else { return nil }
-        
-        func readUInt16(at offset: Int) -> UInt16 {
-            guard offset + 1 < data.count else { return 0 }
-            return UInt16(data[offset]) | (UInt16(data[offset + 1]) << 8)
-        }
-        
-        func readUInt32(at offset: Int) -> UInt32 {
-            guard offset + 3 < data.count else { return 0 }
-            return UInt32(data[offset]) |
-                   (UInt32(data[offset + 1]) << 8) |
-                   (UInt32(data[offset + 2]) << 16) |
-                   (UInt32(data[offset + 3]) << 24)
+        guard let stats = SFFStatsScanner.shared.stats(for: sffURL),
+              let width = stats.portraitWidth, let height = stats.portraitHeight else {
+            return nil
         }
-        
-        let numImages = readUInt32(at: 20)
-        let firstSubfileOffset = readUInt32(at: 24)
-        
-        guard numImages > 0, firstSubfileOffset < data.count else { return nil }
-        
-        var offset = Int(firstSubfileOffset)
-        
-        for _ in 0..<min(Int(numImages), 1000) {
-            guard offset + 20 <= data.count else { break }
-            
-            let nextOffset = readUInt32(at: offset)
-            let groupNum = readUInt16(at: offset + 12)
-            let imageNum = readUInt16(at: offset + 14)
-            
-            if groupNum == 9000 && imageNum == 0 {
-                let pcxOffset = offset + 32
-                if pcxOffset + 12 <= data.count {
-                    let xmin = readUInt16(at: pcxOffset + 4)
-                    let ymin = readUInt16(at: pcxOffset + 6)
-                    let xmax = readUInt16(at: pcxOffset + 8)
-                    let ymax = readUInt16(at: pcxOffset + 10)
-                    
-                    let width = Int(xmax) - Int(xmin) + 1
-                    let height = Int(ymax) - Int(ymin) + 1
-                    
-                    if width > 0 && height > 0 && width < 2000 && height < 2000 {
-                        return (width, height)
-                    }
-                }
-            }
-            
-            if nextOffset == 0 || nextOffset <= offset { break }
-            offset = Int(nextOffset)
-        }
-        
-        return nil
+        return (width, height)
     }
 }
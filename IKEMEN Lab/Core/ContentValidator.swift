@@ -81,8 +81,8 @@ public class ContentValidator {
         var issues: [ValidationIssue] = []
         let stageName = defFile.deletingPathExtension().lastPathComponent
         
-        // Parse the .def file (try multiple encodings)
-        guard let content = readFileContent(at: defFile) else {
+        // Read the .def file
+        guard let data = try? Data(contentsOf: defFile) else {
             issues.append(ValidationIssue(
                 severity: .error,
                 message: "Cannot read .def file",
@@ -96,33 +96,32 @@ public class ContentValidator {
         var spriteFile: String?
         var soundFile: String?
         
-        for line in content.components(separatedBy: .newlines) {
-            let trimmed = line.trimmingCharacters(in: .whitespaces)
-            
-            // Skip comments
-            if trimmed.hasPrefix(";") { continue }
-            
-            let lowercased = trimmed.lowercased()
-            
-            // Check for spr = (exact key, not spriteno/spriteinfo/etc)
-            // Must be "spr" or "sprite" followed by optional whitespace and "="
-            if lowercased.hasPrefix("spr") && !lowercased.hasPrefix("spriteno") && !lowercased.hasPrefix("spriteinfo") {
-                if let value = extractValue(from: trimmed) {
-                    // Only accept if it looks like a filename (ends in .sff or contains path separator)
-                    if value.lowercased().hasSuffix(".sff") || value.contains("/") || value.contains("\\") {
-                        spriteFile = value
+        DEFTokenizer.scan(data) { tokens in
+            tokens.forEachToken { token in
+                guard token.kind == .keyValue else { return true }
+                let key = token.name
+                
+                // Check for spr = (exact key, not spriteno/spriteinfo/etc)
+                // Must be "spr" or "sprite" followed by optional whitespace and "="
+                if tokens.hasPrefix(key, "spr") && !tokens.hasPrefix(key, "spriteno") && !tokens.hasPrefix(key, "spriteinfo") {
+                    if let value = fileReference(tokens, token) {
+                        // Only accept if it looks like a filename (ends in .sff or contains path separator)
+                        if value.lowercased().hasSuffix(".sff") || value.contains("/") || value.contains("\\") {
+                            spriteFile = value
+                        }
                     }
                 }
-            }
-            
-            // Check for snd = or sound = (exact key)
-            if (lowercased.hasPrefix("snd") && !lowercased.hasPrefix("sndtime")) || lowercased.hasPrefix("sound") {
-                if let value = extractValue(from: trimmed) {
-                    // Only accept if it looks like a filename
-                    if value.lowercased().hasSuffix(".snd") || value.contains("/") || value.contains("\\") {
-                        soundFile = value
+                
+                // Check for snd = or sound = (exact key)
+                if (tokens.hasPrefix(key, "snd") && !tokens.hasPrefix(key, "sndtime")) || tokens.hasPrefix(key, "sound") {
+                    if let value = fileReference(tokens, token) {
+                        // Only accept if it looks like a filename
+                        if value.lowercased().hasSuffix(".snd") || value.contains("/") || value.contains("\\") {
+                            soundFile = value
+                        }
                     }
                 }
+                return true
             }
         }
         
@@ -176,8 +175,14 @@ public class ContentValidator {
     
     /// Validate a character folder and its referenced resources
     public func validateCharacter(folder: URL) -> ValidationResult {
+        let listing = LibraryManifest.folder(at: folder) ?? LibraryManifest.CharacterFolder(url: folder, modifiedAt: nil, files: [])
+        return validateCharacter(listing)
+    }
+    
+    /// Validate a character folder from a library manifest listing
+    func validateCharacter(_ folder: LibraryManifest.CharacterFolder) -> ValidationResult {
         var issues: [ValidationIssue] = []
-        let charName = folder.lastPathComponent
+        let charName = folder.name
         
         // Find .def file
         guard let defFile = findMainDefFile(in: folder) else {
@@ -190,8 +195,8 @@ public class ContentValidator {
             return ValidationResult(contentName: charName, contentType: "character", issues: issues)
         }
         
-        // Parse the .def file (try multiple encodings)
-        guard let content = readFileContent(at: defFile) else {
+        // Read the .def file
+        guard let data = try? Data(contentsOf: defFile) else {
             issues.append(ValidationIssue(
                 severity: .error,
                 message: "Cannot read .def file",
@@ -202,7 +207,6 @@ public class ContentValidator {
         }
         
         // Check for required file references in [Files] section
-        var inFilesSection = false
         var requiredFiles: [String: String?] = [
             "sprite": nil,
             "anim": nil,
@@ -214,37 +218,33 @@ public class ContentValidator {
             "ai": nil
         ]
         
-        for line in content.components(separatedBy: .newlines) {
-            let trimmed = line.trimmingCharacters(in: .whitespaces)
-            
-            // Skip comments
-            if trimmed.hasPrefix(";") { continue }
-            
-            // Check section
-            if trimmed.hasPrefix("[") && trimmed.hasSuffix("]") {
-                let section = trimmed.dropFirst().dropLast().lowercased()
-                inFilesSection = (section == "files")
-                continue
-            }
-            
-            if inFilesSection {
-                let lowercased = trimmed.lowercased()
-                
-                for key in requiredFiles.keys {
-                    if lowercased.hasPrefix(key) {
-                        if let value = extractValue(from: trimmed) {
-                            requiredFiles[key] = value
+        DEFTokenizer.scan(data) { tokens in
+            var inFilesSection = false
+            tokens.forEachToken { token in
+                switch token.kind {
+                case .section:
+                    inFilesSection = tokens.matches(token.name, "files")
+                    
+                case .keyValue where inFilesSection:
+                    // Keys are matched by prefix, as MUGEN accepts e.g. "sprites" for "sprite"
+                    let key = tokens.lowercasedString(token.name)
+                    
+                    for name in requiredFiles.keys where key.hasPrefix(name) {
+                        if let value = fileReference(tokens, token) {
+                            requiredFiles[name] = value
                         }
                     }
-                }
-                
-                for key in optionalFiles.keys {
-                    if lowercased.hasPrefix(key) {
-                        if let value = extractValue(from: trimmed) {
-                            optionalFiles[key] = value
+                    
+                    for name in optionalFiles.keys where key.hasPrefix(name) {
+                        if let value = fileReference(tokens, token) {
+                            optionalFiles[name] = value
                         }
                     }
+                    
+                default:
+                    break
                 }
+                return true
             }
         }
         
@@ -321,21 +321,15 @@ public class ContentValidator {
     }
     
     /// Validate all characters in the chars folder
-    public func validateAllCharacters(in workingDir: URL) -> [ValidationResult] {
-        let charsDir = workingDir.appendingPathComponent("chars")
+    /// - Parameter manifest: Listing of chars/ to validate; nil uses the shared manifest from the latest refresh
+    public func validateAllCharacters(in workingDir: URL, manifest: LibraryManifest? = nil) -> [ValidationResult] {
+        let manifest = manifest ?? LibraryManifest.current(charsDirectory: workingDir.appendingPathComponent("chars"))
         var results: [ValidationResult] = []
         
-        guard let contents = try? fileManager.contentsOfDirectory(at: charsDir, includingPropertiesForKeys: nil) else {
-            return results
-        }
-        
-        for folder in contents {
-            var isDir: ObjCBool = false
-            if fileManager.fileExists(atPath: folder.path, isDirectory: &isDir), isDir.boolValue {
-                let result = validateCharacter(folder: folder)
-                if !result.issues.isEmpty {
-                    results.append(result)
-                }
+        for folder in manifest.folders {
+            let result = validateCharacter(folder)
+            if !result.issues.isEmpty {
+                results.append(result)
             }
         }
         
@@ -345,18 +339,12 @@ public class ContentValidator {
     // MARK: - Helper Methods
     
     /// Extract value from "key = value" line
-    private func extractValue(from line: String) -> String? {
-        guard let equalsIndex = line.firstIndex(of: "=") else { return nil }
-        var value = String(line[line.index(after: equalsIndex)...])
-            .trimmingCharacters(in: .whitespaces)
-        
-        // Remove inline comments
-        if let commentIndex = value.firstIndex(of: ";") {
-            value = String(value[..<commentIndex]).trimmingCharacters(in: .whitespaces)
-        }
+    /// File name from a key/value token (inline comment already removed), without surrounding quotes
+    private func fileReference(_ tokens: DEFTokenizer, _ token: DEFTokenizer.Token) -> String? {
+        var value = tokens.string(token.value)
         
         // Remove quotes if present
-        if value.hasPrefix("\"") && value.hasSuffix("\"") {
+        if value.count >= 2 && value.hasPrefix("\"") && value.hasSuffix("\"") {
             value = String(value.dropFirst().dropLast())
         }
         
@@ -487,26 +475,25 @@ public class ContentValidator {
     }
     
     /// Find the main .def file in a character folder
-    private func findMainDefFile(in folder: URL) -> URL? {
-        guard let contents = try? fileManager.contentsOfDirectory(at: folder, includingPropertiesForKeys: nil) else {
-            return nil
+    /// Uses the library's choice first; DEFs it rejects are still validated so broken characters get reported.
+    private func findMainDefFile(in folder: LibraryManifest.CharacterFolder) -> URL? {
+        if let defFile = folder.characterDefFile {
+            return defFile
         }
         
-        let defFiles = contents.filter { $0.pathExtension.lowercased() == "def" }
-        
         // Filter out storyboard files (intro*.def, ending*.def) - these are cutscene definitions, not character defs
-        let characterDefFiles = defFiles.filter { file in
+        let characterDefFiles = folder.defFiles.filter { file in
             let name = file.deletingPathExtension().lastPathComponent.lowercased()
             return !name.hasPrefix("intro") && !name.hasPrefix("ending")
         }
         
         // Prefer file matching folder name
-        let folderName = folder.lastPathComponent.lowercased()
+        let folderName = folder.name.lowercased()
         if let match = characterDefFiles.first(where: { $0.deletingPathExtension().lastPathComponent.lowercased() == folderName }) {
             return match
         }
         
-        // Otherwise return first valid .def file found
+        // Otherwise return first .def file found
         return characterDefFiles.first
     }
     
@@ -548,23 +535,9 @@ public class ContentValidator {
         return issues
     }
     
-    /// Read file content trying multiple encodings (MUGEN content uses various encodings)
+    /// Read file content with its detected encoding (MUGEN content uses various encodings)
     private func readFileContent(at url: URL) -> String? {
-        // Try common encodings in order of likelihood
-        let encodings: [String.Encoding] = [
-            .utf8,
-            .isoLatin1,        // ISO-8859-1 (common for old MUGEN content)
-            .windowsCP1252,    // Windows Latin-1
-            .ascii
-        ]
-        
-        for encoding in encodings {
-            if let content = try? String(contentsOf: url, encoding: encoding) {
-                return content
-            }
-        }
-        
-        return nil
+        return DEFParser.readFileContent(from: url)
     }
     
     // MARK: - Auto-Fix Methods
@@ -667,40 +640,17 @@ public class ContentValidator {
     
     /// Analyze a .def file to determine its actual content type
     public func detectContentType(defFile: URL) -> DetectedContentType {
-        guard let content = readFileContent(at: defFile) else {
+        guard let classification = DEFClassifier.shared.classify(defFile) else {
             return .unknown
         }
-        let lowercased = content.lowercased()
-        
-        // Storyboard: has [SceneDef] section
-        if lowercased.contains("[scenedef]") {
-            return .storyboard
-        }
-        
-        // Screenpack: system.def with screenpack sections
-        if defFile.lastPathComponent.lowercased() == "system.def" ||
-           lowercased.contains("[title info]") ||
-           lowercased.contains("[select info]") ||
-           lowercased.contains("[vs screen]") {
-            return .screenpack
-        }
         
-        // Character: has [Files] section with .cmd/.cns/.air references
-        if lowercased.contains("[files]") &&
-           (lowercased.contains(".cmd") || lowercased.contains(".cns") || lowercased.contains(".air")) {
-            return .character
+        switch classification.contentType {
+        case .character: return .character
+        case .stage: return .stage
+        case .storyboard: return .storyboard
+        case .screenpack: return .screenpack
+        case .font, .unknown: return .unknown
         }
-        
-        // Stage: has [StageInfo], [BGdef], or [BG ...] sections
-        let hasStageInfo = lowercased.contains("[stageinfo]")
-        let hasBGdef = lowercased.contains("[bgdef]")
-        let hasBGElements = lowercased.range(of: #"\[bg\s"#, options: .regularExpression) != nil
-        
-        if hasStageInfo || hasBGdef || hasBGElements {
-            return .stage
-        }
-        
-        return .unknown
     }
     
     /// Find all files that belong to a character based on its .def file
@@ -0,0 +1,145 @@
+import Foundation
+
+// MARK: - DEF Content Type
+
+/// What a .def file describes, judged from its sections and file references
+public enum DEFContentType {
+    case character
+    case stage
+    case storyboard  // intro/ending scenes
+    case font
+    case screenpack
+    case unknown
+}
+
+// MARK: - DEF Classification
+
+/// A .def file's content type together with its parsed values
+public struct DEFClassification {
+    public let contentType: DEFContentType
+    public let parsed: DEFParser.ParseResult
+
+    /// Stage name, including names hidden in a comment (see `DEFParser.extractStageName`)
+    /// Only set for stages.
+    public let stageName: String?
+}
+
+// MARK: - DEF Classifier
+
+/// Reads each .def file once and answers every "what is this file" question from that read
+///
+/// The character scan, stage scan, validator, importer and the info models all used to open
+/// and lowercase the same file separately. Results are cached by path and invalidated when
+/// the file's size or modification date changes.
+public final class DEFClassifier {
+
+    public static let shared = DEFClassifier()
+
+    // MARK: - Properties
+
+    private final class CachedClassification {
+        let fileSize: Int64
+        let modifiedAt: Double
+        let classification: DEFClassification
+
+        init(fileSize: Int64, modifiedAt: Double, classification: DEFClassification) {
+            self.fileSize = fileSize
+            self.modifiedAt = modifiedAt
+            self.classification = classification
+        }
+    }
+
+    private let cache: NSCache<NSString, CachedClassification>
+
+    // MARK: - Initialization
+
+    private init() {
+        cache = NSCache<NSString, CachedClassification>()
+        cache.name = "com.ikemenlab.DEFClassifier"
+        cache.countLimit = 5000
+    }
+
+    // MARK: - Classification
+
+    /// Classify a .def file, reusing the cached result if the file is unchanged
+    /// - Returns: nil if the file can't be read
+    public func classify(_ url: URL) -> DEFClassification? {
+        guard let identity = SFFDirectoryIndex.fileIdentity(of: url) else { return nil }
+        let key = url.standardizedFileURL.path as NSString
+
+        if let cached = cache.object(forKey: key),
+           cached.fileSize == identity.size, cached.modifiedAt == identity.modifiedAt {
+            return cached.classification
+        }
+
+        guard let data = try? Data(contentsOf: url) else { return nil }
+        let classification = DEFClassifier.classify(data: data, fileName: url.lastPathComponent)
+
+        cache.setObject(CachedClassification(fileSize: identity.size, modifiedAt: identity.modifiedAt,
+                                             classification: classification), forKey: key)
+        return classification
+    }
+
+    /// Drop every cached result
+    public func removeAll() {
+        cache.removeAllObjects()
+    }
+
+    /// Classify raw .def bytes
+    /// - Parameter fileName: Used to recognize a screenpack's system.def
+    public static func classify(data: Data, fileName: String) -> DEFClassification {
+        let parsed = DEFParser.parse(data: data)
+        let type = contentType(of: parsed, fileName: fileName)
+        let stageName = type == .stage ? DEFParser.extractStageName(data: data) : nil
+        return DEFClassification(contentType: type, parsed: parsed, stageName: stageName)
+    }
+
+    /// Decide the content type from a file's sections and values
+    static func contentType(of parsed: DEFParser.ParseResult, fileName: String) -> DEFContentType {
+        let sections = parsed.sectionValues.keys
+
+        // Storyboards (intros/endings) have a [SceneDef] section
+        if sections.contains("scenedef") {
+            return .storyboard
+        }
+
+        // Fonts have [Fnt] or [FNT v2] sections
+        if sections.contains("fnt") || sections.contains("fnt v2") {
+            return .font
+        }
+
+        // Screenpack: system.def with screenpack sections
+        if fileName.lowercased() == "system.def" ||
+           sections.contains("title info") ||
+           sections.contains("select info") ||
+           sections.contains("vs screen") {
+            return .screenpack
+        }
+
+        // Character: [Files] section with .cmd/.cns/.air references
+        // (a character wins over stage markers, e.g. a char that ships a [BGdef] for its intro)
+        if sections.contains("files") && referencesCharacterFiles(parsed) {
+            return .character
+        }
+
+        // Stage: [StageInfo], [BGdef], or [BG ...] sections
+        if sections.contains("stageinfo") || sections.contains("bgdef") ||
+           sections.contains(where: { $0.hasPrefix("bg ") || $0.hasPrefix("bg\t") }) {
+            return .stage
+        }
+
+        return .unknown
+    }
+
+    private static func referencesCharacterFiles(_ parsed: DEFParser.ParseResult) -> Bool {
+        func isCharacterFile(_ value: String) -> Bool {
+            let lowercased = value.lowercased()
+            return lowercased.contains(".cmd") || lowercased.contains(".cns") || lowercased.contains(".air")
+        }
+
+        if parsed.values.values.contains(where: isCharacterFile) {
+            return true
+        }
+        return parsed.sectionValues.values.contains { $0.values.contains(where: isCharacterFile) }
+    }
+}
@@ -6,23 +6,11 @@ import Foundation
 /// Handles INI-style key=value parsing with section tracking
 public struct DEFParser {
     
-    /// Common encodings used in MUGEN/Ikemen content from various regions
-    private static let fallbackEncodings: [String.Encoding] = [
-        .utf8,
-        .windowsCP1252,      // Western European (common for English MUGEN content)
-        .shiftJIS,           // Japanese (common for Japanese MUGEN content)
-        .isoLatin1,          // ISO Latin 1
-        .ascii               // Last resort
-    ]
-    
-    /// Read file content with fallback encodings for international MUGEN content
+    /// Read file content, detecting the encoding used by international MUGEN content
+    /// The file is read once and its encoding sniffed from the bytes (UTF-8, Shift-JIS or
+    /// Windows-1252); unchanged files are served from `TextFileCache`.
     public static func readFileContent(from url: URL) -> String? {
-        for encoding in fallbackEncodings {
-            if let content = try? String(contentsOf: url, encoding: encoding) {
-                return content
-            }
-        }
-        return nil
+        return TextFileCache.shared.string(contentsOf: url)
     }
     
     /// Parsed result from a DEF file
@@ -57,114 +45,95 @@ public struct DEFParser {
     }
     
     /// Parse a DEF file from a URL
+    /// Files are read and classified once by `DEFClassifier`; unchanged files reuse that result.
     public static func parse(url: URL) -> ParseResult? {
-        guard let content = readFileContent(from: url) else {
-            return nil
-        }
-        return parse(content: content)
+        return DEFClassifier.shared.classify(url)?.parsed
     }
     
     /// Extract the stage name, handling quirky files where real name is in a comment
     /// e.g., name = "O";"Avalon" -> returns "Avalon"
     public static func extractStageName(from url: URL) -> String? {
-        guard let content = readFileContent(from: url) else {
+        guard let data = try? Data(contentsOf: url) else {
             return nil
         }
-        
-        let lines = content.components(separatedBy: .newlines)
-        
-        for line in lines {
-            let trimmed = line.trimmingCharacters(in: .whitespaces)
-            
-            // Skip comments and empty lines
-            if trimmed.isEmpty || trimmed.hasPrefix(";") { continue }
-            
-            // Look for name = ...
-            guard let equalsIndex = trimmed.firstIndex(of: "=") else { continue }
-            let key = String(trimmed[..<equalsIndex]).trimmingCharacters(in: .whitespaces).lowercased()
-            
-            if key == "name" || key == "displayname" {
-                let valueAndComment = String(trimmed[trimmed.index(after: equalsIndex)...]).trimmingCharacters(in: .whitespaces)
+        return extractStageName(data: data)
+    }
+    
+    /// Extract the stage name from raw DEF bytes
+    public static func extractStageName(data: Data) -> String? {
+        return DEFTokenizer.scan(data) { tokens -> String? in
+            var result: String?
+            tokens.forEachToken { token in
+                guard token.kind == .keyValue,
+                      tokens.matches(token.name, "name") || tokens.matches(token.name, "displayname") else {
+                    return true
+                }
+                
+                let value = tokens.string(token.value, removingQuotes: true)
                 
                 // Check if there's a semicolon with a better name after it
                 // Pattern: "X";"Real Name" or "X" ; "Real Name"
-                if let semicolonIndex = valueAndComment.firstIndex(of: ";") {
-                    let beforeSemicolon = String(valueAndComment[..<semicolonIndex])
-                        .trimmingCharacters(in: .whitespaces)
-                        .replacingOccurrences(of: "\"", with: "")
-                    
-                    let afterSemicolon = String(valueAndComment[valueAndComment.index(after: semicolonIndex)...])
-                        .trimmingCharacters(in: .whitespaces)
-                        .replacingOccurrences(of: "\"", with: "")
+                if let comment = token.comment {
+                    let afterSemicolon = tokens.string(comment, removingQuotes: true)
                     
                     // If before semicolon is very short (1-2 chars) and after is longer,
                     // the real name is probably in the comment
-                    if beforeSemicolon.count <= 2 && afterSemicolon.count > beforeSemicolon.count {
-                        return afterSemicolon
+                    if value.count <= 2 && afterSemicolon.count > value.count {
+                        result = afterSemicolon
+                        return false
                     }
-                    
-                    // Otherwise use the value before semicolon
-                    return beforeSemicolon.isEmpty ? nil : beforeSemicolon
                 }
                 
-                // No semicolon, just return the cleaned value
-                let cleanValue = valueAndComment.replacingOccurrences(of: "\"", with: "")
-                return cleanValue.isEmpty ? nil : cleanValue
+                // Otherwise use the value before any semicolon
+                result = value.isEmpty ? nil : value
+                return false
             }
+            return result
         }
-        
-        return nil
     }
     
     /// Parse DEF file content string
     public static func parse(content: String) -> ParseResult {
+        return parse(data: Data(content.utf8))
+    }
+    
+    /// Parse raw DEF file bytes in a single pass
+    /// Only section names, keys and values are materialized as strings; comments are skipped
+    /// without being decoded.
+    public static func parse(data: Data) -> ParseResult {
         var values: [String: String] = [:]
         var sectionValues: [String: [String: String]] = [:]
         var currentSection: String? = nil
         
-        let lines = content.components(separatedBy: .newlines)
-        
-        for line in lines {
-            let trimmed = line.trimmingCharacters(in: .whitespaces)
-            
-            // Skip empty lines and comments
-            if trimmed.isEmpty || trimmed.hasPrefix(";") {
-                continue
-            }
-            
-            // Check for section header [SectionName]
-            if trimmed.hasPrefix("[") && trimmed.contains("]") {
-                if let endIndex = trimmed.firstIndex(of: "]") {
-                    let sectionName = String(trimmed[trimmed.index(after: trimmed.startIndex)..<endIndex])
-                    currentSection = sectionName.lowercased()
-                    if sectionValues[currentSection!] == nil {
-                        sectionValues[currentSection!] = [:]
+        DEFTokenizer.scan(data) { tokens in
+            tokens.forEachToken { token in
+                switch token.kind {
+                case .section:
+                    let sectionName = tokens.lowercasedString(token.name)
+                    currentSection = sectionName
+                    if sectionValues[sectionName] == nil {
+                        sectionValues[sectionName] = [:]
+                    }
+                    
+                case .keyValue:
+                    let key = tokens.lowercasedString(token.name)
+                    
+                    // Quotes are decorative; inline comments are already cut off
+                    let value = tokens.string(token.value, removingQuotes: true)
+                    
+                    // Store in appropriate location
+                    if let section = currentSection {
+                        sectionValues[section]?[key] = value
                     }
+                    
+                    // Also store in flat values (last occurrence wins for duplicates)
+                    values[key] = value
+                    
+                case .comment:
+                    break
                 }
-                continue
-            }
-            
-            // Parse key = value
-            guard let equalsIndex = trimmed.firstIndex(of: "=") else { continue }
-            
-            let key = String(trimmed[..<equalsIndex]).trimmingCharacters(in: .whitespaces).lowercased()
-            var value = String(trimmed[trimmed.index(after: equalsIndex)...]).trimmingCharacters(in: .whitespaces)
-            
-            // Remove inline comments (after semicolon)
-            if let commentIndex = value.firstIndex(of: ";") {
-                value = String(value[..<commentIndex]).trimmingCharacters(in: .whitespaces)
-            }
-            
-            // Remove surrounding quotes
-            value = value.replacingOccurrences(of: "\"", with: "")
-            
-            // Store in appropriate location
-            if let section = currentSection {
-                sectionValues[section]?[key] = value
+                return true
             }
-            
-            // Also store in flat values (last occurrence wins for duplicates)
-            values[key] = value
         }
         
         return ParseResult(values: values, sectionValues: sectionValues)
@@ -175,72 +144,21 @@ public struct DEFParser {
     /// Check if a .def file is a storyboard (intro/ending scene)
     /// Storyboards have [SceneDef] section and should not be treated as characters
     public static func isStoryboardDefFile(_ url: URL) -> Bool {
-        guard let content = readFileContent(from: url) else { return false }
-        return content.lowercased().contains("[scenedef]")
+        return DEFClassifier.shared.classify(url)?.contentType == .storyboard
     }
     
     /// Check if a .def file is a valid character definition (not a storyboard, stage, font, etc.)
+    /// Valid characters have a [Files] section with .cmd, .cns, or .air references.
     /// Used by EmulatorBridge to filter valid characters
     public static func isValidCharacterDefFile(_ url: URL) -> Bool {
-        guard let content = readFileContent(from: url) else { return false }
-        let lowercased = content.lowercased()
-        
-        // Exclude storyboards (intros/endings) - they have [SceneDef] section
-        if lowercased.contains("[scenedef]") {
-            return false
-        }
-        
-        // Exclude font files - they have [Fnt] or [FNT v2] sections
-        if lowercased.contains("[fnt]") || lowercased.contains("[fnt v2]") {
-            return false
-        }
-        
-        // Exclude stages - they have [StageInfo] or [BGdef] but no [Files] with character files
-        if lowercased.contains("[stageinfo]") || lowercased.contains("[bgdef]") {
-            // Could be a stage, check if it has character files
-            if !(lowercased.contains("[files]") &&
-                 (lowercased.contains(".cmd") || lowercased.contains(".cns") || lowercased.contains(".air"))) {
-                return false
-            }
-        }
-        
-        // Valid characters have [Files] section with .cmd, .cns, or .air references
-        if lowercased.contains("[files]") &&
-           (lowercased.contains(".cmd") || lowercased.contains(".cns") || lowercased.contains(".air")) {
-            return true
-        }
-        
-        return false
+        return DEFClassifier.shared.classify(url)?.contentType == .character
     }
     
     /// Check if a .def file is actually a stage definition (not a character, storyboard, font, etc.)
+    /// Valid stages have [StageInfo], [BGdef], or [BG ] sections.
     /// Used by both EmulatorBridge and MetadataStore to filter valid stages
     public static func isValidStageDefFile(_ url: URL) -> Bool {
-        guard let content = readFileContent(from: url) else { return false }
-        let lowercased = content.lowercased()
-        
-        // Exclude storyboards (intros/endings) - they have [SceneDef] section
-        if lowercased.contains("[scenedef]") {
-            return false
-        }
-        
-        // Exclude character definitions - they have [Files] with .cmd, .cns, .air
-        if lowercased.contains("[files]") &&
-           (lowercased.contains(".cmd") || lowercased.contains(".cns") || lowercased.contains(".air")) {
-            return false
-        }
-        
-        // Exclude font files - they have [Fnt] or [FNT v2] sections
-        if lowercased.contains("[fnt]") || lowercased.contains("[fnt v2]") {
-            return false
-        }
-        
-        // Valid stages have [StageInfo], [BGdef], or [BG ] sections
-        let hasStageInfo = lowercased.contains("[stageinfo]")
-        let hasBGdef = lowercased.contains("[bgdef]")
-        let hasBGElements = lowercased.range(of: #"\[bg\s"#, options: .regularExpression) != nil
-        
-        return hasStageInfo || hasBGdef || hasBGElements
+        return DEFClassifier.shared.classify(url)?.contentType == .stage
     }
 }
 
@@ -292,11 +210,27 @@ extension DEFParser.ParseResult {
         return false
     }
     
+    /// Palette files from the [Files] section (pal1 through pal12), keyed by palette number
+    public var paletteFiles: [Int: String] {
+        var files: [Int: String] = [:]
+        for number in 1...12 {
+            if let file = value(for: "pal\(number)", inSection: "files"), !file.isEmpty {
+                files[number] = file
+            }
+        }
+        return files
+    }
+    
     /// Get the CNS file reference (for characters)
     public var cnsFile: String? {
         return value(for: "cns")
     }
     
+    /// Get the AIR (animation) file reference (for characters)
+    public var animFile: String? {
+        return value(for: "anim")
+    }
+    
     /// Get the CMD file reference (for characters)
     public var cmdFile: String? {
         return value(for: "cmd")
@@ -322,58 +256,203 @@ public struct CNSParser {
         public static let maxAttack = 200
         public static let maxDefence = 200
         public static let maxPower = 5000
+        
+        /// MUGEN's defaults, used when a character has no readable [Data] section
+        public static let defaults = CharacterStats(life: 1000, attack: 100, defence: 100, power: 3000, airJuggle: 15, fallDefenceUp: 50)
     }
     
+    /// Stats read from a CNS file
+    public struct StatsReadResult {
+        public let stats: CharacterStats
+        /// Whether the file had a [Data] section (otherwise `stats` are defaults)
+        public let foundData: Bool
+    }
+    
+    /// Bytes read per chunk when streaming a CNS file
+    static let chunkSize = 64 * 1024
+    
     /// Parse CNS file from URL
     public static func parseStats(from url: URL) -> CharacterStats? {
-        guard let content = DEFParser.readFileContent(from: url) else {
-            return nil
-        }
-        return parseStats(content: content)
+        return readStats(from: url)?.stats
     }
     
     /// Parse CNS content string for stats
     public static func parseStats(content: String) -> CharacterStats {
-        // Use DEFParser since CNS uses same INI-like format
-        let parsed = DEFParser.parse(content: content)
+        return parseStats(data: Data(content.utf8))
+    }
+    
+    /// Parse raw CNS bytes for stats
+    /// Only integers in the [Data] section are read, straight from the bytes; the thousands of
+    /// state controller lines after it are never tokenized.
+    public static func parseStats(data: Data) -> CharacterStats {
+        return readStats(data: data).stats
+    }
+    
+    /// Read [Data] from CNS bytes that are already in memory
+    public static func readStats(data: Data) -> StatsReadResult {
+        var collector = StatsCollector()
+        _ = collector.consume(data)
+        return collector.result
+    }
+    
+    /// Stream a CNS file in fixed-size chunks until [Data] has been read
+    /// [Data] sits at the top of almost every CNS, so multi-MB files with thousands of state
+    /// controllers usually stop after the first chunk.
+    /// - Returns: nil if the file can't be opened
+    public static func readStats(from url: URL) -> StatsReadResult? {
+        guard let handle = try? FileHandle(forReadingFrom: url) else { return nil }
+        defer { try? handle.close() }
         
-        // Extract values from [Data] section
-        let life = parsed.intValue(for: "life", inSection: "data", default: 1000)
-        let attack = parsed.intValue(for: "attack", inSection: "data", default: 100)
-        let defence = parsed.intValue(for: "defence", inSection: "data", default: 100)
-        let power = parsed.intValue(for: "power", inSection: "data", default: 3000)
-        let airJuggle = parsed.intValue(for: "airjuggle", inSection: "data", default: 15)
-        let fallDefenceUp = parsed.intValue(for: "fall.defence_up", inSection: "data", default: 50)
+        var collector = StatsCollector()
+        var pending = Data()
+        var finished = false
         
-        return CharacterStats(
-            life: life,
-            attack: attack,
-            defence: defence,
-            power: power,
-            airJuggle: airJuggle,
-            fallDefenceUp: fallDefenceUp
-        )
+        while !finished {
+            guard let chunk = try? handle.read(upToCount: chunkSize), !chunk.isEmpty else { break }
+            pending.append(chunk)
+            
+            // Only complete lines are tokenized; a partial last line waits for the next chunk
+            guard let lastBreak = pending.lastIndex(where: { $0 == 0x0A || $0 == 0x0D }) else { continue }
+            finished = !collector.consume(pending[pending.startIndex...lastBreak])
+            pending = Data(pending[(lastBreak + 1)...])
+        }
+        
+        if !finished && !pending.isEmpty {
+            _ = collector.consume(pending)
+        }
+        return collector.result
     }
     
-    /// Get stats for a character by finding and parsing their CNS file
-    public static func getStats(for characterDirectory: URL, defFile: URL) -> CharacterStats {
-        // Parse DEF file to get CNS reference
-        guard let defContent = DEFParser.readFileContent(from: defFile) else {
-            return CharacterStats(life: 1000, attack: 100, defence: 100, power: 3000, airJuggle: 15, fallDefenceUp: 50)
-        }
+    /// Accumulates [Data] values across chunks of a CNS file
+    private struct StatsCollector {
+        private var inData = false
+        private var foundData = false
         
-        let defParsed = DEFParser.parse(content: defContent)
+        private var life: Int?
+        private var attack: Int?
+        private var defence: Int?
+        private var power: Int?
+        private var airJuggle: Int?
+        private var fallDefenceUp: Int?
         
-        // Get CNS file path from [Files] section or root
-        let cnsPath = defParsed.value(for: "cns", inSection: "files") ?? defParsed.value(for: "cns")
+        /// Tokenize a run of complete lines
+        /// - Returns: false once the [Data] section has been read
+        mutating func consume(_ data: Data) -> Bool {
+            var keepReading = true
+            
+            DEFTokenizer.scan(data) { tokens in
+                tokens.forEachToken { token in
+                    switch token.kind {
+                    case .section:
+                        // Leaving [Data] means it's complete
+                        if inData {
+                            keepReading = false
+                            return false
+                        }
+                        if tokens.matches(token.name, "data") {
+                            inData = true
+                            foundData = true
+                        }
+                        
+                    case .keyValue where inData:
+                        // Last occurrence wins; unparseable values fall back to the default
+                        let key = token.name
+                        if tokens.matches(key, "life") {
+                            life = tokens.int(token.value)
+                        } else if tokens.matches(key, "attack") {
+                            attack = tokens.int(token.value)
+                        } else if tokens.matches(key, "defence") {
+                            defence = tokens.int(token.value)
+                        } else if tokens.matches(key, "power") {
+                            power = tokens.int(token.value)
+                        } else if tokens.matches(key, "airjuggle") {
+                            airJuggle = tokens.int(token.value)
+                        } else if tokens.matches(key, "fall.defence_up") {
+                            fallDefenceUp = tokens.int(token.value)
+                        }
+                        
+                    default:
+                        break
+                    }
+                    return true
+                }
+            }
+            return keepReading
+        }
         
-        guard let cnsFileName = cnsPath else {
-            return CharacterStats(life: 1000, attack: 100, defence: 100, power: 3000, airJuggle: 15, fallDefenceUp: 50)
+        var result: StatsReadResult {
+            let stats = CharacterStats(
+                life: life ?? 1000,
+                attack: attack ?? 100,
+                defence: defence ?? 100,
+                power: power ?? 3000,
+                airJuggle: airJuggle ?? 15,
+                fallDefenceUp: fallDefenceUp ?? 50
+            )
+            return StatsReadResult(stats: stats, foundData: foundData)
         }
+    }
+    
+    /// Get stats for a character by finding and parsing their CNS file
+    /// The `cns` entry is searched first, then any `st`/`st0`-`st9` state files, stopping at
+    /// the first one with a [Data] section.
+    public static func getStats(for characterDirectory: URL, defFile: URL) -> CharacterStats {
+        return readStats(for: characterDirectory, defFile: defFile)?.stats ?? CharacterStats.defaults
+    }
+    
+    /// Read [Data] for a character from the files its DEF lists
+    /// - Returns: nil if none of the listed files has a [Data] section
+    public static func readStats(for characterDirectory: URL, defFile: URL) -> StatsReadResult? {
+        // Parse DEF file to get CNS references
+        guard let defParsed = DEFParser.parse(url: defFile) else { return nil }
         
-        // Resolve CNS file path relative to character directory
-        let cnsFile = characterDirectory.appendingPathComponent(cnsFileName)
+        for file in stateFiles(for: characterDirectory, defParsed: defParsed) {
+            if let result = readStats(from: file), result.foundData {
+                return result
+            }
+        }
+        return nil
+    }
+    
+    /// The `cns` file followed by the distinct `st`/`st0`-`st9` state files a DEF lists
+    public static func stateFiles(for characterDirectory: URL, defParsed: DEFParser.ParseResult) -> [URL] {
+        let keys = ["cns", "st"] + (0...9).map { "st\($0)" }
+        var seen = Set<String>()
+        var files: [URL] = []
         
-        return parseStats(from: cnsFile) ?? CharacterStats(life: 1000, attack: 100, defence: 100, power: 3000, airJuggle: 15, fallDefenceUp: 50)
+        for key in keys {
+            // Get file path from [Files] section or root
+            guard let fileName = defParsed.value(for: key, inSection: "files") ?? defParsed.value(for: key),
+                  !fileName.isEmpty, seen.insert(fileName.lowercased()).inserted else {
+                continue
+            }
+            
+            // Resolve file path relative to character directory
+            files.append(characterDirectory.appendingPathComponent(fileName))
+        }
+        return files
+    }
+    
+    // MARK: - State Counting
+    
+    /// Count the [Statedef] blocks in a CNS/ST file
+    /// - Returns: nil if the file can't be read
+    public static func stateCount(in url: URL) -> Int? {
+        guard let data = try? Data(contentsOf: url) else { return nil }
+        return stateCount(data: data)
+    }
+    
+    /// Count the [Statedef] blocks in raw CNS/ST bytes
+    public static func stateCount(data: Data) -> Int {
+        var count = 0
+        DEFTokenizer.scan(data) { tokens in
+            tokens.forEachToken { token in
+                if token.kind == .section && tokens.hasPrefix(token.name, "statedef") {
+                    count += 1
+                }
+                return true
+            }
+        }
+        return count
     }
 }
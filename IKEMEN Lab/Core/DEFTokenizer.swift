@@ -0,0 +1,230 @@
+import Foundation
+
+// MARK: - DEF Tokenizer
+
+/// Single-pass tokenizer for MUGEN/Ikemen INI-style files (.def, .cns, .cmd, .st)
+///
+/// Scans the raw bytes once and reports each meaningful line as a token whose parts are byte
+/// ranges into the file - nothing is copied or decoded until a parser asks for a string.
+/// Keys and section names are compared with ASCII case folding on the fly, so matching
+/// `[Data]` or `Life` never allocates a lowercased copy of the line.
+///
+/// Every delimiter (`[ ] = ; " CR LF`) is ASCII, which is safe for UTF-8, Windows-1252 and
+/// Latin-1 content; only values are decoded with the file's text encoding, which is detected
+/// once per file in `scan` because short slices are too ambiguous to detect on their own.
+struct DEFTokenizer {
+
+    // MARK: - Tokens
+
+    enum TokenKind {
+        /// `[Name]` - `name` is the text between the brackets
+        case section
+        /// `key = value ; comment`
+        case keyValue
+        /// A line starting with `;` - `name` is the text after it
+        case comment
+    }
+
+    struct Token {
+        let kind: TokenKind
+        /// Section name, key, or comment text (trimmed)
+        let name: Range<Int>
+        /// Value up to the first `;` (trimmed); empty for sections and comments
+        let value: Range<Int>
+        /// Text after the first `;` of a key/value line (trimmed), if there is one
+        let comment: Range<Int>?
+    }
+
+    // MARK: - Properties
+
+    /// The bytes being tokenized; only valid inside `scan`
+    let bytes: UnsafeBufferPointer<UInt8>
+    /// Text encoding detected over the whole buffer, used to decode values
+    let encoding: String.Encoding
+
+    // MARK: - Scanning
+
+    /// Run `body` with a tokenizer over the data
+    static func scan<Result>(_ data: Data, _ body: (DEFTokenizer) throws -> Result) rethrows -> Result {
+        return try data.withUnsafeBytes { raw in
+            let bytes = raw.bindMemory(to: UInt8.self)
+            return try body(DEFTokenizer(bytes: bytes, encoding: TextEncodingDetector.detect(bytes)))
+        }
+    }
+
+    /// Visit every token in file order
+    /// Lines that are empty or have no `=` (and aren't sections or comments) produce no token.
+    /// - Parameter body: Return false to stop scanning
+    func forEachToken(_ body: (Token) throws -> Bool) rethrows {
+        let count = bytes.count
+        var lineStart = 0
+
+        // UTF-8 byte order mark
+        if count >= 3 && bytes[0] == 0xEF && bytes[1] == 0xBB && bytes[2] == 0xBF {
+            lineStart = 3
+        }
+
+        while lineStart < count {
+            var lineEnd = lineStart
+            while lineEnd < count && bytes[lineEnd] != 0x0A && bytes[lineEnd] != 0x0D {
+                lineEnd += 1
+            }
+
+            if let token = token(from: lineStart, to: lineEnd), try !body(token) {
+                return
+            }
+            lineStart = lineEnd + 1
+        }
+    }
+
+    private func token(from start: Int, to end: Int) -> Token? {
+        var i = start
+        while i < end && isBlank(bytes[i]) { i += 1 }
+        guard i < end else { return nil }
+
+        switch bytes[i] {
+        case UInt8(ascii: ";"):
+            return Token(kind: .comment, name: trimmed(i + 1, end), value: end..<end, comment: nil)
+
+        case UInt8(ascii: "["):
+            var close = i + 1
+            while close < end && bytes[close] != UInt8(ascii: "]") { close += 1 }
+            if close < end {
+                return Token(kind: .section, name: trimmed(i + 1, close), value: end..<end, comment: nil)
+            }
+            // No closing bracket: treat it like any other line
+
+        default:
+            break
+        }
+
+        var equals = i
+        while equals < end && bytes[equals] != UInt8(ascii: "=") && bytes[equals] != UInt8(ascii: ";") {
+            equals += 1
+        }
+        guard equals < end, bytes[equals] == UInt8(ascii: "=") else { return nil }
+
+        var semicolon = equals + 1
+        while semicolon < end && bytes[semicolon] != UInt8(ascii: ";") { semicolon += 1 }
+
+        return Token(kind: .keyValue,
+                     name: trimmed(i, equals),
+                     value: trimmed(equals + 1, semicolon),
+                     comment: semicolon < end ? trimmed(semicolon + 1, end) : nil)
+    }
+
+    @inline(__always)
+    private func isBlank(_ byte: UInt8) -> Bool {
+        return byte == 0x20 || byte == 0x09
+    }
+
+    private func trimmed(_ start: Int, _ end: Int) -> Range<Int> {
+        var lower = start
+        var upper = end
+        while lower < upper && isBlank(bytes[lower]) { lower += 1 }
+        while upper > lower && isBlank(bytes[upper - 1]) { upper -= 1 }
+        return lower..<upper
+    }
+
+    // MARK: - Case-Folded Matching
+
+    @inline(__always)
+    static func fold(_ byte: UInt8) -> UInt8 {
+        return byte &- 0x41 < 26 ? byte | 0x20 : byte
+    }
+
+    /// Whether the slice equals `lowercased`, ignoring ASCII case
+    func matches(_ range: Range<Int>, _ lowercased: StaticString) -> Bool {
+        guard range.count == lowercased.utf8CodeUnitCount else { return false }
+        return hasPrefix(range, lowercased)
+    }
+
+    /// Whether the slice starts with `lowercased`, ignoring ASCII case
+    func hasPrefix(_ range: Range<Int>, _ lowercased: StaticString) -> Bool {
+        let length = lowercased.utf8CodeUnitCount
+        guard range.count >= length else { return false }
+
+        let expected = lowercased.utf8Start
+        for offset in 0..<length where DEFTokenizer.fold(bytes[range.lowerBound + offset]) != expected[offset] {
+            return false
+        }
+        return true
+    }
+
+    /// Whether the slice contains `lowercased`, ignoring ASCII case
+    func contains(_ range: Range<Int>, _ lowercased: StaticString) -> Bool {
+        let length = lowercased.utf8CodeUnitCount
+        guard length > 0, range.count >= length else { return length == 0 }
+
+        for start in range.lowerBound...(range.upperBound - length)
+            where hasPrefix(start..<range.upperBound, lowercased) {
+            return true
+        }
+        return false
+    }
+
+    // MARK: - Values
+
+    /// Parse a decimal integer (optional sign, digits only) without creating a String
+    func int(_ range: Range<Int>) -> Int? {
+        var i = range.lowerBound
+        var negative = false
+        if i < range.upperBound && (bytes[i] == UInt8(ascii: "-") || bytes[i] == UInt8(ascii: "+")) {
+            negative = bytes[i] == UInt8(ascii: "-")
+            i += 1
+        }
+        guard i < range.upperBound, range.upperBound - i <= 18 else { return nil }
+
+        var value = 0
+        while i < range.upperBound {
+            let digit = bytes[i] &- 0x30
+            guard digit < 10 else { return nil }
+            value = value * 10 + Int(digit)
+            i += 1
+        }
+        return negative ? -value : value
+    }
+
+    /// Key or section name as a lowercased String (ASCII folding only)
+    func lowercasedString(_ range: Range<Int>) -> String {
+        guard !range.isEmpty else { return "" }
+        guard isASCII(range) else { return string(range).lowercased() }
+
+        return String(unsafeUninitializedCapacity: range.count) { buffer in
+            for offset in 0..<range.count {
+                buffer[offset] = DEFTokenizer.fold(bytes[range.lowerBound + offset])
+            }
+            return range.count
+        }
+    }
+
+    /// Decode a slice as text in the file's encoding
+    /// - Parameter removingQuotes: Drop every `"` in the slice (MUGEN quotes are decorative)
+    func string(_ range: Range<Int>, removingQuotes: Bool = false) -> String {
+        guard !range.isEmpty else { return "" }
+        let slice = UnsafeBufferPointer(rebasing: bytes[range])
+
+        if removingQuotes && slice.contains(UInt8(ascii: "\"")) {
+            return decode(slice.filter { $0 != UInt8(ascii: "\"") })
+        }
+        return decode(slice)
+    }
+
+    /// Decode bytes with `encoding`, falling back to Latin-1 (which accepts any byte)
+    private func decode<Bytes: Sequence>(_ slice: Bytes) -> String where Bytes.Element == UInt8 {
+        if encoding == .utf8 {
+            // The whole buffer validated as UTF-8, and slices end on ASCII delimiters
+            return String(decoding: slice, as: UTF8.self)
+        }
+        return String(bytes: slice, encoding: encoding)
+            ?? String(bytes: slice, encoding: .isoLatin1)
+            ?? String(decoding: slice, as: UTF8.self)
+    }
+
+    private func isASCII(_ range: Range<Int>) -> Bool {
+        for index in range where bytes[index] >= 0x80 {
+            return false
+        }
+        return true
+    }
+}
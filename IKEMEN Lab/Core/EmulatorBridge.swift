@@ -127,6 +127,10 @@ class IkemenBridge: ObservableObject {
     @Published private(set) var stages: [StageInfo] = []
     @Published private(set) var screenpacks: [ScreenpackInfo] = []
     @Published private(set) var activeScreenpackPath: String?
+    /// Progress of the character or stage scan in flight, nil when no scan is running
+    @Published private(set) var libraryScanProgress: LibraryScanner.Progress?
+    /// Content kind `libraryScanProgress` belongs to (.characters or .stages)
+    @Published private(set) var libraryScanContent: LibraryScanner.Scope = []
     
     // MARK: - Process
     
@@ -173,8 +177,24 @@ class IkemenBridge: ObservableObject {
                 break
             }
         }
+        
+        startWatchingLibrary()
     }
     
+    // In-flight library scan; later scans wait for it so results publish in order
+    private var currentScan: Task<Void, Never>?
+    private var currentScanScope: LibraryScanner.Scope = []
+    // Every scan queued or running, so cancelLibraryScan() stops the whole chain
+    private var pendingScans: [UUID: Task<Void, Never>] = [:]
+    
+    // The published lists are partial results of a scan still filling them in
+    private var showingPartialCharacters = false
+    private var showingPartialStages = false
+    private let scanLock = NSLock()
+    
+    // Pushes changes made to chars/, stages/ and data/ outside the app
+    private var libraryWatcher: LibraryWatcher?
+    
     // For tracking the launched app
     private var launchedAppPID: pid_t?
     private var terminationObserver: NSObjectProtocol?
@@ -197,7 +217,7 @@ class IkemenBridge: ObservableObject {
         
         createDirectoriesIfNeeded()
         findEngine()
-        loadContent()
+        startWatchingLibrary()
         setupTerminationObserver()
         setupCollectionObserver()
         
@@ -365,189 +385,369 @@ class IkemenBridge: ObservableObject {
     // MARK: - Content Management
     
     /// Reload all content from disk
-    func loadContent() {
-        loadCharacters()
-        loadStages()
-        loadScreenpacks()
+    /// Characters, stages and screenpacks are scanned off the main thread and published together.
+    /// - Parameter completion: Called on the main queue once the new content is published
+    func loadContent(completion: (() -> Void)? = nil) {
+        scanContent(.all, completion: completion)
+    }
+    
+    /// Publish the library stored by the last scan right away, then reconcile it with disk
+    ///
+    /// Characters and stages are decoded from MetadataStore's library snapshot in one query, with
+    /// no DEF parsed, and the first screen of grid thumbnails is preloaded from the database. The
+    /// rescan that follows is snapshot-backed: it only re-parses folders that changed and only
+    /// republishes lists that differ from what is already shown. Call once the database is open.
+    func loadContentFromSnapshot() {
+        enqueueScan(completion: nil) { bridge, workingDir in
+            await bridge.hydrateFromSnapshot(in: workingDir)
+        }
+        scanContent(.all)
     }
     
     /// Refresh stages list from disk
     func refreshStages() {
-        loadStages()
+        scanContent(.stages)
     }
     
-    /// Load all characters from the chars directory
-    private func loadCharacters() {
-        var foundCharacters: [CharacterInfo] = []
-        let fileManager = FileManager.default
+    /// Reload screenpacks (e.g. after the active motif changes)
+    private func loadScreenpacks() {
+        scanContent(.screenpacks)
+    }
+    
+    /// Scan the requested content kinds and publish them in a single main-queue update
+    private func scanContent(_ scope: LibraryScanner.Scope, completion: (() -> Void)? = nil) {
+        enqueueScan(replacing: scope, completion: completion) { bridge, workingDir in
+            await bridge.scanLibrary(scope, in: workingDir)
+        }
+    }
+    
+    /// Re-parse only the library entries a filesystem change touched and publish the result
+    /// - Parameter completion: Called on the main queue once the update is published
+    func applyLibraryChanges(_ changes: LibraryChangeSet, completion: (() -> Void)? = nil) {
+        guard !changes.isEmpty else { return }
+        // Consumers outside the scan (validation, reindex) must not reuse the old chars/ listing
+        if changes.rescanCharacters || !changes.characterFolders.isEmpty {
+            LibraryManifest.invalidate()
+        }
+        enqueueScan(completion: completion) { bridge, workingDir in
+            await bridge.scanChanges(changes, in: workingDir)
+        }
+    }
+    
+    /// Watch the working directory's library folders and apply their changes as they happen
+    private func startWatchingLibrary() {
+        libraryWatcher?.stop()
+        libraryWatcher = nil
         
-        // Scan the chars directory in the engine's working directory
         guard let workingDir = engineWorkingDirectory else { return }
-        let engineCharsPath = workingDir.appendingPathComponent("chars")
-        
-        // Parse select.def status
-        let (activeSet, disabledSet, selectDefOrder) = parseSelectDefStatus(in: workingDir)
-        
-        guard let charDirs = try? fileManager.contentsOfDirectory(at: engineCharsPath, includingPropertiesForKeys: [.isDirectoryKey]) else {
-            return
+        let watcher = LibraryWatcher(root: workingDir) { [weak self] changes in
+            self?.applyLibraryChanges(changes)
         }
+        watcher.start()
+        libraryWatcher = watcher
+    }
+    
+    /// Run a scan off the main thread and publish its result
+    ///
+    /// Scans are chained so they publish in the order they were requested; a stage-only refresh
+    /// started during a full rescan can't be overwritten by the older results. A rescan covering
+    /// everything the previous request covers makes that one stale, so it is cancelled instead of
+    /// being left to finish and publish first.
+    /// - Parameter scope: Content this scan rescans from scratch; empty for targeted updates
+    private func enqueueScan(replacing scope: LibraryScanner.Scope = [],
+                             completion: (() -> Void)?,
+                             _ scan: @escaping (IkemenBridge, URL) async -> LibraryScanResult) {
+        guard let workingDir = engineWorkingDirectory else { return }
         
-        for charDir in charDirs {
-            var isDirectory: ObjCBool = false
-            guard fileManager.fileExists(atPath: charDir.path, isDirectory: &isDirectory), isDirectory.boolValue else {
-                continue
-            }
+        scanLock.lock()
+        let previousScan = currentScan
+        if !currentScanScope.isEmpty && scope.isSuperset(of: currentScanScope) {
+            previousScan?.cancel()
+        }
+        currentScanScope = scope
+        let scanId = UUID()
+        let scanTask = Task.detached(priority: .userInitiated) { [weak self] in
+            await previousScan?.value
+            guard let self = self else { return }
             
-            // Look for .def file
-            let defName = charDir.lastPathComponent + ".def"
-            let directDefFile = charDir.appendingPathComponent(defName)
-            var targetDefFile: URL?
-
-            if fileManager.fileExists(atPath: directDefFile.path) && DEFParser.isValidCharacterDefFile(directDefFile) {
-                targetDefFile = directDefFile
-            } else {
-                // Try to find a suitable .def file in the directory
-                if let contents = try? fileManager.contentsOfDirectory(at: charDir, includingPropertiesForKeys: nil) {
-                    let defFiles = contents.filter { $0.pathExtension.lowercased() == "def" }
-                    // Filter to only valid character def files
-                    let characterDefFiles = defFiles.filter { DEFParser.isValidCharacterDefFile($0) }
-                    
-                    // Prefer def file matching folder name, otherwise take first valid one
-                    let folderName = charDir.lastPathComponent.lowercased()
-                    let preferredDef = characterDefFiles.first { file in
-                        file.deletingPathExtension().lastPathComponent.lowercased() == folderName
-                    } ?? characterDefFiles.first
-                    
-                    targetDefFile = preferredDef
+            let result = Task.isCancelled ? LibraryScanResult() : await scan(self, workingDir)
+            let cancelled = Task.isCancelled
+            
+            await MainActor.run {
+                self.scanLock.lock()
+                self.pendingScans[scanId] = nil
+                self.scanLock.unlock()
+                
+                // A cancelled scan's partial results are dropped; the scan that replaced it publishes
+                if cancelled {
+                    self.libraryScanProgress = nil
+                } else {
+                    self.publish(result)
                 }
+                completion?()
             }
+        }
+        currentScan = scanTask
+        pendingScans[scanId] = scanTask
+        scanLock.unlock()
+    }
+    
+    /// Stop every queued or running library scan (the browsers' Cancel button)
+    /// The lists keep what they showed; the next rescan or filesystem change brings them up to date.
+    func cancelLibraryScan() {
+        scanLock.lock()
+        let scans = Array(pendingScans.values)
+        currentScanScope = []
+        scanLock.unlock()
+        
+        scans.forEach { $0.cancel() }
+    }
+    
+    /// Content found by one scan; kinds outside the scan's scope are nil
+    private struct LibraryScanResult {
+        var characters: [CharacterInfo]?
+        var stages: [StageInfo]?
+        var screenpacks: [ScreenpackInfo]?
+        var activeScreenpackPath: String?
+    }
+    
+    /// Scan each requested kind, fanning out per folder, and resolve select.def status and order
+    private func scanLibrary(_ scope: LibraryScanner.Scope, in workingDir: URL) async -> LibraryScanResult {
+        var result = LibraryScanResult()
+        
+        if scope.contains(.characters) {
+            let snapshot = LibrarySnapshot(kind: .character)
+            let batches = LibraryScanner.characterBatches(in: workingDir.appendingPathComponent("chars"), snapshot: snapshot)
+            let selectDefStatus = parseSelectDefStatus(in: workingDir)
+            // Fill an empty browser as batches arrive (first run); otherwise keep showing the current list
+            let preview = await MainActor.run { self.characters.isEmpty || self.showingPartialCharacters }
+            var found: [CharacterInfo] = []
             
-            if let defFile = targetDefFile {
-                // determine status
-                let folderName = charDir.lastPathComponent
-                let fileDefName = defFile.lastPathComponent
-                let relativePath = "\(folderName)/\(fileDefName)".lowercased()
-                
-                var status: ContentStatus = .unregistered
-                if activeSet.contains(relativePath) {
-                    status = .active
-                } else if disabledSet.contains(relativePath) {
-                    status = .disabled
+            for await batch in batches {
+                if Task.isCancelled { break }
+                found += batch.items
+                let partial = preview ? resolveCharacterStatus(found, using: selectDefStatus) : nil
+                await MainActor.run {
+                    self.libraryScanContent = .characters
+                    self.libraryScanProgress = batch.progress
+                    if let partial = partial {
+                        self.showingPartialCharacters = true
+                        self.characters = partial
+                    }
                 }
-                
-                let charInfo = CharacterInfo(directory: charDir, defFile: defFile, status: status)
-                foundCharacters.append(charInfo)
             }
+            guard !Task.isCancelled else { return result }
+            
+            result.characters = resolveCharacterStatus(found, using: selectDefStatus)
+            print("Loaded \(found.count) characters (\(snapshot.parsedCount) folders parsed)")
         }
         
-        // Sort characters according to select.def order
-        let sortedCharacters = sortCharactersBy(selectDefOrder: selectDefOrder, characters: foundCharacters)
-        
-        DispatchQueue.main.async {
-            self.characters = sortedCharacters
+        if scope.contains(.stages) {
+            let snapshot = LibrarySnapshot(kind: .stage)
+            let batches = LibraryScanner.stageBatches(in: workingDir.appendingPathComponent("stages"), snapshot: snapshot)
+            let selectDefStatus = parseSelectDefStageStatus(in: workingDir)
+            let preview = await MainActor.run { self.stages.isEmpty || self.showingPartialStages }
+            var found: [StageInfo] = []
             
-            // Sync the default collection with loaded characters
-            let charData = sortedCharacters.map { (folder: $0.directory.lastPathComponent, def: $0.defFile.lastPathComponent) }
-            CollectionStore.shared.syncDefaultCollectionCharacters(charData)
+            for await batch in batches {
+                if Task.isCancelled { break }
+                found += batch.items
+                let partial = preview ? resolveStageStatus(found, in: workingDir, using: selectDefStatus) : nil
+                await MainActor.run {
+                    self.libraryScanContent = .stages
+                    self.libraryScanProgress = batch.progress
+                    if let partial = partial {
+                        self.showingPartialStages = true
+                        self.stages = partial
+                    }
+                }
+            }
+            guard !Task.isCancelled else { return result }
+            
+            result.stages = resolveStageStatus(found, in: workingDir, using: selectDefStatus)
+            print("Loaded \(found.count) stages (\(snapshot.parsedCount) entries parsed)")
+        }
+        
+        if scope.contains(.screenpacks) {
+            let activeMotif = readActiveMotifFromConfig(in: workingDir)
+            let found = await LibraryScanner.scanScreenpacks(in: workingDir.appendingPathComponent("data"),
+                                                             activeMotif: activeMotif)
             
-            // If the default collection is active, regenerate select.def with the new content
-            if let active = CollectionStore.shared.activeCollection, active.isDefault,
-               let workingDir = self.engineWorkingDirectory {
-                print("Default collection updated with new characters, regenerating select.def...")
-                // Regenerate directly to avoid "Collection Activated" notification
-                _ = SelectDefGenerator.writeSelectDef(for: active, ikemenPath: workingDir)
+            result.activeScreenpackPath = activeMotif
+            result.screenpacks = found.sorted {
+                // Active first, then alphabetical
+                if $0.isActive != $1.isActive {
+                    return $0.isActive
+                }
+                return $0.name.lowercased() < $1.name.lowercased()
             }
+            print("Loaded \(found.count) screenpacks, active: \(activeMotif ?? "default")")
         }
         
-        print("Loaded \(foundCharacters.count) characters")
+        return result
     }
     
-    /// Sort characters according to select.def order, with any unlisted characters at the end alphabetically
-    private func sortCharactersBy(selectDefOrder: [String], characters: [CharacterInfo]) -> [CharacterInfo] {
-        var result: [CharacterInfo] = []
-        var remaining = characters
+    /// The last scan's characters and stages from the database, plus the screenpacks (few enough
+    /// to scan directly); empty when nothing has been stored yet
+    private func hydrateFromSnapshot(in workingDir: URL) async -> LibraryScanResult {
+        let stored = LibrarySnapshot.storedLibrary()
+        var result = await scanLibrary(.screenpacks, in: workingDir)
+        guard !stored.characters.isEmpty || !stored.stages.isEmpty else { return result }
         
-        // First, add characters in select.def order
-        for name in selectDefOrder {
-            // Extract folder name from select.def entry (could be "kfm" or "kfm/kfm.def")
-            let folderName = name.components(separatedBy: "/").first ?? name
-            
-            if let index = remaining.firstIndex(where: { $0.directory.lastPathComponent.lowercased() == folderName.lowercased() }) {
-                result.append(remaining[index])
-                remaining.remove(at: index)
-            }
-        }
+        result.characters = resolveCharacterStatus(stored.characters, in: workingDir)
+        result.stages = resolveStageStatus(stored.stages, in: workingDir)
         
-        // Add remaining characters (not in select.def) alphabetically at the end
-        let sortedRemaining = remaining.sorted { $0.displayName.lowercased() < $1.displayName.lowercased() }
-        result.append(contentsOf: sortedRemaining)
+        // Enough for the first screen of either browser
+        ImageCache.shared.preloadThumbnails(characters: Array(result.characters?.prefix(120) ?? []),
+                                            stages: Array(result.stages?.prefix(60) ?? []))
         
+        print("Restored \(stored.characters.count) characters and \(stored.stages.count) stages from the library snapshot")
         return result
     }
     
-    /// Load all stages from the stages directory
-    private func loadStages() {
-        var foundStages: [StageInfo] = []
-        let fileManager = FileManager.default
-        
-        guard let workingDir = engineWorkingDirectory else { return }
-        let engineStagesPath = workingDir.appendingPathComponent("stages")
-
-        // Parse select.def for stage status
-        let (activeSet, disabledSet) = parseSelectDefStageStatus(in: workingDir)
-        
-        // Helper to determine status
-        func getStatus(for defURL: URL) -> ContentStatus {
-             let path = defURL.path
-             let root = workingDir.path
-             
-             if path.hasPrefix(root) {
-                 var relative = String(path.dropFirst(root.count))
-                 if relative.hasPrefix("/") { relative = String(relative.dropFirst()) }
-                 let key = relative.replacingOccurrences(of: "\\", with: "/").lowercased()
-                 
-                 if activeSet.contains(key) { return .active }
-                 if disabledSet.contains(key) { return .disabled }
-             }
-             return .unregistered
-        }
-        
-        // Search for .def files at top level and one level deep (in subdirectories)
-        guard let stageItems = try? fileManager.contentsOfDirectory(at: engineStagesPath, includingPropertiesForKeys: [.isDirectoryKey]) else {
-            return
+    /// Merge re-parsed entries into the published lists
+    /// Changes that can't be pinned to an entry fall back to a (snapshot-backed) scan of that folder.
+    private func scanChanges(_ changes: LibraryChangeSet, in workingDir: URL) async -> LibraryScanResult {
+        var scope: LibraryScanner.Scope = []
+        if changes.rescanCharacters { scope.insert(.characters) }
+        if changes.rescanStages { scope.insert(.stages) }
+        if changes.screenpacks { scope.insert(.screenpacks) }
+        var result = await scanLibrary(scope, in: workingDir)
+        
+        let (currentCharacters, currentStages) = await MainActor.run { (self.characters, self.stages) }
+        
+        if result.characters == nil && (!changes.characterFolders.isEmpty || changes.selectDef) {
+            var characters = currentCharacters
+            if !changes.characterFolders.isEmpty {
+                let charsDir = workingDir.appendingPathComponent("chars")
+                let folders = changes.characterFolders.sorted().map { charsDir.appendingPathComponent($0) }
+                let updated = await LibraryScanner.rescanCharacters(folders, snapshot: LibrarySnapshot(kind: .character, entries: folders))
+                characters.removeAll { changes.characterFolders.contains($0.directory.lastPathComponent) }
+                characters.append(contentsOf: updated)
+                print("Re-parsed \(folders.count) character folders")
+            }
+            result.characters = resolveCharacterStatus(characters, in: workingDir)
         }
         
-        for item in stageItems {
-            // Check if it's a .def file at top level
-            if item.pathExtension.lowercased() == "def" {
-                if DEFParser.isValidStageDefFile(item) {
-                    let status = getStatus(for: item)
-                    let stageInfo = StageInfo(defFile: item, status: status)
-                    foundStages.append(stageInfo)
+        if result.stages == nil && (!changes.stageEntries.isEmpty || changes.selectDef) {
+            var stages = currentStages
+            if !changes.stageEntries.isEmpty {
+                let stagesDir = workingDir.appendingPathComponent("stages")
+                let entries = changes.stageEntries.sorted().map { stagesDir.appendingPathComponent($0) }
+                let updated = await LibraryScanner.rescanStages(entries, snapshot: LibrarySnapshot(kind: .stage, entries: entries))
+                stages.removeAll { stage in
+                    stageEntryName(of: stage, in: stagesDir).map { changes.stageEntries.contains($0) } ?? false
                 }
+                stages.append(contentsOf: updated)
+                print("Re-parsed \(entries.count) stage entries")
             }
+            result.stages = resolveStageStatus(stages, in: workingDir)
+        }
+        
+        return result
+    }
+    
+    /// Name of the top-level stages/ entry (folder or .def file) a stage was found in
+    private func stageEntryName(of stage: StageInfo, in stagesDir: URL) -> String? {
+        let root = stagesDir.standardizedFileURL.path + "/"
+        let path = stage.defFile.standardizedFileURL.path
+        guard path.hasPrefix(root) else { return nil }
+        return path.dropFirst(root.count).split(separator: "/").first.map(String.init)
+    }
+    
+    /// Apply select.def status to characters and put them in select.def order
+    private func resolveCharacterStatus(_ characters: [CharacterInfo], in workingDir: URL) -> [CharacterInfo] {
+        return resolveCharacterStatus(characters, using: parseSelectDefStatus(in: workingDir))
+    }
+    
+    /// Apply already-parsed select.def status and order to characters
+    private func resolveCharacterStatus(_ characters: [CharacterInfo],
+                                        using selectDefStatus: (active: Set<String>, disabled: Set<String>, order: [String])) -> [CharacterInfo] {
+        let (activeSet, disabledSet, selectDefOrder) = selectDefStatus
+        var resolved = characters
+        
+        for index in resolved.indices {
+            let relativePath = "\(resolved[index].directory.lastPathComponent)/\(resolved[index].defFile.lastPathComponent)".lowercased()
+            if activeSet.contains(relativePath) {
+                resolved[index].status = .active
+            } else if disabledSet.contains(relativePath) {
+                resolved[index].status = .disabled
+            } else {
+                resolved[index].status = .unregistered
+            }
+        }
+        
+        return LibraryScanner.sortCharacters(resolved, selectDefOrder: selectDefOrder)
+    }
+    
+    /// Apply select.def status to stages and sort them by name
+    private func resolveStageStatus(_ stages: [StageInfo], in workingDir: URL) -> [StageInfo] {
+        return resolveStageStatus(stages, in: workingDir, using: parseSelectDefStageStatus(in: workingDir))
+    }
+    
+    /// Apply already-parsed select.def status to stages and sort them by name
+    private func resolveStageStatus(_ stages: [StageInfo], in workingDir: URL,
+                                    using selectDefStatus: (active: Set<String>, disabled: Set<String>)) -> [StageInfo] {
+        let (activeSet, disabledSet) = selectDefStatus
+        var resolved = stages
+        
+        let root = workingDir.path
+        for index in resolved.indices {
+            let path = resolved[index].defFile.path
+            guard path.hasPrefix(root) else { continue }
+            var relative = String(path.dropFirst(root.count))
+            if relative.hasPrefix("/") { relative = String(relative.dropFirst()) }
+            let key = relative.replacingOccurrences(of: "\\", with: "/").lowercased()
             
-            // Check if it's a directory - look for .def files inside
-            var isDirectory: ObjCBool = false
-            if fileManager.fileExists(atPath: item.path, isDirectory: &isDirectory), isDirectory.boolValue {
-                if let subItems = try? fileManager.contentsOfDirectory(at: item, includingPropertiesForKeys: nil) {
-                    for subItem in subItems where subItem.pathExtension.lowercased() == "def" {
-                        if DEFParser.isValidStageDefFile(subItem) {
-                            let status = getStatus(for: subItem)
-                            let stageInfo = StageInfo(defFile: subItem, status: status)
-                            foundStages.append(stageInfo)
-                        }
-                    }
-                }
+            if activeSet.contains(key) {
+                resolved[index].status = .active
+            } else if disabledSet.contains(key) {
+                resolved[index].status = .disabled
+            } else {
+                resolved[index].status = .unregistered
             }
         }
         
-        DispatchQueue.main.async {
-            let sortedStages = foundStages.sorted { $0.name.lowercased() < $1.name.lowercased() }
-            self.stages = sortedStages
+        return resolved.sorted { $0.name.lowercased() < $1.name.lowercased() }
+    }
+    
+    /// Apply a scan result: assign the published lists, sync the default collection and
+    /// regenerate select.def at most once
+    private func publish(_ result: LibraryScanResult) {
+        var defaultCollectionChanged = false
+        
+        if libraryScanProgress != nil {
+            libraryScanProgress = nil
+        }
+        
+        // Partial lists shown while scanning were never synced to the default collection
+        if let characters = result.characters,
+           showingPartialCharacters || !LibraryScanner.isIdentical(characters, to: self.characters) {
+            let previous = showingPartialCharacters ? [] : self.characters
+            showingPartialCharacters = false
+            
+            // Status-only updates (e.g. select.def edited) leave the collection alone, so writing
+            // select.def below can't trigger another update from the library watcher
+            defaultCollectionChanged = Set(previous.map { $0.defFile }) != Set(characters.map { $0.defFile })
+            self.characters = characters
+            
+            // Sync the default collection with loaded characters
+            let charData = characters.map { (folder: $0.directory.lastPathComponent, def: $0.defFile.lastPathComponent) }
+            CollectionStore.shared.syncDefaultCollectionCharacters(charData)
+        }
+        
+        if let stages = result.stages,
+           showingPartialStages || !LibraryScanner.isIdentical(stages, to: self.stages) {
+            let previous = showingPartialStages ? [] : self.stages
+            showingPartialStages = false
+            
+            if Set(previous.map { $0.defFile }) != Set(stages.map { $0.defFile }) {
+                defaultCollectionChanged = true
+            }
+            self.stages = stages
             
             // Sync default collection
-            let stagePaths = sortedStages.map { stage -> String in
+            let stagePaths = stages.map { stage -> String in
                 let path = stage.defFile
                 // If parent is "stages", return just filename (e.g. "my_stage.def")
                 // If parent is subfolder, return subfolder name (e.g. "MyStage")
@@ -558,73 +758,26 @@ class IkemenBridge: ObservableObject {
                 }
             }
             CollectionStore.shared.syncDefaultCollectionStages(stagePaths)
-            
-            // If the default collection is active, regenerate select.def with the new content
-            if let active = CollectionStore.shared.activeCollection, active.isDefault,
-               let workingDir = self.engineWorkingDirectory {
-                print("Default collection updated with new stages, regenerating select.def...")
-                // Regenerate directly to avoid "Collection Activated" notification
-                _ = SelectDefGenerator.writeSelectDef(for: active, ikemenPath: workingDir)
-            }
-        }
-        
-        print("Loaded \(foundStages.count) stages")
-    }
-    
-    /// Load all screenpacks from the data directory
-    private func loadScreenpacks() {
-        var foundScreenpacks: [ScreenpackInfo] = []
-        let fileManager = FileManager.default
-        
-        guard let workingDir = engineWorkingDirectory else { return }
-        let dataPath = workingDir.appendingPathComponent("data")
-        
-        // First, read the active screenpack from config
-        let activeMotif = readActiveMotifFromConfig(in: workingDir)
-        
-        // Look for screenpack directories in data/
-        guard let dataDirs = try? fileManager.contentsOfDirectory(at: dataPath, includingPropertiesForKeys: [.isDirectoryKey]) else {
-            return
         }
         
-        for dir in dataDirs {
-            var isDirectory: ObjCBool = false
-            guard fileManager.fileExists(atPath: dir.path, isDirectory: &isDirectory), isDirectory.boolValue else {
-                continue
+        if let screenpacks = result.screenpacks {
+            if self.activeScreenpackPath != result.activeScreenpackPath {
+                self.activeScreenpackPath = result.activeScreenpackPath
             }
-            
-            // Look for system.def in the directory
-            let systemDef = dir.appendingPathComponent("system.def")
-            if fileManager.fileExists(atPath: systemDef.path) {
-                // Check if this is the active screenpack
-                let relativePath = "data/\(dir.lastPathComponent)/system.def"
-                let isActive = (activeMotif == relativePath) || (activeMotif == dir.lastPathComponent)
-                
-                let screenpackInfo = ScreenpackInfo(defFile: systemDef, isActive: isActive)
-                foundScreenpacks.append(screenpackInfo)
+            let summary = { (packs: [ScreenpackInfo]) in packs.map { "\($0.defFile.path)|\($0.name)|\($0.isActive)" } }
+            if summary(screenpacks) != summary(self.screenpacks) {
+                self.screenpacks = screenpacks
             }
         }
         
-        // Also check for system.def directly in data/ (default screenpack)
-        let defaultSystemDef = dataPath.appendingPathComponent("system.def")
-        if fileManager.fileExists(atPath: defaultSystemDef.path) {
-            let isActive = (activeMotif == "data/system.def") || (activeMotif == nil) || activeMotif?.isEmpty == true
-            let defaultScreenpack = ScreenpackInfo(defFile: defaultSystemDef, isActive: isActive)
-            foundScreenpacks.append(defaultScreenpack)
-        }
-        
-        DispatchQueue.main.async {
-            self.activeScreenpackPath = activeMotif
-            self.screenpacks = foundScreenpacks.sorted { 
-                // Active first, then alphabetical
-                if $0.isActive != $1.isActive {
-                    return $0.isActive
-                }
-                return $0.name.lowercased() < $1.name.lowercased() 
-            }
+        // If the default collection is active, regenerate select.def with the new content
+        if defaultCollectionChanged,
+           let active = CollectionStore.shared.activeCollection, active.isDefault,
+           let workingDir = engineWorkingDirectory {
+            print("Default collection updated with new content, regenerating select.def...")
+            // Regenerate directly to avoid "Collection Activated" notification
+            _ = SelectDefGenerator.writeSelectDef(for: active, ikemenPath: workingDir)
         }
-        
-        print("Loaded \(foundScreenpacks.count) screenpacks, active: \(activeMotif ?? "default")")
     }
     
     /// Read the active motif/screenpack path from Ikemen's config
@@ -855,9 +1008,7 @@ class IkemenBridge: ObservableObject {
         let result = try ContentManager.shared.installContent(from: archiveURL, to: workingDir, overwrite: overwrite)
         
         // Reload content after installation
-        loadCharacters()
-        loadStages()
-        loadScreenpacks()
+        loadContent()
         
         return result
     }
@@ -871,9 +1022,7 @@ class IkemenBridge: ObservableObject {
         let result = try ContentManager.shared.installContentFolder(from: folderURL, to: workingDir, overwrite: overwrite)
         
         // Reload content after installation
-        loadCharacters()
-        loadStages()
-        loadScreenpacks()
+        loadContent()
         
         return result
     }
@@ -207,6 +207,11 @@ public final class FolderSanitizer {
         // Find the character def file
         guard let defFile = findCharacterDefFile(in: folder) else { return nil }
         
+        return suggestedFolderName(for: folder, defFile: defFile)
+    }
+    
+    /// Suggested name for a folder whose character DEF is already known, nil if the name is fine
+    private func suggestedFolderName(for folder: URL, defFile: URL) -> String? {
         // Parse the def file
         guard let parsed = DEFParser.parse(url: defFile) else { return nil }
         
@@ -239,24 +244,16 @@ public final class FolderSanitizer {
     
     /// Find misnamed character folders in the chars directory
     /// Returns array of (folder URL, suggested name)
-    public func findMisnamedCharacterFolders(in workingDir: URL) -> [(URL, String)] {
-        let charsDir = workingDir.appendingPathComponent("chars")
+    /// - Parameter manifest: Listing of chars/ to check; nil uses the shared manifest from the latest refresh
+    public func findMisnamedCharacterFolders(in workingDir: URL, manifest: LibraryManifest? = nil) -> [(URL, String)] {
+        let manifest = manifest ?? LibraryManifest.current(charsDirectory: workingDir.appendingPathComponent("chars"))
         var misnamed: [(URL, String)] = []
         
-        guard let folders = try? fileManager.contentsOfDirectory(at: charsDir, includingPropertiesForKeys: [.isDirectoryKey]) else {
-            return misnamed
-        }
-        
-        for folder in folders {
-            var isDir: ObjCBool = false
-            guard fileManager.fileExists(atPath: folder.path, isDirectory: &isDir), isDir.boolValue else {
-                continue
-            }
-            
-            if folder.lastPathComponent.hasPrefix(".") { continue }
+        for folder in manifest.folders {
+            guard let defFile = folder.characterDefFile else { continue }
             
-            if let suggestedName = detectMismatchedCharacterFolder(folder) {
-                misnamed.append((folder, suggestedName))
+            if let suggestedName = suggestedFolderName(for: folder.url, defFile: defFile) {
+                misnamed.append((folder.url, suggestedName))
             }
         }
         
@@ -282,6 +279,7 @@ public final class FolderSanitizer {
         
         // Rename the folder
         try fileManager.moveItem(at: folder, to: newPath)
+        LibraryManifest.invalidate()
         
         // Update select.def
         SelectDefManager.shared.updateSelectDefEntry(from: currentName, to: newName, in: workingDir)
@@ -312,26 +310,7 @@ public final class FolderSanitizer {
     
     /// Find the valid character def file in a folder (skips storyboards, fonts, stages)
     func findCharacterDefFile(in folder: URL) -> URL? {
-        // First check for def file matching folder name
-        let folderName = folder.lastPathComponent
-        let matchingDef = folder.appendingPathComponent("\(folderName).def")
-        
-        if fileManager.fileExists(atPath: matchingDef.path) && DEFParser.isValidCharacterDefFile(matchingDef) {
-            return matchingDef
-        }
-        
-        // Fall back to finding any valid character def
-        guard let contents = try? fileManager.contentsOfDirectory(at: folder, includingPropertiesForKeys: nil) else {
-            return nil
-        }
-        
-        let defFiles = contents.filter { $0.pathExtension.lowercased() == "def" }
-        let validDefFiles = defFiles.filter { DEFParser.isValidCharacterDefFile($0) }
-        
-        // Prefer def file that matches folder name pattern, otherwise take first
-        return validDefFiles.first { file in
-            file.deletingPathExtension().lastPathComponent.lowercased() == folderName.lowercased()
-        } ?? validDefFiles.first
+        return LibraryManifest.folder(at: folder)?.characterDefFile
     }
     
     // MARK: - Stage Name Editing
@@ -191,8 +191,7 @@ final class FullgameImporter {
             
             // Validate it's a character (has .def with character markers)
             if let def = defFile,
-               let content = try? String(contentsOf: def, encoding: .utf8).lowercased(),
-               content.contains("[files]") && (content.contains(".cmd") || content.contains(".cns") || content.contains(".air")) {
+               DEFClassifier.shared.classify(def)?.contentType == .character {
                 entries.append(FullgameManifest.CharacterEntry(
                     folderURL: item,
                     folderName: item.lastPathComponent,
@@ -244,10 +243,7 @@ final class FullgameImporter {
     }
     
     private func isValidStageFile(_ url: URL) -> Bool {
-        guard let content = try? String(contentsOf: url, encoding: .utf8).lowercased() else {
-            return false
-        }
-        return content.contains("[stageinfo]") || content.contains("[bgdef]") || content.contains("[bg ")
+        return DEFClassifier.shared.classify(url)?.contentType == .stage
     }
     
     private func scanDataFolder(_ url: URL) -> FullgameManifest.ScreenpackEntry? {
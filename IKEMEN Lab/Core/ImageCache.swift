@@ -1,5 +1,6 @@
 import Foundation
 import AppKit
+import os.log
 
 // MARK: - Image Cache
 
@@ -13,7 +14,10 @@ public final class ImageCache {
     
     // MARK: - Properties
     
+    private static let logger = Logger(subsystem: Bundle.main.bundleIdentifier ?? "com.ikemenlab", category: "ImageCache")
+    
     private let cache: NSCache<NSString, NSImage>
+    private let persistQueue = DispatchQueue(label: "com.ikemenlab.imageCache.persist", qos: .utility)
     
     /// Cache statistics for debugging
     private(set) var hitCount: Int = 0
@@ -44,6 +48,16 @@ public final class ImageCache {
         return "stage:\(stageId)"
     }
     
+    /// Generate a cache key for a grid-sized character portrait
+    public static func portraitThumbnailKey(for characterId: String) -> String {
+        return "portrait-thumb:\(characterId)"
+    }
+    
+    /// Generate a cache key for a grid-sized stage preview
+    public static func stagePreviewThumbnailKey(for stageId: String) -> String {
+        return "stage-thumb:\(stageId)"
+    }
+    
     /// Generate a cache key for an SFF sprite
     public static func sffKey(filePath: String, group: Int, image: Int) -> String {
         return "sff:\(filePath):\(group):\(image)"
@@ -65,8 +79,10 @@ public final class ImageCache {
     /// Store an image in cache
     public func set(_ image: NSImage, for key: String) {
         let nsKey = key as NSString
-        // Estimate cost based on image size (width * height * 4 bytes per pixel)
-        let cost = Int(image.size.width * image.size.height * 4)
+        // Estimate cost based on pixel size (width * height * 4 bytes per pixel)
+        // Thumbnails decoded at reduced size are charged for what they actually hold
+        let pixelSize = image.representations.first.map { NSSize(width: $0.pixelsWide, height: $0.pixelsHigh) } ?? image.size
+        let cost = Int(max(pixelSize.width, 1) * max(pixelSize.height, 1) * 4)
         cache.setObject(image, forKey: nsKey, cost: cost)
     }
     
@@ -86,11 +102,13 @@ public final class ImageCache {
     /// Remove cached images for a specific character
     public func clearCharacter(_ characterId: String) {
         remove(ImageCache.portraitKey(for: characterId))
+        remove(ImageCache.portraitThumbnailKey(for: characterId))
     }
     
     /// Remove cached images for a specific stage
     public func clearStage(_ stageId: String) {
         remove(ImageCache.stagePreviewKey(for: stageId))
+        remove(ImageCache.stagePreviewThumbnailKey(for: stageId))
     }
     
     // MARK: - Convenience Methods
@@ -113,6 +131,30 @@ public final class ImageCache {
         return nil
     }
     
+    /// Get or load a grid-sized character portrait (downscaled during decode)
+    /// Falls back to the thumbnail persisted by an earlier launch before decoding the SFF.
+    public func getPortraitThumbnail(for character: CharacterInfo) -> NSImage? {
+        let key = ImageCache.portraitThumbnailKey(for: character.id)
+        
+        if let cached = get(key) {
+            return cached
+        }
+        
+        let fingerprint = ImageCache.thumbnailFingerprint(for: character)
+        if let stored = persistedThumbnail(for: key, fingerprint: fingerprint) {
+            set(stored, for: key)
+            return stored
+        }
+        
+        if let image = character.getPortraitImage(maxPixelSize: BrowserLayout.portraitThumbnailPixelSize) {
+            set(image, for: key)
+            persistThumbnail(image, for: key, fingerprint: fingerprint)
+            return image
+        }
+        
+        return nil
+    }
+    
     /// Get or load a stage preview
     public func getStagePreview(for stage: StageInfo) -> NSImage? {
         let key = ImageCache.stagePreviewKey(for: stage.id)
@@ -131,6 +173,105 @@ public final class ImageCache {
         return nil
     }
     
+    /// Get or load a grid-sized stage preview (downscaled during decode)
+    /// Falls back to the thumbnail persisted by an earlier launch before decoding the SFF.
+    public func getStagePreviewThumbnail(for stage: StageInfo) -> NSImage? {
+        let key = ImageCache.stagePreviewThumbnailKey(for: stage.id)
+        
+        if let cached = get(key) {
+            return cached
+        }
+        
+        let fingerprint = ImageCache.thumbnailFingerprint(for: stage)
+        if let stored = persistedThumbnail(for: key, fingerprint: fingerprint) {
+            set(stored, for: key)
+            return stored
+        }
+        
+        if let image = stage.loadPreviewImage(maxPixelSize: BrowserLayout.stageThumbnailPixelSize) {
+            set(image, for: key)
+            persistThumbnail(image, for: key, fingerprint: fingerprint)
+            return image
+        }
+        
+        return nil
+    }
+    
+    // MARK: - Persisted Thumbnails
+    
+    /// Load the persisted thumbnails of these characters and stages into memory with one query
+    /// Used at launch so the first screen of the grid appears without decoding any SFF.
+    public func preloadThumbnails(characters: [CharacterInfo], stages: [StageInfo]) {
+        var fingerprints: [String: String] = [:]
+        for character in characters {
+            fingerprints[ImageCache.portraitThumbnailKey(for: character.id)] = ImageCache.thumbnailFingerprint(for: character)
+        }
+        for stage in stages {
+            fingerprints[ImageCache.stagePreviewThumbnailKey(for: stage.id)] = ImageCache.thumbnailFingerprint(for: stage)
+        }
+        
+        let missing = fingerprints.keys.filter { cache.object(forKey: $0 as NSString) == nil }
+        guard let records = try? MetadataStore.shared.thumbnails(keys: missing) else { return }
+        
+        var loaded: [String] = []
+        for record in records where fingerprints[record.key] == record.sourceFingerprint {
+            if let image = NSImage(data: record.imageData) {
+                set(image, for: record.key)
+                loaded.append(record.key)
+            }
+        }
+        touchThumbnails(loaded)
+    }
+    
+    /// Identity of the files a character portrait is decoded from
+    /// The folder's own mtime covers an added or replaced portrait.png.
+    static func thumbnailFingerprint(for character: CharacterInfo) -> String {
+        let spriteFile = character.spriteFile.map { character.directory.appendingPathComponent($0) }
+        return LibrarySnapshot.fingerprint(of: character.directory, files: [character.defFile] + [spriteFile].compactMap { $0 })
+    }
+    
+    /// Identity of the files a stage preview is decoded from
+    static func thumbnailFingerprint(for stage: StageInfo) -> String {
+        return LibrarySnapshot.fingerprint(of: stage.defFile, files: [stage.sffFile].compactMap { $0 })
+    }
+    
+    private func persistedThumbnail(for key: String, fingerprint: String) -> NSImage? {
+        guard let record = try? MetadataStore.shared.thumbnails(keys: [key]).first,
+              record.sourceFingerprint == fingerprint,
+              let image = NSImage(data: record.imageData) else {
+            return nil
+        }
+        touchThumbnails([key])
+        return image
+    }
+    
+    private func touchThumbnails(_ keys: [String]) {
+        guard !keys.isEmpty else { return }
+        persistQueue.async {
+            do {
+                try MetadataStore.shared.touchThumbnails(keys: keys)
+            } catch {
+                Self.logger.warning("Failed to update thumbnail access dates: \(error.localizedDescription)")
+            }
+        }
+    }
+    
+    private func persistThumbnail(_ image: NSImage, for key: String, fingerprint: String) {
+        persistQueue.async {
+            guard let tiff = image.tiffRepresentation,
+                  let png = NSBitmapImageRep(data: tiff)?.representation(using: .png, properties: [:]) else {
+                return
+            }
+            let now = Date()
+            let record = ThumbnailRecord(key: key, sourceFingerprint: fingerprint, imageData: png, storedAt: now, accessedAt: now)
+            do {
+                try MetadataStore.shared.storeThumbnail(record)
+            } catch {
+                Self.logger.error("Failed to store thumbnail \(key): \(error.localizedDescription)")
+            }
+        }
+    }
+    
     // MARK: - Debug
     
     /// Cache hit rate for debugging
@@ -0,0 +1,155 @@
+import Foundation
+
+// MARK: - Library Manifest
+
+/// One walk of chars/: every character folder with its file listing and attributes
+///
+/// The library scan, MetadataStore reindexing, content validation and the folder sanitizer all
+/// read the same manifest instead of each listing chars/ and every folder in it. Listings are
+/// made with prefetched resource keys, so directory flags, sizes and dates come back with the
+/// directory entries rather than costing a stat() per file. The manifest is a value: a refresh
+/// builds a new one and anyone still holding the old one keeps a consistent view.
+public struct LibraryManifest {
+
+    /// A file or folder directly inside a character folder
+    public struct FileEntry {
+        public let url: URL
+        public let isDirectory: Bool
+        public let size: Int64
+        public let modifiedAt: Date?
+
+        public var name: String { url.lastPathComponent }
+        public var isDefFile: Bool { !isDirectory && url.pathExtension.lowercased() == "def" }
+    }
+
+    /// One top-level folder of chars/
+    public struct CharacterFolder {
+        public let url: URL
+        public let modifiedAt: Date?
+        /// Everything directly inside the folder, in listing order
+        public let files: [FileEntry]
+
+        public var name: String { url.lastPathComponent }
+
+        /// Every .def file in the folder (characters, storyboards, fonts...)
+        public var defFiles: [URL] { files.filter { $0.isDefFile }.map { $0.url } }
+
+        /// The character DEF: the one named after the folder, otherwise the first valid one
+        public var characterDefFile: URL? { characterDefSelection().chosen }
+
+        /// The chosen character DEF plus every DEF that was classified to pick it
+        /// DEFs named after the folder are tried first so the others usually aren't read at all;
+        /// classification goes through DEFClassifier's cache either way.
+        public func characterDefSelection() -> (chosen: URL?, considered: [URL]) {
+            let folderName = name.lowercased()
+            let defFiles = self.defFiles
+            let named = defFiles.filter { $0.deletingPathExtension().lastPathComponent.lowercased() == folderName }
+
+            if let direct = named.first(where: { DEFParser.isValidCharacterDefFile($0) }) {
+                return (direct, named)
+            }
+
+            let chosen = defFiles.first { !named.contains($0) && DEFParser.isValidCharacterDefFile($0) }
+            return (chosen, defFiles)
+        }
+    }
+
+    // MARK: - Properties
+
+    public let charsDirectory: URL
+    /// Character folders in listing order; hidden folders are not part of the library
+    public let folders: [CharacterFolder]
+    public let createdAt: Date
+
+    /// Attributes fetched along with every directory listing
+    static let resourceKeys: [URLResourceKey] = [.isDirectoryKey, .isSymbolicLinkKey, .fileSizeKey, .contentModificationDateKey]
+
+    /// Folder with the given name (case-insensitive)
+    public func folder(named name: String) -> CharacterFolder? {
+        let lowercased = name.lowercased()
+        return folders.first { $0.name.lowercased() == lowercased }
+    }
+
+    // MARK: - Building
+
+    /// Walk chars/ and every folder in it, listing folders concurrently
+    public static func build(charsDirectory: URL) -> LibraryManifest {
+        let entries = (try? FileManager.default.contentsOfDirectory(at: charsDirectory,
+                                                                     includingPropertiesForKeys: resourceKeys)) ?? []
+        let candidates = entries.filter { !$0.lastPathComponent.hasPrefix(".") }
+
+        var folders = [CharacterFolder?](repeating: nil, count: candidates.count)
+        let lock = NSLock()
+
+        DispatchQueue.concurrentPerform(iterations: candidates.count) { index in
+            guard let folder = folder(at: candidates[index]) else { return }
+            lock.lock()
+            folders[index] = folder
+            lock.unlock()
+        }
+
+        return LibraryManifest(charsDirectory: charsDirectory, folders: folders.compactMap { $0 }, createdAt: Date())
+    }
+
+    /// List one character folder; nil when the URL isn't a directory (or no longer exists)
+    public static func folder(at url: URL) -> CharacterFolder? {
+        guard let values = try? url.resourceValues(forKeys: Set(resourceKeys)), isDirectory(url, values) else {
+            return nil
+        }
+
+        let contents = (try? FileManager.default.contentsOfDirectory(at: url, includingPropertiesForKeys: resourceKeys)) ?? []
+        let files = contents.map { file -> FileEntry in
+            let fileValues = try? file.resourceValues(forKeys: Set(resourceKeys))
+            return FileEntry(url: file,
+                             isDirectory: fileValues.map { isDirectory(file, $0) } ?? false,
+                             size: Int64(fileValues?.fileSize ?? 0),
+                             modifiedAt: fileValues?.contentModificationDate)
+        }
+
+        return CharacterFolder(url: url, modifiedAt: values.contentModificationDate, files: files)
+    }
+
+    /// Directory flag from prefetched values, following symlinks the way fileExists(atPath:isDirectory:) does
+    private static func isDirectory(_ url: URL, _ values: URLResourceValues) -> Bool {
+        if values.isSymbolicLink == true {
+            var isDir: ObjCBool = false
+            return FileManager.default.fileExists(atPath: url.path, isDirectory: &isDir) && isDir.boolValue
+        }
+        return values.isDirectory == true
+    }
+
+    // MARK: - Shared Manifest
+
+    private static let lock = NSLock()
+    private static var cached: LibraryManifest?
+
+    /// The manifest from the latest refresh, walking chars/ only if there isn't one for this folder
+    public static func current(charsDirectory: URL) -> LibraryManifest {
+        lock.lock()
+        let manifest = cached
+        lock.unlock()
+
+        if let manifest = manifest,
+           manifest.charsDirectory.standardizedFileURL.path == charsDirectory.standardizedFileURL.path {
+            return manifest
+        }
+        return refresh(charsDirectory: charsDirectory)
+    }
+
+    /// Walk chars/ again and share the result with later consumers
+    @discardableResult
+    public static func refresh(charsDirectory: URL) -> LibraryManifest {
+        let manifest = build(charsDirectory: charsDirectory)
+        lock.lock()
+        cached = manifest
+        lock.unlock()
+        return manifest
+    }
+
+    /// Drop the shared manifest after chars/ changed; the next consumer walks it again
+    public static func invalidate() {
+        lock.lock()
+        cached = nil
+        lock.unlock()
+    }
+}
@@ -0,0 +1,352 @@
+import Foundation
+
+// MARK: - Library Scanner
+
+/// Scans the chars/, stages/ and data/ folders with bounded concurrency
+///
+/// Each top-level folder is one unit of work: classifying its DEFs and building the info value
+/// (which parses the DEF) happen in one child task. Character folders come from the shared
+/// LibraryManifest, so their listings are the same ones the other library consumers read.
+/// No more than `maxConcurrentTasks` folders are in flight at once, so a 4,000-folder library
+/// doesn't flood the cooperative pool with blocking file I/O. Results come back in directory-listing order whatever
+/// order the tasks finish in, so sorting them afterwards is deterministic. Full scans are also
+/// available as cancellable streams of batches with progress, for browsers that fill as they go.
+enum LibraryScanner {
+
+    /// Which content kinds a scan covers
+    struct Scope: OptionSet {
+        let rawValue: Int
+
+        static let characters = Scope(rawValue: 1 << 0)
+        static let stages = Scope(rawValue: 1 << 1)
+        static let screenpacks = Scope(rawValue: 1 << 2)
+
+        static let all: Scope = [.characters, .stages, .screenpacks]
+    }
+
+    /// Upper bound on folders scanned at once
+    static var maxConcurrentTasks: Int {
+        return max(2, ProcessInfo.processInfo.activeProcessorCount)
+    }
+
+    // MARK: - Bounded Map
+
+    /// Transform items concurrently with at most `limit` tasks in flight
+    /// - Returns: Non-nil results in the same order as `items`
+    static func map<Item, Output>(_ items: [Item],
+                                  limit: Int = maxConcurrentTasks,
+                                  _ transform: @escaping @Sendable (Item) -> Output?) async -> [Output] {
+        guard !items.isEmpty else { return [] }
+
+        var results = [Output?](repeating: nil, count: items.count)
+
+        await withTaskGroup(of: (Int, Output?).self) { group in
+            var next = 0
+
+            // Prime the group, then start one new task for every one that finishes
+            while next < min(max(1, limit), items.count) {
+                let index = next
+                let item = items[index]
+                group.addTask { (index, transform(item)) }
+                next += 1
+            }
+
+            while let finished = await group.next() {
+                results[finished.0] = finished.1
+                guard next < items.count, !Task.isCancelled else { continue }
+                let nextIndex = next
+                let item = items[nextIndex]
+                group.addTask { (nextIndex, transform(item)) }
+                next += 1
+            }
+        }
+
+        return results.compactMap { $0 }
+    }
+
+    // MARK: - Streaming
+
+    /// Running totals of a streamed scan
+    struct Progress: Equatable {
+        /// Top-level entries in the library folder
+        var totalEntries = 0
+        /// Entries visited so far
+        var entriesSeen = 0
+        /// Entries that produced content, parsed from disk or decoded from the snapshot
+        var entriesParsed = 0
+        /// Entries with nothing usable in them (no character or stage DEF)
+        var entriesFailed = 0
+        /// Time since the scan started
+        var elapsed: TimeInterval = 0
+
+        var fractionCompleted: Double {
+            return totalEntries > 0 ? Double(entriesSeen) / Double(totalEntries) : 1
+        }
+    }
+
+    /// Content found in one batch of entries, with the totals so far
+    struct Batch<Item> {
+        let items: [Item]
+        let progress: Progress
+    }
+
+    /// Entries per streamed batch
+    static let defaultBatchSize = 250
+
+    /// Run a scan in its own task and deliver it in listing-order batches
+    ///
+    /// Each batch is scanned with bounded concurrency (see `map`). Finishing or cancelling the
+    /// consuming task ends the stream and cancels the scan between folders; the snapshot is only
+    /// committed when every entry was visited.
+    private static func batches<Entry, Item>(batchSize: Int,
+                                             snapshot: LibrarySnapshot?,
+                                             listEntries: @escaping @Sendable () -> [Entry],
+                                             scan: @escaping @Sendable (Entry) -> [Item]) -> AsyncStream<Batch<Item>> {
+        return AsyncStream { continuation in
+            let task = Task.detached(priority: .userInitiated) {
+                let start = Date()
+                let entries = listEntries()
+                let size = max(1, batchSize)
+                var progress = Progress(totalEntries: entries.count)
+
+                var batchStart = 0
+                while batchStart < entries.count && !Task.isCancelled {
+                    let batch = Array(entries[batchStart..<min(entries.count, batchStart + size)])
+                    batchStart += batch.count
+
+                    let perEntry: [[Item]] = await map(batch) { scan($0) }
+                    // The map stops early when cancelled, so a short result is incomplete
+                    guard !Task.isCancelled, perEntry.count == batch.count else { break }
+
+                    progress.entriesSeen += batch.count
+                    progress.entriesParsed += perEntry.filter { !$0.isEmpty }.count
+                    progress.entriesFailed = progress.entriesSeen - progress.entriesParsed
+                    progress.elapsed = Date().timeIntervalSince(start)
+                    continuation.yield(Batch(items: perEntry.flatMap { $0 }, progress: progress))
+                }
+
+                if !Task.isCancelled {
+                    snapshot?.commit()
+                }
+                continuation.finish()
+            }
+
+            continuation.onTermination = { _ in
+                task.cancel()
+            }
+        }
+    }
+
+    // MARK: - Characters
+
+    /// Scan chars/ for character folders, one task per folder
+    /// Characters are returned with `.unregistered` status and in listing order.
+    /// - Parameters:
+    ///   - snapshot: When given, unchanged folders are decoded from it instead of parsed,
+    ///     and it is committed once every folder has been visited
+    ///   - manifest: Listing of chars/ to scan; nil walks chars/ again and shares the result
+    static func scanCharacters(in charsDir: URL,
+                               snapshot: LibrarySnapshot? = nil,
+                               manifest: LibraryManifest? = nil) async -> [CharacterInfo] {
+        var characters: [CharacterInfo] = []
+        for await batch in characterBatches(in: charsDir, snapshot: snapshot, manifest: manifest) {
+            characters += batch.items
+        }
+        return characters
+    }
+
+    /// Scan chars/ as a stream of batches, so callers can show characters as they are found
+    /// Same parameters and results as `scanCharacters(in:snapshot:manifest:)`, split into batches.
+    static func characterBatches(in charsDir: URL,
+                                 snapshot: LibrarySnapshot? = nil,
+                                 manifest: LibraryManifest? = nil,
+                                 batchSize: Int = defaultBatchSize) -> AsyncStream<Batch<CharacterInfo>> {
+        return batches(batchSize: batchSize, snapshot: snapshot) {
+            (manifest ?? LibraryManifest.refresh(charsDirectory: charsDir)).folders
+        } scan: { folder in
+            guard let snapshot = snapshot else {
+                return parseCharacter(in: folder).values
+            }
+            return snapshot.values(for: folder.url) { parseCharacter(in: folder) }
+        }
+    }
+
+    /// Re-parse specific chars/ folders (new, changed or deleted), e.g. after a filesystem event
+    /// - Returns: Characters now in those folders; deleted folders contribute none
+    static func rescanCharacters(_ folders: [URL], snapshot: LibrarySnapshot? = nil) async -> [CharacterInfo] {
+        // The shared manifest no longer matches chars/
+        LibraryManifest.invalidate()
+
+        let perFolder: [[CharacterInfo]] = await map(folders) { url in
+            let parse = { () -> (values: [CharacterInfo], files: [URL]) in
+                guard let folder = LibraryManifest.folder(at: url) else { return ([], []) }
+                return parseCharacter(in: folder)
+            }
+            guard let snapshot = snapshot else {
+                return parse().values
+            }
+            return snapshot.values(for: url, parse: parse)
+        }
+
+        if !Task.isCancelled {
+            snapshot?.commitChanges()
+        }
+        return perFolder.flatMap { $0 }
+    }
+
+    private static func parseCharacter(in folder: LibraryManifest.CharacterFolder) -> (values: [CharacterInfo], files: [URL]) {
+        let selection = folder.characterDefSelection()
+        guard let defFile = selection.chosen else { return ([], selection.considered) }
+        return ([CharacterInfo(directory: folder.url, defFile: defFile, status: .unregistered)], selection.considered)
+    }
+
+    /// Order characters as listed in select.def, with unlisted characters after them alphabetically
+    /// - Parameter selectDefOrder: Entries as written in select.def ("kfm" or "kfm/kfm.def")
+    static func sortCharacters(_ characters: [CharacterInfo], selectDefOrder: [String]) -> [CharacterInfo] {
+        // Queue of positions per folder name, so duplicates are taken in listing order
+        var positions: [String: [Int]] = [:]
+        for (index, character) in characters.enumerated() {
+            positions[character.directory.lastPathComponent.lowercased(), default: []].append(index)
+        }
+
+        var result: [CharacterInfo] = []
+        result.reserveCapacity(characters.count)
+        var taken = [Bool](repeating: false, count: characters.count)
+
+        for name in selectDefOrder {
+            let folderName = (name.components(separatedBy: "/").first ?? name).lowercased()
+            guard var queue = positions[folderName], !queue.isEmpty else { continue }
+            let index = queue.removeFirst()
+            positions[folderName] = queue
+            taken[index] = true
+            result.append(characters[index])
+        }
+
+        let remaining = characters.indices.filter { !taken[$0] }.map { characters[$0] }
+        result.append(contentsOf: remaining.sorted { $0.displayName.lowercased() < $1.displayName.lowercased() })
+        return result
+    }
+
+    /// Whether two character lists match field for field and in order
+    /// `CharacterInfo.==` compares ids only, which would hide renames and status changes.
+    static func isIdentical(_ lhs: [CharacterInfo], to rhs: [CharacterInfo]) -> Bool {
+        guard lhs.count == rhs.count else { return false }
+        return zip(lhs, rhs).allSatisfy { a, b in
+            a.id == b.id && a.name == b.name && a.displayName == b.displayName && a.author == b.author
+                && a.versionDate == b.versionDate && a.spriteFile == b.spriteFile
+                && a.defFile == b.defFile && a.status == b.status
+        }
+    }
+
+    // MARK: - Stages
+
+    /// Scan stages/ for stage DEFs at the top level and one folder deep, one task per entry
+    /// Stages are returned with `.unregistered` status and in listing order.
+    /// - Parameter snapshot: When given, unchanged entries are decoded from it instead of parsed,
+    ///   and it is committed once every entry has been visited
+    static func scanStages(in stagesDir: URL, snapshot: LibrarySnapshot? = nil) async -> [StageInfo] {
+        var stages: [StageInfo] = []
+        for await batch in stageBatches(in: stagesDir, snapshot: snapshot) {
+            stages += batch.items
+        }
+        return stages
+    }
+
+    /// Scan stages/ as a stream of batches; same results as `scanStages(in:snapshot:)`
+    static func stageBatches(in stagesDir: URL,
+                             snapshot: LibrarySnapshot? = nil,
+                             batchSize: Int = defaultBatchSize) -> AsyncStream<Batch<StageInfo>> {
+        return batches(batchSize: batchSize, snapshot: snapshot) {
+            (try? FileManager.default.contentsOfDirectory(at: stagesDir, includingPropertiesForKeys: [.isDirectoryKey])) ?? []
+        } scan: { item in
+            guard let snapshot = snapshot else {
+                return parseStages(at: item).values
+            }
+            return snapshot.values(for: item) { parseStages(at: item) }
+        }
+    }
+
+    /// Re-parse specific stages/ entries (new, changed or deleted), e.g. after a filesystem event
+    /// - Returns: Stages now defined by those entries; deleted entries contribute none
+    static func rescanStages(_ items: [URL], snapshot: LibrarySnapshot? = nil) async -> [StageInfo] {
+        let perItem: [[StageInfo]] = await map(items) { item in
+            guard let snapshot = snapshot else {
+                return parseStages(at: item).values
+            }
+            return snapshot.values(for: item) { parseStages(at: item) }
+        }
+
+        if !Task.isCancelled {
+            snapshot?.commitChanges()
+        }
+        return perItem.flatMap { $0 }
+    }
+
+    /// Stages defined by a top-level .def file, or by the .def files inside a top-level folder
+    private static func parseStages(at item: URL) -> (values: [StageInfo], files: [URL]) {
+        var stages: [StageInfo] = []
+        var files: [URL] = []
+
+        if item.pathExtension.lowercased() == "def" {
+            files.append(item)
+            if DEFParser.isValidStageDefFile(item) {
+                stages.append(StageInfo(defFile: item, status: .unregistered))
+            }
+        }
+
+        var isDirectory: ObjCBool = false
+        if FileManager.default.fileExists(atPath: item.path, isDirectory: &isDirectory), isDirectory.boolValue,
+           let subItems = try? FileManager.default.contentsOfDirectory(at: item, includingPropertiesForKeys: nil) {
+            for subItem in subItems where subItem.pathExtension.lowercased() == "def" {
+                files.append(subItem)
+                if DEFParser.isValidStageDefFile(subItem) {
+                    stages.append(StageInfo(defFile: subItem, status: .unregistered))
+                }
+            }
+        }
+
+        return (stages, files)
+    }
+
+    /// Whether two stage lists match field for field and in order
+    static func isIdentical(_ lhs: [StageInfo], to rhs: [StageInfo]) -> Bool {
+        guard lhs.count == rhs.count else { return false }
+        return zip(lhs, rhs).allSatisfy { a, b in
+            a.id == b.id && a.name == b.name && a.author == b.author && a.defFile == b.defFile
+                && a.sffFile == b.sffFile && a.boundLeft == b.boundLeft && a.boundRight == b.boundRight
+                && a.hasBGM == b.hasBGM && a.modificationDate == b.modificationDate && a.status == b.status
+        }
+    }
+
+    // MARK: - Screenpacks
+
+    /// Scan data/ for screenpack folders containing a system.def, plus data/system.def itself
+    /// - Parameter activeMotif: The Motif value from config.ini, used to flag the active screenpack
+    static func scanScreenpacks(in dataDir: URL, activeMotif: String?) async -> [ScreenpackInfo] {
+        let fileManager = FileManager.default
+        let folders = (try? fileManager.contentsOfDirectory(at: dataDir, includingPropertiesForKeys: [.isDirectoryKey])) ?? []
+
+        var screenpacks: [ScreenpackInfo] = await map(folders) { folder in
+            var isDirectory: ObjCBool = false
+            guard FileManager.default.fileExists(atPath: folder.path, isDirectory: &isDirectory), isDirectory.boolValue else {
+                return nil
+            }
+
+            let systemDef = folder.appendingPathComponent("system.def")
+            guard FileManager.default.fileExists(atPath: systemDef.path) else { return nil }
+
+            let relativePath = "data/\(folder.lastPathComponent)/system.def"
+            let isActive = (activeMotif == relativePath) || (activeMotif == folder.lastPathComponent)
+            return ScreenpackInfo(defFile: systemDef, isActive: isActive)
+        }
+
+        // The default screenpack lives directly in data/
+        let defaultSystemDef = dataDir.appendingPathComponent("system.def")
+        if fileManager.fileExists(atPath: defaultSystemDef.path) {
+            let isActive = (activeMotif == "data/system.def") || (activeMotif == nil) || activeMotif?.isEmpty == true
+            screenpacks.append(ScreenpackInfo(defFile: defaultSystemDef, isActive: isActive))
+        }
+
+        return screenpacks
+    }
+}
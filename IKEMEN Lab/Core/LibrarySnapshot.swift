@@ -0,0 +1,177 @@
+import Foundation
+import os.log
+
+// MARK: - Library Snapshot
+
+/// Persisted filesystem snapshot that lets a library rescan skip unchanged folders
+///
+/// Each top-level entry of chars/ or stages/ is stored with the values parsed from it and a
+/// fingerprint of the entry and the DEF files it was built from (inode, size, modification date).
+/// Adding, removing or renaming a file changes the folder's own mtime, and editing a DEF changes
+/// that file's, so an entry whose fingerprint still matches is decoded from the database instead
+/// of re-listed and re-parsed; renaming or editing one character re-parses just that folder.
+///
+/// Lookups are thread-safe, so a snapshot can be shared by every task of a concurrent scan.
+/// Call `commit()` once a full scan has visited every entry, or `commitChanges()` after
+/// re-parsing just a few entries (see LibraryWatcher).
+final class LibrarySnapshot {
+
+    /// Which library folder a snapshot covers
+    enum Kind: String {
+        case character
+        case stage
+    }
+
+    // MARK: - Properties
+
+    private static let logger = Logger(subsystem: Bundle.main.bundleIdentifier ?? "com.ikemenlab", category: "LibrarySnapshot")
+
+    let kind: Kind
+    private let previous: [String: LibrarySnapshotRecord]
+    private let lock = NSLock()
+    private var seenPaths = Set<String>()
+    private var changed: [LibrarySnapshotRecord] = []
+    private var removedPaths: [String] = []
+
+    /// Entries that had to be parsed (new or changed) during this scan
+    var parsedCount: Int {
+        lock.lock()
+        defer { lock.unlock() }
+        return changed.count
+    }
+
+    // MARK: - Initialization
+
+    /// Load the stored snapshot for a library folder (empty when the database isn't open)
+    /// - Parameter entries: Load only these entries, for a targeted rescan; nil loads them all
+    init(kind: Kind, entries: [URL]? = nil) {
+        self.kind = kind
+        let records: [LibrarySnapshotRecord]
+        if let entries = entries {
+            records = (try? MetadataStore.shared.librarySnapshot(paths: entries.map { $0.standardizedFileURL.path })) ?? []
+        } else {
+            records = (try? MetadataStore.shared.librarySnapshot(kind: kind.rawValue)) ?? []
+        }
+        self.previous = Dictionary(records.map { ($0.path, $0) }, uniquingKeysWith: { first, _ in first })
+    }
+
+    /// Every character and stage from the last scan, decoded from the snapshot in one query
+    /// Nothing on disk is checked; values come back with `.unregistered` status, grouped by entry.
+    static func storedLibrary() -> (characters: [CharacterInfo], stages: [StageInfo]) {
+        let records = ((try? MetadataStore.shared.allLibrarySnapshots()) ?? []).sorted { $0.path < $1.path }
+        let decoder = JSONDecoder()
+        var characters: [CharacterInfo] = []
+        var stages: [StageInfo] = []
+
+        for record in records {
+            switch Kind(rawValue: record.kind) {
+            case .character:
+                characters += (try? decoder.decode([CharacterInfo].self, from: record.payload)) ?? []
+            case .stage:
+                stages += (try? decoder.decode([StageInfo].self, from: record.payload)) ?? []
+            case nil:
+                continue
+            }
+        }
+        return (characters, stages)
+    }
+
+    // MARK: - Lookup
+
+    /// Values for one library entry, decoded from the snapshot when the entry is unchanged
+    /// - Parameters:
+    ///   - entry: Top-level folder (or .def file) in the library folder
+    ///   - parse: Builds the values from disk and reports the DEF files they were read from
+    func values<Value: Codable>(for entry: URL, parse: () -> (values: [Value], files: [URL])) -> [Value] {
+        let key = entry.standardizedFileURL.path
+
+        lock.lock()
+        seenPaths.insert(key)
+        lock.unlock()
+
+        if let record = previous[key] {
+            let files = record.files.isEmpty ? [] : record.files.components(separatedBy: "\n").map { URL(fileURLWithPath: $0) }
+            if LibrarySnapshot.fingerprint(of: entry, files: files) == record.fingerprint,
+               let values = try? JSONDecoder().decode([Value].self, from: record.payload) {
+                return values
+            }
+        }
+
+        let result = parse()
+
+        // Deleted entries are dropped rather than stored as empty
+        if result.values.isEmpty && !FileManager.default.fileExists(atPath: key) {
+            lock.lock()
+            seenPaths.remove(key)
+            removedPaths.append(key)
+            lock.unlock()
+            return []
+        }
+
+        if let payload = try? JSONEncoder().encode(result.values) {
+            let record = LibrarySnapshotRecord(
+                path: key,
+                kind: kind.rawValue,
+                files: result.files.map { $0.standardizedFileURL.path }.joined(separator: "\n"),
+                fingerprint: LibrarySnapshot.fingerprint(of: entry, files: result.files),
+                payload: payload,
+                scannedAt: Date()
+            )
+            lock.lock()
+            changed.append(record)
+            lock.unlock()
+        }
+        return result.values
+    }
+
+    // MARK: - Persistence
+
+    /// Store new and changed entries and drop entries that weren't seen by the scan
+    func commit() {
+        lock.lock()
+        let records = changed
+        let livePaths = seenPaths
+        lock.unlock()
+
+        // Nothing added, changed or removed: skip the write transaction entirely
+        if records.isEmpty && livePaths.count == previous.count && livePaths.allSatisfy({ previous[$0] != nil }) {
+            return
+        }
+
+        do {
+            try MetadataStore.shared.updateLibrarySnapshot(records, kind: kind.rawValue, livePaths: livePaths)
+        } catch {
+            Self.logger.error("Failed to store library snapshot: \(error.localizedDescription)")
+        }
+    }
+
+    /// Store new and changed entries and drop deleted ones, leaving every other entry alone
+    func commitChanges() {
+        lock.lock()
+        let records = changed
+        let removed = removedPaths
+        lock.unlock()
+
+        guard !records.isEmpty || !removed.isEmpty else { return }
+
+        do {
+            try MetadataStore.shared.updateLibrarySnapshot(records, removingPaths: removed)
+        } catch {
+            Self.logger.error("Failed to store library snapshot: \(error.localizedDescription)")
+        }
+    }
+
+    // MARK: - Fingerprint
+
+    /// Inode, size and modification date of an entry and each of its DEF files
+    static func fingerprint(of entry: URL, files: [URL]) -> String {
+        return ([entry] + files).map { identity(of: $0.path) }.joined(separator: "|")
+    }
+
+    /// One stat() per path; missing files are recorded as such
+    private static func identity(of path: String) -> String {
+        var info = stat()
+        guard stat(path, &info) == 0 else { return "-" }
+        return "\(info.st_ino):\(info.st_size):\(info.st_mtimespec.tv_sec).\(info.st_mtimespec.tv_nsec)"
+    }
+}
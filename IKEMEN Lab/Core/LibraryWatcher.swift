@@ -0,0 +1,320 @@
+import Foundation
+import CoreServices
+
+// MARK: - Library Change Set
+
+/// What a batch of filesystem events touched, reduced to library entries
+struct LibraryChangeSet: Equatable {
+    /// Names of top-level chars/ folders that were added, changed or removed
+    var characterFolders = Set<String>()
+    /// Names of top-level stages/ entries (folders or .def files) that were added, changed or removed
+    var stageEntries = Set<String>()
+    /// chars/ itself changed in a way that can't be pinned to one folder
+    var rescanCharacters = false
+    /// stages/ itself changed in a way that can't be pinned to one entry
+    var rescanStages = false
+    /// Something under data/ that affects screenpacks changed
+    var screenpacks = false
+    /// data/select.def changed (status and order need re-applying)
+    var selectDef = false
+
+    var isEmpty: Bool {
+        return characterFolders.isEmpty && stageEntries.isEmpty && !rescanCharacters && !rescanStages
+            && !screenpacks && !selectDef
+    }
+}
+
+// MARK: - Change Sources
+
+/// Delivers the paths of changed files and folders under a set of watched directories
+/// FSEvents backs this in the app; polling works anywhere, including headless tests.
+protocol LibraryChangeSource: AnyObject {
+    /// Start watching; `handler` may be called on any queue
+    func start(watching paths: [URL], handler: @escaping ([String]) -> Void)
+    func stop()
+}
+
+/// FSEvents-backed change source reporting individual file paths
+final class FSEventsChangeSource: LibraryChangeSource {
+
+    private let latency: CFTimeInterval
+    private let queue = DispatchQueue(label: "com.ikemenlab.libraryWatcher.fsevents", qos: .utility)
+    private var stream: FSEventStreamRef?
+    private var handler: (([String]) -> Void)?
+
+    /// - Parameter latency: How long FSEvents buffers events before delivering them
+    init(latency: CFTimeInterval = 0.2) {
+        self.latency = latency
+    }
+
+    deinit {
+        stop()
+    }
+
+    func start(watching paths: [URL], handler: @escaping ([String]) -> Void) {
+        stop()
+        self.handler = handler
+
+        var context = FSEventStreamContext(version: 0,
+                                           info: Unmanaged.passUnretained(self).toOpaque(),
+                                           retain: nil,
+                                           release: nil,
+                                           copyDescription: nil)
+
+        let callback: FSEventStreamCallback = { _, info, _, eventPaths, _, _ in
+            guard let info = info else { return }
+            let source = Unmanaged<FSEventsChangeSource>.fromOpaque(info).takeUnretainedValue()
+            let paths = unsafeBitCast(eventPaths, to: NSArray.self) as? [String] ?? []
+            source.handler?(paths)
+        }
+
+        let flags = FSEventStreamCreateFlags(kFSEventStreamCreateFlagUseCFTypes | kFSEventStreamCreateFlagFileEvents)
+        guard let stream = FSEventStreamCreate(kCFAllocatorDefault,
+                                               callback,
+                                               &context,
+                                               paths.map { $0.path } as CFArray,
+                                               FSEventStreamEventId(kFSEventStreamEventIdSinceNow),
+                                               latency,
+                                               flags) else {
+            print("Failed to create FSEvents stream for library watcher")
+            return
+        }
+
+        FSEventStreamSetDispatchQueue(stream, queue)
+        FSEventStreamStart(stream)
+        self.stream = stream
+    }
+
+    func stop() {
+        guard let stream = stream else { return }
+        FSEventStreamStop(stream)
+        FSEventStreamInvalidate(stream)
+        FSEventStreamRelease(stream)
+        self.stream = nil
+        handler = nil
+    }
+}
+
+/// Change source that compares file modification dates and sizes on a timer
+/// Looks `depth` levels below each watched directory (2 covers chars/<folder>/<file>).
+final class PollingChangeSource: LibraryChangeSource {
+
+    private let interval: TimeInterval
+    private let depth: Int
+    private let queue = DispatchQueue(label: "com.ikemenlab.libraryWatcher.polling", qos: .utility)
+    private var timer: DispatchSourceTimer?
+    private var lastState: [String: String] = [:]
+
+    init(interval: TimeInterval = 1.0, depth: Int = 2) {
+        self.interval = interval
+        self.depth = depth
+    }
+
+    deinit {
+        timer?.cancel()
+    }
+
+    func start(watching paths: [URL], handler: @escaping ([String]) -> Void) {
+        stop()
+
+        queue.sync {
+            lastState = state(of: paths)
+        }
+
+        let timer = DispatchSource.makeTimerSource(queue: queue)
+        timer.schedule(deadline: .now() + interval, repeating: interval)
+        timer.setEventHandler { [weak self] in
+            guard let self = self else { return }
+            let current = self.state(of: paths)
+            let changed = Set(current.keys).union(self.lastState.keys).filter { current[$0] != self.lastState[$0] }
+            self.lastState = current
+            if !changed.isEmpty {
+                handler(changed.sorted())
+            }
+        }
+        timer.resume()
+        self.timer = timer
+    }
+
+    func stop() {
+        timer?.cancel()
+        timer = nil
+    }
+
+    /// Modification date and size of every path within `depth` levels of the roots
+    private func state(of roots: [URL]) -> [String: String] {
+        var state: [String: String] = [:]
+        let keys: [URLResourceKey] = [.isDirectoryKey, .contentModificationDateKey, .fileSizeKey]
+
+        func visit(_ url: URL, level: Int) {
+            guard let values = try? url.resourceValues(forKeys: Set(keys)) else { return }
+            let modifiedAt = values.contentModificationDate?.timeIntervalSince1970 ?? 0
+            state[url.standardizedFileURL.path] = "\(modifiedAt):\(values.fileSize ?? 0)"
+
+            guard values.isDirectory == true, level < depth,
+                  let children = try? FileManager.default.contentsOfDirectory(at: url, includingPropertiesForKeys: keys) else {
+                return
+            }
+            for child in children {
+                visit(child, level: level + 1)
+            }
+        }
+
+        for root in roots {
+            visit(root, level: 0)
+        }
+        return state
+    }
+}
+
+// MARK: - Library Watcher
+
+/// Watches chars/, stages/ and data/ (including data/select.def) for changes made outside the app
+///
+/// Events are coalesced: a burst such as unzipping a pack into chars/ is delivered once, after
+/// `coalescingInterval` of quiet or at most `maximumDelay` after its first event, reduced to the
+/// top-level entries it touched so only those are re-parsed.
+final class LibraryWatcher {
+
+    // MARK: - Properties
+
+    let root: URL
+    private let source: LibraryChangeSource
+    private let coalescingInterval: TimeInterval
+    private let maximumDelay: TimeInterval
+    private let handler: (LibraryChangeSet) -> Void
+
+    private let queue = DispatchQueue(label: "com.ikemenlab.libraryWatcher", qos: .utility)
+    private var pendingPaths = Set<String>()
+    private var firstPendingAt: Date?
+    private var flushWork: DispatchWorkItem?
+
+    // MARK: - Initialization
+
+    /// - Parameters:
+    ///   - root: Ikemen GO working directory
+    ///   - source: Where filesystem events come from
+    ///   - handler: Called on a background queue with each coalesced batch of changes
+    init(root: URL,
+         source: LibraryChangeSource = FSEventsChangeSource(),
+         coalescingInterval: TimeInterval = 0.25,
+         maximumDelay: TimeInterval = 0.6,
+         handler: @escaping (LibraryChangeSet) -> Void) {
+        self.root = root
+        self.source = source
+        self.coalescingInterval = coalescingInterval
+        self.maximumDelay = maximumDelay
+        self.handler = handler
+    }
+
+    deinit {
+        source.stop()
+    }
+
+    // MARK: - Control
+
+    func start() {
+        let watched = ["chars", "stages", "data"].map { root.appendingPathComponent($0, isDirectory: true) }
+        source.start(watching: watched) { [weak self] paths in
+            self?.queue.async {
+                self?.enqueue(paths)
+            }
+        }
+    }
+
+    func stop() {
+        source.stop()
+        queue.sync {
+            flushWork?.cancel()
+            flushWork = nil
+            pendingPaths.removeAll()
+            firstPendingAt = nil
+        }
+    }
+
+    // MARK: - Coalescing
+
+    private func enqueue(_ paths: [String]) {
+        pendingPaths.formUnion(paths)
+
+        let now = Date()
+        let firstPendingAt = self.firstPendingAt ?? now
+        self.firstPendingAt = firstPendingAt
+
+        // Wait for a quiet period, but never past the maximum delay since the burst began
+        let remaining = max(0, maximumDelay - now.timeIntervalSince(firstPendingAt))
+        let delay = min(coalescingInterval, remaining)
+
+        flushWork?.cancel()
+        let work = DispatchWorkItem { [weak self] in
+            self?.flush()
+        }
+        flushWork = work
+        queue.asyncAfter(deadline: .now() + delay, execute: work)
+    }
+
+    private func flush() {
+        let paths = pendingPaths
+        pendingPaths.removeAll()
+        firstPendingAt = nil
+        flushWork = nil
+
+        let changes = LibraryWatcher.changes(for: paths, root: root)
+        guard !changes.isEmpty else { return }
+        handler(changes)
+    }
+
+    // MARK: - Path Mapping
+
+    /// Reduce changed paths to the library entries they belong to
+    static func changes<Paths: Sequence>(for paths: Paths, root: URL) -> LibraryChangeSet where Paths.Element == String {
+        // FSEvents reports resolved paths (e.g. /private/var rather than /var)
+        let roots = Set([root.standardizedFileURL.path, root.resolvingSymlinksInPath().path])
+        var changes = LibraryChangeSet()
+
+        for path in paths {
+            guard let relative = roots.lazy.compactMap({ relativePath(of: path, under: $0) }).first else { continue }
+            let components = relative.split(separator: "/").map(String.init)
+            guard let top = components.first?.lowercased() else { continue }
+
+            switch top {
+            case "chars":
+                if components.count > 1 {
+                    changes.characterFolders.insert(components[1])
+                } else {
+                    changes.rescanCharacters = true
+                }
+            case "stages":
+                if components.count > 1 {
+                    changes.stageEntries.insert(components[1])
+                } else {
+                    changes.rescanStages = true
+                }
+            case "data":
+                guard components.count > 1 else {
+                    changes.screenpacks = true
+                    continue
+                }
+                let name = components[1].lowercased()
+                if components.count == 2 && name == "select.def" {
+                    changes.selectDef = true
+                } else if components.count == 2 && name.hasPrefix("select.def") {
+                    // select.def backups written by SelectDefGenerator
+                    continue
+                } else {
+                    changes.screenpacks = true
+                }
+            default:
+                continue
+            }
+        }
+
+        return changes
+    }
+
+    private static func relativePath(of path: String, under root: String) -> String? {
+        let prefix = root.hasSuffix("/") ? root : root + "/"
+        guard path.hasPrefix(prefix) else { return nil }
+        return String(path.dropFirst(prefix.count))
+    }
+}
@@ -92,6 +92,158 @@ public struct CharacterCustomTag: Codable, FetchableRecord, PersistableRecord {
     public var createdAt: Date
 }
 
+/// Persisted sprite directory for an SFF file (see SFFDirectoryIndex)
+/// Invalidated whenever the file's size or modification date changes
+public struct SFFDirectoryRecord: Codable, FetchableRecord, PersistableRecord {
+    public static let databaseTableName = "sff_directories"
+    
+    public var path: String             // Standardized absolute path (primary key)
+    public var fileSize: Int64
+    public var modifiedAt: Double       // Modification date as seconds since 1970
+    public var version: Int             // SFF major version
+    public var spriteCount: Int
+    public var paletteCount: Int
+    public var entries: Data            // Packed SFFSpriteDirectory entries
+    public var indexedAt: Date
+}
+
+/// Header-derived statistics for an SFF file (see SFFStatsScanner)
+/// Invalidated whenever the file's size or modification date changes
+public struct SFFStatsRecord: Codable, FetchableRecord, PersistableRecord {
+    public static let databaseTableName = "sff_stats"
+    
+    public var path: String             // Standardized absolute path (primary key)
+    public var characterId: String?     // Owning character, when scanned as part of the library
+    public var fileSize: Int64
+    public var modifiedAt: Double       // Modification date as seconds since 1970
+    public var version: Int
+    public var spriteCount: Int
+    public var linkedSpriteCount: Int
+    public var paletteCount: Int
+    public var characterPaletteCount: Int
+    public var formatCounts: String     // JSON object of format name -> sprite count
+    public var maxSpriteWidth: Int
+    public var maxSpriteHeight: Int
+    public var portraitWidth: Int?
+    public var portraitHeight: Int?
+    public var decodedPixelCount: Int64
+    public var scannedAt: Date
+    
+    public init(path: String, characterId: String?, fileSize: Int64, modifiedAt: Double, stats: SFFStats) {
+        self.path = path
+        self.characterId = characterId
+        self.fileSize = fileSize
+        self.modifiedAt = modifiedAt
+        self.version = stats.version
+        self.spriteCount = stats.spriteCount
+        self.linkedSpriteCount = stats.linkedSpriteCount
+        self.paletteCount = stats.paletteCount
+        self.characterPaletteCount = stats.characterPaletteCount
+        let encoded = (try? JSONEncoder().encode(stats.formatCounts)) ?? Data()
+        self.formatCounts = String(data: encoded, encoding: .utf8) ?? "{}"
+        self.maxSpriteWidth = stats.maxSpriteWidth
+        self.maxSpriteHeight = stats.maxSpriteHeight
+        self.portraitWidth = stats.portraitWidth
+        self.portraitHeight = stats.portraitHeight
+        self.decodedPixelCount = stats.decodedPixelCount
+        self.scannedAt = Date()
+    }
+    
+    /// Decoded stats value
+    public var stats: SFFStats {
+        let counts = (try? JSONDecoder().decode([String: Int].self, from: Data(formatCounts.utf8))) ?? [:]
+        return SFFStats(
+            version: version,
+            spriteCount: spriteCount,
+            linkedSpriteCount: linkedSpriteCount,
+            paletteCount: paletteCount,
+            characterPaletteCount: characterPaletteCount,
+            formatCounts: counts,
+            maxSpriteWidth: maxSpriteWidth,
+            maxSpriteHeight: maxSpriteHeight,
+            portraitWidth: portraitWidth,
+            portraitHeight: portraitHeight,
+            decodedPixelCount: decodedPixelCount
+        )
+    }
+}
+
+/// Outcome of transcoding an SFF file (see SFFTranscoder)
+/// Keyed to the file's size and modification date after the job, so an interrupted library
+/// run resumes with the files it hasn't reached yet
+public struct SFFTranscodeRecord: Codable, FetchableRecord, PersistableRecord {
+    public static let databaseTableName = "sff_transcodes"
+    
+    public var path: String             // Standardized absolute path (primary key)
+    public var characterId: String?
+    public var fileSize: Int64          // Size after the job
+    public var modifiedAt: Double       // Modification date after the job
+    public var status: String           // SFFTranscodeResult.Status raw value
+    public var originalBytes: Int64
+    public var transcodedBytes: Int64
+    public var detail: String?
+    public var transcodedAt: Date
+}
+
+/// Gameplay structure parsed from a character's CNS, CMD and AIR files (see CharacterStructureIndexer)
+/// Invalidated whenever any source file's size or modification date changes
+public struct CharacterStructureRecord: Codable, FetchableRecord, PersistableRecord {
+    public static let databaseTableName = "character_structure"
+    
+    public var characterId: String      // Character folder name (primary key)
+    public var sourceFingerprint: String // Name, size and mtime of every source file
+    public var life: Int
+    public var attack: Int
+    public var defence: Int
+    public var power: Int
+    public var airJuggle: Int
+    public var fallDefenceUp: Int
+    public var stateCount: Int          // [Statedef] blocks across the cns and st files
+    public var commandCount: Int        // [Command] blocks in the CMD
+    public var specialMoveCount: Int
+    public var hyperMoveCount: Int
+    public var actionCount: Int         // AIR actions
+    public var moves: String            // JSON array of MoveCommand, hypers first
+    public var indexedAt: Date
+    
+    /// Decoded stats value
+    public var stats: CNSParser.CharacterStats {
+        CNSParser.CharacterStats(life: life, attack: attack, defence: defence, power: power,
+                                 airJuggle: airJuggle, fallDefenceUp: fallDefenceUp)
+    }
+    
+    /// Decoded move list
+    var moveList: [MoveCommand] {
+        (try? JSONDecoder().decode([MoveCommand].self, from: Data(moves.utf8))) ?? []
+    }
+}
+
+/// Filesystem identity of one library entry and the content parsed from it (see LibrarySnapshot)
+/// Reused on rescan while the entry and its DEF files keep the same inode, size and modification date
+public struct LibrarySnapshotRecord: Codable, FetchableRecord, PersistableRecord {
+    public static let databaseTableName = "library_snapshot"
+    
+    public var path: String             // Standardized folder or top-level .def path (primary key)
+    public var kind: String             // LibrarySnapshot.Kind raw value
+    public var files: String            // Newline-separated DEF paths covered by the fingerprint
+    public var fingerprint: String      // Inode, size and mtime of the entry and each DEF file
+    public var payload: Data            // JSON array of the CharacterInfo/StageInfo values found
+    public var scannedAt: Date
+}
+
+/// Grid thumbnail persisted across launches (see ImageCache)
+/// Ignored once the fingerprint of its source files no longer matches; the least recently
+/// used rows are dropped once the table holds more than `MetadataStore.maxStoredThumbnails`.
+public struct ThumbnailRecord: Codable, FetchableRecord, PersistableRecord {
+    public static let databaseTableName = "thumbnails"
+    
+    public var key: String              // ImageCache thumbnail key (primary key)
+    public var sourceFingerprint: String // Identity of the files the image was decoded from
+    public var imageData: Data          // PNG
+    public var storedAt: Date
+    public var accessedAt: Date         // Last time the grid loaded it
+}
+
 // MARK: - Metadata Store
 
 /// SQLite-backed metadata index for characters and stages
@@ -104,6 +256,9 @@ public final class MetadataStore {
     
     // MARK: - Properties
     
+    /// Most grid thumbnails kept in the database (characters and stages together)
+    public static let maxStoredThumbnails = 5000
+    
     private var dbQueue: DatabaseQueue?
     private let fileManager = FileManager.default
     
@@ -182,6 +337,89 @@ public final class MetadataStore {
             t.column("createdAt", .datetime).notNull()
         }
         
+        // SFF sprite directories (node tables cached per file)
+        try db.create(table: "sff_directories", ifNotExists: true) { t in
+            t.column("path", .text).primaryKey()
+            t.column("fileSize", .integer).notNull()
+            t.column("modifiedAt", .double).notNull()
+            t.column("version", .integer).notNull()
+            t.column("spriteCount", .integer).notNull()
+            t.column("paletteCount", .integer).notNull()
+            t.column("entries", .blob).notNull()
+            t.column("indexedAt", .datetime).notNull()
+        }
+        
+        // SFF statistics (header-only scan results per file)
+        try db.create(table: "sff_stats", ifNotExists: true) { t in
+            t.column("path", .text).primaryKey()
+            t.column("characterId", .text).indexed()
+            t.column("fileSize", .integer).notNull()
+            t.column("modifiedAt", .double).notNull()
+            t.column("version", .integer).notNull()
+            t.column("spriteCount", .integer).notNull()
+            t.column("linkedSpriteCount", .integer).notNull()
+            t.column("paletteCount", .integer).notNull()
+            t.column("characterPaletteCount", .integer).notNull()
+            t.column("formatCounts", .text).notNull()
+            t.column("maxSpriteWidth", .integer).notNull()
+            t.column("maxSpriteHeight", .integer).notNull()
+            t.column("portraitWidth", .integer)
+            t.column("portraitHeight", .integer)
+            t.column("decodedPixelCount", .integer).notNull()
+            t.column("scannedAt", .datetime).notNull()
+        }
+        
+        // SFF transcoding results (resume state for SFFTranscoder)
+        try db.create(table: "sff_transcodes", ifNotExists: true) { t in
+            t.column("path", .text).primaryKey()
+            t.column("characterId", .text).indexed()
+            t.column("fileSize", .integer).notNull()
+            t.column("modifiedAt", .double).notNull()
+            t.column("status", .text).notNull()
+            t.column("originalBytes", .integer).notNull()
+            t.column("transcodedBytes", .integer).notNull()
+            t.column("detail", .text)
+            t.column("transcodedAt", .datetime).notNull()
+        }
+        
+        // Character CNS/CMD/AIR structure (background index for details and smart collections)
+        try db.create(table: "character_structure", ifNotExists: true) { t in
+            t.column("characterId", .text).primaryKey()
+            t.column("sourceFingerprint", .text).notNull()
+            t.column("life", .integer).notNull()
+            t.column("attack", .integer).notNull()
+            t.column("defence", .integer).notNull()
+            t.column("power", .integer).notNull()
+            t.column("airJuggle", .integer).notNull()
+            t.column("fallDefenceUp", .integer).notNull()
+            t.column("stateCount", .integer).notNull()
+            t.column("commandCount", .integer).notNull()
+            t.column("specialMoveCount", .integer).notNull()
+            t.column("hyperMoveCount", .integer).notNull()
+            t.column("actionCount", .integer).notNull()
+            t.column("moves", .text).notNull()
+            t.column("indexedAt", .datetime).notNull()
+        }
+        
+        // Per-folder filesystem snapshot (lets rescans skip unchanged folders)
+        try db.create(table: "library_snapshot", ifNotExists: true) { t in
+            t.column("path", .text).primaryKey()
+            t.column("kind", .text).notNull().indexed()
+            t.column("files", .text).notNull()
+            t.column("fingerprint", .text).notNull()
+            t.column("payload", .blob).notNull()
+            t.column("scannedAt", .datetime).notNull()
+        }
+        
+        // Grid thumbnails (shown at launch before any SFF is decoded)
+        try db.create(table: "thumbnails", ifNotExists: true) { t in
+            t.column("key", .text).primaryKey()
+            t.column("sourceFingerprint", .text).notNull()
+            t.column("imageData", .blob).notNull()
+            t.column("storedAt", .datetime).notNull()
+            t.column("accessedAt", .datetime).notNull()
+        }
+        
         // Add tags column if it doesn't exist (migration)
         let characterColumns = try db.columns(in: "characters").map { $0.name }
         if !characterColumns.contains("tags") {
@@ -190,6 +428,20 @@ public final class MetadataStore {
             }
         }
         
+        // Add thumbnails.accessedAt if it doesn't exist (migration)
+        let thumbnailColumns = try db.columns(in: "thumbnails").map { $0.name }
+        if !thumbnailColumns.contains("accessedAt") {
+            try db.alter(table: "thumbnails") { t in
+                t.add(column: "accessedAt", .datetime)
+            }
+            try db.execute(sql: "UPDATE thumbnails SET accessedAt = storedAt")
+        }
+        
+        try db.execute(sql: """
+            CREATE INDEX IF NOT EXISTS idx_thumbnails_accessed
+            ON thumbnails(accessedAt)
+        """)
+        
         // Full-text search indexes (for future advanced search)
         try db.execute(sql: """
             CREATE INDEX IF NOT EXISTS idx_characters_name_author 
@@ -219,39 +471,19 @@ public final class MetadataStore {
     
     // MARK: - Character Operations
     
-    /// Insert or update a character record
-    public func upsertCharacter(_ record: CharacterRecord) throws {
-        try dbQueue?.write { db in
-            try record.save(db)
-        }
-    }
-    
     /// Insert or update character from CharacterInfo
+    /// An existing row keeps its original `installedAt` (same upsert as `replaceCharacters(with:)`).
     public func indexCharacter(_ info: CharacterInfo) throws {
-        let tagsString = info.inferredTags.joined(separator: ",")
-        
-        let record = CharacterRecord(
-            id: info.id,
-            name: info.displayName,
-            author: info.author,
-            versionDate: info.versionDate.isEmpty ? nil : info.versionDate,
-            spriteFile: info.spriteFile,
-            folderPath: info.directory.path,
-            installedAt: Date(),
-            updatedAt: Date(),
-            sourceGame: nil,
-            style: nil,
-            isHD: nil,
-            hasAI: nil,
-            tags: tagsString.isEmpty ? nil : tagsString
-        )
-        try upsertCharacter(record)
+        try dbQueue?.write { db in
+            try db.execute(sql: Self.characterUpsertSQL, arguments: Self.upsertArguments(for: info, now: Date()))
+        }
     }
     
-    /// Delete a character by ID
+    /// Delete a character (and its stored thumbnail) by ID
     public func deleteCharacter(id: String) throws {
         try dbQueue?.write { db in
             _ = try CharacterRecord.deleteOne(db, key: id)
+            _ = try ThumbnailRecord.deleteOne(db, key: ImageCache.portraitThumbnailKey(for: id))
         }
     }
     
@@ -301,32 +533,19 @@ public final class MetadataStore {
     
     // MARK: - Stage Operations
     
-    /// Insert or update a stage record
-    public func upsertStage(_ record: StageRecord) throws {
-        try dbQueue?.write { db in
-            try record.save(db)
-        }
-    }
-    
     /// Insert or update stage from StageInfo
+    /// An existing row keeps its original `installedAt` (same upsert as `replaceStages(with:)`).
     public func indexStage(_ info: StageInfo) throws {
-        let record = StageRecord(
-            id: info.id,
-            name: info.name,
-            author: info.author,
-            filePath: info.defFile.path,
-            installedAt: Date(),
-            updatedAt: Date(),
-            sourceGame: nil,
-            resolution: nil
-        )
-        try upsertStage(record)
+        try dbQueue?.write { db in
+            try db.execute(sql: Self.stageUpsertSQL, arguments: Self.upsertArguments(for: info, now: Date()))
+        }
     }
     
-    /// Delete a stage by ID
+    /// Delete a stage (and its stored thumbnail) by ID
     public func deleteStage(id: String) throws {
         try dbQueue?.write { db in
             _ = try StageRecord.deleteOne(db, key: id)
+            _ = try ThumbnailRecord.deleteOne(db, key: ImageCache.stagePreviewThumbnailKey(for: id))
         }
     }
     
@@ -386,42 +605,75 @@ public final class MetadataStore {
     
     /// Re-index all characters from filesystem
     /// Useful for syncing database with actual content
-    public func reindexCharacters(from workingDir: URL) throws {
+    /// - Parameter manifest: Listing of chars/ to index; nil uses the shared manifest from the latest refresh
+    public func reindexCharacters(from workingDir: URL, manifest: LibraryManifest? = nil) throws {
         let charsDir = workingDir.appendingPathComponent("chars")
+        guard fileManager.fileExists(atPath: charsDir.path) else { return }
+        let folders = (manifest ?? LibraryManifest.current(charsDirectory: charsDir)).folders
         
-        guard let folders = try? fileManager.contentsOfDirectory(at: charsDir, includingPropertiesForKeys: [.isDirectoryKey]) else {
-            return
+        // Parse DEFs concurrently and outside the write transaction
+        var characters = [CharacterInfo?](repeating: nil, count: folders.count)
+        let lock = NSLock()
+        DispatchQueue.concurrentPerform(iterations: folders.count) { index in
+            // Folders without a character DEF aren't characters (same rule as the library scan)
+            guard let defFile = folders[index].characterDefFile else { return }
+            let info = CharacterInfo(directory: folders[index].url, defFile: defFile)
+            lock.lock()
+            characters[index] = info
+            lock.unlock()
         }
         
-        // Get current DB records
-        let existingIds = Set(try allCharacters().map { $0.id })
-        var foundIds = Set<String>()
+        try replaceCharacters(with: characters.compactMap { $0 })
+    }
+    
+    /// Upsert every given character and remove all others, in a single transaction
+    ///
+    /// Rows go through one prepared upsert that keeps each character's original `installedAt`.
+    /// Removed characters are found set-based, through a temporary table of the ids written, and
+    /// take their structure, SFF directories, stats, transcodes, scan snapshot and stored thumbnail
+    /// with them.
+    public func replaceCharacters(with characters: [CharacterInfo]) throws {
+        let now = Date()
         
-        for folder in folders {
-            var isDir: ObjCBool = false
-            guard fileManager.fileExists(atPath: folder.path, isDirectory: &isDir), isDir.boolValue else {
-                continue
+        try dbQueue?.write { db in
+            let upsert = try db.makeStatement(sql: Self.characterUpsertSQL)
+            for info in characters {
+                try upsert.execute(arguments: Self.upsertArguments(for: info, now: now))
             }
             
-            let charName = folder.lastPathComponent
-            if charName.hasPrefix(".") { continue }
+            try createSeenIdTable(characters.map { $0.id }, in: db)
+            
+            // Characters that weren't written, with the folder prefix their cached SFF data lives under
+            try db.execute(sql: """
+                DROP TABLE IF EXISTS temp.reindex_removed;
+                CREATE TEMP TABLE reindex_removed AS
+                    SELECT id, folderPath || '/' AS prefix FROM characters
+                    WHERE id NOT IN (SELECT id FROM temp.reindex_seen);
+                """)
             
-            foundIds.insert(charName)
+            let removedFolders = try String.fetchAll(db, sql: "SELECT folderPath FROM characters WHERE id IN (SELECT id FROM temp.reindex_removed)")
+            try deleteLibrarySnapshots(for: removedFolders, in: db)
             
-            // Find .def file
-            if let contents = try? fileManager.contentsOfDirectory(at: folder, includingPropertiesForKeys: nil) {
-                let defFiles = contents.filter { $0.pathExtension.lowercased() == "def" }
-                if let defFile = defFiles.first {
-                    let info = CharacterInfo(directory: folder, defFile: defFile)
-                    try indexCharacter(info)
-                }
+            for table in [SFFDirectoryRecord.databaseTableName, SFFStatsRecord.databaseTableName, SFFTranscodeRecord.databaseTableName] {
+                try db.execute(sql: """
+                    DELETE FROM \(table) WHERE EXISTS (
+                        SELECT 1 FROM temp.reindex_removed r
+                        WHERE substr(\(table).path, 1, length(r.prefix)) = r.prefix
+                    )
+                    """)
             }
-        }
-        
-        // Remove entries for deleted characters
-        let deletedIds = existingIds.subtracting(foundIds)
-        for id in deletedIds {
-            try deleteCharacter(id: id)
+            
+            try db.execute(
+                sql: "DELETE FROM thumbnails WHERE key IN (SELECT ? || id FROM temp.reindex_removed)",
+                arguments: [ImageCache.portraitThumbnailKey(for: "")]
+            )
+            
+            try db.execute(sql: """
+                DELETE FROM character_structure WHERE characterId IN (SELECT id FROM temp.reindex_removed);
+                DELETE FROM characters WHERE id IN (SELECT id FROM temp.reindex_removed);
+                DROP TABLE temp.reindex_removed;
+                DROP TABLE temp.reindex_seen;
+                """)
         }
     }
     
@@ -433,8 +685,7 @@ public final class MetadataStore {
             return
         }
         
-        let existingIds = Set(try allStages().map { $0.id })
-        var foundIds = Set<String>()
+        var stages: [StageInfo] = []
         
         for file in files where file.pathExtension.lowercased() == "def" {
             let stageId = file.deletingPathExtension().lastPathComponent
@@ -443,16 +694,105 @@ public final class MetadataStore {
             // Skip non-stage .def files (storyboards, characters, fonts, etc.)
             guard DEFParser.isValidStageDefFile(file) else { continue }
             
-            foundIds.insert(stageId)
+            stages.append(StageInfo(defFile: file))
+        }
+        
+        try replaceStages(with: stages)
+    }
+    
+    /// Upsert every given stage and remove all others, in a single transaction
+    /// Same approach as `replaceCharacters(with:)`: one prepared upsert, set-based removal.
+    public func replaceStages(with stages: [StageInfo]) throws {
+        let now = Date()
+        
+        try dbQueue?.write { db in
+            let upsert = try db.makeStatement(sql: Self.stageUpsertSQL)
+            for info in stages {
+                try upsert.execute(arguments: Self.upsertArguments(for: info, now: now))
+            }
+            
+            try createSeenIdTable(stages.map { $0.id }, in: db)
+            
+            // A stage's snapshot entry is either its top-level .def or the folder holding it
+            let removedFiles = try String.fetchAll(db, sql: "SELECT filePath FROM stages WHERE id NOT IN (SELECT id FROM temp.reindex_seen)")
+            try deleteLibrarySnapshots(for: removedFiles + removedFiles.map { ($0 as NSString).deletingLastPathComponent }, in: db)
             
-            let info = StageInfo(defFile: file)
-            try indexStage(info)
+            try db.execute(
+                sql: """
+                    DELETE FROM thumbnails WHERE key IN (
+                        SELECT ? || id FROM stages WHERE id NOT IN (SELECT id FROM temp.reindex_seen)
+                    )
+                    """,
+                arguments: [ImageCache.stagePreviewThumbnailKey(for: "")]
+            )
+            try db.execute(sql: """
+                DELETE FROM stages WHERE id NOT IN (SELECT id FROM temp.reindex_seen);
+                DROP TABLE temp.reindex_seen;
+                """)
         }
+    }
+    
+    /// Insert a character, or update everything but `installedAt` if the id exists
+    private static let characterUpsertSQL = """
+        INSERT INTO characters (id, name, author, versionDate, spriteFile, folderPath, installedAt, updatedAt, tags)
+        VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?)
+        ON CONFLICT(id) DO UPDATE SET
+            name = excluded.name,
+            author = excluded.author,
+            versionDate = excluded.versionDate,
+            spriteFile = excluded.spriteFile,
+            folderPath = excluded.folderPath,
+            updatedAt = excluded.updatedAt,
+            tags = excluded.tags
+        """
+    
+    /// Insert a stage, or update everything but `installedAt` if the id exists
+    private static let stageUpsertSQL = """
+        INSERT INTO stages (id, name, author, filePath, installedAt, updatedAt)
+        VALUES (?, ?, ?, ?, ?, ?)
+        ON CONFLICT(id) DO UPDATE SET
+            name = excluded.name,
+            author = excluded.author,
+            filePath = excluded.filePath,
+            updatedAt = excluded.updatedAt
+        """
+    
+    private static func upsertArguments(for info: CharacterInfo, now: Date) -> StatementArguments {
+        let tags = info.inferredTags.joined(separator: ",")
+        return [
+            info.id,
+            info.displayName,
+            info.author,
+            info.versionDate.isEmpty ? nil : info.versionDate,
+            info.spriteFile,
+            info.directory.path,
+            now,
+            now,
+            tags.isEmpty ? nil : tags
+        ]
+    }
+    
+    private static func upsertArguments(for info: StageInfo, now: Date) -> StatementArguments {
+        return [info.id, info.name, info.author, info.defFile.path, now, now]
+    }
+    
+    /// Drop scan snapshot entries for these paths, keyed the way LibrarySnapshot stores them
+    private func deleteLibrarySnapshots(for paths: [String], in db: Database) throws {
+        guard !paths.isEmpty else { return }
+        _ = try LibrarySnapshotRecord.deleteAll(db, keys: paths.map { URL(fileURLWithPath: $0).standardizedFileURL.path })
+    }
+    
+    /// Fill a temporary `reindex_seen(id)` table with the ids a reindex wrote
+    /// Lives for the connection; callers drop it before their transaction ends.
+    private func createSeenIdTable(_ ids: [String], in db: Database) throws {
+        try db.execute(sql: """
+            DROP TABLE IF EXISTS temp.reindex_seen;
+            CREATE TEMP TABLE reindex_seen (id TEXT PRIMARY KEY);
+            """)
         
-        // Remove entries for deleted stages
-        let deletedIds = existingIds.subtracting(foundIds)
-        for id in deletedIds {
-            try deleteStage(id: id)
+        let insert = try db.makeStatement(sql: "INSERT OR IGNORE INTO temp.reindex_seen (id) VALUES (?)")
+        for id in ids {
+            try insert.execute(arguments: [id])
         }
     }
     
@@ -706,6 +1046,199 @@ public final class MetadataStore {
         }
     }
     
+    // MARK: - SFF Directory Operations
+    
+    /// Get the stored sprite directory for an SFF file if it is still current
+    /// Returns nil when the file has changed size or modification date since it was indexed
+    public func sffDirectory(path: String, fileSize: Int64, modifiedAt: Double) throws -> SFFDirectoryRecord? {
+        try dbQueue?.read { db in
+            try SFFDirectoryRecord
+                .filter(Column("path") == path)
+                .filter(Column("fileSize") == fileSize)
+                .filter(Column("modifiedAt") == modifiedAt)
+                .fetchOne(db)
+        }
+    }
+    
+    /// Insert or replace the sprite directory for an SFF file
+    public func storeSFFDirectory(_ record: SFFDirectoryRecord) throws {
+        try dbQueue?.write { db in
+            try record.save(db)
+        }
+    }
+    
+    // MARK: - SFF Stats Operations
+    
+    /// Get the stored stats for an SFF file if they are still current
+    public func sffStats(path: String, fileSize: Int64, modifiedAt: Double) throws -> SFFStatsRecord? {
+        try dbQueue?.read { db in
+            try SFFStatsRecord
+                .filter(Column("path") == path)
+                .filter(Column("fileSize") == fileSize)
+                .filter(Column("modifiedAt") == modifiedAt)
+                .fetchOne(db)
+        }
+    }
+    
+    /// Get all stored SFF stats
+    public func allSFFStats() throws -> [SFFStatsRecord] {
+        try dbQueue?.read { db in
+            try SFFStatsRecord.fetchAll(db)
+        } ?? []
+    }
+    
+    /// Insert or replace stats for a batch of SFF files in a single transaction
+    public func storeSFFStats(_ records: [SFFStatsRecord]) throws {
+        guard !records.isEmpty else { return }
+        try dbQueue?.write { db in
+            for record in records {
+                try record.save(db)
+            }
+        }
+    }
+    
+    // MARK: - SFF Transcode Operations
+    
+    /// Get all stored transcoding results
+    public func allSFFTranscodes() throws -> [SFFTranscodeRecord] {
+        try dbQueue?.read { db in
+            try SFFTranscodeRecord.fetchAll(db)
+        } ?? []
+    }
+    
+    /// Insert or replace the transcoding result for an SFF file
+    public func storeSFFTranscode(_ record: SFFTranscodeRecord) throws {
+        try dbQueue?.write { db in
+            try record.save(db)
+        }
+    }
+    
+    // MARK: - Character Structure Operations
+    
+    /// Get the stored structure for a character
+    public func characterStructure(id: String) throws -> CharacterStructureRecord? {
+        try dbQueue?.read { db in
+            try CharacterStructureRecord.fetchOne(db, key: id)
+        }
+    }
+    
+    /// Get all stored character structures
+    public func allCharacterStructures() throws -> [CharacterStructureRecord] {
+        try dbQueue?.read { db in
+            try CharacterStructureRecord.fetchAll(db)
+        } ?? []
+    }
+    
+    /// Insert or replace structures for a batch of characters in a single transaction
+    public func storeCharacterStructures(_ records: [CharacterStructureRecord]) throws {
+        guard !records.isEmpty else { return }
+        try dbQueue?.write { db in
+            for record in records {
+                try record.save(db)
+            }
+        }
+    }
+    
+    /// Remove the stored structure for a character
+    public func deleteCharacterStructure(id: String) throws {
+        try dbQueue?.write { db in
+            _ = try CharacterStructureRecord.deleteOne(db, key: id)
+        }
+    }
+    
+    // MARK: - Library Snapshot Operations
+    
+    /// Get the stored snapshot entries of one kind
+    public func librarySnapshot(kind: String) throws -> [LibrarySnapshotRecord] {
+        try dbQueue?.read { db in
+            try LibrarySnapshotRecord
+                .filter(Column("kind") == kind)
+                .fetchAll(db)
+        } ?? []
+    }
+    
+    /// Get every stored snapshot entry (all kinds) in one query
+    public func allLibrarySnapshots() throws -> [LibrarySnapshotRecord] {
+        try dbQueue?.read { db in
+            try LibrarySnapshotRecord.fetchAll(db)
+        } ?? []
+    }
+    
+    /// Get the stored snapshot entries for specific paths
+    public func librarySnapshot(paths: [String]) throws -> [LibrarySnapshotRecord] {
+        try dbQueue?.read { db in
+            try LibrarySnapshotRecord.fetchAll(db, keys: paths)
+        } ?? []
+    }
+    
+    /// Store changed snapshot entries and delete the given paths in a single transaction
+    public func updateLibrarySnapshot(_ records: [LibrarySnapshotRecord], removingPaths paths: [String]) throws {
+        try dbQueue?.write { db in
+            for record in records {
+                try record.save(db)
+            }
+            if !paths.isEmpty {
+                _ = try LibrarySnapshotRecord.deleteAll(db, keys: paths)
+            }
+        }
+    }
+    
+    /// Store changed snapshot entries and drop entries of the same kind that no longer exist,
+    /// in a single transaction
+    /// - Parameters:
+    ///   - records: New or changed entries
+    ///   - kind: Entry kind being updated
+    ///   - livePaths: Every path seen by the scan; other entries of this kind are deleted
+    public func updateLibrarySnapshot(_ records: [LibrarySnapshotRecord], kind: String, livePaths: Set<String>) throws {
+        try dbQueue?.write { db in
+            for record in records {
+                try record.save(db)
+            }
+            
+            let storedPaths = try String.fetchAll(db, sql: "SELECT path FROM library_snapshot WHERE kind = ?", arguments: [kind])
+            let removedPaths = storedPaths.filter { !livePaths.contains($0) }
+            if !removedPaths.isEmpty {
+                _ = try LibrarySnapshotRecord.deleteAll(db, keys: removedPaths)
+            }
+        }
+    }
+    
+    // MARK: - Thumbnail Operations
+    
+    /// Get stored thumbnails for a set of keys in one query
+    public func thumbnails(keys: [String]) throws -> [ThumbnailRecord] {
+        guard !keys.isEmpty else { return [] }
+        return try dbQueue?.read { db in
+            try ThumbnailRecord.fetchAll(db, keys: keys)
+        } ?? []
+    }
+    
+    /// Insert or replace a stored thumbnail, then drop the least recently used rows over the limit
+    public func storeThumbnail(_ record: ThumbnailRecord, limit: Int = MetadataStore.maxStoredThumbnails) throws {
+        try dbQueue?.write { db in
+            try record.save(db)
+            
+            // Walks the accessedAt index only as far as the limit
+            try db.execute(sql: """
+                DELETE FROM thumbnails WHERE accessedAt < (
+                    SELECT accessedAt FROM thumbnails ORDER BY accessedAt DESC LIMIT 1 OFFSET ?
+                )
+                """, arguments: [limit - 1])
+        }
+    }
+    
+    /// Mark stored thumbnails as used now, so the size cap keeps them
+    public func touchThumbnails(keys: [String]) throws {
+        guard !keys.isEmpty else { return }
+        try dbQueue?.write { db in
+            let now = Date()
+            let update = try db.makeStatement(sql: "UPDATE thumbnails SET accessedAt = ? WHERE key = ?")
+            for key in keys {
+                try update.execute(arguments: [now, key])
+            }
+        }
+    }
+    
     // MARK: - Utility
     
     /// Check if database is initialized
@@ -0,0 +1,169 @@
+import Foundation
+import AppKit
+
+// MARK: - SFF Animation Stream
+
+/// Streams the frames of one AIR action from an open SFF archive
+///
+/// Frames are decoded on demand and held in a small LRU keyed by the sprite they resolve to,
+/// so an idle loop that revisits the same sprite (0,0 -> 0,1 -> 0,0) decodes it once. Each slot
+/// keeps the sprite's 8-bit index buffer next to its rendered image: switching palettes only
+/// re-expands the cached index buffers instead of decoding the frames again.
+final class SFFAnimationStream {
+
+    // MARK: - Properties
+
+    /// The action being played
+    let action: AIRAction
+
+    private let archive: SFFArchive
+
+    /// Maximum number of decoded sprites kept in memory
+    let capacity: Int
+
+    /// Palette override for indexed sprites (nil = each sprite's own palette)
+    private var palette: SFFPaletteKernel.LookupTable?
+
+    private struct Slot {
+        /// Index buffer, for sprites that can be recolored
+        let sprite: SFFArchive.IndexedSprite?
+        /// Rendered frame; dropped on palette change and re-expanded from `sprite`
+        var image: NSImage?
+    }
+
+    /// Resolved sprite index -> decoded slot
+    private var slots: [Int: Slot] = [:]
+
+    /// Slot keys, least recently used first
+    private var recency: [Int] = []
+
+    private let lock = NSLock()
+
+    // MARK: - Initialization
+
+    init(archive: SFFArchive, action: AIRAction, capacity: Int = 16, palette: SFFPaletteKernel.LookupTable? = nil) {
+        self.archive = archive
+        self.action = action
+        self.capacity = max(1, capacity)
+        self.palette = palette
+    }
+
+    /// Open the stand animation (action 0) of a character
+    /// Only the AIR index and action 0's block are read; no frames are decoded yet
+    static func idle(for character: CharacterInfo, palette: SFFPaletteKernel.LookupTable? = nil) -> SFFAnimationStream? {
+        guard let sffURL = character.spriteFileURL,
+              let airURL = animationFileURL(for: character),
+              let action = AIRParser.index(for: airURL)?.action(0),
+              !action.frames.isEmpty,
+              let archive = try? SFFArchive(url: sffURL) else {
+            return nil
+        }
+        return SFFAnimationStream(archive: archive, action: action, palette: palette)
+    }
+
+    /// The AIR file named in the DEF, else the first .air in the character folder
+    private static func animationFileURL(for character: CharacterInfo) -> URL? {
+        let fileManager = FileManager.default
+
+        if let anim = DEFParser.parse(url: character.defFile)?.animFile {
+            let url = character.directory.appendingPathComponent(anim)
+            if fileManager.fileExists(atPath: url.path) {
+                return url
+            }
+        }
+
+        let contents = (try? fileManager.contentsOfDirectory(at: character.directory, includingPropertiesForKeys: nil)) ?? []
+        return contents.first { $0.pathExtension.lowercased() == "air" }
+    }
+
+    // MARK: - Frames
+
+    var frameCount: Int { action.frames.count }
+
+    func frame(at index: Int) -> AIRFrame {
+        return action.frames[index]
+    }
+
+    /// Frame to show after `index`, honoring the action's loop start
+    func nextFrameIndex(after index: Int) -> Int {
+        let next = index + 1
+        return next < frameCount ? next : action.loopStart
+    }
+
+    /// Image for a frame, decoding its sprite if it isn't cached
+    /// - Returns: The sprite image, or nil if the frame's sprite is missing or can't be decoded
+    func image(at frameIndex: Int) -> NSImage? {
+        guard action.frames.indices.contains(frameIndex) else { return nil }
+        let frame = action.frames[frameIndex]
+
+        guard let spriteIndex = archive.directory.index(group: frame.group, image: frame.image),
+              let resolved = archive.resolvedIndex(spriteIndex) else { return nil }
+
+        lock.lock()
+        defer { lock.unlock() }
+
+        if var slot = slots[resolved] {
+            touch(resolved)
+            if let image = slot.image {
+                return image
+            }
+            slot.image = slot.sprite.flatMap(render)
+            slots[resolved] = slot
+            return slot.image
+        }
+
+        // True-color sprites have no index buffer and are cached as images only
+        let sprite = archive.indexedSprite(at: resolved)
+        let image = sprite.flatMap(render) ?? archive.image(at: resolved)
+        insert(Slot(sprite: sprite, image: image), for: resolved)
+        return image
+    }
+
+    /// Decode this action's frames up front (up to the LRU capacity)
+    func prefetch() {
+        for index in 0..<min(frameCount, capacity) {
+            _ = image(at: index)
+        }
+    }
+
+    /// Recolor all frames with a different palette, reusing the cached index buffers
+    func setPalette(_ table: SFFPaletteKernel.LookupTable?) {
+        lock.lock()
+        defer { lock.unlock() }
+
+        palette = table
+        for key in slots.keys where slots[key]?.sprite != nil {
+            slots[key]?.image = nil
+        }
+    }
+
+    /// Number of sprites currently decoded
+    var cachedSpriteCount: Int {
+        lock.lock()
+        defer { lock.unlock() }
+        return slots.count
+    }
+
+    // MARK: - LRU
+
+    private func render(_ sprite: SFFArchive.IndexedSprite) -> NSImage? {
+        return SFFUtils.createImage(fromIndices: sprite.pixels, width: sprite.width, height: sprite.height,
+                                    table: palette ?? sprite.table, maxPixelSize: nil)
+    }
+
+    private func touch(_ key: Int) {
+        if let position = recency.firstIndex(of: key) {
+            recency.remove(at: position)
+        }
+        recency.append(key)
+    }
+
+    private func insert(_ slot: Slot, for key: Int) {
+        slots[key] = slot
+        touch(key)
+
+        while recency.count > capacity {
+            slots.removeValue(forKey: recency.removeFirst())
+        }
+    }
+}
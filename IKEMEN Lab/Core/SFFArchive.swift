@@ -0,0 +1,251 @@
+import Foundation
+import AppKit
+
+// MARK: - SFF Archive
+
+/// Random-access handle on an open SFF file
+///
+/// Opens the file once (memory-mapped via `SFFReader`), resolves its sprite directory through
+/// `SFFDirectoryIndex`, and decodes individual sprites on demand. Linked sprites and linked
+/// palettes are followed iteratively, so a portrait that points at another sprite decodes
+/// like any other. Intended to be shared by the grid, the detail view, palette previews and
+/// validators instead of each running its own parse.
+public final class SFFArchive {
+
+    // MARK: - Properties
+
+    /// Reader over the underlying file
+    public let reader: SFFReader
+
+    /// Sprite directory (node table) of the file
+    public let directory: SFFSpriteDirectory
+
+    /// External .act palette (768 bytes RGB) used by SFFv1 sprites that share a palette
+    public let externalPalette: Data?
+
+    /// SFFv1 shared palette: the first sprite's embedded palette, else the external palette
+    private let sharedPalette: Data?
+
+    /// SFFv2 palette node table offset and literal data offset
+    private let paletteListOffset: Int
+    private let ldataOffset: Int
+
+    /// SFF major version (1 or 2)
+    public var version: Int { directory.version }
+
+    public var spriteCount: Int { directory.spriteCount }
+
+    public var paletteCount: Int { directory.paletteCount }
+
+    // MARK: - Initialization
+
+    /// Open an archive over an existing reader
+    /// - Parameters:
+    ///   - reader: Reader over the SFF file
+    ///   - externalPalette: Optional .act palette for SFFv1 shared-palette sprites
+    /// - Throws: `SFFError` if the file is too small, not an SFF, or has no readable node table
+    public init(reader: SFFReader, externalPalette: Data? = nil) throws {
+        guard reader.count > 32 else { throw SFFError.fileTooSmall }
+        guard reader.hasValidSignature else { throw SFFError.invalidSignature }
+        guard let directory = SFFDirectoryIndex.shared.directory(for: reader) else {
+            throw SFFError.corruptedData("Invalid sprite count or offset")
+        }
+
+        self.reader = reader
+        self.directory = directory
+        self.externalPalette = externalPalette
+        self.paletteListOffset = Int(reader.readUInt32(at: 44))
+        self.ldataOffset = Int(reader.readUInt32(at: 52))
+
+        // Embedded palette takes PRIORITY over external .act (which may be an alternate palette)
+        // Only the palette trailer (marker byte + 768 colors) of the first sprite is read
+        var shared = externalPalette
+        if directory.version == 1, let first = directory.entries.first,
+           first.dataLength > 769 && first.paletteIndex == 0,
+           let trailer = reader.bytes(at: Int(first.dataOffset) + Int(first.dataLength) - 770, length: 770),
+           let embedded = SFFv1Parser.extractPCXPalette(from: trailer) {
+            shared = embedded
+        }
+        self.sharedPalette = shared
+    }
+
+    /// Open an archive over an SFF file on disk
+    public convenience init(url: URL, externalPalette: Data? = nil) throws {
+        try self.init(reader: try SFFReader(url: url), externalPalette: externalPalette)
+    }
+
+    // MARK: - Lookup
+
+    /// Whether the archive contains the given sprite
+    public func contains(group: Int, image: Int) -> Bool {
+        return directory.index(group: group, image: image) != nil
+    }
+
+    /// Directory entry for the given sprite (may be a linked node)
+    public func entry(group: Int, image: Int) -> SFFSpriteDirectory.Entry? {
+        return directory.entry(group: group, image: image)
+    }
+
+    /// Follow sprite links until reaching the node that owns the pixel data
+    /// - Parameter index: Index of a sprite node
+    /// - Returns: Index of the node holding the payload, or nil for broken/cyclic links
+    public func resolvedIndex(_ index: Int) -> Int? {
+        return directory.resolvedIndex(index)
+    }
+
+    /// Resolved directory entry for the given sprite, following links
+    public func resolvedEntry(group: Int, image: Int) -> SFFSpriteDirectory.Entry? {
+        return directory.resolvedEntry(group: group, image: image)
+    }
+
+    // MARK: - Palettes
+
+    /// Read an SFFv2 palette node as 256 RGBA entries, following palette links
+    /// - Parameter paletteIndex: Index into the palette node table
+    /// - Returns: 1024 bytes (256 x RGBA), or nil if the node or its data is missing
+    public func palette(at paletteIndex: Int) -> [UInt8]? {
+        guard version >= 2 else { return nil }
+
+        var current = paletteIndex
+        for _ in 0...max(directory.paletteCount, 1) {
+            let nodeOffset = paletteListOffset + current * 16
+            guard current >= 0, reader.contains(offset: nodeOffset, length: 16) else { return nil }
+
+            let colorCount = Int(reader.readUInt16(at: nodeOffset + 4))
+            let linkedIndex = Int(reader.readUInt16(at: nodeOffset + 6))
+            let palDataOffset = Int(reader.readUInt32(at: nodeOffset + 8))
+            let palDataLength = reader.readUInt32(at: nodeOffset + 12)
+
+            // Palettes without data of their own reuse the linked palette's colors
+            if palDataLength == 0 {
+                guard linkedIndex != current else { return nil }
+                current = linkedIndex
+                continue
+            }
+
+            guard let colors = reader.bytes(at: ldataOffset + palDataOffset, length: min(colorCount, 256) * 4) else {
+                return nil
+            }
+
+            var palette = [UInt8](repeating: 0, count: 256 * 4)
+            palette.replaceSubrange(0..<colors.count, with: colors)
+            return palette
+        }
+        return nil
+    }
+
+    // MARK: - Indexed Decoding
+
+    /// An 8-bit sprite decoded to palette indices, ready to be recolored with any palette
+    struct IndexedSprite {
+        let width: Int
+        let height: Int
+        /// Tightly packed palette indices (`width * height`)
+        let pixels: [UInt8]
+        /// Lookup table the sprite decodes with by default
+        let table: SFFPaletteKernel.LookupTable
+        /// Indexed PNG sprites take alpha from the palette; other formats are opaque
+        let usesPaletteAlpha: Bool
+    }
+
+    /// Decode a sprite to palette indices, following links
+    /// - Parameter index: Index into `directory.entries`
+    /// - Returns: The index buffer and its default palette, or nil for true-color or undecodable sprites
+    func indexedSprite(at index: Int) -> IndexedSprite? {
+        guard let resolved = resolvedIndex(index) else { return nil }
+        let entry = directory.entries[resolved]
+
+        if version >= 2 {
+            guard entry.colorDepth == 8, entry.format != 11, entry.format != 12,
+                  let payload = reader.bytes(at: Int(entry.dataOffset), length: Int(entry.dataLength)) else {
+                return nil
+            }
+            let width = Int(entry.width)
+            let height = Int(entry.height)
+            guard width > 0, width < 4000, height > 0, height < 4000,
+                  let decoded = SFFv2Parser.decodeIndices(payload, width: width, height: height,
+                                                          format: entry.format, colorDepth: entry.colorDepth) else {
+                return nil
+            }
+
+            let usesPaletteAlpha = entry.format == 10
+            let palette = self.palette(at: Int(entry.paletteIndex)) ?? [UInt8](repeating: 0, count: 1024)
+            return IndexedSprite(width: decoded.width, height: decoded.height, pixels: decoded.pixels,
+                                 table: SFFPaletteKernel.lookupTable(rgba: palette, usePaletteAlpha: usesPaletteAlpha),
+                                 usesPaletteAlpha: usesPaletteAlpha)
+        } else {
+            guard let payload = reader.bytes(at: Int(entry.dataOffset), upTo: Int(entry.dataLength)),
+                  let decoded = SFFv1Parser.decodePCXIndices(payload) else {
+                return nil
+            }
+
+            // Same palette precedence as `image(at:)`: embedded, then shared for samePalette sprites
+            var palette = decoded.embeddedPalette ?? [UInt8](repeating: 0, count: 768)
+            if decoded.embeddedPalette == nil, entry.paletteIndex != 0, let shared = sharedPalette, shared.count >= 768 {
+                palette = [UInt8](shared.prefix(768))
+            }
+            return IndexedSprite(width: decoded.width, height: decoded.height, pixels: decoded.pixels,
+                                 table: SFFPaletteKernel.lookupTable(rgb: palette), usesPaletteAlpha: false)
+        }
+    }
+
+    /// Index of the SFFv2 palette node with the given group and item number
+    public func paletteIndex(group: Int, item: Int) -> Int? {
+        guard version >= 2 else { return nil }
+
+        for i in 0..<directory.paletteCount {
+            let nodeOffset = paletteListOffset + i * 16
+            guard reader.contains(offset: nodeOffset, length: 16) else { return nil }
+            if Int(reader.readUInt16(at: nodeOffset)) == group && Int(reader.readUInt16(at: nodeOffset + 2)) == item {
+                return i
+            }
+        }
+        return nil
+    }
+
+    // MARK: - Decoding
+
+    /// Decode a sprite by group and image number
+    /// - Parameter maxPixelSize: Longest side of the result; larger sprites are downscaled during decode
+    public func image(group: Int, image: Int, maxPixelSize: Int? = nil) -> NSImage? {
+        guard let index = directory.index(group: group, image: image) else { return nil }
+        return self.image(at: index, maxPixelSize: maxPixelSize)
+    }
+
+    /// Decode the sprite at a directory index, following links
+    /// - Parameters:
+    ///   - index: Index into `directory.entries`
+    ///   - maxPixelSize: Longest side of the result; larger sprites are downscaled during decode
+    public func image(at index: Int, maxPixelSize: Int? = nil) -> NSImage? {
+        guard let resolved = resolvedIndex(index) else { return nil }
+        let entry = directory.entries[resolved]
+
+        if version >= 2 {
+            // Copy out only this sprite's payload; everything else stays unmapped
+            guard let payload = reader.bytes(at: Int(entry.dataOffset), length: Int(entry.dataLength)) else {
+                return nil
+            }
+            let width = Int(entry.width)
+            let height = Int(entry.height)
+            guard width > 0, width < 4000, height > 0, height < 4000 else { return nil }
+
+            var palette: [UInt8]?
+            if entry.colorDepth == 8 && entry.format != 11 && entry.format != 12 {
+                palette = self.palette(at: Int(entry.paletteIndex))
+            }
+            return SFFv2Parser.decodeSprite(payload, width: width, height: height,
+                                            format: entry.format, colorDepth: entry.colorDepth, palette: palette,
+                                            maxPixelSize: maxPixelSize)
+        } else {
+            // Truncated PCX payloads still decode as far as the data goes
+            guard let payload = reader.bytes(at: Int(entry.dataOffset), upTo: Int(entry.dataLength)) else {
+                return nil
+            }
+
+            // If samePalette != 0, sprite uses shared palette (from first sprite or external .act)
+            let useSharedPalette = entry.paletteIndex != 0
+            return SFFv1Parser.decodePCX(payload, sharedPalette: useSharedPalette ? sharedPalette : nil,
+                                         maxPixelSize: maxPixelSize)
+        }
+    }
+}
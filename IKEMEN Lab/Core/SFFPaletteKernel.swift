@@ -0,0 +1,234 @@
+import Foundation
+
+// MARK: - Palette Expansion Kernel
+
+/// Shared 8-bit index -> RGBA expansion used by every indexed sprite path
+///
+/// Palettes are first packed into a 256-entry lookup table of RGBA pixels with index 0
+/// transparency already baked in, so the hot loop is a pure table lookup with no branches.
+/// The kernel then works on raw buffers eight pixels at a time and writes each group with a
+/// single 32-byte SIMD store; a scalar loop handles the tail.
+///
+/// Neither Apple Silicon (NEON has no gather and `tbl` tops out at 64-byte tables) nor the
+/// baseline x86_64 target (no AVX2) can gather from a 1 KB table in hardware, so the lookups
+/// themselves stay scalar. Dropping the four bounds-checked array stores per pixel is where
+/// the win comes from.
+enum SFFPaletteKernel {
+
+    /// 256 packed pixels, each laid out in memory as R, G, B, A
+    typealias LookupTable = [UInt32]
+
+    // MARK: - Lookup Tables
+
+    /// Pack an SFFv2 palette (256 x RGBA bytes) into a lookup table
+    /// - Parameters:
+    ///   - rgba: Palette bytes, 4 per color; missing colors are left black
+    ///   - usePaletteAlpha: Take alpha from the palette (indexed PNG) instead of forcing it opaque
+    /// - Returns: Lookup table where index 0 is fully transparent
+    static func lookupTable(rgba palette: [UInt8], usePaletteAlpha: Bool = false) -> LookupTable {
+        var table = LookupTable(repeating: packed(0, 0, 0, 255), count: 256)
+        let colorCount = min(palette.count / 4, 256)
+        for i in 0..<colorCount {
+            let alpha = usePaletteAlpha ? palette[i * 4 + 3] : 255
+            table[i] = packed(palette[i * 4], palette[i * 4 + 1], palette[i * 4 + 2], alpha)
+        }
+        table[0] = packed(table[0], alpha: 0)
+        return table
+    }
+
+    /// Pack a PCX / .act palette (256 x RGB bytes) into a lookup table
+    /// - Returns: Lookup table where index 0 is fully transparent
+    static func lookupTable(rgb palette: [UInt8]) -> LookupTable {
+        var table = LookupTable(repeating: packed(0, 0, 0, 255), count: 256)
+        let colorCount = min(palette.count / 3, 256)
+        for i in 0..<colorCount {
+            table[i] = packed(palette[i * 3], palette[i * 3 + 1], palette[i * 3 + 2], 255)
+        }
+        table[0] = packed(table[0], alpha: 0)
+        return table
+    }
+
+    /// Pack a MUGEN .act palette file into a lookup table
+    ///
+    /// Character .act files store their 256 colors in reverse order (the first color in the
+    /// file is index 255), which is how IKEMEN-GO loads `pal1`...`pal12`.
+    /// - Returns: Lookup table where index 0 is fully transparent, or nil if the file is too short
+    static func lookupTable(act data: Data) -> LookupTable? {
+        guard data.count >= 768 else { return nil }
+        let bytes = [UInt8](data.prefix(768))
+
+        var reversed = [UInt8](repeating: 0, count: 768)
+        for i in 0..<256 {
+            let source = (255 - i) * 3
+            reversed[i * 3] = bytes[source]
+            reversed[i * 3 + 1] = bytes[source + 1]
+            reversed[i * 3 + 2] = bytes[source + 2]
+        }
+        return lookupTable(rgb: reversed)
+    }
+
+    @inline(__always)
+    private static func packed(_ r: UInt8, _ g: UInt8, _ b: UInt8, _ a: UInt8) -> UInt32 {
+        // Stored little-endian so the bytes land in memory as R, G, B, A
+        let value = UInt32(r) | (UInt32(g) << 8) | (UInt32(b) << 16) | (UInt32(a) << 24)
+        return value.littleEndian
+    }
+
+    @inline(__always)
+    private static func packed(_ pixel: UInt32, alpha: UInt8) -> UInt32 {
+        let value = UInt32(littleEndian: pixel)
+        return ((value & 0x00FF_FFFF) | (UInt32(alpha) << 24)).littleEndian
+    }
+
+    // MARK: - Kernel
+
+    /// Expand `count` indices into RGBA pixels
+    /// - Parameters:
+    ///   - indices: Source palette indices
+    ///   - count: Number of pixels
+    ///   - table: 256-entry lookup table from `lookupTable(...)`
+    ///   - output: Destination for `count * 4` bytes; no alignment required
+    @inline(__always)
+    static func expand(_ indices: UnsafePointer<UInt8>, count: Int,
+                       table: UnsafePointer<UInt32>, into output: UnsafeMutableRawPointer) {
+        var i = 0
+
+        while i + 8 <= count {
+            let p = indices + i
+            let pixels = SIMD8<UInt32>(
+                table[Int(p[0])], table[Int(p[1])], table[Int(p[2])], table[Int(p[3])],
+                table[Int(p[4])], table[Int(p[5])], table[Int(p[6])], table[Int(p[7])]
+            )
+            output.storeBytes(of: pixels, toByteOffset: i * 4, as: SIMD8<UInt32>.self)
+            i += 8
+        }
+
+        while i < count {
+            output.storeBytes(of: table[Int(indices[i])], toByteOffset: i * 4, as: UInt32.self)
+            i += 1
+        }
+    }
+
+    /// Expand a tightly packed index buffer into an RGBA byte array
+    static func expand(_ indices: [UInt8], table: LookupTable) -> [UInt8] {
+        let count = indices.count
+        guard count > 0 else { return [] }
+
+        return [UInt8](unsafeUninitializedCapacity: count * 4) { buffer, initializedCount in
+            indices.withUnsafeBufferPointer { src in
+                table.withUnsafeBufferPointer { lut in
+                    expand(src.baseAddress!, count: count, table: lut.baseAddress!,
+                           into: UnsafeMutableRawPointer(buffer.baseAddress!))
+                }
+            }
+            initializedCount = count * 4
+        }
+    }
+
+    /// Expand a strided index bitmap (e.g. a decoded indexed PNG) row by row
+    /// - Parameters:
+    ///   - base: First byte of the bitmap
+    ///   - width: Pixels per row
+    ///   - height: Number of rows
+    ///   - bytesPerRow: Row stride of the source, which may include padding
+    ///   - table: 256-entry lookup table
+    /// - Returns: Tightly packed RGBA bytes (`width * height * 4`)
+    static func expand(rows base: UnsafePointer<UInt8>, width: Int, height: Int,
+                       bytesPerRow: Int, table: LookupTable) -> [UInt8] {
+        guard width > 0, height > 0 else { return [] }
+
+        return [UInt8](unsafeUninitializedCapacity: width * height * 4) { buffer, initializedCount in
+            let output = UnsafeMutableRawPointer(buffer.baseAddress!)
+            table.withUnsafeBufferPointer { lut in
+                for y in 0..<height {
+                    expand(base + y * bytesPerRow, count: width, table: lut.baseAddress!,
+                           into: output + y * width * 4)
+                }
+            }
+            initializedCount = width * height * 4
+        }
+    }
+
+    // MARK: - Downsampling
+
+    /// Size that fits `width` x `height` inside a `maxPixelSize` square, keeping the aspect ratio
+    /// - Returns: The scaled size, or nil if the image already fits
+    static func thumbnailSize(width: Int, height: Int, maxPixelSize: Int) -> (width: Int, height: Int)? {
+        let longest = max(width, height)
+        guard maxPixelSize > 0, longest > maxPixelSize else { return nil }
+
+        let scale = Double(maxPixelSize) / Double(longest)
+        return (max(1, Int((Double(width) * scale).rounded())), max(1, Int((Double(height) * scale).rounded())))
+    }
+
+    /// Expand a strided index bitmap straight into a smaller RGBA buffer
+    ///
+    /// Each target pixel is the box-filtered average of the source pixels it covers, looked up
+    /// through the palette on the fly, so no full-resolution RGBA buffer is ever allocated.
+    /// Colors are weighted by alpha and written premultiplied, so transparent index-0 pixels
+    /// don't bleed a dark fringe into the edges.
+    /// - Parameters:
+    ///   - base: First byte of the bitmap
+    ///   - width: Source pixels per row
+    ///   - height: Source rows
+    ///   - bytesPerRow: Row stride of the source
+    ///   - table: 256-entry lookup table
+    ///   - targetWidth: Output width (at most `width`)
+    ///   - targetHeight: Output height (at most `height`)
+    /// - Returns: Premultiplied RGBA bytes (`targetWidth * targetHeight * 4`)
+    static func expandDownsampled(rows base: UnsafePointer<UInt8>, width: Int, height: Int, bytesPerRow: Int,
+                                  table: LookupTable, targetWidth: Int, targetHeight: Int) -> [UInt8] {
+        guard width > 0, height > 0, targetWidth > 0, targetHeight > 0 else { return [] }
+
+        // Source column span covered by each output column
+        let columnStarts = (0...targetWidth).map { $0 * width / targetWidth }
+
+        // Per-output-column sums for the current output row: alpha, then alpha-weighted R, G, B
+        var sums = [UInt64](repeating: 0, count: targetWidth * 4)
+
+        return [UInt8](unsafeUninitializedCapacity: targetWidth * targetHeight * 4) { buffer, initializedCount in
+            table.withUnsafeBufferPointer { lut in
+                sums.withUnsafeMutableBufferPointer { acc in
+                    for ty in 0..<targetHeight {
+                        let y0 = ty * height / targetHeight
+                        let y1 = max(y0 + 1, (ty + 1) * height / targetHeight)
+                        acc.update(repeating: 0)
+
+                        for y in y0..<y1 {
+                            let row = base + y * bytesPerRow
+                            for tx in 0..<targetWidth {
+                                let x1 = max(columnStarts[tx] + 1, columnStarts[tx + 1])
+                                var a: UInt32 = 0, r: UInt32 = 0, g: UInt32 = 0, b: UInt32 = 0
+                                for x in columnStarts[tx]..<x1 {
+                                    let pixel = UInt32(littleEndian: lut[Int(row[x])])
+                                    let alpha = pixel >> 24
+                                    a += alpha
+                                    r += (pixel & 0xFF) * alpha
+                                    g += ((pixel >> 8) & 0xFF) * alpha
+                                    b += ((pixel >> 16) & 0xFF) * alpha
+                                }
+                                acc[tx * 4] += UInt64(a)
+                                acc[tx * 4 + 1] += UInt64(r)
+                                acc[tx * 4 + 2] += UInt64(g)
+                                acc[tx * 4 + 3] += UInt64(b)
+                            }
+                        }
+
+                        let rowHeight = UInt64(y1 - y0)
+                        let output = buffer.baseAddress! + ty * targetWidth * 4
+                        for tx in 0..<targetWidth {
+                            let x1 = max(columnStarts[tx] + 1, columnStarts[tx + 1])
+                            let area = rowHeight * UInt64(x1 - columnStarts[tx]) * 255
+                            // Premultiplied: channel = sum(c * a) / (255 * n), alpha = sum(a) / n
+                            output[tx * 4] = UInt8(acc[tx * 4 + 1] / area)
+                            output[tx * 4 + 1] = UInt8(acc[tx * 4 + 2] / area)
+                            output[tx * 4 + 2] = UInt8(acc[tx * 4 + 3] / area)
+                            output[tx * 4 + 3] = UInt8(acc[tx * 4] * 255 / area)
+                        }
+                    }
+                }
+            }
+            initializedCount = targetWidth * targetHeight * 4
+        }
+    }
+}
@@ -0,0 +1,149 @@
+import Foundation
+import AppKit
+
+// MARK: - Palette Preview
+
+/// A character sprite rendered with one of its selectable palettes
+struct PalettePreview {
+    /// Palette number (1-12, as in the DEF's pal1...pal12)
+    let number: Int
+    let image: NSImage
+}
+
+// MARK: - Palette Preview Engine
+
+/// Renders a character's palettes by recoloring one cached index buffer
+///
+/// The idle sprite (0,0, else the portrait 9000,0) is decoded once to 8-bit palette indices
+/// and kept in memory. Each palette is then just a 256-entry lookup table run through
+/// `SFFPaletteKernel`, so rendering all twelve costs twelve table expansions rather than
+/// twelve sprite decodes. Palettes come from the DEF's `pal1`...`pal12` .act files, falling
+/// back to SFFv2 palette nodes 1,1...1,12.
+final class SFFPalettePreview {
+
+    // MARK: - Singleton
+
+    static let shared = SFFPalettePreview()
+
+    // MARK: - Properties
+
+    /// Decoded index buffer plus the palettes stored inside the SFF
+    private final class CachedSprite {
+        let fileSize: Int64
+        let modifiedAt: Double
+        let sprite: SFFArchive.IndexedSprite
+        /// SFFv2 palette nodes 1,N keyed by N
+        let sffPalettes: [Int: SFFPaletteKernel.LookupTable]
+
+        init(fileSize: Int64, modifiedAt: Double, sprite: SFFArchive.IndexedSprite,
+             sffPalettes: [Int: SFFPaletteKernel.LookupTable]) {
+            self.fileSize = fileSize
+            self.modifiedAt = modifiedAt
+            self.sprite = sprite
+            self.sffPalettes = sffPalettes
+        }
+    }
+
+    private let cache: NSCache<NSString, CachedSprite>
+
+    /// Sprites tried in order for the preview
+    private static let previewSprites: [(group: Int, image: Int)] = [(0, 0), (9000, 0)]
+
+    // MARK: - Initialization
+
+    private init() {
+        cache = NSCache<NSString, CachedSprite>()
+        cache.name = "com.ikemenlab.SFFPalettePreview"
+        cache.totalCostLimit = 64 * 1024 * 1024  // index bytes
+    }
+
+    // MARK: - Public Methods
+
+    /// Render the character's sprite once per available palette
+    /// - Parameters:
+    ///   - character: Character to preview
+    ///   - maxPixelSize: Longest side of each preview; larger sprites are downscaled during expansion
+    /// - Returns: Previews in palette order; a single default preview if the character defines no palettes
+    func previews(for character: CharacterInfo, maxPixelSize: Int? = nil) -> [PalettePreview] {
+        guard let cached = cachedSprite(for: character) else { return [] }
+
+        let tables = paletteTables(for: character, cached: cached)
+        if tables.isEmpty {
+            return render(cached.sprite, table: cached.sprite.table, maxPixelSize: maxPixelSize)
+                .map { [PalettePreview(number: 1, image: $0)] } ?? []
+        }
+
+        return tables.compactMap { palette in
+            render(cached.sprite, table: palette.table, maxPixelSize: maxPixelSize)
+                .map { PalettePreview(number: palette.number, image: $0) }
+        }
+    }
+
+    /// Drop cached index buffers
+    func clearCache() {
+        cache.removeAllObjects()
+    }
+
+    // MARK: - Palettes
+
+    /// Lookup tables for palettes 1-12: DEF .act files first, then SFFv2 palette nodes
+    private func paletteTables(for character: CharacterInfo,
+                               cached: CachedSprite) -> [(number: Int, table: SFFPaletteKernel.LookupTable)] {
+        let paletteFiles = DEFParser.parse(url: character.defFile)?.paletteFiles ?? [:]
+        var tables: [(number: Int, table: SFFPaletteKernel.LookupTable)] = []
+
+        for number in 1...12 {
+            if let file = paletteFiles[number],
+               let data = try? Data(contentsOf: character.directory.appendingPathComponent(file)),
+               let table = SFFPaletteKernel.lookupTable(act: data) {
+                tables.append((number, table))
+            } else if let table = cached.sffPalettes[number] {
+                tables.append((number, table))
+            }
+        }
+        return tables
+    }
+
+    // MARK: - Decoding
+
+    private func cachedSprite(for character: CharacterInfo) -> CachedSprite? {
+        guard let sffURL = character.spriteFileURL,
+              let identity = SFFDirectoryIndex.fileIdentity(of: sffURL) else { return nil }
+        let key = sffURL.standardizedFileURL.path as NSString
+
+        if let cached = cache.object(forKey: key),
+           cached.fileSize == identity.size, cached.modifiedAt == identity.modifiedAt {
+            return cached
+        }
+
+        guard let archive = try? SFFArchive(url: sffURL) else { return nil }
+
+        var decoded: SFFArchive.IndexedSprite?
+        for candidate in SFFPalettePreview.previewSprites {
+            if let index = archive.directory.index(group: candidate.group, image: candidate.image),
+               let sprite = archive.indexedSprite(at: index) {
+                decoded = sprite
+                break
+            }
+        }
+        guard let sprite = decoded else { return nil }
+
+        var sffPalettes: [Int: SFFPaletteKernel.LookupTable] = [:]
+        for number in 1...12 {
+            if let index = archive.paletteIndex(group: 1, item: number), let palette = archive.palette(at: index) {
+                sffPalettes[number] = SFFPaletteKernel.lookupTable(rgba: palette, usePaletteAlpha: sprite.usesPaletteAlpha)
+            }
+        }
+
+        let cached = CachedSprite(fileSize: identity.size, modifiedAt: identity.modifiedAt,
+                                  sprite: sprite, sffPalettes: sffPalettes)
+        cache.setObject(cached, forKey: key, cost: sprite.pixels.count)
+        return cached
+    }
+
+    private func render(_ sprite: SFFArchive.IndexedSprite, table: SFFPaletteKernel.LookupTable,
+                        maxPixelSize: Int?) -> NSImage? {
+        return SFFUtils.createImage(fromIndices: sprite.pixels, width: sprite.width, height: sprite.height,
+                                    table: table, maxPixelSize: maxPixelSize)
+    }
+}
@@ -0,0 +1,98 @@
+import Foundation
+
+// MARK: - SFF Reader
+
+/// Read-only, random-access view over an SFF file
+///
+/// Files opened from a URL are memory-mapped instead of loaded with `Data(contentsOf:)`,
+/// so a portrait lookup only pages in the header, the sprite/palette node tables and the
+/// bytes of the sprite that is actually decoded - not the other 30-80 MB of an HD character.
+/// All reads are bounds-checked and return zero / nil past the end of the file, matching
+/// the forgiving behaviour the parsers had with whole-file `Data`.
+public struct SFFReader {
+
+    /// Backing bytes (memory-mapped when opened from a URL)
+    private let data: Data
+
+    /// Source file, if the reader was opened from disk
+    public let url: URL?
+
+    // MARK: - Initialization
+
+    /// Memory-map an SFF file
+    /// - Parameter url: URL to the SFF file
+    /// - Throws: `SFFError.fileNotFound` if the file cannot be opened or mapped
+    public init(url: URL) throws {
+        do {
+            // .alwaysMapped keeps Foundation from falling back to a full read for large files
+            self.data = try Data(contentsOf: url, options: [.alwaysMapped])
+        } catch {
+            throw SFFError.fileNotFound(url)
+        }
+        self.url = url
+    }
+
+    /// Wrap SFF bytes that are already in memory (tests, archives, generated files)
+    public init(data: Data) {
+        // Rebase slices so offsets are always relative to the start of the file
+        self.data = data.startIndex == 0 ? data : Data(data)
+        self.url = nil
+    }
+
+    // MARK: - Header
+
+    /// Total file size in bytes
+    public var count: Int { data.count }
+
+    /// Whether the file starts with the "ElecbyteSpr" signature
+    public var hasValidSignature: Bool {
+        guard data.count >= 12 else { return false }
+        let signature = String(data: data[0..<12], encoding: .ascii) ?? ""
+        return signature.hasPrefix("ElecbyteSpr")
+    }
+
+    /// Major version byte (1 = SFFv1, 2 = SFFv2)
+    public var versionHi: UInt8 {
+        return byte(at: 15)
+    }
+
+    // MARK: - Primitive Reads
+
+    /// Whether `length` bytes starting at `offset` lie inside the file
+    public func contains(offset: Int, length: Int) -> Bool {
+        return offset >= 0 && length >= 0 && offset <= data.count - length
+    }
+
+    public func byte(at offset: Int) -> UInt8 {
+        guard offset >= 0, offset < data.count else { return 0 }
+        return data[offset]
+    }
+
+    public func readUInt16(at offset: Int) -> UInt16 {
+        guard offset >= 0, offset + 1 < data.count else { return 0 }
+        return UInt16(data[offset]) | (UInt16(data[offset + 1]) << 8)
+    }
+
+    public func readUInt32(at offset: Int) -> UInt32 {
+        guard offset >= 0, offset + 3 < data.count else { return 0 }
+        return UInt32(data[offset]) |
+               (UInt32(data[offset + 1]) << 8) |
+               (UInt32(data[offset + 2]) << 16) |
+               (UInt32(data[offset + 3]) << 24)
+    }
+
+    /// Copy out a byte range (e.g. one sprite's payload)
+    /// - Returns: The bytes, or nil if the range runs past the end of the file
+    public func bytes(at offset: Int, length: Int) -> Data? {
+        guard contains(offset: offset, length: length) else { return nil }
+        return data.subdata(in: offset..<(offset + length))
+    }
+
+    /// Copy out a byte range, truncated to the end of the file
+    public func bytes(at offset: Int, upTo length: Int) -> Data? {
+        guard offset >= 0, offset < data.count else { return nil }
+        let end = min(offset + max(length, 0), data.count)
+        guard end > offset else { return nil }
+        return data.subdata(in: offset..<end)
+    }
+}
@@ -0,0 +1,285 @@
+import Foundation
+
+// MARK: - SFFv2 Sprite Decoders
+
+/// Pointer-based decoders for SFFv2 compressed sprite payloads (raw, RLE8, RLE5, LZ5)
+///
+/// Output matches IKEMEN-GO's `Rle8Decode` / `Rle5Decode` / `Lz5Decode` byte for byte,
+/// including their handling of truncated input: reads past the end keep returning the last
+/// byte. Instead of bounds-checking every byte, each decoder checks once per token whether
+/// the longest possible token still fits in the input, and only falls back to clamped reads
+/// for the last few tokens. Runs are written with `memset` and back-references with `memcpy`
+/// (in period-sized chunks when the source overlaps the destination).
+enum SFFSpriteDecoder {
+
+    // MARK: - Raw
+
+    static func decodeRaw8(_ data: Data, width: Int, height: Int) -> [UInt8] {
+        var pixels = [UInt8](repeating: 0, count: width * height)
+        let copyCount = min(data.count, pixels.count)
+        guard copyCount > 0 else { return pixels }
+
+        pixels.withUnsafeMutableBytes { out in
+            data.withUnsafeBytes { src in
+                out.baseAddress!.copyMemory(from: src.baseAddress!, byteCount: copyCount)
+            }
+        }
+        return pixels
+    }
+
+    static func decodeRaw32(_ data: Data, width: Int, height: Int) -> [UInt8] {
+        var pixels = [UInt8](repeating: 255, count: width * height * 4)
+        let copyCount = min(data.count, pixels.count)
+        guard copyCount > 0 else { return pixels }
+
+        pixels.withUnsafeMutableBytes { out in
+            data.withUnsafeBytes { src in
+                out.baseAddress!.copyMemory(from: src.baseAddress!, byteCount: copyCount)
+            }
+        }
+        return pixels
+    }
+
+    // MARK: - RLE8
+
+    /// RLE8 decoder matching IKEMEN-GO's Rle8Decode
+    /// Algorithm: (byte & 0xC0) == 0x40 are RLE markers with count = (byte & 0x3F)
+    ///            ALL other bytes are literal pixel values (output directly)
+    static func decodeRLE8(_ data: Data, width: Int, height: Int) -> [UInt8] {
+        let count = width * height
+        guard !data.isEmpty, count > 0 else { return [] }
+
+        var pixels = [UInt8](repeating: 0, count: count)
+        pixels.withUnsafeMutableBufferPointer { buffer in
+            let out = buffer.baseAddress!
+            withCursor(over: data) { cursor in
+                var dst = 0
+
+                while dst < count {
+                    // Marker + value is the longest token
+                    let clamped = cursor.remaining < 2
+                    var runLen = 1
+                    var d = cursor.next(clamped: clamped)
+
+                    // Only 0x40-0x7F are RLE markers
+                    if (d & 0xC0) == 0x40 {
+                        runLen = Int(d & 0x3F)
+                        d = cursor.next(clamped: clamped)
+                    }
+
+                    let n = min(runLen, count - dst)
+                    fill(out + dst, with: d, count: n)
+                    dst += n
+
+                    // A zero-length marker as the clamped last byte repeats forever without output
+                    if cursor.isExhausted && cursor.peek() == 0x40 { break }
+                }
+            }
+        }
+        return pixels
+    }
+
+    // MARK: - RLE5
+
+    /// RLE5 decoder matching IKEMEN-GO's Rle5Decode
+    /// Packet: run length, data length (bit 7 = explicit first color), [color], then
+    ///         data-length bytes of 3-bit run / 5-bit color
+    static func decodeRLE5(_ data: Data, width: Int, height: Int) -> [UInt8] {
+        let count = width * height
+        guard !data.isEmpty, count > 0 else { return [] }
+
+        var pixels = [UInt8](repeating: 0, count: count)
+        pixels.withUnsafeMutableBufferPointer { buffer in
+            let out = buffer.baseAddress!
+            withCursor(over: data) { cursor in
+                var dst = 0
+
+                while dst < count {
+                    // 3 header bytes plus at most 127 run bytes per packet
+                    let clamped = cursor.remaining < 130
+                    let rl = Int(cursor.next(clamped: clamped))
+                    var dl = Int(cursor.peek() & 0x7F)
+                    var c: UInt8 = 0
+
+                    if (cursor.peek() >> 7) != 0 {
+                        cursor.advance(clamped: clamped)
+                        c = cursor.peek()
+                    }
+                    cursor.advance(clamped: clamped)
+
+                    var n = min(rl + 1, count - dst)
+                    fill(out + dst, with: c, count: n)
+                    dst += n
+
+                    while dl > 0 && dst < count {
+                        dl -= 1
+                        let b = cursor.next(clamped: clamped)
+                        n = min(Int(b >> 5) + 1, count - dst)
+                        fill(out + dst, with: b & 0x1F, count: n)
+                        dst += n
+                    }
+                }
+            }
+        }
+        return pixels
+    }
+
+    // MARK: - LZ5
+
+    /// LZ5 decoder matching IKEMEN-GO's Lz5Decode
+    /// A control byte selects, one bit per token, between RLE packets and back-references.
+    /// Short back-references pool their top two bits: every fourth one takes its offset from
+    /// the bits recycled from the previous three.
+    static func decodeLZ5(_ data: Data, width: Int, height: Int) -> [UInt8] {
+        let count = width * height
+        guard !data.isEmpty, count > 0 else { return [] }
+
+        var pixels = [UInt8](repeating: 0, count: count)
+        pixels.withUnsafeMutableBufferPointer { buffer in
+            let out = buffer.baseAddress!
+            withCursor(over: data) { cursor in
+                var dst = 0
+                var ct = cursor.next(clamped: true)
+                var cts: UInt8 = 0
+                var rb = 0
+                var rbc = 0
+                var stalledTokens = 0
+
+                while dst < count {
+                    // Long back-reference (3 bytes) followed by a control byte is the longest token
+                    let clamped = cursor.remaining < 4
+                    let start = dst
+                    var d = Int(cursor.next(clamped: clamped))
+
+                    if (ct & (1 << cts)) != 0 {
+                        // Copy from previous output
+                        let length: Int
+                        if (d & 0x3F) == 0 {
+                            // Long offset mode
+                            d = (d << 2 | Int(cursor.next(clamped: clamped))) + 1
+                            length = Int(cursor.next(clamped: clamped)) + 3
+                        } else {
+                            // Short offset mode with recycled bits
+                            rb |= (d & 0xC0) >> rbc
+                            rbc += 2
+                            length = (d & 0x3F) + 1
+                            if rbc < 8 {
+                                d = Int(cursor.next(clamped: clamped)) + 1
+                            } else {
+                                d = rb + 1
+                                rb = 0
+                                rbc = 0
+                            }
+                        }
+
+                        // References before the start of the sprite are skipped entirely
+                        if d <= dst {
+                            let n = min(length, count - dst)
+                            copyBack(out, at: dst, distance: d, count: n)
+                            dst += n
+                        }
+                    } else {
+                        // RLE packet
+                        let length: Int
+                        if (d & 0xE0) == 0 {
+                            // Long run
+                            length = Int(cursor.next(clamped: clamped)) + 8
+                        } else {
+                            // Short run
+                            length = d >> 5
+                            d &= 0x1F
+                        }
+
+                        let n = min(length, count - dst)
+                        fill(out + dst, with: UInt8(d), count: n)
+                        dst += n
+                    }
+
+                    cts += 1
+                    if cts >= 8 {
+                        ct = cursor.next(clamped: clamped)
+                        cts = 0
+                    }
+
+                    // Once the input is exhausted every token re-reads the last byte; the
+                    // decoder state cycles within a few dozen tokens, so no progress by then
+                    // means it never will
+                    if dst == start && cursor.isExhausted {
+                        stalledTokens += 1
+                        if stalledTokens > 64 { break }
+                    } else {
+                        stalledTokens = 0
+                    }
+                }
+            }
+        }
+        return pixels
+    }
+
+    // MARK: - Helpers
+
+    /// Read position over compressed input that clamps at the last byte
+    private struct Cursor {
+        let base: UnsafePointer<UInt8>
+        let last: Int
+        var index = 0
+
+        /// Bytes that can be consumed before reads start clamping
+        var remaining: Int { last - index }
+
+        var isExhausted: Bool { index == last }
+
+        @inline(__always)
+        func peek() -> UInt8 {
+            return base[index]
+        }
+
+        /// Advance one byte; unclamped advances are only valid after checking `remaining`
+        @inline(__always)
+        mutating func advance(clamped: Bool) {
+            if !clamped || index < last {
+                index += 1
+            }
+        }
+
+        @inline(__always)
+        mutating func next(clamped: Bool) -> UInt8 {
+            let byte = base[index]
+            advance(clamped: clamped)
+            return byte
+        }
+    }
+
+    private static func withCursor(over data: Data, _ body: (inout Cursor) -> Void) {
+        data.withUnsafeBytes { raw in
+            var cursor = Cursor(base: raw.bindMemory(to: UInt8.self).baseAddress!, last: raw.count - 1)
+            body(&cursor)
+        }
+    }
+
+    @inline(__always)
+    private static func fill(_ destination: UnsafeMutablePointer<UInt8>, with value: UInt8, count: Int) {
+        guard count > 0 else { return }
+        memset(destination, Int32(value), count)
+    }
+
+    /// Copy `count` bytes from `distance` bytes back in the output (LZ77 semantics)
+    @inline(__always)
+    private static func copyBack(_ out: UnsafeMutablePointer<UInt8>, at dst: Int, distance: Int, count: Int) {
+        guard count > 0 else { return }
+
+        if distance >= count {
+            memcpy(out + dst, out + dst - distance, count)
+        } else if distance == 1 {
+            memset(out + dst, Int32(out[dst - 1]), count)
+        } else {
+            // Overlapping: the source repeats with period `distance`, so copy one period at a time
+            var copied = 0
+            while copied < count {
+                let chunk = min(distance, count - copied)
+                memcpy(out + dst + copied, out + dst + copied - distance, chunk)
+                copied += chunk
+            }
+        }
+    }
+}
@@ -0,0 +1,401 @@
+import Foundation
+import os.log
+
+// MARK: - SFF Sprite Directory
+
+/// Compact table of contents for an SFF file
+///
+/// One entry per sprite node, in file order, with everything needed to decode the sprite
+/// without walking the node list again: absolute payload range, dimensions, format and
+/// palette reference. Built once per file by `build(from:)` and persisted in
+/// `MetadataStore` (see `SFFDirectoryIndex`), keyed by path, size and modification date.
+public struct SFFSpriteDirectory {
+
+    /// A single sprite node
+    public struct Entry: Equatable {
+        public let group: UInt16
+        public let image: UInt16
+        /// Offset of the sprite node (v2) or subfile header (v1)
+        public let nodeOffset: UInt32
+        public let width: UInt16
+        public let height: UInt16
+        /// v2 compression format (0 raw, 2 RLE8, 3 RLE5, 4 LZ5, 10-12 PNG); always 0 for v1 PCX
+        public let format: UInt8
+        public let colorDepth: UInt8
+        /// v2 palette node index; v1 "same palette" flag
+        public let paletteIndex: UInt16
+        /// Index of the sprite this one is linked to (only meaningful when `dataLength` is 0)
+        public let linkedIndex: UInt16
+        /// Absolute file offset of the sprite payload
+        public let dataOffset: UInt32
+        public let dataLength: UInt32
+
+        /// Linked sprites carry no payload of their own and reuse `linkedIndex`'s data
+        public var isLinked: Bool { dataLength == 0 }
+    }
+
+    /// SFF major version (1 or 2)
+    public let version: Int
+
+    /// Sprite nodes in file order
+    public let entries: [Entry]
+
+    /// Number of palettes (v2 palette nodes; v1 sprites carrying their own palette)
+    public let paletteCount: Int
+
+    /// (group, image) -> first entry index
+    private let lookup: [UInt32: Int]
+
+    public var spriteCount: Int { entries.count }
+
+    public init(version: Int, entries: [Entry], paletteCount: Int) {
+        self.version = version
+        self.entries = entries
+        self.paletteCount = paletteCount
+
+        var lookup = [UInt32: Int](minimumCapacity: entries.count)
+        for (index, entry) in entries.enumerated() {
+            let key = SFFSpriteDirectory.key(group: entry.group, image: entry.image)
+            if lookup[key] == nil {
+                lookup[key] = index
+            }
+        }
+        self.lookup = lookup
+    }
+
+    // MARK: - Lookup
+
+    private static func key(group: UInt16, image: UInt16) -> UInt32 {
+        return (UInt32(group) << 16) | UInt32(image)
+    }
+
+    /// Index of the first sprite with the given group and image number
+    public func index(group: Int, image: Int) -> Int? {
+        guard let g = UInt16(exactly: group), let i = UInt16(exactly: image) else { return nil }
+        return lookup[SFFSpriteDirectory.key(group: g, image: i)]
+    }
+
+    /// First sprite with the given group and image number
+    public func entry(group: Int, image: Int) -> Entry? {
+        return index(group: group, image: image).map { entries[$0] }
+    }
+
+    /// Follow sprite links until reaching the node that owns the pixel data
+    /// - Parameter index: Index of a sprite node
+    /// - Returns: Index of the node holding the payload, or nil for broken/cyclic links
+    public func resolvedIndex(_ index: Int) -> Int? {
+        guard entries.indices.contains(index) else { return nil }
+
+        var current = index
+        // A valid chain can't be longer than the node table; anything longer is a cycle
+        for _ in 0..<entries.count {
+            let entry = entries[current]
+            guard entry.isLinked else { return current }
+
+            let target = Int(entry.linkedIndex)
+            guard entries.indices.contains(target), target != current else { return nil }
+            current = target
+        }
+        return nil
+    }
+
+    /// Resolved entry for the given sprite, following links
+    public func resolvedEntry(group: Int, image: Int) -> Entry? {
+        guard let index = index(group: group, image: image),
+              let resolved = resolvedIndex(index) else { return nil }
+        return entries[resolved]
+    }
+
+    // MARK: - Building
+
+    /// Walk the node tables of an SFF file
+    /// Only headers and node tables are read (plus the 12-byte PCX header of each v1 sprite)
+    /// - Parameter reader: Reader over the SFF file
+    /// - Returns: The directory, or nil if the file is not a valid SFF
+    public static func build(from reader: SFFReader) -> SFFSpriteDirectory? {
+        guard reader.count > 32, reader.hasValidSignature else { return nil }
+
+        if reader.versionHi >= 2 {
+            return buildV2(from: reader)
+        } else {
+            return buildV1(from: reader)
+        }
+    }
+
+    private static func buildV1(from reader: SFFReader) -> SFFSpriteDirectory? {
+        let numImages = Int(reader.readUInt32(at: 20))
+        let firstSubfileOffset = Int(reader.readUInt32(at: 24))
+
+        guard firstSubfileOffset < reader.count else { return nil }
+
+        var entries: [Entry] = []
+        entries.reserveCapacity(min(numImages, 10_000))
+        var paletteCount = 0
+        var offset = firstSubfileOffset
+
+        for _ in 0..<numImages {
+            guard offset + 32 <= reader.count else { break }
+
+            let nextOffset = Int(reader.readUInt32(at: offset))
+            let subfileLength = reader.readUInt32(at: offset + 4)
+            let samePalette = reader.byte(at: offset + 18)
+
+            // Dimensions come from the PCX header that follows the 32-byte subfile header
+            var width: UInt16 = 0
+            var height: UInt16 = 0
+            let pcxOffset = offset + 32
+            if subfileLength >= 12 && reader.contains(offset: pcxOffset, length: 12) {
+                let xmin = Int(reader.readUInt16(at: pcxOffset + 4))
+                let ymin = Int(reader.readUInt16(at: pcxOffset + 6))
+                let xmax = Int(reader.readUInt16(at: pcxOffset + 8))
+                let ymax = Int(reader.readUInt16(at: pcxOffset + 10))
+                width = UInt16(clamping: max(xmax - xmin + 1, 0))
+                height = UInt16(clamping: max(ymax - ymin + 1, 0))
+            }
+
+            if subfileLength > 0 && samePalette == 0 {
+                paletteCount += 1
+            }
+
+            entries.append(Entry(
+                group: reader.readUInt16(at: offset + 12),
+                image: reader.readUInt16(at: offset + 14),
+                nodeOffset: UInt32(offset),
+                width: width,
+                height: height,
+                format: 0,
+                colorDepth: 8,
+                paletteIndex: UInt16(samePalette),
+                linkedIndex: reader.readUInt16(at: offset + 16),
+                dataOffset: UInt32(pcxOffset),
+                dataLength: subfileLength
+            ))
+
+            if nextOffset == 0 || nextOffset <= offset { break }
+            offset = nextOffset
+        }
+
+        return SFFSpriteDirectory(version: 1, entries: entries, paletteCount: paletteCount)
+    }
+
+    private static func buildV2(from reader: SFFReader) -> SFFSpriteDirectory? {
+        // Offset 36+: spriteListOffset, spriteCount, paletteListOffset, paletteCount, ldataOffset, ldataLength, tdataOffset, tdataLength
+        let spriteOffset = Int(reader.readUInt32(at: 36))
+        let spriteCount = Int(reader.readUInt32(at: 40))
+        let paletteCount = Int(reader.readUInt32(at: 48))
+        let ldataOffset = Int(reader.readUInt32(at: 52))
+        let tdataOffset = Int(reader.readUInt32(at: 60))
+
+        guard spriteOffset < reader.count else { return nil }
+
+        // The node table is contiguous, so a truncated file simply yields fewer nodes
+        let available = max(0, (reader.count - spriteOffset) / 28)
+        let nodeCount = min(spriteCount, available)
+
+        var entries: [Entry] = []
+        entries.reserveCapacity(nodeCount)
+
+        for i in 0..<nodeCount {
+            let offset = spriteOffset + i * 28
+            let flags = reader.readUInt16(at: offset + 26)
+            // flags & 1 == 0 means ldata, flags & 1 == 1 means tdata
+            let base = (flags & 1) == 0 ? ldataOffset : tdataOffset
+            let dataOffset = base + Int(reader.readUInt32(at: offset + 16))
+
+            entries.append(Entry(
+                group: reader.readUInt16(at: offset),
+                image: reader.readUInt16(at: offset + 2),
+                nodeOffset: UInt32(offset),
+                width: reader.readUInt16(at: offset + 4),
+                height: reader.readUInt16(at: offset + 6),
+                format: reader.byte(at: offset + 14),
+                colorDepth: reader.byte(at: offset + 15),
+                paletteIndex: reader.readUInt16(at: offset + 24),
+                linkedIndex: reader.readUInt16(at: offset + 12),
+                dataOffset: UInt32(clamping: dataOffset),
+                dataLength: reader.readUInt32(at: offset + 20)
+            ))
+        }
+
+        return SFFSpriteDirectory(version: 2, entries: entries, paletteCount: paletteCount)
+    }
+
+    // MARK: - Serialization
+
+    /// Size of one packed entry in bytes
+    static let packedEntrySize = 26
+
+    /// Pack entries into a little-endian blob for the on-disk index
+    public func packedEntries() -> Data {
+        var data = Data(capacity: entries.count * SFFSpriteDirectory.packedEntrySize)
+        for entry in entries {
+            data.appendLE(entry.group)
+            data.appendLE(entry.image)
+            data.appendLE(entry.nodeOffset)
+            data.appendLE(entry.width)
+            data.appendLE(entry.height)
+            data.append(entry.format)
+            data.append(entry.colorDepth)
+            data.appendLE(entry.paletteIndex)
+            data.appendLE(entry.linkedIndex)
+            data.appendLE(entry.dataOffset)
+            data.appendLE(entry.dataLength)
+        }
+        return data
+    }
+
+    /// Rebuild a directory from a blob produced by `packedEntries()`
+    public static func unpack(version: Int, paletteCount: Int, packed: Data) -> SFFSpriteDirectory? {
+        let size = packedEntrySize
+        guard packed.count % size == 0 else { return nil }
+
+        let reader = SFFReader(data: packed)
+        var entries: [Entry] = []
+        entries.reserveCapacity(packed.count / size)
+
+        var offset = 0
+        while offset < packed.count {
+            entries.append(Entry(
+                group: reader.readUInt16(at: offset),
+                image: reader.readUInt16(at: offset + 2),
+                nodeOffset: reader.readUInt32(at: offset + 4),
+                width: reader.readUInt16(at: offset + 8),
+                height: reader.readUInt16(at: offset + 10),
+                format: reader.byte(at: offset + 12),
+                colorDepth: reader.byte(at: offset + 13),
+                paletteIndex: reader.readUInt16(at: offset + 14),
+                linkedIndex: reader.readUInt16(at: offset + 16),
+                dataOffset: reader.readUInt32(at: offset + 18),
+                dataLength: reader.readUInt32(at: offset + 22)
+            ))
+            offset += size
+        }
+
+        return SFFSpriteDirectory(version: version, entries: entries, paletteCount: paletteCount)
+    }
+}
+
+// MARK: - Directory Index
+
+/// Resolves sprite directories for SFF files, avoiding node-table walks on repeat lookups
+///
+/// Lookups go memory cache -> `MetadataStore` (`sff_directories` table) -> build from file.
+/// Entries are invalidated whenever the file's size or modification date changes.
+public final class SFFDirectoryIndex {
+
+    // MARK: - Singleton
+
+    public static let shared = SFFDirectoryIndex()
+
+    // MARK: - Properties
+
+    private static let logger = Logger(subsystem: Bundle.main.bundleIdentifier ?? "com.ikemenlab", category: "SFFDirectoryIndex")
+
+    private final class CachedDirectory {
+        let fileSize: Int64
+        let modifiedAt: Double
+        let directory: SFFSpriteDirectory
+
+        init(fileSize: Int64, modifiedAt: Double, directory: SFFSpriteDirectory) {
+            self.fileSize = fileSize
+            self.modifiedAt = modifiedAt
+            self.directory = directory
+        }
+    }
+
+    private let cache: NSCache<NSString, CachedDirectory>
+
+    // MARK: - Initialization
+
+    private init() {
+        cache = NSCache<NSString, CachedDirectory>()
+        cache.name = "com.ikemenlab.SFFDirectoryIndex"
+        cache.countLimit = 1000
+    }
+
+    // MARK: - Lookup
+
+    /// Get the sprite directory for an SFF file
+    /// - Parameter reader: Reader over the file; readers without a URL are indexed in memory only
+    /// - Returns: The directory, or nil if the file is not a valid SFF
+    public func directory(for reader: SFFReader) -> SFFSpriteDirectory? {
+        guard let url = reader.url, let identity = SFFDirectoryIndex.fileIdentity(of: url) else {
+            return SFFSpriteDirectory.build(from: reader)
+        }
+
+        let path = url.standardizedFileURL.path
+        let key = path as NSString
+
+        if let cached = cache.object(forKey: key),
+           cached.fileSize == identity.size, cached.modifiedAt == identity.modifiedAt {
+            return cached.directory
+        }
+
+        if let record = try? MetadataStore.shared.sffDirectory(path: path, fileSize: identity.size, modifiedAt: identity.modifiedAt),
+           let directory = SFFSpriteDirectory.unpack(version: record.version, paletteCount: record.paletteCount, packed: record.entries) {
+            cache.setObject(CachedDirectory(fileSize: identity.size, modifiedAt: identity.modifiedAt, directory: directory), forKey: key)
+            return directory
+        }
+
+        guard let directory = SFFSpriteDirectory.build(from: reader) else { return nil }
+
+        cache.setObject(CachedDirectory(fileSize: identity.size, modifiedAt: identity.modifiedAt, directory: directory), forKey: key)
+
+        let record = SFFDirectoryRecord(
+            path: path,
+            fileSize: identity.size,
+            modifiedAt: identity.modifiedAt,
+            version: directory.version,
+            spriteCount: directory.spriteCount,
+            paletteCount: directory.paletteCount,
+            entries: directory.packedEntries(),
+            indexedAt: Date()
+        )
+        do {
+            try MetadataStore.shared.storeSFFDirectory(record)
+        } catch {
+            Self.logger.error("Failed to store SFF directory: \(error.localizedDescription)")
+        }
+
+        return directory
+    }
+
+    /// Get the sprite directory for an SFF file on disk
+    public func directory(for url: URL) -> SFFSpriteDirectory? {
+        guard let reader = try? SFFReader(url: url) else { return nil }
+        return directory(for: reader)
+    }
+
+    /// Drop all in-memory directories (the on-disk index is left intact)
+    public func clearMemoryCache() {
+        cache.removeAllObjects()
+    }
+
+    // MARK: - File Identity
+
+    /// Size and modification date used to invalidate index entries
+    static func fileIdentity(of url: URL) -> (size: Int64, modifiedAt: Double)? {
+        guard let values = try? url.resourceValues(forKeys: [.fileSizeKey, .contentModificationDateKey]),
+              let size = values.fileSize else {
+            return nil
+        }
+        let modifiedAt = values.contentModificationDate?.timeIntervalSince1970 ?? 0
+        return (Int64(size), modifiedAt)
+    }
+}
+
+// MARK: - Data Extension for Little Endian Writing
+
+fileprivate extension Data {
+    mutating func appendLE(_ value: UInt16) {
+        append(UInt8(value & 0xFF))
+        append(UInt8((value >> 8) & 0xFF))
+    }
+
+    mutating func appendLE(_ value: UInt32) {
+        append(UInt8(value & 0xFF))
+        append(UInt8((value >> 8) & 0xFF))
+        append(UInt8((value >> 16) & 0xFF))
+        append(UInt8((value >> 24) & 0xFF))
+    }
+}
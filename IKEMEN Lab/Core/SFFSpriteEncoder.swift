@@ -0,0 +1,246 @@
+import Foundation
+
+// MARK: - SFFv2 Sprite Encoders
+
+/// Encoders for 8-bit SFFv2 sprite payloads (raw, RLE8, LZ5)
+///
+/// Output decodes with `SFFSpriteDecoder` and IKEMEN-GO's `Rle8Decode` / `Lz5Decode`. Payloads
+/// are returned without the 4-byte uncompressed-size prefix that compressed sprites carry in
+/// the file; `SFFStreamWriter` adds it.
+enum SFFSpriteEncoder {
+
+    /// SFFv2 sprite formats the encoder can produce (raw value = format byte in the sprite node)
+    enum Format: UInt8 {
+        case raw = 0
+        case rle8 = 2
+        case lz5 = 4
+    }
+
+    /// Size of the uncompressed-length prefix stored in front of compressed payloads
+    static let sizePrefixLength = 4
+
+    // MARK: - Mode Selection
+
+    /// Encode an index buffer in the requested format
+    /// `.smallest` tries every format and keeps the one with the fewest bytes on disk (prefix
+    /// included). LZ5 can only store indices 0-31; other sprites fall back to the smallest of
+    /// raw and RLE8 even when LZ5 is requested.
+    static func encode(_ pixels: [UInt8], as encoding: SFFWriter.Encoding) -> (format: Format, payload: Data) {
+        switch encoding {
+        case .raw:
+            return (.raw, Data(pixels))
+        case .rle8:
+            return (.rle8, encodeRLE8(pixels))
+        case .lz5:
+            if let lz5 = encodeLZ5(pixels) {
+                return (.lz5, lz5)
+            }
+            return smallest(pixels)
+        case .png, .smallest:
+            return smallest(pixels)
+        }
+    }
+
+    private static func smallest(_ pixels: [UInt8]) -> (format: Format, payload: Data) {
+        var best: (format: Format, payload: Data) = (.raw, Data(pixels))
+        var bestSize = pixels.count
+
+        let rle8 = encodeRLE8(pixels)
+        if rle8.count + sizePrefixLength < bestSize {
+            best = (.rle8, rle8)
+            bestSize = rle8.count + sizePrefixLength
+        }
+
+        if let lz5 = encodeLZ5(pixels), lz5.count + sizePrefixLength < bestSize {
+            best = (.lz5, lz5)
+        }
+        return best
+    }
+
+    // MARK: - RLE8
+
+    /// RLE8 encoder: runs become a 0x40|count marker plus the value, single pixels are stored
+    /// as literals unless they'd be read as a marker (0x40-0x7F)
+    static func encodeRLE8(_ pixels: [UInt8]) -> Data {
+        var out: [UInt8] = []
+        out.reserveCapacity(pixels.count / 2 + 16)
+
+        pixels.withUnsafeBufferPointer { src in
+            let count = src.count
+            var i = 0
+
+            while i < count {
+                let value = src[i]
+                var run = 1
+                while run < 63 && i + run < count && src[i + run] == value {
+                    run += 1
+                }
+
+                if run == 1 && (value & 0xC0) != 0x40 {
+                    out.append(value)
+                } else {
+                    out.append(0x40 | UInt8(run))
+                    out.append(value)
+                }
+                i += run
+            }
+        }
+        return Data(out)
+    }
+
+    // MARK: - LZ5
+
+    /// Back-reference window and length limits of the LZ5 token forms
+    private static let lz5Window = 1024
+    private static let lz5ShortCopyWindow = 256
+    private static let lz5ShortCopyMaxLength = 64
+    private static let lz5LongCopyMaxLength = 258
+    private static let lz5RunMaxLength = 263
+    private static let lz5MinMatch = 3
+
+    /// Hash chain positions visited per match search
+    private static let lz5MaxChainDepth = 32
+
+    /// LZ5 encoder: greedy parse choosing, at each position, the longer of the run starting
+    /// there and the best back-reference within the 1 KB window (3-byte hash chains)
+    /// - Returns: The payload, or nil if the sprite uses indices above 31 (runs store 5-bit
+    ///   colors and there are no literals, so such pixels can't be expressed)
+    static func encodeLZ5(_ pixels: [UInt8]) -> Data? {
+        guard !pixels.contains(where: { $0 >= 32 }) else { return nil }
+
+        var writer = LZ5TokenWriter()
+        writer.out.reserveCapacity(pixels.count / 4 + 16)
+
+        pixels.withUnsafeBufferPointer { src in
+            let count = src.count
+
+            // Indices are 5-bit, so three of them pack into a 15-bit hash key
+            var head = [Int32](repeating: -1, count: 1 << 15)
+            var previous = [Int32](repeating: -1, count: count)
+
+            func key(_ i: Int) -> Int {
+                return Int(src[i]) << 10 | Int(src[i + 1]) << 5 | Int(src[i + 2])
+            }
+
+            func insert(_ i: Int) {
+                guard i + 2 < count else { return }
+                let k = key(i)
+                previous[i] = head[k]
+                head[k] = Int32(i)
+            }
+
+            var i = 0
+            while i < count {
+                let value = src[i]
+                var run = 1
+                while run < lz5RunMaxLength && i + run < count && src[i + run] == value {
+                    run += 1
+                }
+
+                var matchLength = 0
+                var matchDistance = 0
+                if i + lz5MinMatch <= count {
+                    let limit = min(lz5LongCopyMaxLength, count - i)
+                    var candidate = Int(head[key(i)])
+                    var depth = 0
+
+                    while candidate >= 0 && i - candidate <= lz5Window && depth < lz5MaxChainDepth {
+                        var length = 0
+                        while length < limit && src[candidate + length] == src[i + length] {
+                            length += 1
+                        }
+                        if length > matchLength {
+                            matchLength = length
+                            matchDistance = i - candidate
+                            if length == limit { break }
+                        }
+                        candidate = Int(previous[candidate])
+                        depth += 1
+                    }
+                }
+
+                let advance: Int
+                if matchLength >= lz5MinMatch && matchLength > run {
+                    if matchDistance <= lz5ShortCopyWindow && matchLength <= lz5ShortCopyMaxLength {
+                        writer.shortCopy(distance: matchDistance, length: matchLength)
+                    } else {
+                        writer.longCopy(distance: matchDistance, length: matchLength)
+                    }
+                    advance = matchLength
+                } else {
+                    writer.run(value, length: run)
+                    advance = run
+                }
+
+                for position in i..<(i + advance) {
+                    insert(position)
+                }
+                i += advance
+            }
+        }
+        return Data(writer.out)
+    }
+
+    /// Emits LZ5 tokens and their control bytes
+    private struct LZ5TokenWriter {
+        var out: [UInt8] = []
+
+        /// Position of the control byte for the current group of eight tokens
+        private var controlPosition = 0
+        private var tokensInGroup = 8
+
+        /// Output positions of short copies whose top two bits are still unassigned
+        /// Every fourth short copy has no offset byte: its offset is rebuilt from the top bits
+        /// of itself and the three before it, so those are back-patched once it's known.
+        private var pendingShortCopies: [Int] = []
+
+        private mutating func beginToken(isCopy: Bool) {
+            if tokensInGroup == 8 {
+                controlPosition = out.count
+                out.append(0)
+                tokensInGroup = 0
+            }
+            if isCopy {
+                out[controlPosition] |= UInt8(1 << tokensInGroup)
+            }
+            tokensInGroup += 1
+        }
+
+        /// Run of one 5-bit color: 1 byte for up to 7 pixels, else 2 bytes for up to 263
+        mutating func run(_ color: UInt8, length: Int) {
+            beginToken(isCopy: false)
+            if length <= 7 {
+                out.append(UInt8(length << 5) | color)
+            } else {
+                out.append(color)
+                out.append(UInt8(length - 8))
+            }
+        }
+
+        /// Back-reference of 2-64 bytes within 256 pixels
+        mutating func shortCopy(distance: Int, length: Int) {
+            beginToken(isCopy: true)
+
+            if pendingShortCopies.count == 3 {
+                let recycled = distance - 1
+                for (slot, position) in pendingShortCopies.enumerated() {
+                    out[position] |= UInt8((recycled >> (6 - slot * 2)) & 0x03) << 6
+                }
+                out.append(UInt8(recycled & 0x03) << 6 | UInt8(length - 1))
+                pendingShortCopies.removeAll(keepingCapacity: true)
+            } else {
+                pendingShortCopies.append(out.count)
+                out.append(UInt8(length - 1))
+                out.append(UInt8(distance - 1))
+            }
+        }
+
+        /// Back-reference of 3-258 bytes within 1024 pixels
+        mutating func longCopy(distance: Int, length: Int) {
+            beginToken(isCopy: true)
+            out.append(UInt8((distance - 1) >> 8) << 6)
+            out.append(UInt8((distance - 1) & 0xFF))
+            out.append(UInt8(length - 3))
+        }
+    }
+}
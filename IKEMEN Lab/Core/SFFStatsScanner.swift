@@ -0,0 +1,221 @@
+import Foundation
+import os.log
+
+// MARK: - SFF Stats
+
+/// Library-level facts about an SFF file, derived from its headers and node tables alone
+public struct SFFStats: Equatable {
+    /// SFF major version (1 or 2)
+    public let version: Int
+    public let spriteCount: Int
+    /// Sprites that reuse another sprite's payload
+    public let linkedSpriteCount: Int
+    /// v2 palette nodes; v1 sprites carrying their own palette
+    public let paletteCount: Int
+    /// v2 palette nodes in group 1, items 1-12 (the selectable character palettes); 0 for v1
+    public let characterPaletteCount: Int
+    /// Sprite count per compression format (see `SFFStats.formatName(_:version:)`)
+    public let formatCounts: [String: Int]
+    public let maxSpriteWidth: Int
+    public let maxSpriteHeight: Int
+    /// Dimensions of sprite 9000,0 after following links, if present
+    public let portraitWidth: Int?
+    public let portraitHeight: Int?
+    /// Total pixels across all non-linked sprites
+    public let decodedPixelCount: Int64
+
+    /// Memory needed to hold every sprite decoded to RGBA
+    public var decodedRGBABytes: Int64 { decodedPixelCount * 4 }
+
+    /// Human-readable name for a sprite's compression format
+    public static func formatName(_ format: UInt8, version: Int) -> String {
+        guard version >= 2 else { return "pcx" }
+        switch format {
+        case 0: return "raw"
+        case 2: return "rle8"
+        case 3: return "rle5"
+        case 4: return "lz5"
+        case 10: return "png8"
+        case 11: return "png24"
+        case 12: return "png32"
+        default: return "unknown"
+        }
+    }
+}
+
+// MARK: - SFF Stats Scanner
+
+/// Computes `SFFStats` without decoding any sprite data and persists them in `MetadataStore`
+///
+/// The sprite directory comes from `SFFDirectoryIndex`, so a scan touches only the file
+/// header and node tables (v2 palette nodes are read directly for the palette breakdown).
+/// Results are keyed by path, size and modification date, so repeat lookups and library
+/// rescans skip files that haven't changed.
+public final class SFFStatsScanner {
+
+    // MARK: - Singleton
+
+    public static let shared = SFFStatsScanner()
+
+    // MARK: - Properties
+
+    private static let logger = Logger(subsystem: Bundle.main.bundleIdentifier ?? "com.ikemenlab", category: "SFFStatsScanner")
+
+    private let scanQueue = DispatchQueue(label: "com.ikemenlab.sffStatsScanner", qos: .utility)
+
+    // MARK: - Initialization
+
+    private init() {}
+
+    // MARK: - Lookup
+
+    /// Get stats for an SFF file, scanning it only if the stored stats are missing or stale
+    public func stats(for url: URL) -> SFFStats? {
+        guard let identity = SFFDirectoryIndex.fileIdentity(of: url) else { return nil }
+        let path = url.standardizedFileURL.path
+
+        if let record = try? MetadataStore.shared.sffStats(path: path, fileSize: identity.size, modifiedAt: identity.modifiedAt) {
+            return record.stats
+        }
+
+        guard let stats = scan(url) else { return nil }
+        do {
+            try MetadataStore.shared.storeSFFStats([
+                SFFStatsRecord(path: path, characterId: nil, fileSize: identity.size, modifiedAt: identity.modifiedAt, stats: stats)
+            ])
+        } catch {
+            Self.logger.error("Failed to store SFF stats: \(error.localizedDescription)")
+        }
+        return stats
+    }
+
+    /// Get stats for a character's sprite file
+    public func stats(for character: CharacterInfo) -> SFFStats? {
+        guard let sffURL = character.spriteFileURL else { return nil }
+        return stats(for: sffURL)
+    }
+
+    // MARK: - Scanning
+
+    /// Compute stats for an SFF file without consulting the stored index
+    public func scan(_ url: URL) -> SFFStats? {
+        guard let reader = try? SFFReader(url: url) else { return nil }
+        return scan(reader)
+    }
+
+    /// Compute stats from an open reader
+    public func scan(_ reader: SFFReader) -> SFFStats? {
+        guard let directory = SFFDirectoryIndex.shared.directory(for: reader) else { return nil }
+
+        var formatCounts: [String: Int] = [:]
+        var linkedCount = 0
+        var maxWidth = 0
+        var maxHeight = 0
+        var pixelCount: Int64 = 0
+
+        for entry in directory.entries {
+            maxWidth = max(maxWidth, Int(entry.width))
+            maxHeight = max(maxHeight, Int(entry.height))
+
+            if entry.isLinked {
+                linkedCount += 1
+                continue
+            }
+
+            formatCounts[SFFStats.formatName(entry.format, version: directory.version), default: 0] += 1
+            pixelCount += Int64(entry.width) * Int64(entry.height)
+        }
+
+        var portraitWidth: Int?
+        var portraitHeight: Int?
+        if let portrait = directory.resolvedEntry(group: 9000, image: 0) {
+            portraitWidth = Int(portrait.width)
+            portraitHeight = Int(portrait.height)
+        }
+
+        return SFFStats(
+            version: directory.version,
+            spriteCount: directory.spriteCount,
+            linkedSpriteCount: linkedCount,
+            paletteCount: directory.paletteCount,
+            characterPaletteCount: directory.version >= 2 ? characterPaletteCount(in: reader) : 0,
+            formatCounts: formatCounts,
+            maxSpriteWidth: maxWidth,
+            maxSpriteHeight: maxHeight,
+            portraitWidth: portraitWidth,
+            portraitHeight: portraitHeight,
+            decodedPixelCount: pixelCount
+        )
+    }
+
+    /// Scan every character's sprite file in parallel and store the results in one transaction
+    /// Files whose stored stats are still current are skipped.
+    /// - Parameters:
+    ///   - characters: Characters to scan
+    ///   - completion: Called on the main queue with the number of files (re)scanned
+    public func scanLibrary(_ characters: [CharacterInfo], completion: ((Int) -> Void)? = nil) {
+        scanQueue.async {
+            let existing = (try? MetadataStore.shared.allSFFStats()) ?? []
+            let current = Dictionary(existing.map { ($0.path, $0) }, uniquingKeysWith: { first, _ in first })
+
+            // Resolve sprite files up front; this touches only directory listings
+            var pending: [(url: URL, path: String, characterId: String, size: Int64, modifiedAt: Double)] = []
+            for character in characters {
+                guard let url = character.spriteFileURL,
+                      let identity = SFFDirectoryIndex.fileIdentity(of: url) else { continue }
+                let path = url.standardizedFileURL.path
+
+                if let record = current[path], record.fileSize == identity.size,
+                   record.modifiedAt == identity.modifiedAt, record.characterId == character.id {
+                    continue
+                }
+                pending.append((url, path, character.id, identity.size, identity.modifiedAt))
+            }
+
+            var results = [SFFStatsRecord?](repeating: nil, count: pending.count)
+            let lock = NSLock()
+
+            DispatchQueue.concurrentPerform(iterations: pending.count) { i in
+                let item = pending[i]
+                guard let stats = self.scan(item.url) else { return }
+                let record = SFFStatsRecord(path: item.path, characterId: item.characterId,
+                                            fileSize: item.size, modifiedAt: item.modifiedAt, stats: stats)
+                lock.lock()
+                results[i] = record
+                lock.unlock()
+            }
+
+            let records = results.compactMap { $0 }
+            do {
+                try MetadataStore.shared.storeSFFStats(records)
+            } catch {
+                Self.logger.error("Failed to store SFF stats: \(error.localizedDescription)")
+            }
+
+            DispatchQueue.main.async {
+                completion?(records.count)
+            }
+        }
+    }
+
+    // MARK: - Helpers
+
+    /// Count v2 palette nodes in group 1, items 1-12
+    private func characterPaletteCount(in reader: SFFReader) -> Int {
+        let paletteOffset = Int(reader.readUInt32(at: 44))
+        let paletteCount = Int(reader.readUInt32(at: 48))
+        guard paletteOffset > 0, paletteOffset < reader.count else { return 0 }
+
+        let available = (reader.count - paletteOffset) / 16
+        var count = 0
+        for i in 0..<min(paletteCount, available) {
+            let offset = paletteOffset + i * 16
+            let group = reader.readUInt16(at: offset)
+            let item = reader.readUInt16(at: offset + 2)
+            if group == 1 && (1...12).contains(item) {
+                count += 1
+            }
+        }
+        return count
+    }
+}
@@ -0,0 +1,472 @@
+import Foundation
+
+// MARK: - Transcode Results
+
+/// Outcome of transcoding one SFF file
+public struct SFFTranscodeResult: Equatable {
+
+    public enum Status: String {
+        /// Rewritten smaller, verified and swapped in
+        case transcoded
+        /// Re-encoding didn't make the file smaller; left untouched
+        case alreadyCompact
+        /// Not a format the transcoder rewrites (e.g. SFFv1); left untouched
+        case skipped
+        /// Couldn't be read, written or verified; the original is left untouched
+        case failed
+    }
+
+    public let path: String
+    public let characterId: String?
+    public let status: Status
+    public let originalBytes: Int64
+    /// Size after the job (equal to `originalBytes` unless transcoded)
+    public let transcodedBytes: Int64
+    /// Reason for skips and failures
+    public let detail: String?
+
+    public var savedBytes: Int64 {
+        return status == .transcoded ? originalBytes - transcodedBytes : 0
+    }
+
+    /// The same outcome with a different detail message
+    func withDetail(_ detail: String) -> SFFTranscodeResult {
+        return SFFTranscodeResult(path: path, characterId: characterId, status: status,
+                                  originalBytes: originalBytes, transcodedBytes: transcodedBytes, detail: detail)
+    }
+}
+
+/// Summary of a library transcoding run
+public struct SFFTranscodeReport {
+
+    /// Savings for one character's sprite files
+    public struct CharacterSavings: Equatable {
+        public let characterId: String
+        public let files: Int
+        public let originalBytes: Int64
+        public let transcodedBytes: Int64
+
+        public var savedBytes: Int64 { originalBytes - transcodedBytes }
+    }
+
+    /// One result per SFF file, including files finished by an earlier (resumed) run
+    public let results: [SFFTranscodeResult]
+
+    /// Whether the run was cancelled before every file was processed
+    public let wasCancelled: Bool
+
+    public var totalSavedBytes: Int64 {
+        return results.reduce(0) { $0 + $1.savedBytes }
+    }
+
+    public var failures: [SFFTranscodeResult] {
+        return results.filter { $0.status == .failed }
+    }
+
+    /// Per-character savings, largest first
+    public var characters: [CharacterSavings] {
+        var totals: [String: CharacterSavings] = [:]
+        for result in results {
+            guard let id = result.characterId else { continue }
+            let previous = totals[id]
+            totals[id] = CharacterSavings(
+                characterId: id,
+                files: (previous?.files ?? 0) + 1,
+                originalBytes: (previous?.originalBytes ?? 0) + result.originalBytes,
+                transcodedBytes: (previous?.transcodedBytes ?? 0) + result.transcodedBytes
+            )
+        }
+        return totals.values.sorted {
+            $0.savedBytes != $1.savedBytes ? $0.savedBytes > $1.savedBytes : $0.characterId < $1.characterId
+        }
+    }
+
+    /// One-line summary for the UI
+    public var summary: String {
+        let saved = ByteCountFormatter.string(fromByteCount: totalSavedBytes, countStyle: .file)
+        let transcoded = results.filter { $0.status == .transcoded }.count
+        var text = "Saved \(saved) across \(transcoded) of \(results.count) sprite files"
+        if !failures.isEmpty {
+            text += " (\(failures.count) failed)"
+        }
+        return text
+    }
+}
+
+// MARK: - SFF Transcoder
+
+/// Re-encodes SFFv2 files in place with the smallest lossless sprite formats
+///
+/// Each 8-bit raw / RLE8 / RLE5 / LZ5 sprite is decoded to palette indices and stored as
+/// whichever of raw, RLE8 and LZ5 is smallest (see `SFFSpriteEncoder`); PNG and true-color
+/// sprites, palettes, sprite links, axes and the header's version and compatibility bytes are
+/// copied as they are. The new file is written next to the original, decoded again and compared
+/// sprite by sprite against the original, and only then swapped in with an atomic replace.
+/// Files that don't get smaller are left alone.
+///
+/// Library runs process files on a bounded worker pool and record every outcome in
+/// `MetadataStore`, so a cancelled or interrupted run picks up where it stopped.
+public final class SFFTranscoder {
+
+    // MARK: - Singleton
+
+    public static let shared = SFFTranscoder()
+
+    // MARK: - Options
+
+    public struct Options {
+        /// Files transcoded at the same time
+        public var maxConcurrentFiles = max(1, min(4, ProcessInfo.processInfo.activeProcessorCount - 1))
+        /// Keep each replaced original next to the new file as `<name>.sff.bak`
+        public var keepBackups = false
+
+        public init() {}
+    }
+
+    /// Suffix of the in-progress output written next to each file
+    static let temporaryExtension = "transcoding"
+
+    // MARK: - Properties
+
+    private let jobQueue = DispatchQueue(label: "com.ikemenlab.SFFTranscoder", qos: .utility)
+    private let lock = NSLock()
+    private var activeQueue: OperationQueue?
+    /// Set by `cancel()`; also stops a job whose workers haven't started yet
+    private var isCancelled = false
+
+    // MARK: - Library Job
+
+    /// Transcode the sprite files of every character
+    /// Files already handled by an earlier run (and unchanged since) aren't touched again.
+    /// - Parameters:
+    ///   - characters: Characters whose folders are scanned for .sff files
+    ///   - options: Worker count and backup behavior
+    ///   - progress: Called on the main queue with (files done, files to do) for this run
+    ///   - fileFinished: Called on the worker thread as each file is done, before its worker
+    ///     picks up the next file
+    ///   - completion: Called on the main queue with the report
+    public func transcodeLibrary(_ characters: [CharacterInfo], options: Options = Options(),
+                                 progress: ((Int, Int) -> Void)? = nil,
+                                 fileFinished: ((SFFTranscodeResult) -> Void)? = nil,
+                                 completion: @escaping (SFFTranscodeReport) -> Void) {
+        lock.lock()
+        isCancelled = false
+        lock.unlock()
+
+        jobQueue.async {
+            let existing = (try? MetadataStore.shared.allSFFTranscodes()) ?? []
+            let finished = Dictionary(existing.map { ($0.path, $0) }, uniquingKeysWith: { first, _ in first })
+
+            var carried: [SFFTranscodeResult] = []
+            var pending: [(url: URL, characterId: String)] = []
+            var seen = Set<String>()
+
+            for character in characters {
+                for url in SFFTranscoder.spriteFiles(in: character.directory) {
+                    let path = url.standardizedFileURL.path
+                    guard seen.insert(path).inserted,
+                          let identity = SFFDirectoryIndex.fileIdentity(of: url) else { continue }
+
+                    if let record = finished[path], record.fileSize == identity.size,
+                       record.modifiedAt == identity.modifiedAt,
+                       let status = SFFTranscodeResult.Status(rawValue: record.status) {
+                        carried.append(SFFTranscodeResult(path: path, characterId: character.id, status: status,
+                                                          originalBytes: record.originalBytes,
+                                                          transcodedBytes: record.transcodedBytes,
+                                                          detail: record.detail))
+                        continue
+                    }
+                    pending.append((url, character.id))
+                }
+            }
+
+            let queue = OperationQueue()
+            queue.name = "com.ikemenlab.SFFTranscoder.workers"
+            queue.maxConcurrentOperationCount = max(1, options.maxConcurrentFiles)
+            queue.qualityOfService = .utility
+
+            self.lock.lock()
+            self.activeQueue = queue
+            let cancelledEarly = self.isCancelled
+            self.lock.unlock()
+
+            var results = [SFFTranscodeResult?](repeating: nil, count: pending.count)
+            var completed = 0
+            let resultsLock = NSLock()
+
+            for (i, item) in pending.enumerated() where !cancelledEarly {
+                queue.addOperation {
+                    var result = SFFTranscoder.transcodeFile(at: item.url, characterId: item.characterId,
+                                                             keepBackup: options.keepBackups)
+                    do {
+                        try SFFTranscoder.record(result, url: item.url)
+                    } catch {
+                        result = result.withDetail("Result not saved, so the file is checked again next run: \(error.localizedDescription)")
+                    }
+
+                    resultsLock.lock()
+                    results[i] = result
+                    completed += 1
+                    let done = completed
+                    resultsLock.unlock()
+
+                    fileFinished?(result)
+
+                    if let progress = progress {
+                        DispatchQueue.main.async {
+                            progress(done, pending.count)
+                        }
+                    }
+                }
+            }
+            queue.waitUntilAllOperationsAreFinished()
+
+            self.lock.lock()
+            self.activeQueue = nil
+            self.lock.unlock()
+
+            let processed = results.compactMap { $0 }
+            let report = SFFTranscodeReport(results: carried + processed, wasCancelled: processed.count < pending.count)
+            DispatchQueue.main.async {
+                completion(report)
+            }
+        }
+    }
+
+    /// Stop a running library job after the files currently in progress
+    public func cancel() {
+        lock.lock()
+        isCancelled = true
+        activeQueue?.cancelAllOperations()
+        lock.unlock()
+    }
+
+    /// Persist an outcome so a later run can skip the file; failures are retried next time
+    private static func record(_ result: SFFTranscodeResult, url: URL) throws {
+        guard result.status != .failed,
+              let identity = SFFDirectoryIndex.fileIdentity(of: url) else { return }
+
+        let record = SFFTranscodeRecord(path: result.path, characterId: result.characterId,
+                                        fileSize: identity.size, modifiedAt: identity.modifiedAt,
+                                        status: result.status.rawValue, originalBytes: result.originalBytes,
+                                        transcodedBytes: result.transcodedBytes, detail: result.detail,
+                                        transcodedAt: Date())
+        try MetadataStore.shared.storeSFFTranscode(record)
+    }
+
+    /// .sff files directly inside a character folder
+    private static func spriteFiles(in directory: URL) -> [URL] {
+        let contents = (try? FileManager.default.contentsOfDirectory(at: directory, includingPropertiesForKeys: nil)) ?? []
+        return contents
+            .filter { $0.pathExtension.lowercased() == "sff" }
+            .sorted { $0.lastPathComponent < $1.lastPathComponent }
+    }
+
+    // MARK: - Single File
+
+    /// Transcode one SFF file in place
+    /// The original is only replaced once the new file has been written and verified.
+    /// - Parameters:
+    ///   - url: SFF file to rewrite
+    ///   - characterId: Owning character, for the report
+    ///   - keepBackup: Keep the original as `<name>.sff.bak` after the swap
+    public static func transcodeFile(at url: URL, characterId: String? = nil, keepBackup: Bool = false) -> SFFTranscodeResult {
+        let path = url.standardizedFileURL.path
+        let fileManager = FileManager.default
+        let originalBytes = SFFDirectoryIndex.fileIdentity(of: url)?.size ?? 0
+        let tempURL = url.appendingPathExtension(temporaryExtension)
+
+        func result(_ status: SFFTranscodeResult.Status, bytes: Int64? = nil,
+                    detail: String? = nil) -> SFFTranscodeResult {
+            return SFFTranscodeResult(path: path, characterId: characterId, status: status,
+                                      originalBytes: originalBytes, transcodedBytes: bytes ?? originalBytes, detail: detail)
+        }
+
+        // Output left behind by an interrupted run is never trusted
+        try? fileManager.removeItem(at: tempURL)
+
+        var transcodedBytes: Int64 = 0
+        do {
+            let original = try SFFArchive(url: url)
+            guard original.version >= 2 else {
+                return result(.skipped, detail: "SFFv1 files are left as PCX")
+            }
+
+            try write(original, to: tempURL)
+            transcodedBytes = SFFDirectoryIndex.fileIdentity(of: tempURL)?.size ?? 0
+            guard transcodedBytes > 0, transcodedBytes < originalBytes else {
+                try? fileManager.removeItem(at: tempURL)
+                return result(.alreadyCompact)
+            }
+
+            // Opened without a URL so the temporary file's directory isn't persisted
+            let mapped = try Data(contentsOf: tempURL, options: [.alwaysMapped])
+            let transcoded = try SFFArchive(reader: SFFReader(data: mapped))
+            if let mismatch = verify(original: original, transcoded: transcoded) {
+                try? fileManager.removeItem(at: tempURL)
+                return result(.failed, detail: "Verification failed: \(mismatch)")
+            }
+        } catch {
+            try? fileManager.removeItem(at: tempURL)
+            return result(.failed, detail: error.localizedDescription)
+        }
+
+        do {
+            let backupName = keepBackup ? url.lastPathComponent + ".bak" : nil
+            _ = try fileManager.replaceItemAt(url, withItemAt: tempURL, backupItemName: backupName,
+                                              options: keepBackup ? .withoutDeletingBackupItem : [])
+        } catch {
+            try? fileManager.removeItem(at: tempURL)
+            return result(.failed, detail: "Could not replace file: \(error.localizedDescription)")
+        }
+
+        return result(.transcoded, bytes: transcodedBytes)
+    }
+
+    // MARK: - Writing
+
+    /// Rewrite every sprite of an SFFv2 archive into a new file
+    static func write(_ archive: SFFArchive, to url: URL) throws {
+        let reader = archive.reader
+        let entries = archive.directory.entries
+        guard let versionHeader = SFFStreamWriter.VersionHeader(of: reader) else {
+            throw SFFError.corruptedData("Header is truncated")
+        }
+        let writer = try SFFStreamWriter(url: url, spriteCapacity: entries.count,
+                                         paletteNodes: try paletteNodes(of: archive),
+                                         versionHeader: versionHeader)
+
+        for (index, entry) in entries.enumerated() {
+            let x = Int16(bitPattern: reader.readUInt16(at: Int(entry.nodeOffset) + 8))
+            let y = Int16(bitPattern: reader.readUInt16(at: Int(entry.nodeOffset) + 10))
+
+            if entry.isLinked {
+                try writer.appendLink(group: entry.group, image: entry.image, x: x, y: y,
+                                      width: entry.width, height: entry.height,
+                                      format: entry.format, colorDepth: entry.colorDepth,
+                                      paletteIndex: entry.paletteIndex, linkedIndex: entry.linkedIndex)
+                continue
+            }
+
+            guard let payload = reader.bytes(at: Int(entry.dataOffset), length: Int(entry.dataLength)) else {
+                throw SFFError.corruptedData("Sprite \(index) data is out of range")
+            }
+
+            if let pixels = indices(of: entry, payload: payload) {
+                try writer.append(group: entry.group, image: entry.image, x: x, y: y,
+                                  width: entry.width, height: entry.height,
+                                  indexedPixels: pixels, encoding: .smallest, paletteIndex: entry.paletteIndex)
+            } else {
+                try writer.append(group: entry.group, image: entry.image, x: x, y: y,
+                                  width: entry.width, height: entry.height,
+                                  format: entry.format, colorDepth: entry.colorDepth,
+                                  paletteIndex: entry.paletteIndex, payload: payload)
+            }
+        }
+
+        try writer.finish()
+    }
+
+    /// The archive's palette table, copied node for node (links included)
+    private static func paletteNodes(of archive: SFFArchive) throws -> [SFFStreamWriter.PaletteNode] {
+        let reader = archive.reader
+        let listOffset = Int(reader.readUInt32(at: 44))
+        let ldataOffset = Int(reader.readUInt32(at: 52))
+
+        return try (0..<archive.paletteCount).map { index in
+            let nodeOffset = listOffset + index * SFFStreamWriter.paletteNodeSize
+            guard reader.contains(offset: nodeOffset, length: SFFStreamWriter.paletteNodeSize) else {
+                throw SFFError.corruptedData("Palette \(index) node is out of range")
+            }
+
+            let dataOffset = Int(reader.readUInt32(at: nodeOffset + 8))
+            let dataLength = Int(reader.readUInt32(at: nodeOffset + 12))
+            var colors: [UInt8] = []
+            if dataLength > 0 {
+                guard let data = reader.bytes(at: ldataOffset + dataOffset, length: dataLength) else {
+                    throw SFFError.corruptedData("Palette \(index) data is out of range")
+                }
+                colors = [UInt8](data)
+            }
+
+            return SFFStreamWriter.PaletteNode(group: reader.readUInt16(at: nodeOffset),
+                                               item: reader.readUInt16(at: nodeOffset + 2),
+                                               colorCount: reader.readUInt16(at: nodeOffset + 4),
+                                               linkedIndex: reader.readUInt16(at: nodeOffset + 6),
+                                               colors: colors)
+        }
+    }
+
+    /// Palette indices of an 8-bit raw / RLE8 / RLE5 / LZ5 sprite; nil for anything that is copied as-is
+    private static func indices(of entry: SFFSpriteDirectory.Entry, payload: Data) -> [UInt8]? {
+        guard entry.colorDepth == 8, [0, 2, 3, 4].contains(entry.format),
+              entry.width > 0, entry.height > 0 else { return nil }
+        return SFFv2Parser.decodeIndices(payload, width: Int(entry.width), height: Int(entry.height),
+                                         format: entry.format, colorDepth: entry.colorDepth)?.pixels
+    }
+
+    // MARK: - Verification
+
+    /// What a sprite looks like to the engine: its own node fields plus the decoded content of
+    /// the node it resolves to
+    private struct SpriteSnapshot: Equatable {
+        let group: UInt16
+        let image: UInt16
+        let x: UInt16
+        let y: UInt16
+        let width: UInt16
+        let height: UInt16
+        let paletteIndex: UInt16
+        /// Palette of the node holding the data, which linked sprites inherit
+        let resolvedPaletteIndex: UInt16?
+        /// Decoded palette indices for re-encoded sprites, the stored payload otherwise
+        let content: Data?
+    }
+
+    /// Compare two archives' header version block, then sprite by sprite and palette by palette
+    /// - Returns: nil if they decode identically, else a description of the first difference
+    static func verify(original: SFFArchive, transcoded: SFFArchive) -> String? {
+        let originalHeader = SFFStreamWriter.VersionHeader(of: original.reader)
+        let transcodedHeader = SFFStreamWriter.VersionHeader(of: transcoded.reader)
+        guard originalHeader != nil, originalHeader == transcodedHeader else {
+            return "version \(originalHeader?.versionString ?? "?") != \(transcodedHeader?.versionString ?? "?")"
+        }
+        guard original.spriteCount == transcoded.spriteCount else {
+            return "sprite count \(original.spriteCount) != \(transcoded.spriteCount)"
+        }
+        guard original.paletteCount == transcoded.paletteCount else {
+            return "palette count \(original.paletteCount) != \(transcoded.paletteCount)"
+        }
+
+        for index in 0..<original.paletteCount where original.palette(at: index) != transcoded.palette(at: index) {
+            return "palette \(index) differs"
+        }
+
+        for index in 0..<original.spriteCount where snapshot(of: original, at: index) != snapshot(of: transcoded, at: index) {
+            let entry = original.directory.entries[index]
+            return "sprite \(entry.group),\(entry.image) differs"
+        }
+        return nil
+    }
+
+    private static func snapshot(of archive: SFFArchive, at index: Int) -> SpriteSnapshot {
+        let reader = archive.reader
+        let entry = archive.directory.entries[index]
+
+        var resolvedPaletteIndex: UInt16?
+        var content: Data?
+        if let resolved = archive.resolvedIndex(index) {
+            let owner = archive.directory.entries[resolved]
+            resolvedPaletteIndex = owner.paletteIndex
+            if let payload = reader.bytes(at: Int(owner.dataOffset), length: Int(owner.dataLength)) {
+                content = indices(of: owner, payload: payload).map { Data($0) } ?? payload
+            }
+        }
+
+        return SpriteSnapshot(group: entry.group, image: entry.image,
+                              x: reader.readUInt16(at: Int(entry.nodeOffset) + 8),
+                              y: reader.readUInt16(at: Int(entry.nodeOffset) + 10),
+                              width: entry.width, height: entry.height, paletteIndex: entry.paletteIndex,
+                              resolvedPaletteIndex: resolvedPaletteIndex, content: content)
+    }
+}
@@ -1,7 +1,8 @@
 import Foundation
 import AppKit
+import CryptoKit
 
-/// Writes SFF v2 sprite files with embedded PNG images
+/// Writes SFF v2 sprite files with embedded PNG or indexed (raw / RLE8 / LZ5) images
 /// Used to create stage sprites from PNG background images
 public final class SFFWriter {
     
@@ -24,6 +25,22 @@ public final class SFFWriter {
         }
     }
     
+    // MARK: - Encoding
+    
+    /// How a sprite's pixels are stored
+    public enum Encoding {
+        /// 32-bit PNG (format 12)
+        case png
+        /// Uncompressed 8-bit indices (format 0)
+        case raw
+        /// 8-bit RLE (format 2)
+        case rle8
+        /// LZ5 (format 4); only for sprites using palette indices 0-31
+        case lz5
+        /// Whichever of raw, RLE8 and LZ5 is smallest for this sprite
+        case smallest
+    }
+    
     // MARK: - Sprite Entry
     
     /// Represents a sprite to be written to the SFF file
@@ -35,11 +52,19 @@ public final class SFFWriter {
         let pngData: Data
         let width: UInt16
         let height: UInt16
-        
-        public init(group: UInt16, image: UInt16, x: Int16 = 0, y: Int16 = 0, image nsImage: NSImage) throws {
+        /// Palette indices for 8-bit sprites (nil = PNG sprite)
+        let indexedPixels: [UInt8]?
+        /// RGBA palette for `indexedPixels`, 4 bytes per color
+        let palette: [UInt8]?
+        let encoding: Encoding
+        
+        /// Create a sprite from an image
+        /// With an indexed encoding, images of up to 255 opaque colors (plus fully transparent
+        /// pixels, stored as color 0) are converted to palette indices; anything else is kept as PNG.
+        public init(group: UInt16, image: UInt16, x: Int16 = 0, y: Int16 = 0, image nsImage: NSImage,
+                    encoding: Encoding = .png) throws {
             guard let tiffData = nsImage.tiffRepresentation,
-                  let bitmap = NSBitmapImageRep(data: tiffData),
-                  let png = bitmap.representation(using: .png, properties: [:]) else {
+                  let bitmap = NSBitmapImageRep(data: tiffData) else {
                 throw SFFWriteError.pngEncodingFailed
             }
             
@@ -47,9 +72,24 @@ public final class SFFWriter {
             self.image = image
             self.x = x
             self.y = y
-            self.pngData = png
             self.width = UInt16(bitmap.pixelsWide)
             self.height = UInt16(bitmap.pixelsHigh)
+            
+            if encoding != .png, let indexed = SFFWriter.indexedPixels(from: bitmap) {
+                self.pngData = Data()
+                self.indexedPixels = indexed.pixels
+                self.palette = indexed.palette
+                self.encoding = encoding
+                return
+            }
+            
+            guard let png = bitmap.representation(using: .png, properties: [:]) else {
+                throw SFFWriteError.pngEncodingFailed
+            }
+            self.pngData = png
+            self.indexedPixels = nil
+            self.palette = nil
+            self.encoding = .png
         }
         
         public init(group: UInt16, image: UInt16, x: Int16 = 0, y: Int16 = 0, pngData: Data, width: UInt16, height: UInt16) {
@@ -60,183 +100,56 @@ public final class SFFWriter {
             self.pngData = pngData
             self.width = width
             self.height = height
+            self.indexedPixels = nil
+            self.palette = nil
+            self.encoding = .png
+        }
+        
+        /// Create an 8-bit sprite from palette indices
+        /// - Parameters:
+        ///   - indexedPixels: One palette index per pixel, row by row
+        ///   - palette: RGBA colors, 4 bytes each (up to 256); color 0 is transparent
+        ///   - encoding: Storage format; `.png` is treated as `.smallest`
+        public init(group: UInt16, image: UInt16, x: Int16 = 0, y: Int16 = 0, indexedPixels: [UInt8],
+                    palette: [UInt8], width: UInt16, height: UInt16, encoding: Encoding = .smallest) {
+            self.group = group
+            self.image = image
+            self.x = x
+            self.y = y
+            self.pngData = Data()
+            self.width = width
+            self.height = height
+            self.indexedPixels = indexedPixels
+            self.palette = palette
+            self.encoding = encoding == .png ? .smallest : encoding
         }
     }
     
     // MARK: - Writing
     
     /// Create an SFF v2 file containing the provided sprites
+    /// Sprites are streamed to disk one at a time; byte-identical sprites are stored once and
+    /// emitted as linked nodes (see `SFFStreamWriter`)
     /// - Parameters:
     ///   - sprites: Array of sprite entries to include
     ///   - outputURL: Destination URL for the SFF file
     /// - Returns: Result indicating success or failure
     public static func write(sprites: [SpriteEntry], to outputURL: URL) -> Result<Void, SFFWriteError> {
-        var data = Data()
-        
-        // --- SFF v2 Header (36 bytes base + variable) ---
-        
-        // Signature: "ElecbyteSpr\0" (12 bytes)
-        let signature = "ElecbyteSpr\0".data(using: .ascii)!
-        data.append(signature)
-        
-        // Version: v2.01 (4 bytes: verlo3, verlo2, verlo1, verhi)
-        data.append(UInt8(0))   // verlo3
-        data.append(UInt8(1))   // verlo2 
-        data.append(UInt8(0))   // verlo1
-        data.append(UInt8(2))   // verhi = 2
-        
-        // Reserved (4 bytes)
-        data.append(contentsOf: [UInt8](repeating: 0, count: 4))
-        
-        // Reserved (4 bytes) 
-        data.append(contentsOf: [UInt8](repeating: 0, count: 4))
-        
-        // Compatibility version (4 bytes)
-        data.append(contentsOf: [UInt8](repeating: 0, count: 4))
-        
-        // Reserved (4 bytes)
-        data.append(contentsOf: [UInt8](repeating: 0, count: 4))
-        
-        // Reserved (4 bytes) - padding before sprite offset field at byte 36
-        data.append(contentsOf: [UInt8](repeating: 0, count: 4))
-        
-        // Calculate offsets
-        // SFF v2 header is 68 bytes total (fields end at byte 68)
-        let headerSize: UInt32 = 68
-        let spriteNodeSize: UInt32 = 28
-        let paletteNodeSize: UInt32 = 16
-        
-        // We'll use 1 dummy palette node
-        let paletteCount: UInt32 = 1
-        let spriteCount = UInt32(sprites.count)
-        
-        let spriteListOffset = headerSize
-        let paletteListOffset = spriteListOffset + (spriteCount * spriteNodeSize)
-        let ldataOffset = paletteListOffset + (paletteCount * paletteNodeSize)
-        
-        // Calculate total ldata size (all PNG data with 4-byte length prefixes)
-        var totalLdataSize: UInt32 = 0
-        for sprite in sprites {
-            totalLdataSize += UInt32(sprite.pngData.count) + 4  // 4 bytes for length prefix
-        }
-        
-        // Add dummy palette data (4 bytes for RGBA of color 0)
-        let paletteDataSize: UInt32 = 4
-        totalLdataSize += paletteDataSize
-        
-        // Offset 36: Sprite list offset
-        data.append(littleEndian: spriteListOffset)
-        
-        // Offset 40: Sprite count
-        data.append(littleEndian: spriteCount)
-        
-        // Offset 44: Palette list offset
-        data.append(littleEndian: paletteListOffset)
-        
-        // Offset 48: Palette count
-        data.append(littleEndian: paletteCount)
-        
-        // Offset 52: Ldata offset (literal data)
-        data.append(littleEndian: ldataOffset)
-        
-        // Offset 56: Ldata length
-        data.append(littleEndian: totalLdataSize)
-        
-        // Offset 60: Tdata offset (not used, same as end of file)
-        let tdataOffset = ldataOffset + totalLdataSize
-        data.append(littleEndian: tdataOffset)
-        
-        // Offset 64: Tdata length (0 - not used)
-        data.append(littleEndian: UInt32(0))
-        
-        // --- Sprite Nodes (28 bytes each) ---
-        
-        var currentLdataOffset: UInt32 = paletteDataSize  // Skip palette data at start
-        
-        for sprite in sprites {
-            // Group number (2 bytes)
-            data.append(littleEndian: sprite.group)
-            
-            // Image number (2 bytes)
-            data.append(littleEndian: sprite.image)
-            
-            // Width (2 bytes)
-            data.append(littleEndian: sprite.width)
-            
-            // Height (2 bytes)
-            data.append(littleEndian: sprite.height)
-            
-            // X axis (2 bytes)
-            data.append(littleEndian: UInt16(bitPattern: sprite.x))
-            
-            // Y axis (2 bytes)
-            data.append(littleEndian: UInt16(bitPattern: sprite.y))
-            
-            // Linked index (2 bytes) - 0xFFFF = not linked
-            data.append(littleEndian: UInt16(0xFFFF))
-            
-            // Format (1 byte) - 11 = PNG24, 12 = PNG32
-            data.append(UInt8(12))  // PNG32 (with alpha)
-            
-            // Color depth (1 byte) - 32 for PNG32
-            data.append(UInt8(32))
-            
-            // Data offset within ldata (4 bytes)
-            data.append(littleEndian: currentLdataOffset)
-            
-            // Data length (4 bytes) - PNG data + 4 byte header
-            let dataLen = UInt32(sprite.pngData.count) + 4
-            data.append(littleEndian: dataLen)
-            
-            // Palette index (2 bytes) - 0 for PNG
-            data.append(littleEndian: UInt16(0))
-            
-            // Flags (2 bytes) - 0 = uses ldata
-            data.append(littleEndian: UInt16(0))
-            
-            currentLdataOffset += dataLen
-        }
-        
-        // --- Palette Nodes (16 bytes each) ---
-        
-        // One dummy palette node
-        // Group number (2 bytes)
-        data.append(littleEndian: UInt16(0))
-        
-        // Item number (2 bytes)
-        data.append(littleEndian: UInt16(0))
-        
-        // Color count (2 bytes)
-        data.append(littleEndian: UInt16(1))
-        
-        // Linked index (2 bytes)
-        data.append(littleEndian: UInt16(0))
-        
-        // Data offset (4 bytes)
-        data.append(littleEndian: UInt32(0))
-        
-        // Data length (4 bytes)
-        data.append(littleEndian: paletteDataSize)
-        
-        // --- Ldata (Literal Data) ---
-        
-        // Dummy palette data (RGBA for color 0 - transparent black)
-        data.append(contentsOf: [UInt8(0), UInt8(0), UInt8(0), UInt8(0)])
-        
-        // PNG sprite data
-        for sprite in sprites {
-            // 4-byte header with uncompressed size (for PNG it's typically ignored)
-            let uncompressedSize = UInt32(sprite.width) * UInt32(sprite.height) * 4
-            data.append(littleEndian: uncompressedSize)
-            
-            // PNG data
-            data.append(sprite.pngData)
-        }
-        
-        // Write to file
         do {
-            try data.write(to: outputURL)
+            // One palette node per distinct palette, in first-use order
+            var palettes: [[UInt8]] = []
+            for palette in sprites.compactMap({ $0.palette }) where !palettes.contains(palette) {
+                palettes.append(palette)
+            }
+            
+            let writer = try SFFStreamWriter(url: outputURL, spriteCapacity: sprites.count, palettes: palettes)
+            for sprite in sprites {
+                try writer.append(sprite)
+            }
+            try writer.finish()
             return .success(())
+        } catch let error as SFFWriteError {
+            return .failure(error)
         } catch {
             return .failure(.writeFailed(error.localizedDescription))
         }
@@ -254,10 +167,11 @@ public final class SFFWriter {
             // Use 240x100 to match working stage0-720 thumbnail size
             // With portraitscale=4 in DEF, this scales to proper display size
             let thumbnailImage = createStageThumbnail(from: image, targetWidth: 240, targetHeight: 100)
-            let thumbSprite = try SpriteEntry(group: 9000, image: 1, x: 0, y: 0, image: thumbnailImage)
+            let thumbSprite = try SpriteEntry(group: 9000, image: 1, x: 0, y: 0, image: thumbnailImage, encoding: .smallest)
             
             // Create background sprite (group 0, image 0)
-            let bgSprite = try SpriteEntry(group: 0, image: 0, x: 0, y: 0, image: image)
+            // Pixel art backgrounds with few colors are stored indexed; photos stay PNG
+            let bgSprite = try SpriteEntry(group: 0, image: 0, x: 0, y: 0, image: image, encoding: .smallest)
             
             return write(sprites: [thumbSprite, bgSprite], to: outputURL)
         } catch let error as SFFWriteError {
@@ -267,6 +181,52 @@ public final class SFFWriter {
         }
     }
     
+    /// Convert a bitmap to palette indices
+    /// - Returns: Indices plus an RGBA palette (color 0 = transparent), or nil if the image has
+    ///   more than 255 opaque colors or any partially transparent pixel
+    static func indexedPixels(from bitmap: NSBitmapImageRep) -> (pixels: [UInt8], palette: [UInt8])? {
+        let width = bitmap.pixelsWide
+        let height = bitmap.pixelsHigh
+        guard width > 0, height > 0, let cgImage = bitmap.cgImage else { return nil }
+        
+        // Normalize to RGBA8 regardless of the source layout
+        var rgba = [UInt8](repeating: 0, count: width * height * 4)
+        let drawn = rgba.withUnsafeMutableBytes { buffer -> Bool in
+            guard let context = CGContext(data: buffer.baseAddress, width: width, height: height,
+                                          bitsPerComponent: 8, bytesPerRow: width * 4,
+                                          space: CGColorSpaceCreateDeviceRGB(),
+                                          bitmapInfo: CGImageAlphaInfo.premultipliedLast.rawValue) else {
+                return false
+            }
+            context.draw(cgImage, in: CGRect(x: 0, y: 0, width: width, height: height))
+            return true
+        }
+        guard drawn else { return nil }
+        
+        var palette: [UInt8] = [0, 0, 0, 0]
+        var colorIndices: [UInt32: UInt8] = [:]
+        var pixels = [UInt8](repeating: 0, count: width * height)
+        
+        for i in 0..<(width * height) {
+            let alpha = rgba[i * 4 + 3]
+            if alpha == 0 { continue }
+            guard alpha == 255 else { return nil }
+            
+            let r = rgba[i * 4], g = rgba[i * 4 + 1], b = rgba[i * 4 + 2]
+            let key = UInt32(r) << 16 | UInt32(g) << 8 | UInt32(b)
+            if let index = colorIndices[key] {
+                pixels[i] = index
+            } else {
+                guard colorIndices.count < 255 else { return nil }
+                let index = UInt8(colorIndices.count + 1)
+                colorIndices[key] = index
+                palette += [r, g, b, 255]
+                pixels[i] = index
+            }
+        }
+        return (pixels, palette)
+    }
+    
     /// Create a thumbnail version of the image
     private static func createThumbnail(from image: NSImage, maxSize: CGFloat) -> NSImage {
         let originalSize = image.size
@@ -360,6 +320,390 @@ public final class SFFWriter {
     }
 }
 
+// MARK: - Streaming Writer
+
+/// Writes an SFF v2 file incrementally through a `FileHandle`
+///
+/// Space for the header and the sprite node table is reserved up front, sprite payloads are
+/// appended to the literal data block as they arrive, and `finish()` seeks back to fill in the
+/// node table and header. Only the 28-byte nodes are kept in memory, never the payloads.
+///
+/// Output goes to a hidden temporary sibling of the destination, which `finish()` moves into
+/// place; a writer that fails or is abandoned before then removes it, so an existing file at
+/// the destination is never left half-overwritten.
+///
+/// Payloads are fingerprinted with SHA-256 (together with their dimensions and format); a
+/// sprite whose payload was already written becomes a linked node (data length 0, linked
+/// index pointing at the first copy), which IKEMEN GO resolves at load time.
+///
+/// Indexed sprites are encoded as raw, RLE8 or LZ5 per their `SFFWriter.Encoding`; their
+/// palettes are passed in up front, since the palette table sits ahead of the sprite data.
+public final class SFFStreamWriter {
+    
+    // MARK: - Layout
+    
+    static let headerSize = 68
+    static let spriteNodeSize = 28
+    static let paletteNodeSize = 16
+    
+    /// Dummy palette (one transparent color) written when no sprite is indexed
+    private static let dummyPalette: [UInt8] = [0, 0, 0, 0]
+    
+    /// Header bytes 12-35: version (verlo3, verlo2, verlo1, verhi), reserved and compatibility fields
+    /// The engine reads v2.00 and v2.01 files differently, so rewrites of an existing file keep its bytes.
+    struct VersionHeader: Equatable {
+        static let offset = 12
+        static let length = 24
+        
+        /// v2.01 with zeroed reserved and compatibility fields, for new files
+        static let v201 = VersionHeader(bytes: [0, 1, 0, 2] + [UInt8](repeating: 0, count: 20))
+        
+        let bytes: [UInt8]
+        
+        init(bytes: [UInt8]) {
+            self.bytes = bytes
+        }
+        
+        /// Copy the version block of an existing SFF file
+        init?(of reader: SFFReader) {
+            guard let data = reader.bytes(at: VersionHeader.offset, length: VersionHeader.length) else { return nil }
+            self.bytes = [UInt8](data)
+        }
+        
+        /// "2.0.1.0" style version, most significant byte first
+        var versionString: String {
+            return "\(bytes[3]).\(bytes[2]).\(bytes[1]).\(bytes[0])"
+        }
+    }
+    
+    /// A palette node as stored in the palette table
+    struct PaletteNode {
+        let group: UInt16
+        let item: UInt16
+        let colorCount: UInt16
+        let linkedIndex: UInt16
+        /// RGBA data; empty for a linked palette
+        let colors: [UInt8]
+    }
+    
+    // MARK: - Properties
+    
+    public let url: URL
+    
+    /// File being written until `finish()` moves it to `url`
+    private let temporaryURL: URL
+    
+    /// Maximum number of sprites; fixes the size of the reserved node table
+    public let spriteCapacity: Int
+    
+    /// Sprites appended so far
+    public private(set) var spriteCount = 0
+    
+    /// Sprites that were written as links to an identical earlier payload
+    public private(set) var linkedSpriteCount = 0
+    
+    private let handle: FileHandle
+    private let ldataOffset: Int
+    
+    /// Bytes written to ldata so far
+    private var ldataLength: Int
+    
+    /// Number of palette nodes written after the sprite node table
+    private let paletteCount: Int
+    
+    /// Version block written into the header on finish
+    private let versionHeader: VersionHeader
+    
+    /// RGBA palette -> palette node index
+    private let paletteIndices: [[UInt8]: UInt16]
+    
+    /// Packed sprite nodes, back-patched into the reserved table on finish
+    private var nodes = Data()
+    
+    /// Payload fingerprint -> index of the sprite that owns the data
+    private var payloadOwners: [Data: Int] = [:]
+    
+    private var isFinished = false
+    
+    // MARK: - Initialization
+    
+    /// Create the temporary output file and reserve the header and node table
+    /// - Parameters:
+    ///   - url: Destination URL for the SFF file
+    ///   - spriteCapacity: Maximum number of sprites that will be appended
+    ///   - palettes: RGBA palettes (4 bytes per color) used by indexed sprites; written as palette
+    ///     nodes 0,0...0,N-1. Without any, a single transparent dummy palette is written.
+    /// - Throws: `SFFWriter.SFFWriteError.writeFailed` if the file can't be created
+    public convenience init(url: URL, spriteCapacity: Int, palettes: [[UInt8]] = []) throws {
+        guard palettes.allSatisfy({ !$0.isEmpty && $0.count <= 256 * 4 && $0.count % 4 == 0 }) else {
+            throw SFFWriter.SFFWriteError.writeFailed("Invalid palette")
+        }
+        
+        let paletteData = palettes.isEmpty ? [SFFStreamWriter.dummyPalette] : palettes
+        let nodes = paletteData.enumerated().map { index, colors in
+            PaletteNode(group: 0, item: UInt16(truncatingIfNeeded: index), colorCount: UInt16(colors.count / 4),
+                        linkedIndex: 0, colors: colors)
+        }
+        try self.init(url: url, spriteCapacity: spriteCapacity, paletteNodes: nodes)
+    }
+    
+    /// Create the output file with an explicit palette table and version block (e.g. copied from another SFF)
+    init(url: URL, spriteCapacity: Int, paletteNodes: [PaletteNode], versionHeader: VersionHeader = .v201) throws {
+        guard spriteCapacity >= 0, spriteCapacity <= Int(UInt16.max) else {
+            throw SFFWriter.SFFWriteError.writeFailed("Too many sprites (\(spriteCapacity))")
+        }
+        guard paletteNodes.count <= Int(UInt16.max) else {
+            throw SFFWriter.SFFWriteError.writeFailed("Too many palettes (\(paletteNodes.count))")
+        }
+        guard versionHeader.bytes.count == VersionHeader.length else {
+            throw SFFWriter.SFFWriteError.writeFailed("Invalid version header")
+        }
+        
+        let temporaryURL = url.deletingLastPathComponent()
+            .appendingPathComponent(".\(url.lastPathComponent).\(UUID().uuidString).partial")
+        guard FileManager.default.createFile(atPath: temporaryURL.path, contents: nil),
+              let handle = try? FileHandle(forWritingTo: temporaryURL) else {
+            throw SFFWriter.SFFWriteError.writeFailed("Could not create \(url.lastPathComponent)")
+        }
+        
+        self.url = url
+        self.temporaryURL = temporaryURL
+        self.spriteCapacity = spriteCapacity
+        self.handle = handle
+        self.paletteCount = paletteNodes.count
+        self.versionHeader = versionHeader
+        
+        var paletteIndices: [[UInt8]: UInt16] = [:]
+        for (index, node) in paletteNodes.enumerated() where !node.colors.isEmpty && paletteIndices[node.colors] == nil {
+            paletteIndices[node.colors] = UInt16(index)
+        }
+        self.paletteIndices = paletteIndices
+        
+        let paletteListOffset = SFFStreamWriter.headerSize + spriteCapacity * SFFStreamWriter.spriteNodeSize
+        self.ldataOffset = paletteListOffset + paletteNodes.count * SFFStreamWriter.paletteNodeSize
+        self.ldataLength = paletteNodes.reduce(0) { $0 + $1.colors.count }
+        
+        // Zeroed header and node table, then the palette nodes and their data
+        var prefix = Data(count: paletteListOffset)
+        
+        var paletteOffset = 0
+        for node in paletteNodes {
+            prefix.append(littleEndian: node.group)                 // Group number
+            prefix.append(littleEndian: node.item)                  // Item number
+            prefix.append(littleEndian: node.colorCount)            // Color count
+            prefix.append(littleEndian: node.linkedIndex)           // Linked index
+            prefix.append(littleEndian: UInt32(paletteOffset))      // Data offset
+            prefix.append(littleEndian: UInt32(node.colors.count))  // Data length (0 = linked)
+            paletteOffset += node.colors.count
+        }
+        
+        // Palette data (RGBA); the dummy is color 0 - transparent black
+        for node in paletteNodes {
+            prefix.append(contentsOf: node.colors)
+        }
+        
+        do {
+            try handle.write(contentsOf: prefix)
+        } catch {
+            try? handle.close()
+            try? FileManager.default.removeItem(at: temporaryURL)
+            throw SFFWriter.SFFWriteError.writeFailed(error.localizedDescription)
+        }
+    }
+    
+    deinit {
+        // Never finished (an append failed or the caller gave up): drop the partial output
+        if !isFinished {
+            try? handle.close()
+            try? FileManager.default.removeItem(at: temporaryURL)
+        }
+    }
+    
+    // MARK: - Writing
+    
+    /// Append a sprite: PNG (format 12), or raw / RLE8 / LZ5 for indexed sprites
+    /// - Throws: `SFFWriter.SFFWriteError.writeFailed` on I/O errors, when the capacity is exceeded
+    ///   or when an indexed sprite's palette wasn't passed to `init`
+    public func append(_ sprite: SFFWriter.SpriteEntry) throws {
+        if let pixels = sprite.indexedPixels, let palette = sprite.palette {
+            guard pixels.count == Int(sprite.width) * Int(sprite.height) else {
+                throw SFFWriter.SFFWriteError.invalidImage
+            }
+            guard let paletteIndex = paletteIndices[palette] else {
+                throw SFFWriter.SFFWriteError.writeFailed("Palette for sprite \(sprite.group),\(sprite.image) not registered")
+            }
+            try append(group: sprite.group, image: sprite.image, x: sprite.x, y: sprite.y,
+                       width: sprite.width, height: sprite.height,
+                       indexedPixels: pixels, encoding: sprite.encoding, paletteIndex: paletteIndex)
+            return
+        }
+        
+        // 4-byte header with uncompressed size (for PNG it's typically ignored)
+        var payload = Data(capacity: sprite.pngData.count + 4)
+        payload.append(littleEndian: UInt32(sprite.width) * UInt32(sprite.height) * 4)
+        payload.append(sprite.pngData)
+        
+        try append(group: sprite.group, image: sprite.image, x: sprite.x, y: sprite.y,
+                   width: sprite.width, height: sprite.height,
+                   format: 12, colorDepth: 32, paletteIndex: 0, payload: payload)
+    }
+    
+    /// Encode and append an 8-bit sprite that uses the given palette node
+    /// - Returns: The format the pixels were stored in
+    @discardableResult
+    func append(group: UInt16, image: UInt16, x: Int16, y: Int16, width: UInt16, height: UInt16,
+                indexedPixels pixels: [UInt8], encoding: SFFWriter.Encoding, paletteIndex: UInt16) throws -> SFFSpriteEncoder.Format {
+        // Compressed payloads start with the uncompressed size; raw ones don't
+        let encoded = SFFSpriteEncoder.encode(pixels, as: encoding)
+        var payload = Data(capacity: encoded.payload.count + SFFSpriteEncoder.sizePrefixLength)
+        if encoded.format != .raw {
+            payload.append(littleEndian: UInt32(pixels.count))
+        }
+        payload.append(encoded.payload)
+        
+        try append(group: group, image: image, x: x, y: y, width: width, height: height,
+                   format: encoded.format.rawValue, colorDepth: 8, paletteIndex: paletteIndex, payload: payload)
+        return encoded.format
+    }
+    
+    /// Append a linked node that reuses the payload of an earlier sprite
+    func appendLink(group: UInt16, image: UInt16, x: Int16, y: Int16, width: UInt16, height: UInt16,
+                    format: UInt8, colorDepth: UInt8, paletteIndex: UInt16, linkedIndex: UInt16) throws {
+        try checkCapacity()
+        appendNode(group: group, image: image, x: x, y: y, width: width, height: height, linkedIndex: linkedIndex,
+                   format: format, colorDepth: colorDepth, dataOffset: 0, dataLength: 0, paletteIndex: paletteIndex)
+        linkedSpriteCount += 1
+    }
+    
+    /// Append an already-encoded sprite payload
+    func append(group: UInt16, image: UInt16, x: Int16, y: Int16, width: UInt16, height: UInt16,
+                format: UInt8, colorDepth: UInt8, paletteIndex: UInt16, payload: Data) throws {
+        try checkCapacity()
+        
+        let fingerprint = SFFStreamWriter.fingerprint(width: width, height: height, format: format,
+                                                      colorDepth: colorDepth, paletteIndex: paletteIndex, payload: payload)
+        
+        var dataOffset = 0
+        var dataLength = 0
+        var linkedIndex = UInt16(0xFFFF)  // 0xFFFF = not linked
+        
+        if let owner = payloadOwners[fingerprint] {
+            // Linked node: no data of its own, reuses the owner's payload
+            linkedIndex = UInt16(owner)
+            linkedSpriteCount += 1
+        } else {
+            do {
+                try handle.write(contentsOf: payload)
+            } catch {
+                throw SFFWriter.SFFWriteError.writeFailed(error.localizedDescription)
+            }
+            dataOffset = ldataLength
+            dataLength = payload.count
+            ldataLength += payload.count
+            payloadOwners[fingerprint] = spriteCount
+        }
+        
+        guard ldataLength <= Int(UInt32.max) else {
+            throw SFFWriter.SFFWriteError.writeFailed("Sprite data exceeds 4 GB")
+        }
+        
+        appendNode(group: group, image: image, x: x, y: y, width: width, height: height, linkedIndex: linkedIndex,
+                   format: format, colorDepth: colorDepth, dataOffset: dataOffset, dataLength: dataLength,
+                   paletteIndex: paletteIndex)
+    }
+    
+    private func checkCapacity() throws {
+        guard !isFinished else {
+            throw SFFWriter.SFFWriteError.writeFailed("Writer already finished")
+        }
+        guard spriteCount < spriteCapacity else {
+            throw SFFWriter.SFFWriteError.writeFailed("Sprite capacity (\(spriteCapacity)) exceeded")
+        }
+    }
+    
+    private func appendNode(group: UInt16, image: UInt16, x: Int16, y: Int16, width: UInt16, height: UInt16,
+                            linkedIndex: UInt16, format: UInt8, colorDepth: UInt8,
+                            dataOffset: Int, dataLength: Int, paletteIndex: UInt16) {
+        nodes.append(littleEndian: group)
+        nodes.append(littleEndian: image)
+        nodes.append(littleEndian: width)
+        nodes.append(littleEndian: height)
+        nodes.append(littleEndian: UInt16(bitPattern: x))
+        nodes.append(littleEndian: UInt16(bitPattern: y))
+        nodes.append(littleEndian: linkedIndex)
+        nodes.append(format)
+        nodes.append(colorDepth)
+        nodes.append(littleEndian: UInt32(dataOffset))      // Offset within ldata
+        nodes.append(littleEndian: UInt32(dataLength))      // 0 for linked sprites
+        nodes.append(littleEndian: paletteIndex)
+        nodes.append(littleEndian: UInt16(0))               // Flags - 0 = uses ldata
+        
+        spriteCount += 1
+    }
+    
+    /// Back-patch the node table and header, close the file and move it to `url`
+    /// - Throws: `SFFWriter.SFFWriteError.writeFailed`; the partial output is removed and `url` is left as it was
+    public func finish() throws {
+        guard !isFinished else { return }
+        isFinished = true
+        
+        let spriteListOffset = UInt32(SFFStreamWriter.headerSize)
+        let paletteListOffset = UInt32(SFFStreamWriter.headerSize + spriteCapacity * SFFStreamWriter.spriteNodeSize)
+        
+        var header = Data()
+        
+        // Signature: "ElecbyteSpr\0" (12 bytes)
+        header.append("ElecbyteSpr\0".data(using: .ascii)!)
+        
+        // Version (verlo3, verlo2, verlo1, verhi), reserved and compatibility fields up to byte 36
+        header.append(contentsOf: versionHeader.bytes)
+        
+        header.append(littleEndian: spriteListOffset)           // Offset 36: Sprite list offset
+        header.append(littleEndian: UInt32(spriteCount))        // Offset 40: Sprite count
+        header.append(littleEndian: paletteListOffset)          // Offset 44: Palette list offset
+        header.append(littleEndian: UInt32(paletteCount))       // Offset 48: Palette count
+        header.append(littleEndian: UInt32(ldataOffset))        // Offset 52: Ldata offset
+        header.append(littleEndian: UInt32(ldataLength))        // Offset 56: Ldata length
+        header.append(littleEndian: UInt32(ldataOffset + ldataLength))  // Offset 60: Tdata offset (end of file)
+        header.append(littleEndian: UInt32(0))                  // Offset 64: Tdata length (not used)
+        
+        let fileManager = FileManager.default
+        do {
+            try handle.seek(toOffset: UInt64(spriteListOffset))
+            try handle.write(contentsOf: nodes)
+            try handle.seek(toOffset: 0)
+            try handle.write(contentsOf: header)
+            try handle.close()
+            
+            if fileManager.fileExists(atPath: url.path) {
+                _ = try fileManager.replaceItemAt(url, withItemAt: temporaryURL)
+            } else {
+                try fileManager.moveItem(at: temporaryURL, to: url)
+            }
+        } catch {
+            try? handle.close()
+            try? fileManager.removeItem(at: temporaryURL)
+            throw SFFWriter.SFFWriteError.writeFailed(error.localizedDescription)
+        }
+    }
+    
+    // MARK: - Deduplication
+    
+    private static func fingerprint(width: UInt16, height: UInt16, format: UInt8, colorDepth: UInt8,
+                                    paletteIndex: UInt16, payload: Data) -> Data {
+        var hasher = SHA256()
+        var descriptor = Data()
+        descriptor.append(littleEndian: width)
+        descriptor.append(littleEndian: height)
+        descriptor.append(format)
+        descriptor.append(colorDepth)
+        descriptor.append(littleEndian: paletteIndex)
+        hasher.update(data: descriptor)
+        hasher.update(data: payload)
+        return Data(hasher.finalize())
+    }
+}
+
 // MARK: - Data Extension for Little Endian Writing
 
 fileprivate extension Data {
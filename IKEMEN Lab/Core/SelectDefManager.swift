@@ -766,6 +766,7 @@ public final class SelectDefManager {
         
         // Then move the character directory to Trash
         try fileManager.trashItem(at: character.path, resultingItemURL: nil)
+        LibraryManifest.invalidate()
         Self.logger.info("Moved character directory to Trash: \(character.path.lastPathComponent)")
         
         // Notify that content has changed
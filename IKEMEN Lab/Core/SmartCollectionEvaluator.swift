@@ -28,9 +28,10 @@ class SmartCollectionEvaluator {
         // Evaluate characters
         if includeCharacters {
             let characters = (try? metadataStore.allCharacters()) ?? []
+            let structures = structuresIfNeeded(for: rules)
             matchingCharacters = characters
                 .filter { character in
-                    evaluateRules(rules, for: character, operator: ruleOperator)
+                    evaluateRules(rules, for: character, structure: structures[character.id], operator: ruleOperator)
                 }
                 .map { $0.id }
         }
@@ -50,13 +51,20 @@ class SmartCollectionEvaluator {
     
     // MARK: - Private Helpers
     
+    /// Indexed CNS/CMD structure by character id, loaded only when a rule needs it
+    private func structuresIfNeeded(for rules: [FilterRule]) -> [String: CharacterStructureRecord] {
+        guard rules.contains(where: { $0.field == .life || $0.field == .moveCount }) else { return [:] }
+        let records = (try? metadataStore.allCharacterStructures()) ?? []
+        return Dictionary(records.map { ($0.characterId, $0) }, uniquingKeysWith: { first, _ in first })
+    }
+    
     /// Evaluate rules for a character
-    private func evaluateRules(_ rules: [FilterRule], for character: CharacterRecord, operator ruleOperator: RuleOperator) -> Bool {
+    private func evaluateRules(_ rules: [FilterRule], for character: CharacterRecord, structure: CharacterStructureRecord?, operator ruleOperator: RuleOperator) -> Bool {
         // Empty rules match all
         guard !rules.isEmpty else { return true }
         
         let results = rules.map { rule in
-            evaluateRule(rule, for: character)
+            evaluateRule(rule, for: character, structure: structure)
         }
         
         switch ruleOperator {
@@ -85,7 +93,7 @@ class SmartCollectionEvaluator {
     }
     
     /// Evaluate a single rule for a character
-    private func evaluateRule(_ rule: FilterRule, for character: CharacterRecord) -> Bool {
+    private func evaluateRule(_ rule: FilterRule, for character: CharacterRecord, structure: CharacterStructureRecord?) -> Bool {
         switch rule.field {
         case .name:
             return evaluateStringField(character.name, rule: rule)
@@ -118,6 +126,10 @@ class SmartCollectionEvaluator {
             return evaluateBoolField(character.hasAI, rule: rule)
         case .style:
             return evaluateOptionalStringField(character.style, rule: rule)
+        case .life:
+            return evaluateIntField(structure?.life, rule: rule)
+        case .moveCount:
+            return evaluateIntField(structure.map { $0.specialMoveCount + $0.hyperMoveCount }, rule: rule)
         case .totalWidth, .hasMusic, .resolution:
             // Stage-specific fields don't apply to characters
             return false
@@ -137,7 +149,7 @@ class SmartCollectionEvaluator {
             return evaluateOptionalStringField(stage.sourceGame, rule: rule)
         case .resolution:
             return evaluateOptionalStringField(stage.resolution, rule: rule)
-        case .tag, .isHD, .hasAI, .style, .totalWidth, .hasMusic:
+        case .tag, .isHD, .hasAI, .style, .life, .moveCount, .totalWidth, .hasMusic:
             // Character-specific or unsupported fields
             return false
         }
@@ -244,6 +256,26 @@ class SmartCollectionEvaluator {
         }
     }
     
+    /// Evaluate an integer field (nil when the character hasn't been indexed yet)
+    private func evaluateIntField(_ fieldValue: Int?, rule: FilterRule) -> Bool {
+        switch rule.comparison {
+        case .isEmpty:
+            return fieldValue == nil
+        case .isNotEmpty:
+            return fieldValue != nil
+        default:
+            guard let fieldValue = fieldValue,
+                  let expected = Int(rule.value.trimmingCharacters(in: .whitespaces)) else { return false }
+            switch rule.comparison {
+            case .equals: return fieldValue == expected
+            case .notEquals: return fieldValue != expected
+            case .greaterThan: return fieldValue > expected
+            case .lessThan: return fieldValue < expected
+            default: return false
+            }
+        }
+    }
+    
     /// Evaluate a date field
     private func evaluateDateField(_ fieldValue: Date, rule: FilterRule) -> Bool {
         switch rule.comparison {
@@ -0,0 +1,213 @@
+import Foundation
+
+// MARK: - Text Encoding Detection
+
+/// Picks the text encoding of MUGEN/Ikemen config files from their bytes in one pass
+///
+/// Content comes from everywhere: UTF-8 from modern editors, Windows-1252 from old Western
+/// releases and Shift-JIS from Japanese authors. Instead of trial-decoding the whole file with
+/// each candidate, the bytes are checked once:
+/// 1. Valid UTF-8 (pure ASCII included) -> UTF-8. ASCII runs are skipped 8 bytes at a time.
+/// 2. Well-formed Shift-JIS whose double-byte pairs look Japanese -> Shift-JIS
+/// 3. Anything else -> Windows-1252 (Latin-1 if Foundation rejects the bytes)
+public enum TextEncodingDetector {
+
+    // MARK: - Detection
+
+    /// Detect the encoding of a byte buffer
+    public static func detect(_ bytes: UnsafeBufferPointer<UInt8>) -> String.Encoding {
+        if isValidUTF8(bytes) {
+            return .utf8
+        }
+        if looksLikeShiftJIS(bytes) {
+            return .shiftJIS
+        }
+        return .windowsCP1252
+    }
+
+    /// Detect the encoding of file contents
+    public static func detect(_ data: Data) -> String.Encoding {
+        return data.withUnsafeBytes { detect($0.bindMemory(to: UInt8.self)) }
+    }
+
+    // MARK: - Decoding
+
+    /// Decode a byte buffer with its detected encoding
+    /// Never fails: bytes Windows-1252 leaves undefined fall back to Latin-1.
+    public static func decode(_ bytes: UnsafeBufferPointer<UInt8>) -> String {
+        let encoding = detect(bytes)
+        if encoding == .utf8 {
+            // Already validated, so this can't introduce replacement characters
+            return String(decoding: bytes, as: UTF8.self)
+        }
+        return String(bytes: bytes, encoding: encoding)
+            ?? String(bytes: bytes, encoding: .isoLatin1)
+            ?? String(decoding: bytes, as: UTF8.self)
+    }
+
+    /// Decode file contents with their detected encoding
+    public static func decode(_ data: Data) -> String {
+        return data.withUnsafeBytes { decode($0.bindMemory(to: UInt8.self)) }
+    }
+
+    // MARK: - UTF-8
+
+    private static let highBitMask: UInt64 = 0x8080_8080_8080_8080
+
+    /// Strict UTF-8 validation (rejects overlong forms, surrogates and code points past U+10FFFF)
+    static func isValidUTF8(_ bytes: UnsafeBufferPointer<UInt8>) -> Bool {
+        guard let base = bytes.baseAddress else { return true }
+        let count = bytes.count
+        var i = 0
+
+        while i < count {
+            if bytes[i] < 0x80 {
+                // Skip ASCII a word at a time, then finish the run byte by byte
+                var word: UInt64 = 0
+                while i + 8 <= count {
+                    memcpy(&word, base + i, 8)
+                    if word & highBitMask != 0 { break }
+                    i += 8
+                }
+                while i < count && bytes[i] < 0x80 {
+                    i += 1
+                }
+                continue
+            }
+
+            // Allowed range of the first continuation byte depends on the lead byte
+            let length: Int
+            var lower: UInt8 = 0x80
+            var upper: UInt8 = 0xBF
+            switch bytes[i] {
+            case 0xC2...0xDF:
+                length = 2
+            case 0xE0:
+                length = 3
+                lower = 0xA0
+            case 0xE1...0xEC, 0xEE...0xEF:
+                length = 3
+            case 0xED:
+                length = 3
+                upper = 0x9F
+            case 0xF0:
+                length = 4
+                lower = 0x90
+            case 0xF1...0xF3:
+                length = 4
+            case 0xF4:
+                length = 4
+                upper = 0x8F
+            default:
+                return false
+            }
+
+            guard i + length <= count, bytes[i + 1] >= lower, bytes[i + 1] <= upper else { return false }
+            for offset in 2..<length where bytes[i + offset] & 0xC0 != 0x80 {
+                return false
+            }
+            i += length
+        }
+        return true
+    }
+
+    // MARK: - Shift-JIS
+
+    /// Whether the bytes parse as Shift-JIS and read like Japanese rather than Western text
+    ///
+    /// Windows-1252 accents (0xE0-0xFC) are also Shift-JIS lead bytes, so structure alone isn't
+    /// enough: "été" parses as a pair. Real kana and kanji mostly have either a lead byte in
+    /// 0x81-0x9F (rare punctuation or unassigned in Windows-1252) or a non-ASCII trail byte, so
+    /// at least half of the pairs must look like that.
+    static func looksLikeShiftJIS(_ bytes: UnsafeBufferPointer<UInt8>) -> Bool {
+        let count = bytes.count
+        var pairs = 0
+        var japanesePairs = 0
+        var i = 0
+
+        while i < count {
+            let lead = bytes[i]
+
+            // ASCII and half-width katakana are single bytes
+            if lead < 0x80 || (0xA1...0xDF).contains(lead) {
+                i += 1
+                continue
+            }
+
+            guard (0x81...0x9F).contains(lead) || (0xE0...0xFC).contains(lead), i + 1 < count else {
+                return false
+            }
+            let trail = bytes[i + 1]
+            guard (0x40...0x7E).contains(trail) || (0x80...0xFC).contains(trail) else {
+                return false
+            }
+
+            pairs += 1
+            if lead <= 0x9F || trail >= 0x80 {
+                japanesePairs += 1
+            }
+            i += 2
+        }
+        return pairs > 0 && japanesePairs * 2 >= pairs
+    }
+}
+
+// MARK: - Decoded Text Cache
+
+/// Reads config files once and keeps the decoded text while the file is unchanged
+///
+/// The same .def is read by the library scan, the validator and the details view; entries are
+/// keyed by path and checked against the file's size and modification date before reuse.
+public final class TextFileCache {
+
+    public static let shared = TextFileCache()
+
+    // MARK: - Properties
+
+    private final class CachedText {
+        let fileSize: Int64
+        let modifiedAt: Double
+        let text: String
+
+        init(fileSize: Int64, modifiedAt: Double, text: String) {
+            self.fileSize = fileSize
+            self.modifiedAt = modifiedAt
+            self.text = text
+        }
+    }
+
+    private let cache: NSCache<NSString, CachedText>
+
+    // MARK: - Initialization
+
+    private init() {
+        cache = NSCache<NSString, CachedText>()
+        cache.name = "com.ikemenlab.TextFileCache"
+        cache.totalCostLimit = 32 * 1024 * 1024  // bytes of file content
+    }
+
+    // MARK: - Reading
+
+    /// Decoded contents of a text file, or nil if it can't be read
+    public func string(contentsOf url: URL) -> String? {
+        guard let identity = SFFDirectoryIndex.fileIdentity(of: url) else { return nil }
+        let key = url.standardizedFileURL.path as NSString
+
+        if let cached = cache.object(forKey: key),
+           cached.fileSize == identity.size, cached.modifiedAt == identity.modifiedAt {
+            return cached.text
+        }
+
+        guard let data = try? Data(contentsOf: url) else { return nil }
+        let text = TextEncodingDetector.decode(data)
+
+        cache.setObject(CachedText(fileSize: identity.size, modifiedAt: identity.modifiedAt, text: text),
+                        forKey: key, cost: data.count)
+        return text
+    }
+
+    /// Drop every cached file
+    public func removeAll() {
+        cache.removeAllObjects()
+    }
+}
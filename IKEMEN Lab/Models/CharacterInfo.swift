@@ -27,7 +27,7 @@ public enum ContentStatus: String, Codable, Hashable, Sendable {
 // MARK: - Character Info
 
 /// Character metadata parsed from .def files
-public struct CharacterInfo: Identifiable, Hashable {
+public struct CharacterInfo: Identifiable, Hashable, Codable {
     public let id: String
     public let name: String
     public let displayName: String
@@ -57,7 +57,7 @@ public struct CharacterInfo: Identifiable, Hashable {
         self.id = directory.lastPathComponent
         self.status = status
         
-        // Parse .def file using shared parser
+        // Parse .def file using shared parser (cached from the scan's classification)
         let parsed = DEFParser.parse(url: defFile)
         
         let parsedName = parsed?.name ?? directory.lastPathComponent
@@ -73,13 +73,15 @@ public struct CharacterInfo: Identifiable, Hashable {
     
     /// Get the portrait image for this character
     /// Looks for portrait.png first, then extracts from SFF file
-    public func getPortraitImage() -> NSImage? {
+    /// - Parameter maxPixelSize: Longest side of the result (nil = full size); grid thumbnails
+    ///   pass a size so PNGs and sprites are downscaled during decode
+    public func getPortraitImage(maxPixelSize: Int? = nil) -> NSImage? {
         let fileManager = FileManager.default
         
         // First check for portrait.png in character directory
         let portraitPng = directory.appendingPathComponent("portrait.png")
         if fileManager.fileExists(atPath: portraitPng.path),
-           let image = NSImage(contentsOf: portraitPng) {
+           let image = loadPNG(portraitPng, maxPixelSize: maxPixelSize) {
             return image
         }
         
@@ -88,39 +90,57 @@ public struct CharacterInfo: Identifiable, Hashable {
             for file in contents where file.pathExtension.lowercased() == "png" {
                 let name = file.deletingPathExtension().lastPathComponent.lowercased()
                 if name.contains("portrait") || name.contains("select") {
-                    if let image = NSImage(contentsOf: file) {
+                    if let image = loadPNG(file, maxPixelSize: maxPixelSize) {
                         return image
                     }
                 }
             }
         }
         
-        // Try to extract from SFF file - use the one specified in DEF if available
+        // Try to extract from SFF file
+        if let sffFile = spriteFileURL {
+            return SFFParser.extractPortrait(from: sffFile, maxPixelSize: maxPixelSize)
+        }
+        
+        return nil
+    }
+    
+    /// Load a PNG portrait, downsampled by ImageIO when a size is given
+    private func loadPNG(_ url: URL, maxPixelSize: Int?) -> NSImage? {
+        guard let maxPixelSize = maxPixelSize else { return NSImage(contentsOf: url) }
+        guard let data = try? Data(contentsOf: url, options: .mappedIfSafe) else { return nil }
+        return SFFUtils.createImage(fromPNG: data, maxPixelSize: maxPixelSize)
+    }
+    
+    /// The character's sprite file
+    /// Uses the SFF named in the DEF if it exists, otherwise an SFF named like the DEF or folder,
+    /// otherwise any SFF in the character folder
+    public var spriteFileURL: URL? {
+        let fileManager = FileManager.default
+        
         if let spriteFileName = spriteFile {
             let sffFile = directory.appendingPathComponent(spriteFileName)
             if fileManager.fileExists(atPath: sffFile.path) {
-                return SFFParser.extractPortrait(from: sffFile)
+                return sffFile
             }
         }
         
         // Fallback: look for any SFF file with same name as DEF or folder
-        if let contents = try? fileManager.contentsOfDirectory(at: directory, includingPropertiesForKeys: nil) {
-            let sffFiles = contents.filter { $0.pathExtension.lowercased() == "sff" }
-            let defName = defFile.deletingPathExtension().lastPathComponent.lowercased()
-            let dirName = directory.lastPathComponent.lowercased()
-            
-            // Prefer SFF with same name as DEF or directory
-            let preferredSff = sffFiles.first { sff in
-                let sffName = sff.deletingPathExtension().lastPathComponent.lowercased()
-                return sffName == defName || sffName == dirName
-            }
-            
-            if let sffFile = preferredSff ?? sffFiles.first {
-                return SFFParser.extractPortrait(from: sffFile)
-            }
+        guard let contents = try? fileManager.contentsOfDirectory(at: directory, includingPropertiesForKeys: nil) else {
+            return nil
         }
         
-        return nil
+        let sffFiles = contents.filter { $0.pathExtension.lowercased() == "sff" }
+        let defName = defFile.deletingPathExtension().lastPathComponent.lowercased()
+        let dirName = directory.lastPathComponent.lowercased()
+        
+        // Prefer SFF with same name as DEF or directory
+        let preferredSff = sffFiles.first { sff in
+            let sffName = sff.deletingPathExtension().lastPathComponent.lowercased()
+            return sffName == defName || sffName == dirName
+        }
+        
+        return preferredSff ?? sffFiles.first
     }
     
     // MARK: - Hashable
@@ -32,6 +32,8 @@ enum FilterField: String, Codable, CaseIterable {
     case isHD
     case hasAI
     case style                              // POTS, MVC2, etc.
+    case life                               // [Data] life from the indexed CNS
+    case moveCount                          // Special + hyper moves from the indexed CMD
     
     // Stage-specific
     case totalWidth                         // Camera bounds
@@ -4,7 +4,7 @@ import AppKit
 // MARK: - Stage Info
 
 /// Stage metadata parsed from .def files
-public struct StageInfo: Identifiable, Hashable {
+public struct StageInfo: Identifiable, Hashable, Codable {
     public let id: String
     public let name: String
     public let author: String
@@ -48,9 +48,11 @@ public struct StageInfo: Identifiable, Hashable {
     }
     
     /// Load preview image from stage SFF (background sprite)
-    public func loadPreviewImage() -> NSImage? {
+    /// - Parameter maxPixelSize: Longest side of the result (nil = full size); thumbnails
+    ///   pass a size so the sprite is downscaled during decode
+    public func loadPreviewImage(maxPixelSize: Int? = nil) -> NSImage? {
         guard let sff = sffFile else { return nil }
-        return SFFParser.extractStagePreview(from: sff)
+        return SFFParser.extractStagePreview(from: sff, maxPixelSize: maxPixelSize)
     }
     
     /// Automatically inferred tags based on file name, stage name, and author
@@ -71,12 +73,15 @@ public struct StageInfo: Identifiable, Hashable {
             self.modificationDate = nil
         }
         
-        // Parse .def file using shared parser
-        let parsed = DEFParser.parse(url: defFile)
+        // Parse .def file using shared classifier (one read, cached from the stage scan)
+        let classification = DEFClassifier.shared.classify(defFile)
+        let parsed = classification?.parsed
         
         // Get name - use special extractor that handles commented names
         // Some stage files have format: name = "O";"Avalon" where real name is in comment
-        let extractedName = DEFParser.extractStageName(from: defFile)
+        let extractedName = classification?.contentType == .stage
+            ? classification?.stageName
+            : DEFParser.extractStageName(from: defFile)
         let fallbackName = defFile.deletingPathExtension().lastPathComponent
         
         // Use extracted name if valid, otherwise fall back to filename
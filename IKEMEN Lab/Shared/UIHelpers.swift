@@ -485,6 +485,10 @@ public struct BrowserLayout {
     public static let stageGridItemWidth: CGFloat = 320  // Stages are twice as wide
     public static let stageGridItemHeight: CGFloat = 160
     
+    // Thumbnail decode sizes (longest side in pixels, 2x the largest cell for Retina)
+    public static let portraitThumbnailPixelSize = 320
+    public static let stageThumbnailPixelSize = 640
+    
     // List view
     public static let listItemHeight: CGFloat = 52  // Character list rows
     public static let stageListItemHeight: CGFloat = 98  // Stage list rows (includes preview thumbnail)
@@ -95,6 +95,7 @@ class CharacterBrowserView: NSView {
         return queue
     }()
     private var reloadDebounceTimer: Timer?
+    private var scanProgressView: LibraryScanProgressView!
     
     // New collection sheet
     private var newCollectionOverlay: NSView?
@@ -146,6 +147,7 @@ class CharacterBrowserView: NSView {
         layer?.backgroundColor = NSColor.clear.cgColor
         
         setupCollectionView()
+        setupScanProgress()
         setupObservers()
     }
     
@@ -218,6 +220,20 @@ class CharacterBrowserView: NSView {
         ])
     }
     
+    // MARK: - Scan Progress
+    
+    private func setupScanProgress() {
+        scanProgressView = LibraryScanProgressView(content: .characters, itemName: "characters")
+        scanProgressView.translatesAutoresizingMaskIntoConstraints = false
+        addSubview(scanProgressView)
+        
+        NSLayoutConstraint.activate([
+            scanProgressView.centerXAnchor.constraint(equalTo: centerXAnchor),
+            scanProgressView.bottomAnchor.constraint(equalTo: bottomAnchor, constant: -16),
+            scanProgressView.widthAnchor.constraint(lessThanOrEqualTo: widthAnchor, constant: -32),
+        ])
+    }
+    
     // MARK: - Responsive Layout
     
     override func layout() {
@@ -397,8 +413,8 @@ NotificationCenter.default.publisher(for: .customTagsChanged)
             // Check local cache first (for current session quick access)
             if portraitCache[character.id] != nil { continue }
             
-            // Check shared ImageCache
-            let cacheKey = ImageCache.portraitKey(for: character.id)
+            // Check shared ImageCache (grid cells hold thumbnail-sized portraits)
+            let cacheKey = ImageCache.portraitThumbnailKey(for: character.id)
             if let cached = ImageCache.shared.get(cacheKey) {
                 portraitCache[character.id] = cached
                 continue
@@ -407,7 +423,8 @@ NotificationCenter.default.publisher(for: .customTagsChanged)
             let operation = BlockOperation()
             operation.addExecutionBlock { [weak self, weak operation] in
                 guard let operation, !operation.isCancelled else { return }
-                let portrait = character.getPortraitImage()
+                // Persisted thumbnail from an earlier launch, otherwise decoded (and persisted) now
+                let portrait = ImageCache.shared.getPortraitThumbnail(for: character)
                 guard !operation.isCancelled else { return }
                 
                 DispatchQueue.main.async { [weak self] in
@@ -17,6 +17,11 @@ class CharacterDetailsView: NSView {
     private var heroSeriesLabel: NSTextField!
     private var heroDateLabel: NSTextField!
     
+    // Idle animation (action 0, streamed from the SFF one frame at a time)
+    private var idleAnimationView: NSImageView!
+    private var idleAnimation: SFFAnimationStream?
+    private var idleAnimationTimer: Timer?
+    
     // Hero action buttons (shown on hover)
     private var heroActionsContainer: NSStackView!
     private var openFolderButton: NSView!
@@ -29,6 +34,8 @@ class CharacterDetailsView: NSView {
     private var authorValueLabel: NSTextField!  // Direct reference instead of tag lookup
     private var versionStatView: NSView!
     private var versionValueLabel: NSTextField!  // Direct reference instead of tag lookup
+    private var spritesStatView: NSView!
+    private var spritesValueLabel: NSTextField!
     
     // Source info section (from browser extension)
     private var sourceInfoHeader: NSTextField!
@@ -134,6 +141,7 @@ class CharacterDetailsView: NSView {
         if let observer = tagsObserver {
             NotificationCenter.default.removeObserver(observer)
         }
+        idleAnimationTimer?.invalidate()
     }
     
     private func applyTheme() {
@@ -182,6 +190,7 @@ class CharacterDetailsView: NSView {
         defFileNameLabel?.textColor = DesignColors.textTertiary
         authorValueLabel?.textColor = DesignColors.textPrimary
         versionValueLabel?.textColor = DesignColors.textPrimary
+        spritesValueLabel?.textColor = DesignColors.textPrimary
         
         // Update tag badges in tagsContainerView
         for subview in tagsContainerView?.subviews ?? [] {
@@ -304,6 +313,15 @@ class CharacterDetailsView: NSView {
         heroDateLabel.textColor = DesignColors.textSecondary
         badgeRow.addArrangedSubview(heroDateLabel)
         
+        // Idle animation, bottom-right of the hero
+        idleAnimationView = NSImageView()
+        idleAnimationView.translatesAutoresizingMaskIntoConstraints = false
+        idleAnimationView.imageScaling = .scaleProportionallyUpOrDown
+        idleAnimationView.imageAlignment = .alignBottom
+        idleAnimationView.wantsLayer = true
+        idleAnimationView.layer?.magnificationFilter = .nearest
+        heroContainerView.addSubview(idleAnimationView)
+        
         // Hero action buttons container (shown on hover)
         heroActionsContainer = NSStackView()
         heroActionsContainer.translatesAutoresizingMaskIntoConstraints = false
@@ -336,8 +354,13 @@ class CharacterDetailsView: NSView {
         versionStatView = versionResult.card
         versionValueLabel = versionResult.valueLabel
         
+        let spritesResult = createStatCard(title: "Sprites", value: "—")
+        spritesStatView = spritesResult.card
+        spritesValueLabel = spritesResult.valueLabel
+        
         statsGridView.addArrangedSubview(authorStatView)
         statsGridView.addArrangedSubview(versionStatView)
+        statsGridView.addArrangedSubview(spritesStatView)
         
         // === Source Info Section (from browser extension) ===
         sourceInfoHeader = NSTextField(labelWithString: "Source")
@@ -532,7 +555,12 @@ class CharacterDetailsView: NSView {
             
             heroNameLabel.leadingAnchor.constraint(equalTo: heroContainerView.leadingAnchor, constant: padding),
             heroNameLabel.bottomAnchor.constraint(equalTo: badgeRow.topAnchor, constant: -4),
-            heroNameLabel.trailingAnchor.constraint(lessThanOrEqualTo: heroContainerView.trailingAnchor, constant: -padding),
+            heroNameLabel.trailingAnchor.constraint(lessThanOrEqualTo: idleAnimationView.leadingAnchor, constant: -8),
+            
+            idleAnimationView.trailingAnchor.constraint(equalTo: heroContainerView.trailingAnchor, constant: -padding),
+            idleAnimationView.bottomAnchor.constraint(equalTo: heroContainerView.bottomAnchor, constant: -12),
+            idleAnimationView.widthAnchor.constraint(equalToConstant: 120),
+            idleAnimationView.heightAnchor.constraint(equalToConstant: 120),
             
             badgeRow.leadingAnchor.constraint(equalTo: heroContainerView.leadingAnchor, constant: padding),
             badgeRow.bottomAnchor.constraint(equalTo: heroContainerView.bottomAnchor, constant: -padding),
@@ -951,8 +979,11 @@ class CharacterDetailsView: NSView {
         let formattedDate = VersionDateFormatter.formatToStandard(character.versionDate)
         heroDateLabel.stringValue = formattedDate.isEmpty ? "" : "Updated \(formattedDate)"
         
+        // Stats and moves come from the indexed CNS/CMD/AIR structure (parsed only if stale)
+        let structure = CharacterStructureIndexer.shared.structure(for: character)
+        
         // Load extended info (includes CNS stats)
-        let extendedInfo = CharacterExtendedInfo(from: character)
+        let extendedInfo = CharacterExtendedInfo(from: character, structure: structure)
         
         // Quick stats
         authorValueLabel.stringValue = character.author
@@ -960,6 +991,15 @@ class CharacterDetailsView: NSView {
         let versionDateFormatted = VersionDateFormatter.formatToStandard(extendedInfo.versionDate)
         versionValueLabel.stringValue = versionDateFormatted.isEmpty ? "1.0" : versionDateFormatted
         
+        // Sprite file facts from the header-only stats scan
+        if let spriteStats = extendedInfo.spriteStats {
+            spritesValueLabel.stringValue = "\(spriteStats.spriteCount) · SFF v\(spriteStats.version)"
+            spritesStatView.toolTip = CharacterDetailsView.spriteStatsDescription(spriteStats)
+        } else {
+            spritesValueLabel.stringValue = "—"
+            spritesStatView.toolTip = nil
+        }
+        
         // Update attribute bars with real CNS data
         lifeBar.update(value: extendedInfo.life, maxValue: CNSParser.CharacterStats.maxLife)
         atkBar.update(value: extendedInfo.attack, maxValue: CNSParser.CharacterStats.maxAttack)
@@ -968,6 +1008,7 @@ class CharacterDetailsView: NSView {
         
         // Palettes
         updatePalettes(count: extendedInfo.paletteCount)
+        loadPalettePreviews(for: character, count: extendedInfo.paletteCount)
         
         // Tags
         updateTags(for: character)
@@ -976,13 +1017,35 @@ class CharacterDetailsView: NSView {
         loadScrapedMetadata(for: character)
         
         // Load move list
-        loadMoveList(for: character)
+        loadMoveList(structure.moveList)
         
         // Load definition file content
         loadDefinitionFile(for: character)
         
         // Load portrait for hero background
         loadPortrait(for: character)
+        
+        // Play the stand animation
+        loadIdleAnimation(for: character)
+    }
+    
+    /// Tooltip text for the sprites card
+    private static func spriteStatsDescription(_ stats: SFFStats) -> String {
+        let formats = stats.formatCounts
+            .sorted { $0.value != $1.value ? $0.value > $1.value : $0.key < $1.key }
+            .map { "\($0.key) \($0.value)" }
+            .joined(separator: ", ")
+        let decoded = ByteCountFormatter.string(fromByteCount: stats.decodedRGBABytes, countStyle: .memory)
+        
+        var lines = [
+            "\(stats.spriteCount) sprites (\(stats.linkedSpriteCount) linked), \(stats.paletteCount) palettes",
+            "Largest sprite: \(stats.maxSpriteWidth)×\(stats.maxSpriteHeight)",
+            "Decoded size: \(decoded)"
+        ]
+        if !formats.isEmpty {
+            lines.append("Formats: \(formats)")
+        }
+        return lines.joined(separator: "\n")
     }
     
     private func loadPortrait(for character: CharacterInfo) {
@@ -1004,17 +1067,88 @@ class CharacterDetailsView: NSView {
         }
     }
     
-    private func updatePalettes(count: Int) {
+    // MARK: - Idle Animation
+    
+    private func loadIdleAnimation(for character: CharacterInfo) {
+        stopIdleAnimation()
+        
+        DispatchQueue.global(qos: .userInitiated).async { [weak self] in
+            // Only action 0's AIR block is read; the first frames are decoded off the main thread
+            guard let stream = SFFAnimationStream.idle(for: character) else { return }
+            stream.prefetch()
+            
+            DispatchQueue.main.async { [weak self] in
+                guard let self = self, self.currentCharacter?.id == character.id else { return }
+                self.idleAnimation = stream
+                self.showIdleFrame(0, of: stream)
+            }
+        }
+    }
+    
+    /// Show one frame and schedule the next after its duration (ticks at 60 per second)
+    private func showIdleFrame(_ index: Int, of stream: SFFAnimationStream) {
+        guard idleAnimation === stream else { return }
+        idleAnimationView.image = stream.image(at: index)
+        
+        let ticks = stream.frame(at: index).duration
+        guard ticks > 0, stream.frameCount > 1 else { return }  // -1 holds the frame
+        
+        idleAnimationTimer = Timer.scheduledTimer(withTimeInterval: Double(ticks) / 60.0, repeats: false) { [weak self] _ in
+            self?.showIdleFrame(stream.nextFrameIndex(after: index), of: stream)
+        }
+    }
+    
+    private func stopIdleAnimation() {
+        idleAnimationTimer?.invalidate()
+        idleAnimationTimer = nil
+        idleAnimation = nil
+        idleAnimationView.image = nil
+    }
+    
+    private func loadPalettePreviews(for character: CharacterInfo, count: Int) {
+        DispatchQueue.global(qos: .userInitiated).async { [weak self] in
+            // One sprite decode, then one palette expansion per preview
+            let previews = SFFPalettePreview.shared.previews(for: character, maxPixelSize: 48)
+            
+            DispatchQueue.main.async { [weak self] in
+                guard let self = self, !previews.isEmpty,
+                      self.currentCharacter?.id == character.id else { return }
+                self.updatePalettes(count: max(count, previews.count), previews: previews)
+            }
+        }
+    }
+    
+    private func updatePalettes(count: Int, previews: [PalettePreview] = []) {
         palettesHeader.stringValue = "Palettes (\(count))"
         
         // Clear existing
         paletteStackView.arrangedSubviews.forEach { $0.removeFromSuperview() }
         
-        // Add palette dots (up to 6, then +N)
+        // Add palette dots (up to 6, then +N); rendered previews replace the dots once loaded
         let colors: [NSColor] = [.white, DesignColors.borderSubtle, .systemBlue, .systemRed, .systemPurple, .systemYellow]
         let displayCount = min(count, 6)
         
         for i in 0..<displayCount {
+            if i < previews.count {
+                let preview = NSImageView(image: previews[i].image)
+                preview.translatesAutoresizingMaskIntoConstraints = false
+                preview.imageScaling = .scaleProportionallyUpOrDown
+                preview.wantsLayer = true
+                preview.layer?.cornerRadius = 6
+                preview.layer?.backgroundColor = DesignColors.cardBackground.cgColor
+                preview.layer?.borderWidth = 1
+                preview.layer?.borderColor = DesignColors.borderSubtle.cgColor
+                preview.toolTip = "Palette \(previews[i].number)"
+                
+                NSLayoutConstraint.activate([
+                    preview.widthAnchor.constraint(equalToConstant: 40),
+                    preview.heightAnchor.constraint(equalToConstant: 40),
+                ])
+                
+                paletteStackView.addArrangedSubview(preview)
+                continue
+            }
+            
             let dot = NSView()
             dot.translatesAutoresizingMaskIntoConstraints = false
             dot.wantsLayer = true
@@ -1156,11 +1290,9 @@ class CharacterDetailsView: NSView {
     
     // MARK: - Move List
     
-    private func loadMoveList(for character: CharacterInfo) {
+    private func loadMoveList(_ moves: [MoveCommand]) {
         moveListStackView.arrangedSubviews.forEach { $0.removeFromSuperview() }
         
-        let moves = CMDParser.parseMoves(for: character)
-        
         if moves.isEmpty {
             let noMovesLabel = NSTextField(labelWithString: "No special moves found")
             noMovesLabel.font = NSFont.systemFont(ofSize: 12, weight: .regular)
@@ -1319,9 +1451,12 @@ class CharacterDetailsView: NSView {
         heroNameLabel.stringValue = "Select a Character"
         heroDateLabel.stringValue = ""
         heroImageView.image = nil
+        stopIdleAnimation()
         
         authorValueLabel.stringValue = "—"
         versionValueLabel.stringValue = "—"
+        spritesValueLabel.stringValue = "—"
+        spritesStatView.toolTip = nil
         
         // Hide source info section
         sourceInfoHeader.isHidden = true
@@ -1468,13 +1603,16 @@ struct CharacterExtendedInfo {
     let mugenVersion: String
     let versionDate: String
     
+    /// Header-derived facts about the character's sprite file
+    let spriteStats: SFFStats?
+    
     // Stats from CNS file
     let life: Int
     let attack: Int
     let defence: Int
     let power: Int
     
-    init(from character: CharacterInfo) {
+    init(from character: CharacterInfo, structure: CharacterStructureRecord) {
         let defFile = character.defFile
         
         var palCount = 0
@@ -1518,244 +1656,20 @@ struct CharacterExtendedInfo {
             }
         }
         
-        self.paletteCount = max(palCount, 1)
+        // SFFv2 characters can ship their palettes inside the sprite file (group 1, items 1-12)
+        let spriteStats = SFFStatsScanner.shared.stats(for: character)
+        let sffPalCount = spriteStats?.characterPaletteCount ?? 0
+        
+        self.spriteStats = spriteStats
+        self.paletteCount = max(palCount, sffPalCount, 1)
         self.mugenVersion = mugenVer
         self.versionDate = verDate
         
-        // Load stats from CNS file
-        let stats = CNSParser.getStats(for: character.directory, defFile: defFile)
+        // Stats from the indexed CNS
+        let stats = structure.stats
         self.life = stats.life
         self.attack = stats.attack
         self.defence = stats.defence
         self.power = stats.power
     }
 }
-
-// MARK: - Move Command
-
-struct MoveCommand {
-    let name: String       // Internal name (e.g., "SpecialX")
-    let displayName: String // Human-readable name
-    let command: String    // Raw command (e.g., "~D,DF,F, x")
-    let notation: String   // Pretty notation (e.g., "↓↘→ + LP")
-}
-
-// MARK: - CMD Parser
-
-struct CMDParser {
-    
-    /// Parse special moves from a character's CMD file
-    static func parseMoves(for character: CharacterInfo) -> [MoveCommand] {
-        // Find CMD file
-        guard let cmdFile = findCMDFile(for: character),
-              let content = try? String(contentsOf: cmdFile, encoding: .utf8) else {
-            return []
-        }
-        
-        var moves: [MoveCommand] = []
-        var seenCommands = Set<String>()
-        
-        let lines = content.components(separatedBy: .newlines)
-        var currentName: String?
-        var currentCommand: String?
-        
-        for line in lines {
-            let trimmed = line.trimmingCharacters(in: .whitespaces)
-            
-            // Skip comments and empty lines
-            if trimmed.isEmpty || trimmed.hasPrefix(";") {
-                continue
-            }
-            
-            let lower = trimmed.lowercased()
-            
-            // Parse name = "..."
-            if lower.hasPrefix("name") && lower.contains("=") {
-                if let nameMatch = extractQuotedValue(from: trimmed) {
-                    currentName = nameMatch
-                }
-            }
-            
-            // Parse command = ...
-            if lower.hasPrefix("command") && lower.contains("=") {
-                if let eqIdx = trimmed.firstIndex(of: "=") {
-                    currentCommand = String(trimmed[trimmed.index(after: eqIdx)...]).trimmingCharacters(in: .whitespaces)
-                }
-            }
-            
-            // If we have both name and command, create a move
-            if let name = currentName, let command = currentCommand {
-                // Skip AI commands and basic movement
-                let skipPrefixes = ["AI_", "holdfwd", "holdback", "holdup", "holddown", "recovery", "fwd", "back", "up", "down"]
-                let shouldSkip = skipPrefixes.contains { name.lowercased().hasPrefix($0.lowercased()) } ||
-                                 name.lowercased() == "run" ||
-                                 name.lowercased() == "dash"
-                
-                // Only include special/hyper moves
-                if !shouldSkip && isSpecialMove(command: command) {
-                    let key = "\(name)|\(command)"
-                    if !seenCommands.contains(key) {
-                        seenCommands.insert(key)
-                        
-                        let displayName = formatMoveName(name)
-                        let notation = formatNotation(command)
-                        
-                        moves.append(MoveCommand(
-                            name: name,
-                            displayName: displayName,
-                            command: command,
-                            notation: notation
-                        ))
-                    }
-                }
-                
-                currentName = nil
-                currentCommand = nil
-            }
-        }
-        
-        // Sort: Hypers first, then specials
-        return moves.sorted { m1, m2 in
-            let isHyper1 = m1.name.lowercased().contains("hyper") || m1.name.lowercased().contains("super")
-            let isHyper2 = m2.name.lowercased().contains("hyper") || m2.name.lowercased().contains("super")
-            if isHyper1 != isHyper2 { return isHyper1 }
-            return m1.displayName < m2.displayName
-        }
-    }
-    
-    private static func findCMDFile(for character: CharacterInfo) -> URL? {
-        let fileManager = FileManager.default
-        
-        // First, check the DEF file for cmd reference
-        if let content = DEFParser.readFileContent(from: character.defFile) {
-            let lines = content.components(separatedBy: .newlines)
-            for line in lines {
-                let trimmed = line.trimmingCharacters(in: .whitespaces).lowercased()
-                if trimmed.hasPrefix("cmd") && trimmed.contains("=") {
-                    if let eqIdx = line.firstIndex(of: "=") {
-                        let cmdName = String(line[line.index(after: eqIdx)...]).trimmingCharacters(in: .whitespaces)
-                        let cmdPath = character.directory.appendingPathComponent(cmdName)
-                        if fileManager.fileExists(atPath: cmdPath.path) {
-                            return cmdPath
-                        }
-                    }
-                }
-            }
-        }
-        
-        // Fallback: look for .cmd file with same name as character
-        let defName = character.defFile.deletingPathExtension().lastPathComponent
-        let cmdFile = character.directory.appendingPathComponent("\(defName).cmd")
-        if fileManager.fileExists(atPath: cmdFile.path) {
-            return cmdFile
-        }
-        
-        // Last resort: any .cmd file
-        if let contents = try? fileManager.contentsOfDirectory(at: character.directory, includingPropertiesForKeys: nil) {
-            return contents.first { $0.pathExtension.lowercased() == "cmd" }
-        }
-        
-        return nil
-    }
-    
-    private static func extractQuotedValue(from line: String) -> String? {
-        guard let firstQuote = line.firstIndex(of: "\""),
-              let lastQuote = line.lastIndex(of: "\""),
-              firstQuote != lastQuote else {
-            return nil
-        }
-        return String(line[line.index(after: firstQuote)..<lastQuote])
-    }
-    
-    private static func isSpecialMove(command: String) -> Bool {
-        let lower = command.lowercased()
-        // Special moves typically have direction sequences
-        let hasDirectionSequence = lower.contains("~d") || lower.contains("~f") || lower.contains("~b") ||
-                                   lower.contains(",d") || lower.contains(",f") || lower.contains(",b") ||
-                                   lower.contains("df") || lower.contains("db") || lower.contains("uf") || lower.contains("ub")
-        // And end with a button
-        let hasButton = lower.contains("x") || lower.contains("y") || lower.contains("z") ||
-                       lower.contains("a") || lower.contains("b") || lower.contains("c")
-        return hasDirectionSequence && hasButton
-    }
-    
-    private static func formatMoveName(_ name: String) -> String {
-        // Convert "SpecialX" to "Special X", "Hyper1" to "Hyper 1", etc.
-        let result = name
-        
-        // Insert space before capital letters and numbers
-        var formatted = ""
-        for (i, char) in result.enumerated() {
-            if i > 0 && (char.isUppercase || char.isNumber) {
-                let prevChar = result[result.index(result.startIndex, offsetBy: i - 1)]
-                if !prevChar.isUppercase && !prevChar.isNumber && prevChar != " " {
-                    formatted += " "
-                }
-            }
-            formatted += String(char)
-        }
-        
-        return formatted
-    }
-    
-    private static func formatNotation(_ command: String) -> String {
-        var result = command
-            .replacingOccurrences(of: " ", with: "")
-            .replacingOccurrences(of: "~", with: "")
-        
-        // Direction mappings
-        let directionMap: [(String, String)] = [
-            ("DF", "↘"),
-            ("DB", "↙"),
-            ("UF", "↗"),
-            ("UB", "↖"),
-            ("D", "↓"),
-            ("U", "↑"),
-            ("F", "→"),
-            ("B", "←"),
-        ]
-        
-        // Button mappings (case-sensitive for final output)
-        let buttonMap: [(String, String)] = [
-            ("x+y", "LP+MP"),
-            ("y+z", "MP+HP"),
-            ("x+z", "LP+HP"),
-            ("a+b", "LK+MK"),
-            ("b+c", "MK+HK"),
-            ("a+c", "LK+HK"),
-            ("x", "LP"),
-            ("y", "MP"),
-            ("z", "HP"),
-            ("a", "LK"),
-            ("b", "MK"),
-            ("c", "HK"),
-        ]
-        
-        // Apply direction mappings (case-insensitive)
-        for (from, to) in directionMap {
-            result = result.replacingOccurrences(of: from, with: to, options: .caseInsensitive)
-        }
-        
-        // Apply button mappings
-        for (from, to) in buttonMap {
-            result = result.replacingOccurrences(of: from, with: to, options: .caseInsensitive)
-        }
-        
-        // Clean up separators
-        result = result.replacingOccurrences(of: ",", with: " ")
-        
-        // Add + before button at the end
-        let buttons = ["LP", "MP", "HP", "LK", "MK", "HK", "LP+MP", "MP+HP", "LP+HP", "LK+MK", "MK+HK", "LK+HK"]
-        for button in buttons {
-            if result.hasSuffix(button) && !result.hasSuffix("+ \(button)") {
-                let prefix = String(result.dropLast(button.count)).trimmingCharacters(in: .whitespaces)
-                if !prefix.isEmpty {
-                    result = "\(prefix) + \(button)"
-                }
-                break
-            }
-        }
-        
-        return result
-    }
-}
@@ -1501,7 +1501,7 @@ class RosterEntryItem: NSCollectionViewItem {
         
         // Find the character in the bridge's loaded characters
         if let character = IkemenBridge.shared.characters.first(where: { $0.directory.lastPathComponent == folder }) {
-            if let cached = ImageCache.shared.getPortrait(for: character) {
+            if let cached = ImageCache.shared.getPortraitThumbnail(for: character) {
                 thumbnailView.image = cached
                 thumbnailView.contentTintColor = nil
             }
@@ -1748,7 +1748,7 @@ class StageEntryItem: NSCollectionViewItem {
         // Prefer the resolved stage's id for cache parity with StageBrowserView
         // (which keys previews by stage.id). Fall back to the folder string when
         // we couldn't resolve a stage so the call still has a stable key.
-        let cacheKey = ImageCache.stagePreviewKey(for: stageInfo?.id ?? folder)
+        let cacheKey = ImageCache.stagePreviewThumbnailKey(for: stageInfo?.id ?? folder)
         if let cached = ImageCache.shared.get(cacheKey) {
             showThumbnail(cached)
             return
@@ -1760,7 +1760,7 @@ class StageEntryItem: NSCollectionViewItem {
 
             // Try SFF extraction first (most common source)
             if let stage = stageInfo {
-                image = stage.loadPreviewImage()
+                image = stage.loadPreviewImage(maxPixelSize: BrowserLayout.stageThumbnailPixelSize)
             }
 
             // Update UI on main thread
@@ -0,0 +1,134 @@
+import Cocoa
+import Combine
+
+// MARK: - Library Scan Progress View
+
+/// Progress bar with a Cancel button, shown at the bottom of a browser while its content is scanned
+///
+/// Follows `IkemenBridge.libraryScanProgress` and hides itself whenever no scan of `content`
+/// is running. Cancel stops the scan through `IkemenBridge.cancelLibraryScan()`.
+class LibraryScanProgressView: NSView {
+    
+    private var progressIndicator: NSProgressIndicator!
+    private var statusLabel: NSTextField!
+    private var cancelButton: NSButton!
+    private var cancellables = Set<AnyCancellable>()
+    private var themeObserver: NSObjectProtocol?
+    private var isCancelling = false
+    
+    /// Content kind this view reports on (.characters or .stages)
+    private let content: LibraryScanner.Scope
+    private let itemName: String
+    
+    init(content: LibraryScanner.Scope, itemName: String) {
+        self.content = content
+        self.itemName = itemName
+        super.init(frame: .zero)
+        setup()
+        setupObservers()
+    }
+    
+    required init?(coder: NSCoder) {
+        fatalError("init(coder:) has not been implemented")
+    }
+    
+    deinit {
+        if let observer = themeObserver {
+            NotificationCenter.default.removeObserver(observer)
+        }
+    }
+    
+    private func setup() {
+        wantsLayer = true
+        layer?.cornerRadius = 10
+        layer?.borderWidth = 1
+        isHidden = true
+        
+        progressIndicator = NSProgressIndicator()
+        progressIndicator.translatesAutoresizingMaskIntoConstraints = false
+        progressIndicator.style = .bar
+        progressIndicator.isIndeterminate = false
+        progressIndicator.minValue = 0
+        progressIndicator.maxValue = 1
+        progressIndicator.controlSize = .small
+        addSubview(progressIndicator)
+        
+        statusLabel = NSTextField(labelWithString: "")
+        statusLabel.translatesAutoresizingMaskIntoConstraints = false
+        statusLabel.font = DesignFonts.caption(size: 12)
+        statusLabel.lineBreakMode = .byTruncatingTail
+        statusLabel.setContentCompressionResistancePriority(.defaultLow, for: .horizontal)
+        addSubview(statusLabel)
+        
+        cancelButton = NSButton(title: "Cancel", target: self, action: #selector(cancelTapped))
+        cancelButton.translatesAutoresizingMaskIntoConstraints = false
+        cancelButton.bezelStyle = .inline
+        cancelButton.isBordered = false
+        cancelButton.font = DesignFonts.body(size: 13)
+        addSubview(cancelButton)
+        
+        applyTheme()
+        
+        NSLayoutConstraint.activate([
+            heightAnchor.constraint(equalToConstant: 36),
+        
+            statusLabel.leadingAnchor.constraint(equalTo: leadingAnchor, constant: 14),
+            statusLabel.centerYAnchor.constraint(equalTo: centerYAnchor),
+            statusLabel.widthAnchor.constraint(lessThanOrEqualToConstant: 220),
+        
+            progressIndicator.leadingAnchor.constraint(equalTo: statusLabel.trailingAnchor, constant: 12),
+            progressIndicator.centerYAnchor.constraint(equalTo: centerYAnchor),
+            progressIndicator.widthAnchor.constraint(greaterThanOrEqualToConstant: 120),
+        
+            cancelButton.leadingAnchor.constraint(equalTo: progressIndicator.trailingAnchor, constant: 12),
+            cancelButton.trailingAnchor.constraint(equalTo: trailingAnchor, constant: -12),
+            cancelButton.centerYAnchor.constraint(equalTo: centerYAnchor),
+        ])
+    }
+    
+    private func setupObservers() {
+        IkemenBridge.shared.$libraryScanProgress
+            .receive(on: DispatchQueue.main)
+            .sink { [weak self] progress in
+                self?.update(progress)
+            }
+            .store(in: &cancellables)
+        
+        themeObserver = NotificationCenter.default.addObserver(
+            forName: .themeChanged,
+            object: nil,
+            queue: .main
+        ) { [weak self] _ in
+            self?.applyTheme()
+        }
+    }
+    
+    private func update(_ progress: LibraryScanner.Progress?) {
+        guard let progress = progress, IkemenBridge.shared.libraryScanContent == content else {
+            isHidden = true
+            isCancelling = false
+            cancelButton.isEnabled = true
+            return
+        }
+        
+        isHidden = false
+        progressIndicator.doubleValue = progress.fractionCompleted
+        guard !isCancelling else { return }
+        statusLabel.stringValue = "Scanning \(itemName)… \(progress.entriesSeen) of \(progress.totalEntries)"
+    }
+    
+    private func applyTheme() {
+        layer?.backgroundColor = DesignColors.toastBackground.cgColor
+        layer?.borderColor = DesignColors.toastBorder.cgColor
+        statusLabel.textColor = DesignColors.textSecondary
+        cancelButton.contentTintColor = DesignColors.negative
+    }
+    
+    @objc private func cancelTapped() {
+        // Stays visible until the scan actually stops and clears its progress
+        isCancelling = true
+        cancelButton.isEnabled = false
+        statusLabel.stringValue = "Cancelling…"
+        IkemenBridge.shared.cancelLibraryScan()
+    }
+}
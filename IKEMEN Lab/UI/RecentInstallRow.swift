@@ -297,7 +297,7 @@ class RecentInstallRow: NSView, ThemeApplicable {
                 if let spriteFileName = parsed?.spriteFile {
                     let sffFile = folderURL.appendingPathComponent(spriteFileName)
                     if fileManager.fileExists(atPath: sffFile.path) {
-                        return SFFParser.extractPortrait(from: sffFile)
+                        return SFFParser.extractPortrait(from: sffFile, maxPixelSize: BrowserLayout.portraitThumbnailPixelSize)
                     }
                 }
             }
@@ -305,7 +305,7 @@ class RecentInstallRow: NSView, ThemeApplicable {
             // Fallback: try any SFF file
             let sffFiles = contents.filter { $0.pathExtension.lowercased() == "sff" }
             if let sffFile = sffFiles.first {
-                return SFFParser.extractPortrait(from: sffFile)
+                return SFFParser.extractPortrait(from: sffFile, maxPixelSize: BrowserLayout.portraitThumbnailPixelSize)
             }
         }
         
@@ -333,7 +333,7 @@ class RecentInstallRow: NSView, ThemeApplicable {
                 }
                 
                 if fileManager.fileExists(atPath: sffURL.path) {
-                    return SFFParser.extractStagePreview(from: sffURL)
+                    return SFFParser.extractStagePreview(from: sffURL, maxPixelSize: BrowserLayout.stageThumbnailPixelSize)
                 }
             }
         }
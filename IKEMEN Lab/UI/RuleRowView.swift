@@ -48,6 +48,8 @@ class RuleRowView: NSView {
         ("Date Added", .installedAt),
         ("Is HD", .isHD),
         ("Has AI", .hasAI),
+        ("Life", .life),
+        ("Special + Hyper Moves", .moveCount),
     ]
     
     // MARK: - Initialization
@@ -200,7 +202,7 @@ class RuleRowView: NSView {
             comparisons = [
                 ("is", .equals),
             ]
-        case .totalWidth:
+        case .totalWidth, .life, .moveCount:
             comparisons = [
                 ("equals", .equals),
                 ("greater than", .greaterThan),
@@ -435,6 +437,8 @@ class RuleRowView: NSView {
         case .name: return "Character name..."
         case .author: return "Author name..."
         case .tag: return "Type to add tag..."
+        case .life: return "1000"
+        case .moveCount: return "5"
         default: return ""
         }
     }
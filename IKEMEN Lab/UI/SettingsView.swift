@@ -25,6 +25,9 @@ class SettingsView: NSView {
     /// Reference to the main area view, used to look up volume slider labels.
     weak var parentView: NSView?
     
+    /// Whether a sprite compaction run started from this view is in progress
+    private var isCompactingSprites = false
+    
     // MARK: - Initialization
     
     override init(frame frameRect: NSRect) {
@@ -114,6 +117,12 @@ class SettingsView: NSView {
                 description: "Clears cached character portraits and stage previews. Use if images appear outdated.",
                 action: #selector(clearImageCache(_:))
             ),
+            createButtonSetting(
+                label: "Sprite Files",
+                buttonTitle: "Compact Sprites…",
+                description: "Re-encodes character SFFv2 files losslessly to save disk space. Each file is verified before it replaces the original; a cancelled run resumes where it stopped.",
+                action: #selector(compactSpriteFiles(_:))
+            ),
         ])
         stackView.addArrangedSubview(maintenanceSection)
         
@@ -377,4 +386,48 @@ class SettingsView: NSView {
         
         NotificationCenter.default.post(name: NSNotification.Name("ImageCacheCleared"), object: nil)
     }
+    
+    @objc private func compactSpriteFiles(_ sender: NSButton) {
+        // The same button cancels a run in progress
+        if isCompactingSprites {
+            SFFTranscoder.shared.cancel()
+            sender.title = "Cancelling…"
+            sender.isEnabled = false
+            return
+        }
+        
+        let alert = NSAlert()
+        alert.messageText = "Compact Sprite Files?"
+        alert.informativeText = "Sprite files in your characters folder will be rewritten in place with smaller lossless encodings. Files that are already compact or can't be verified are left untouched."
+        alert.alertStyle = .informational
+        alert.addButton(withTitle: "Compact")
+        alert.addButton(withTitle: "Cancel")
+        guard alert.runModal() == .alertFirstButtonReturn else { return }
+        
+        isCompactingSprites = true
+        sender.title = "Cancel"
+        
+        SFFTranscoder.shared.transcodeLibrary(IkemenBridge.shared.characters, progress: { [weak sender] done, total in
+            sender?.title = "Cancel (\(done)/\(total))"
+        }, completion: { [weak self, weak sender] report in
+            self?.isCompactingSprites = false
+            sender?.title = "Compact Sprites…"
+            sender?.isEnabled = true
+            
+            var details = [report.summary]
+            if report.wasCancelled {
+                details.append("Run it again to continue where it stopped.")
+            }
+            for failure in report.failures.prefix(5) {
+                details.append("\(URL(fileURLWithPath: failure.path).lastPathComponent): \(failure.detail ?? "failed")")
+            }
+            
+            let done = NSAlert()
+            done.messageText = report.wasCancelled ? "Compaction Stopped" : "Sprite Files Compacted"
+            done.informativeText = details.joined(separator: "\n\n")
+            done.alertStyle = report.failures.isEmpty ? .informational : .warning
+            done.addButton(withTitle: "OK")
+            done.runModal()
+        })
+    }
 }
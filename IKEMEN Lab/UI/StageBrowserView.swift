@@ -64,6 +64,7 @@ class StageBrowserView: NSView {
     private var stages: [StageInfo] = []     // Filtered stages for display
     private var cancellables = Set<AnyCancellable>()
     private var themeObserver: NSObjectProtocol?
+    private var scanProgressView: LibraryScanProgressView!
     
     // Registration status filter
     var registrationFilter: RegistrationFilter = .all {
@@ -99,6 +100,7 @@ class StageBrowserView: NSView {
         layer?.backgroundColor = NSColor.clear.cgColor
         
         setupCollectionView()
+        setupScanProgress()
         setupObservers()
     }
     
@@ -153,6 +155,20 @@ class StageBrowserView: NSView {
         ])
     }
     
+    // MARK: - Scan Progress
+    
+    private func setupScanProgress() {
+        scanProgressView = LibraryScanProgressView(content: .stages, itemName: "stages")
+        scanProgressView.translatesAutoresizingMaskIntoConstraints = false
+        addSubview(scanProgressView)
+        
+        NSLayoutConstraint.activate([
+            scanProgressView.centerXAnchor.constraint(equalTo: centerXAnchor),
+            scanProgressView.bottomAnchor.constraint(equalTo: bottomAnchor, constant: -16),
+            scanProgressView.widthAnchor.constraint(lessThanOrEqualTo: widthAnchor, constant: -32),
+        ])
+    }
+    
     // MARK: - Responsive Layout
     
     override func layout() {
@@ -913,7 +929,7 @@ class StageListItem: NSCollectionViewItem {
     
     private func loadPreviewImage(for stage: StageInfo) {
         // Check cache first
-        let cacheKey = ImageCache.stagePreviewKey(for: stage.id)
+        let cacheKey = ImageCache.stagePreviewThumbnailKey(for: stage.id)
         if let cached = ImageCache.shared.get(cacheKey) {
             previewImageView.image = cached
             return
@@ -922,9 +938,8 @@ class StageListItem: NSCollectionViewItem {
         // Load preview image asynchronously
         previewImageView.image = nil
         DispatchQueue.global(qos: .userInitiated).async { [weak self] in
-            if let image = stage.loadPreviewImage() {
-                // Store in cache
-                ImageCache.shared.set(image, for: cacheKey)
+            // Persisted thumbnail from an earlier launch, otherwise decoded (and persisted) now
+            if let image = ImageCache.shared.getStagePreviewThumbnail(for: stage) {
                 DispatchQueue.main.async { [weak self] in
                     self?.previewImageView.image = image
                 }
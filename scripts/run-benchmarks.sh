@@ -0,0 +1,55 @@
+#!/bin/bash
+
+# IKEMEN Lab — Library Benchmark
+# Generates a synthetic library and reports cold/warm scan, reindex, thumbnail throughput
+# and peak memory as JSON. Compare reports across releases to catch regressions.
+# Also runs the per-component XCTest measure timings (parsers, sprite codecs, palette kernel).
+#
+# Usage:
+#   ./scripts/run-benchmarks.sh                          # 500 characters, 50 stages
+#   CHARACTERS=5000 STAGES=300 ./scripts/run-benchmarks.sh
+#   OUTPUT=bench.json SFF_VERSIONS=1,2 ./scripts/run-benchmarks.sh
+#
+# Options (environment):
+#   CHARACTERS, STAGES     Library size
+#   SPRITES                Filler sprites per character (besides the portraits)
+#   SFF_VERSIONS           Comma-separated SFF versions cycled per character (default 2,2,2,1)
+#   SELECT_FRACTION        Share of characters listed in select.def (0-1)
+#   SEED                   Generator seed
+#   OUTPUT                 Report path (default: build/benchmark-<timestamp>.json)
+
+set -euo pipefail
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_DIR="$(cd "${SCRIPT_DIR}/.." && pwd)"
+OUTPUT="${OUTPUT:-${PROJECT_DIR}/build/benchmark-$(date +%Y%m%d-%H%M%S).json}"
+
+mkdir -p "$(dirname "$OUTPUT")"
+OUTPUT="$(cd "$(dirname "$OUTPUT")" && pwd)/$(basename "$OUTPUT")"
+
+echo "📊 Benchmarking ${CHARACTERS:-500} characters, ${STAGES:-50} stages..."
+
+# xcodebuild forwards TEST_RUNNER_-prefixed variables to the test process without the prefix
+TEST_RUNNER_IKEMEN_BENCHMARK=1 \
+TEST_RUNNER_IKEMEN_BENCHMARK_CHARACTERS="${CHARACTERS:-}" \
+TEST_RUNNER_IKEMEN_BENCHMARK_STAGES="${STAGES:-}" \
+TEST_RUNNER_IKEMEN_BENCHMARK_SPRITES="${SPRITES:-}" \
+TEST_RUNNER_IKEMEN_BENCHMARK_SFF_VERSIONS="${SFF_VERSIONS:-}" \
+TEST_RUNNER_IKEMEN_BENCHMARK_SELECT_FRACTION="${SELECT_FRACTION:-}" \
+TEST_RUNNER_IKEMEN_BENCHMARK_SEED="${SEED:-}" \
+TEST_RUNNER_IKEMEN_BENCHMARK_OUTPUT="$OUTPUT" \
+xcodebuild test \
+    -project "${PROJECT_DIR}/IKEMEN Lab.xcodeproj" \
+    -scheme "IKEMEN Lab" \
+    -destination "platform=macOS" \
+    -only-testing:"IKEMEN Lab Tests/LibraryBenchmarkTests" \
+    -only-testing:"IKEMEN Lab Tests/ComponentBenchmarkTests" \
+    -quiet
+
+if [ ! -f "$OUTPUT" ]; then
+    echo "❌ Benchmark did not produce a report"
+    exit 1
+fi
+
+echo "✅ Report written to $OUTPUT"
+cat "$OUTPUT"